@@ -1,38 +1,522 @@
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
 #include "buffer/buffer_pool_manager.h"
+#include "common/perf_trace.h"
 
 namespace cmudb {
 
+// flush passes between two rewrites of the warmup sidecar
+static const int WARMUP_SAVE_INTERVAL = 16;
+
 /*
  * BufferPoolManager Constructor
  * When log_manager is nullptr, logging is disabled (for test purpose)
- * WARNING: Do Not Edit This Function
+ * The single-argument form keeps the historical behavior of one global
+ * partition
  */
 BufferPoolManager::BufferPoolManager(size_t pool_size,
                                      DiskManager *disk_manager,
                                      LogManager *log_manager)
-        : pool_size_(pool_size), disk_manager_(disk_manager),
-          log_manager_(log_manager) {
-    // a consecutive memory space for buffer pool
-    pages_ = new Page[pool_size_];
-    page_table_ = new ExtendibleHash<page_id_t, Page *>(BUCKET_SIZE);
-    replacer_ = new LRUReplacer<Page *>;
-    free_list_ = new std::list<Page *>;
+        : BufferPoolManager(pool_size, 1, disk_manager, log_manager) {}
+
+/*
+ * Partitioned BufferPoolManager Constructor
+ * Pool frames are divided evenly across num_shards shards, each shard owns
+ * its own page table, replacer, free list and latch
+ */
+BufferPoolManager::BufferPoolManager(size_t pool_size, size_t num_shards,
+                                     DiskManager *disk_manager,
+                                     LogManager *log_manager,
+                                     ReplacerType replacer_type)
+        : pool_size_(pool_size), num_shards_(num_shards),
+          disk_manager_(disk_manager), log_manager_(log_manager) {
+    // a shard without a frame could never serve a fetch
+    if (num_shards_ == 0 || num_shards_ > pool_size_) {
+        num_shards_ = 1;
+    }
 
-    // put all the pages into free list
-    for (size_t i = 0; i < pool_size_; ++i) {
-        free_list_->push_back(&pages_[i]);
+    shards_ = new Shard[num_shards_];
+
+    for (size_t i = 0; i < num_shards_; ++i) {
+        shards_[i].page_table_ =
+                new StripedHashTable<page_id_t, Page *>(PAGE_TABLE_STRIPES);
+        if (replacer_type == ReplacerType::LRU_K) {
+            shards_[i].replacer_ = new LRUKReplacer<Page *>;
+        } else if (replacer_type == ReplacerType::SAMPLING) {
+            // room for every frame the shard could ever own, plus slack
+            // so the open-addressed probe stays short
+            shards_[i].replacer_ = new SamplingReplacer<Page *>(
+                    4 * (pool_size_ / num_shards_));
+        } else {
+            shards_[i].replacer_ = new LRUReplacer<Page *>;
+        }
     }
+
+    // one frame segment per shard rather than one block for the pool: the
+    // segment is constructed (first-touched) on a CPU chosen for the shard,
+    // so with the kernel's first-touch policy each shard's frames live on
+    // that CPU's memory node. Workers pinned by the same convention (shard
+    // i <-> cpu i * ncpus / num_shards) then fetch from local memory
+    for (size_t i = 0; i < num_shards_; ++i) {
+        size_t num_frames =
+                pool_size_ / num_shards_ + (i < pool_size_ % num_shards_ ? 1 : 0);
+        Page *segment = AllocateFrameSegment(num_frames, i);
+        for (size_t j = 0; j < num_frames; ++j) {
+            shards_[i].free_list_.push_back(&segment[j]);
+        }
+    }
+}
+
+// preferred backing granule for frame segments
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+/*
+ * Allocate and construct one segment of frames on a thread bound to the
+ * shard's CPU, so the memory is first-touched (and therefore placed) near
+ * the workers that will use the shard. Affinity is best effort: on a
+ * single-CPU host or if binding fails the segment is simply allocated
+ * wherever the thread runs.
+ *
+ * The segment is carved 2MB-aligned out of an anonymous mapping and advised
+ * to use transparent huge pages, cutting TLB misses on Page::data_ accesses
+ * for large pools; when mmap fails the segment falls back to operator new[]
+ */
+Page *BufferPoolManager::AllocateFrameSegment(size_t num_frames,
+                                              size_t shard_index) {
+    Page *segment = nullptr;
+    void *map_base = nullptr;
+    size_t map_bytes = 0;
+
+    std::thread allocator([&] {
+        unsigned num_cpus = std::thread::hardware_concurrency();
+        if (num_cpus > 1) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET((shard_index * num_cpus / num_shards_) % num_cpus, &cpus);
+            pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        }
+
+        // over-map by one granule so the usable range can be aligned to a
+        // huge page boundary, then trim the unaligned head and tail
+        size_t bytes = ((num_frames * sizeof(Page) + HUGE_PAGE_SIZE - 1) /
+                        HUGE_PAGE_SIZE) *
+                       HUGE_PAGE_SIZE;
+        void *raw = mmap(nullptr, bytes + HUGE_PAGE_SIZE,
+                         PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                         -1, 0);
+        if (raw != MAP_FAILED) {
+            uintptr_t raw_addr = reinterpret_cast<uintptr_t>(raw);
+            uintptr_t aligned =
+                    (raw_addr + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+            if (aligned != raw_addr) {
+                munmap(raw, aligned - raw_addr);
+            }
+            size_t tail = raw_addr + HUGE_PAGE_SIZE - aligned;
+            if (tail != 0) {
+                munmap(reinterpret_cast<void *>(aligned + bytes), tail);
+            }
+            map_base = reinterpret_cast<void *>(aligned);
+            map_bytes = bytes;
+            madvise(map_base, map_bytes, MADV_HUGEPAGE);
+
+            segment = static_cast<Page *>(map_base);
+            for (size_t i = 0; i < num_frames; ++i) {
+                new (&segment[i]) Page();
+            }
+        } else {
+            segment = new Page[num_frames];
+        }
+    });
+    allocator.join();
+
+    page_segments_.push_back(segment);
+    segment_sizes_.push_back(num_frames);
+    segment_map_bases_.push_back(map_base);
+    segment_map_bytes_.push_back(map_bytes);
+    return segment;
 }
 
 /*
  * BufferPoolManager Deconstructor
- * WARNING: Do Not Edit This Function
  */
 BufferPoolManager::~BufferPoolManager() {
-    delete[] pages_;
-    delete page_table_;
-    delete replacer_;
-    delete free_list_;
+    StopFlushThread();
+    StopReadAheadThread();
+    for (size_t i = 0; i < num_shards_; ++i) {
+        delete shards_[i].page_table_;
+        delete shards_[i].replacer_;
+    }
+    delete[] shards_;
+    for (size_t s = 0; s < page_segments_.size(); ++s) {
+        if (segment_map_bases_[s] != nullptr) {
+            for (size_t i = 0; i < segment_sizes_[s]; ++i) {
+                page_segments_[s][i].~Page();
+            }
+            munmap(segment_map_bases_[s], segment_map_bytes_[s]);
+        } else {
+            delete[] page_segments_[s];
+        }
+    }
+}
+
+/*
+ * Start a separate thread that wakes up periodically (every FLUSH_TIMEOUT)
+ * and writes back dirty pages that are not pinned, so that SelectPage()
+ * rarely has to do a synchronous write on the fetch path
+ */
+void BufferPoolManager::RunFlushThread() {
+    if (flusher_running_) {
+        return;
+    }
+    flusher_running_ = true;
+    flush_thread_ = new std::thread(&BufferPoolManager::FlushDirtyPages, this);
+}
+
+/*
+ * Stop and join the background flush thread; safe to call when the thread
+ * was never started
+ */
+void BufferPoolManager::StopFlushThread() {
+    flusher_running_ = false;
+    {
+        std::lock_guard<std::mutex> guard(flush_latch_);
+        flush_cv_.notify_one();
+    }
+
+    if (flush_thread_ != nullptr) {
+        if (flush_thread_->joinable()) {
+            flush_thread_->join();
+        }
+        delete flush_thread_;
+        flush_thread_ = nullptr;
+    }
+}
+
+/*
+ * Stop and join the read-ahead worker; safe when it was never started
+ */
+void BufferPoolManager::StopReadAheadThread() {
+    read_ahead_running_ = false;
+    {
+        std::lock_guard<std::mutex> guard(read_ahead_latch_);
+        read_ahead_cv_.notify_one();
+    }
+
+    if (read_ahead_thread_ != nullptr) {
+        if (read_ahead_thread_->joinable()) {
+            read_ahead_thread_->join();
+        }
+        delete read_ahead_thread_;
+        read_ahead_thread_ = nullptr;
+    }
+}
+
+/*
+ * Per-thread streak detector, run on every FetchPage. Three perfectly
+ * ascending page ids in a row after the first (TableIterator, log recovery
+ * and table scans all fetch this way) schedule an asynchronous window of
+ * the pages that follow; the trigger re-arms one window later so a long
+ * scan keeps exactly one window in flight. The state is thread local and
+ * remembers its pool, so interleaved scans on different pools (or random
+ * fetches between the sequential ones) just restart the streak
+ */
+void BufferPoolManager::NoteFetchForReadAhead(page_id_t page_id) {
+    struct Streak {
+        const void *pool;
+        page_id_t last_page_id;
+        int length;
+    };
+    static thread_local Streak streak = {nullptr, INVALID_PAGE_ID, 0};
+
+    if (streak.pool != this || page_id != streak.last_page_id + 1) {
+        streak.pool = this;
+        streak.last_page_id = page_id;
+        streak.length = 1;
+        return;
+    }
+    streak.last_page_id = page_id;
+    if (++streak.length < READ_AHEAD_STREAK) {
+        return;
+    }
+    streak.length = READ_AHEAD_STREAK - READ_AHEAD_WINDOW;
+    ScheduleReadAhead(page_id + 1);
+}
+
+/*
+ * Queue one read-ahead window and lazily start the worker on first use
+ */
+void BufferPoolManager::ScheduleReadAhead(page_id_t start_page_id) {
+    // nothing to fetch past the end of the file
+    if (start_page_id >= disk_manager_->GetNextPageId()) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(read_ahead_latch_);
+    if (!read_ahead_running_) {
+        read_ahead_running_ = true;
+        read_ahead_thread_ =
+                new std::thread(&BufferPoolManager::ReadAheadLoop, this);
+    }
+    read_ahead_queue_.push_back(start_page_id);
+    read_ahead_cv_.notify_one();
+}
+
+/*
+ * Read-ahead worker: pull pages of each queued window into the pool
+ * unpinned, so the scan that triggered it finds them as cheap hits
+ */
+void BufferPoolManager::ReadAheadLoop() {
+    while (true) {
+        page_id_t start_page_id;
+        {
+            std::unique_lock<std::mutex> lock(read_ahead_latch_);
+            read_ahead_cv_.wait(lock, [this] {
+                return !read_ahead_queue_.empty() || !read_ahead_running_;
+            });
+            if (read_ahead_queue_.empty()) {
+                return;
+            }
+            start_page_id = read_ahead_queue_.front();
+            read_ahead_queue_.pop_front();
+        }
+        page_id_t limit = disk_manager_->GetNextPageId();
+        for (int i = 0; i < READ_AHEAD_WINDOW; ++i) {
+            page_id_t page_id = start_page_id + i;
+            if (page_id >= limit || !read_ahead_running_) {
+                break;
+            }
+            PrefetchPage(page_id);
+            read_ahead_pages_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * Background flusher loop: scan the pool for dirty unpinned pages and write
+ * them back. Before writing a page, honor the WAL rule by forcing the log up
+ * to the page's LSN (same protocol as the synchronous path in SelectPage).
+ */
+void BufferPoolManager::FlushDirtyPages() {
+    while (flusher_running_) {
+        {
+            std::unique_lock<std::mutex> lock(flush_latch_);
+            flush_cv_.wait_for(lock, FLUSH_TIMEOUT);
+        }
+        FlushPass();
+        // keep the warmup sidecar roughly current while we are at it
+        if (!warmup_file_.empty() &&
+            ++passes_since_warmup_save_ >= WARMUP_SAVE_INTERVAL) {
+            passes_since_warmup_save_ = 0;
+            SaveWarmupInfo(warmup_file_);
+        }
+    }
+}
+
+/*
+ * One writeback sweep over every frame, respecting the WAL rule
+ */
+void BufferPoolManager::FlushPass() {
+    // snapshot the segment list so a concurrent Resize can not pull
+    // the vector out from under the scan
+    std::vector<Page *> segments;
+    std::vector<size_t> sizes;
+    {
+        std::lock_guard<std::mutex> guard(resize_latch_);
+        segments = page_segments_;
+        sizes = segment_sizes_;
+    }
+
+    for (size_t seg = 0; seg < segments.size(); ++seg) {
+        for (size_t i = 0; i < sizes[seg]; ++i) {
+            Page *page = &segments[seg][i];
+            // unlatched snapshot just to locate the owning shard,
+            // all decisions are re-checked under the shard latch
+            page_id_t page_id = page->page_id_;
+            if (page_id == INVALID_PAGE_ID) {
+                continue;
+            }
+
+            Shard &shard = GetShard(page_id);
+            std::lock_guard<std::mutex> guard(shard.latch_);
+            if (page->page_id_ != page_id || page->pin_count_ != 0 ||
+                !page->is_dirty_) {
+                continue;
+            }
+
+            // same caveat as SelectPage: skip LSNs the log manager never
+            // issued (non-WAL-logged pages such as the header page)
+            if (ENABLE_LOGGING && log_manager_ != nullptr &&
+                page->GetLSN() < log_manager_->GetNextLSN()) {
+                while (page->GetLSN() > log_manager_->GetPersistentLSN()) {
+                    log_manager_->ForceLogFlushAndWait();
+                }
+            }
+            disk_manager_->WritePage(page_id, page->GetData());
+            page->is_dirty_ = false;
+            shard.dirty_writebacks_++;
+        }
+    }
+}
+
+/*
+ * Synchronously write back every dirty unpinned page, used by checkpoints
+ */
+void BufferPoolManager::FlushAllPages() { FlushPass(); }
+
+/*
+ * Dump the ids of every resident page to the sidecar file, sorted so the
+ * prefetch on the next startup reads them near-sequentially. The snapshot
+ * is unlatched: a stale or torn id costs at most one wasted prefetch
+ */
+void BufferPoolManager::SaveWarmupInfo(const std::string &file_name) {
+    std::vector<page_id_t> resident;
+    {
+        std::lock_guard<std::mutex> guard(resize_latch_);
+        for (size_t seg = 0; seg < page_segments_.size(); ++seg) {
+            for (size_t i = 0; i < segment_sizes_[seg]; ++i) {
+                page_id_t page_id = page_segments_[seg][i].page_id_;
+                if (page_id != INVALID_PAGE_ID) {
+                    resident.push_back(page_id);
+                }
+            }
+        }
+    }
+    std::sort(resident.begin(), resident.end());
+
+    std::ofstream out(file_name, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        return;
+    }
+    for (page_id_t page_id : resident) {
+        out.write(reinterpret_cast<char *>(&page_id), sizeof(page_id));
+    }
+}
+
+/*
+ * Prefetch the page ids saved by an earlier run. The ids are already
+ * sorted on disk, so the faults below turn into near-sequential reads;
+ * PrefetchPage leaves every page unpinned and silently skips pages for
+ * which no frame is free. Also remembers the file so the background
+ * flusher keeps it up to date
+ */
+void BufferPoolManager::LoadWarmupInfo(const std::string &file_name) {
+    warmup_file_ = file_name;
+
+    std::ifstream in(file_name, std::ios::binary);
+    if (!in.is_open()) {
+        return;
+    }
+    size_t loaded = 0;
+    page_id_t page_id;
+    while (loaded < pool_size_ &&
+           in.read(reinterpret_cast<char *>(&page_id), sizeof(page_id))) {
+        // a sidecar can outlive its database file; never prefetch past the
+        // pages the current file actually holds
+        if (page_id >= disk_manager_->GetNextPageId()) {
+            continue;
+        }
+        PrefetchPage(page_id);
+        ++loaded;
+    }
+}
+
+/*
+ * Human-readable dump of the counters, e.g. for periodic polling from the
+ * vtable layer
+ */
+std::string BufferPoolStats::ToString() const {
+    std::ostringstream os;
+    os << "hits:" << hits << " misses:" << misses
+       << " evictions:" << evictions << " dirty_writebacks:" << dirty_writebacks
+       << " fetch_failures:" << fetch_failures
+       << " compressed_hits:" << compressed_hits
+       << " read_ahead_pages:" << read_ahead_pages;
+    return os.str();
+}
+
+/*
+ * Aggregate the per-shard counters into one snapshot. The counters are
+ * relaxed reads, so the snapshot is only approximately consistent across
+ * shards, which is fine for monitoring purposes.
+ */
+BufferPoolStats BufferPoolManager::GetStats() const {
+    BufferPoolStats stats;
+    for (size_t i = 0; i < num_shards_; ++i) {
+        stats.hits += shards_[i].hits_;
+        stats.misses += shards_[i].misses_;
+        stats.evictions += shards_[i].evictions_;
+        stats.dirty_writebacks += shards_[i].dirty_writebacks_;
+        stats.fetch_failures += shards_[i].fetch_failures_;
+        stats.compressed_hits += shards_[i].compressed_hits_;
+    }
+    stats.read_ahead_pages = read_ahead_pages_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/**
+ * Online resize. Growing hands parked frames back out first and only then
+ * allocates a fresh segment, so repeated grow/shrink cycles do not leak
+ * address space. Shrinking retires free or victimizable frames one at a time
+ * (writing back dirty victims through SelectPage) and gives up once every
+ * shard is exhausted, so pinned pages are never yanked from their users.
+ * Returns the effective pool size.
+ */
+size_t BufferPoolManager::Resize(size_t new_pool_size) {
+    std::lock_guard<std::mutex> resize_guard(resize_latch_);
+
+    if (new_pool_size > pool_size_) {
+        size_t delta = new_pool_size - pool_size_;
+        size_t next_shard = 0;
+
+        while (delta > 0 && !retired_frames_.empty()) {
+            Page *page = retired_frames_.front();
+            retired_frames_.pop_front();
+            Shard &shard = shards_[next_shard++ % num_shards_];
+            std::lock_guard<std::mutex> guard(shard.latch_);
+            shard.free_list_.push_back(page);
+            --delta;
+            ++pool_size_;
+        }
+
+        if (delta > 0) {
+            Page *segment = AllocateFrameSegment(delta, next_shard % num_shards_);
+            for (size_t i = 0; i < delta; ++i) {
+                Shard &shard = shards_[(next_shard + i) % num_shards_];
+                std::lock_guard<std::mutex> guard(shard.latch_);
+                shard.free_list_.push_back(&segment[i]);
+            }
+            pool_size_ += delta;
+        }
+    } else {
+        size_t exhausted = 0;
+        size_t next_shard = 0;
+        while (pool_size_ > new_pool_size && exhausted < num_shards_) {
+            Shard &shard = shards_[next_shard++ % num_shards_];
+            std::lock_guard<std::mutex> guard(shard.latch_);
+            Page *page = SelectPage(shard);
+            if (page == nullptr) {
+                ++exhausted;
+                continue;
+            }
+            exhausted = 0;
+            retired_frames_.push_back(page);
+            --pool_size_;
+        }
+    }
+
+    return pool_size_;
+}
+
+/*
+ * Map a page id to its owning shard; the mapping is stable for the lifetime
+ * of the pool so a page can never be cached in two shards at once
+ */
+BufferPoolManager::Shard &BufferPoolManager::GetShard(page_id_t page_id) {
+    return shards_[static_cast<size_t>(page_id) % num_shards_];
 }
 
 /**
@@ -45,31 +529,160 @@ BufferPoolManager::~BufferPoolManager() {
  * entry for the new page.
  * 4. Update page metadata, read page content from disk file and return page
  * pointer
+ *
+ * A page-table hit is resolved without the shard latch: the pin count is
+ * bumped atomically and the page id is re-checked afterwards to detect a
+ * concurrent eviction (SelectPage clears the id before recycling a frame
+ * and backs off if the pin count became non-zero). Only a miss takes the
+ * shard latch.
  */
 Page *BufferPoolManager::FetchPage(page_id_t page_id) {
-    std::lock_guard<std::mutex> guard(latch_);
+    NoteFetchForReadAhead(page_id);
+    Shard &shard = GetShard(page_id);
 
     Page *page = nullptr;
-    if (page_table_->Find(page_id, page)) {
+    // the latch-free probe runs inside an epoch so DeletePage cannot
+    // recycle the frame while this thread still holds the raw pointer;
+    // threads without a slot simply use the latched path below
+    EpochSlot *slot = LocalEpochSlot();
+    if (slot != nullptr) {
+        slot->epoch.store(global_epoch_.load());
+        if (shard.page_table_->Find(page_id, page)) {
+            page->pin_count_++;
+            if (page->page_id_ == page_id) {
+                // lru replacer only keeps unpinned pages
+                shard.replacer_->Erase(page);
+                shard.hits_++;
+                slot->epoch.store(0, std::memory_order_release);
+                return page;
+            }
+            // the frame was victimized underneath us, undo and take the
+            // latched slow path
+            page->pin_count_--;
+        }
+        slot->epoch.store(0, std::memory_order_release);
+    }
+
+    std::lock_guard<std::mutex> guard(shard.latch_);
+
+    if (shard.page_table_->Find(page_id, page)) {
         page->pin_count_++;
-        // lru replacer only keeps unpinned pages
-        replacer_->Erase(page);
+        shard.replacer_->Erase(page);
+        shard.hits_++;
         return page;
     }
 
-    page = SelectPage();
+    page = SelectPage(shard);
     if (page == nullptr) {
+        shard.fetch_failures_++;
         return nullptr;
     }
 
     page->page_id_ = page_id;
     page->pin_count_++;
-    disk_manager_->ReadPage(page_id, page->GetData());
-    page_table_->Insert(page_id, page);
+    LoadPage(shard, page_id, page->GetData());
+    shard.page_table_->Insert(page_id, page);
+    shard.misses_++;
+    PerfCount(PerfCounter::BUFFER_POOL_MISS);
 
     return page;
 }
 
+/**
+ * Fetch and pin a batch of pages. The ids are grouped by owning shard first,
+ * then every group is resolved under one latch acquisition: hits are pinned
+ * and the disk reads for all misses of that shard are issued back to back.
+ * result[i] matches page_ids[i]; an entry is nullptr when the shard had no
+ * free or victimizable frame left.
+ */
+std::vector<Page *>
+BufferPoolManager::FetchPages(const std::vector<page_id_t> &page_ids) {
+    std::vector<Page *> result(page_ids.size(), nullptr);
+
+    // group request positions by shard
+    std::vector<std::vector<size_t>> grouped(num_shards_);
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+        grouped[static_cast<size_t>(page_ids[i]) % num_shards_].push_back(i);
+    }
+
+    for (size_t s = 0; s < num_shards_; ++s) {
+        if (grouped[s].empty()) {
+            continue;
+        }
+
+        Shard &shard = shards_[s];
+        std::lock_guard<std::mutex> guard(shard.latch_);
+        for (size_t pos : grouped[s]) {
+            page_id_t page_id = page_ids[pos];
+
+            Page *page = nullptr;
+            if (shard.page_table_->Find(page_id, page)) {
+                page->pin_count_++;
+                shard.replacer_->Erase(page);
+                shard.hits_++;
+                result[pos] = page;
+                continue;
+            }
+
+            page = SelectPage(shard);
+            if (page == nullptr) {
+                shard.fetch_failures_++;
+                continue;
+            }
+
+            page->page_id_ = page_id;
+            page->pin_count_++;
+            LoadPage(shard, page_id, page->GetData());
+            shard.page_table_->Insert(page_id, page);
+            shard.misses_++;
+            result[pos] = page;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Pull a page into the pool without pinning it. The page is registered with
+ * the replacer right away (same state as a fetched-then-unpinned page), so
+ * it can be evicted again if it is never used. A miss that finds no frame is
+ * silently dropped: prefetching is only a hint.
+ */
+void BufferPoolManager::PrefetchPage(page_id_t page_id) {
+    Shard &shard = GetShard(page_id);
+    std::lock_guard<std::mutex> guard(shard.latch_);
+
+    Page *page = nullptr;
+    if (shard.page_table_->Find(page_id, page)) {
+        return;
+    }
+
+    page = SelectPage(shard);
+    if (page == nullptr) {
+        return;
+    }
+
+    page->page_id_ = page_id;
+    LoadPage(shard, page_id, page->GetData());
+    shard.page_table_->Insert(page_id, page);
+    shard.replacer_->Insert(page);
+    shard.misses_++;
+}
+
+/*
+ * Resolve a miss: promote the page out of the compressed tier if a copy is
+ * retained there, otherwise read it from disk
+ */
+void BufferPoolManager::LoadPage(Shard &shard, page_id_t page_id,
+                                 char *page_data) {
+    if (compressed_cache_ != nullptr &&
+        compressed_cache_->Get(page_id, page_data)) {
+        shard.compressed_hits_++;
+        return;
+    }
+    disk_manager_->ReadPage(page_id, page_data);
+}
+
 /*
  * Implementation of unpin page
  * if pin_count>0, decrement it and if it becomes zero, put it back to
@@ -77,23 +690,29 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
  * dirty flag of this page
  */
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
-    std::lock_guard<std::mutex> guard(latch_);
+    Shard &shard = GetShard(page_id);
 
     Page *page = nullptr;
-    if (!page_table_->Find(page_id, page)) {
+    if (!shard.page_table_->Find(page_id, page)) {
         return false;
     }
 
-    if (page->pin_count_ <= 0) {
-        return false;
+    // set the dirty flag before the pin count can reach zero, so an eviction
+    // racing with this unpin never sees a clean page with unwritten changes
+    if (is_dirty) {
+        page->is_dirty_ = true;
     }
 
-    if (--page->pin_count_ == 0) {
-        replacer_->Insert(page);
+    // atomic decrement, no shard latch needed; SelectPage re-checks the pin
+    // count before recycling a frame, so a stale replacer entry is harmless
+    int prev = page->pin_count_--;
+    if (prev <= 0) {
+        page->pin_count_++;
+        return false;
     }
 
-    if (is_dirty) {
-        page->is_dirty_ = true;
+    if (prev == 1) {
+        shard.replacer_->Insert(page);
     }
 
     return true;
@@ -106,19 +725,21 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
  * NOTE: make sure page_id != INVALID_PAGE_ID
  */
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
-    std::lock_guard<std::mutex> guard(latch_);
-
     if (page_id == INVALID_PAGE_ID) {
         return false;
     }
 
+    Shard &shard = GetShard(page_id);
+    std::lock_guard<std::mutex> guard(shard.latch_);
+
     Page *page = nullptr;
-    if (!page_table_->Find(page_id, page)) {
+    if (!shard.page_table_->Find(page_id, page)) {
         return false;
     }
 
     disk_manager_->WritePage(page_id, page->GetData());
     page->is_dirty_ = false;
+    shard.dirty_writebacks_++;
 
     return true;
 }
@@ -132,10 +753,11 @@ bool BufferPoolManager::FlushPage(page_id_t page_id) {
  * the page is found within page table, but pin_count != 0, return false
  */
 bool BufferPoolManager::DeletePage(page_id_t page_id) {
-    std::lock_guard<std::mutex> guard(latch_);
+    Shard &shard = GetShard(page_id);
+    std::lock_guard<std::mutex> guard(shard.latch_);
 
     Page *page = nullptr;
-    if (!page_table_->Find(page_id, page)) {
+    if (!shard.page_table_->Find(page_id, page)) {
         // If not in page table, it should already
         // be deleted or never been used.
         return true;
@@ -145,13 +767,25 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
         return false;
     }
 
-    replacer_->Erase(page);
-    page_table_->Remove(page_id);
+    // same invalidate-then-recheck protocol as SelectPage to stay safe
+    // against the latch-free pin path
+    shard.replacer_->Erase(page);
+    shard.page_table_->Remove(page_id);
     page->page_id_ = INVALID_PAGE_ID;
+    if (page->pin_count_ != 0) {
+        page->page_id_ = page_id;
+        shard.page_table_->Insert(page_id, page);
+        return false;
+    }
     page->is_dirty_ = false;
     page->ResetMemory();
+    if (compressed_cache_ != nullptr) {
+        compressed_cache_->Remove(page_id);
+    }
     disk_manager_->DeallocatePage(page_id);
-    free_list_->push_back(page);
+    // park the frame until every reader that may have picked up the raw
+    // pointer before the unlink has left its epoch
+    shard.limbo_list_.emplace_back(global_epoch_.fetch_add(1), page);
 
     return true;
 }
@@ -163,53 +797,133 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
  * from free list or lru replacer(NOTE: always choose from free list first),
  * update new page's metadata, zero out memory and add corresponding entry
  * into page table. return nullptr if all the pages in pool are pinned
+ *
+ * The page id has to be allocated before the owning shard is known, so on
+ * failure the freshly allocated id is handed back to the disk manager.
  */
 Page *BufferPoolManager::NewPage(page_id_t &page_id) {
-    std::lock_guard<std::mutex> guard(latch_);
+    page_id = disk_manager_->AllocatePage();
+
+    Shard &shard = GetShard(page_id);
+    std::lock_guard<std::mutex> guard(shard.latch_);
 
-    Page *page = SelectPage();
+    Page *page = SelectPage(shard);
     if (page == nullptr) {
+        disk_manager_->DeallocatePage(page_id);
+        page_id = INVALID_PAGE_ID;
         return nullptr;
     }
 
-    page_id = disk_manager_->AllocatePage();
     page->page_id_ = page_id;
     page->pin_count_++;
     page->is_dirty_ = true;
     page->ResetMemory();
-    page_table_->Insert(page_id, page);
+    shard.page_table_->Insert(page_id, page);
 
     return page;
 }
 
 /**
- * Select a page from free list or a victim from lru replacer.
+ * Select a page from the shard's free list or a victim from its lru replacer.
  * If no page could be selected (no free page or all pages pinned),
- * return a null pointer.
+ * return a null pointer. Caller must hold the shard latch.
  */
-Page *BufferPoolManager::SelectPage() {
-    if (!free_list_->empty()) {
-        Page *page = free_list_->front();
-        free_list_->pop_front();
+/*
+ * Slot used by this thread to publish the epoch it reads under. Slot ids
+ * are handed out once per thread process-wide; threads beyond the table
+ * size get none and use the latched fetch path instead
+ */
+BufferPoolManager::EpochSlot *BufferPoolManager::LocalEpochSlot() {
+    static std::atomic<int> next_thread_id{0};
+    static thread_local int thread_id = next_thread_id.fetch_add(1);
+    if (thread_id >= MAX_EPOCH_SLOTS) {
+        return nullptr;
+    }
+    return &epoch_slots_[thread_id];
+}
+
+uint64_t BufferPoolManager::MinActiveEpoch() {
+    uint64_t min_epoch = global_epoch_.load() + 1;
+    for (auto &slot : epoch_slots_) {
+        uint64_t epoch = slot.epoch.load();
+        if (epoch != 0 && epoch < min_epoch) {
+            min_epoch = epoch;
+        }
+    }
+    return min_epoch;
+}
+
+/*
+ * Recycle limbo frames whose retirement epoch every active reader has
+ * passed. Entries are in retirement order, so the scan stops at the first
+ * frame that is still protected
+ */
+void BufferPoolManager::DrainLimbo(Shard &shard) {
+    if (shard.limbo_list_.empty()) {
+        return;
+    }
+    uint64_t min_active = MinActiveEpoch();
+    while (!shard.limbo_list_.empty() &&
+           shard.limbo_list_.front().first < min_active) {
+        shard.free_list_.push_back(shard.limbo_list_.front().second);
+        shard.limbo_list_.pop_front();
+    }
+}
+
+Page *BufferPoolManager::SelectPage(Shard &shard) {
+    DrainLimbo(shard);
+    if (!shard.free_list_.empty()) {
+        Page *page = shard.free_list_.front();
+        shard.free_list_.pop_front();
         return page;
     }
 
     Page *page = nullptr;
-    if (replacer_->Victim(page)) {
+    while (shard.replacer_->Victim(page)) {
+        // the replacer can hold stale entries for pages that were re-pinned
+        // through the latch-free hit path, just skip those
+        if (page->pin_count_ != 0) {
+            continue;
+        }
+
+        // invalidate the id before the final pin check: a latch-free fetch
+        // that pins concurrently either makes the check below fail, or sees
+        // the invalid id on its own re-check and backs off
+        page_id_t old_page_id = page->page_id_;
+        shard.page_table_->Remove(old_page_id);
+        page->page_id_ = INVALID_PAGE_ID;
+        if (page->pin_count_ != 0) {
+            // lost the race, give the page back
+            page->page_id_ = old_page_id;
+            shard.page_table_->Insert(old_page_id, page);
+            continue;
+        }
+
         if (page->is_dirty_) {
-            if (ENABLE_LOGGING) {
-                while (page->GetLSN() < log_manager_->GetPersistentLSN()) {
+            // WAL rule: the log must cover the page before it goes out.
+            // Pages that are not WAL-logged (the header page reuses the LSN
+            // bytes for its own records) carry values the log manager never
+            // issued, those must not be waited on
+            if (ENABLE_LOGGING &&
+                page->GetLSN() < log_manager_->GetNextLSN()) {
+                while (page->GetLSN() > log_manager_->GetPersistentLSN()) {
                     log_manager_->ForceLogFlushAndWait();
                 }
             }
-            disk_manager_->WritePage(page->page_id_, page->GetData());
+            disk_manager_->WritePage(old_page_id, page->GetData());
             page->is_dirty_ = false;
+            shard.dirty_writebacks_++;
+        }
+        // keep a compressed copy so a re-fetch can skip the disk read
+        if (compressed_cache_ != nullptr) {
+            compressed_cache_->Put(old_page_id, page->GetData());
         }
-        // important: remove victim page from page table
-        page_table_->Remove(page->GetPageId());
+        shard.evictions_++;
+
+        return page;
     }
 
-    return page;
+    return nullptr;
 }
 
 } // namespace cmudb
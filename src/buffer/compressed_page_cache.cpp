@@ -0,0 +1,157 @@
+/**
+ * compressed_page_cache.cpp
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "buffer/compressed_page_cache.h"
+
+namespace cmudb {
+
+CompressedPageCache::CompressedPageCache(size_t capacity_bytes)
+        : capacity_bytes_(capacity_bytes) {}
+
+size_t CompressedPageCache::Compress(const char *in, size_t in_size, char *out,
+                                     size_t out_capacity) {
+    size_t in_pos = 0;
+    size_t out_pos = 0;
+    while (in_pos < in_size) {
+        // count a zero run; runs shorter than 3 are cheaper as literals
+        size_t zeros = 0;
+        while (in_pos + zeros < in_size && in[in_pos + zeros] == 0 &&
+               zeros < 130) {
+            ++zeros;
+        }
+        if (zeros >= 3) {
+            if (out_pos + 1 > out_capacity) {
+                return 0;
+            }
+            out[out_pos++] = static_cast<char>(0x80 | (zeros - 3));
+            in_pos += zeros;
+            continue;
+        }
+        // literal run: up to 128 bytes, stopping before the next long zero run
+        size_t literals = 0;
+        while (in_pos + literals < in_size && literals < 128) {
+            if (in[in_pos + literals] == 0 && in_pos + literals + 2 < in_size &&
+                in[in_pos + literals + 1] == 0 &&
+                in[in_pos + literals + 2] == 0) {
+                break;
+            }
+            ++literals;
+        }
+        if (out_pos + 1 + literals > out_capacity) {
+            return 0;
+        }
+        out[out_pos++] = static_cast<char>(literals - 1);
+        memcpy(out + out_pos, in + in_pos, literals);
+        out_pos += literals;
+        in_pos += literals;
+    }
+    return out_pos;
+}
+
+void CompressedPageCache::Decompress(const char *in, size_t in_size, char *out,
+                                     size_t out_size) {
+    size_t in_pos = 0;
+    size_t out_pos = 0;
+    while (in_pos < in_size) {
+        unsigned char control = static_cast<unsigned char>(in[in_pos++]);
+        if (control & 0x80) {
+            size_t zeros = (control & 0x7f) + 3;
+            assert(out_pos + zeros <= out_size);
+            memset(out + out_pos, 0, zeros);
+            out_pos += zeros;
+        } else {
+            size_t literals = control + 1;
+            assert(out_pos + literals <= out_size);
+            memcpy(out + out_pos, in + in_pos, literals);
+            in_pos += literals;
+            out_pos += literals;
+        }
+    }
+    assert(out_pos == out_size);
+    (void)out_size;
+}
+
+void CompressedPageCache::Put(page_id_t page_id, const char *page_data) {
+    char buffer[PAGE_SIZE];
+    size_t compressed_size =
+            Compress(page_data, PAGE_SIZE, buffer, PAGE_SIZE - 1);
+    if (compressed_size == 0) {
+        // the page does not shrink, caching it would waste the budget
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(latch_);
+    auto it = entries_.find(page_id);
+    if (it != entries_.end()) {
+        size_bytes_ -= it->second.size;
+        lru_.erase(it->second.lru_it);
+        entries_.erase(it);
+    }
+
+    Entry entry;
+    entry.data.reset(new char[compressed_size]);
+    memcpy(entry.data.get(), buffer, compressed_size);
+    entry.size = compressed_size;
+    lru_.push_front(page_id);
+    entry.lru_it = lru_.begin();
+    size_bytes_ += compressed_size;
+    entries_[page_id] = std::move(entry);
+
+    EvictToFit();
+}
+
+bool CompressedPageCache::Get(page_id_t page_id, char *page_data) {
+    std::unique_lock<std::mutex> guard(latch_);
+    auto it = entries_.find(page_id);
+    if (it == entries_.end()) {
+        return false;
+    }
+
+    // detach the entry so decompression runs outside the latch
+    std::unique_ptr<char[]> data = std::move(it->second.data);
+    size_t size = it->second.size;
+    size_bytes_ -= size;
+    lru_.erase(it->second.lru_it);
+    entries_.erase(it);
+    guard.unlock();
+
+    Decompress(data.get(), size, page_data, PAGE_SIZE);
+    return true;
+}
+
+void CompressedPageCache::Remove(page_id_t page_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+    auto it = entries_.find(page_id);
+    if (it == entries_.end()) {
+        return;
+    }
+    size_bytes_ -= it->second.size;
+    lru_.erase(it->second.lru_it);
+    entries_.erase(it);
+}
+
+size_t CompressedPageCache::GetSizeBytes() const {
+    std::lock_guard<std::mutex> guard(latch_);
+    return size_bytes_;
+}
+
+size_t CompressedPageCache::GetEntryCount() const {
+    std::lock_guard<std::mutex> guard(latch_);
+    return entries_.size();
+}
+
+void CompressedPageCache::EvictToFit() {
+    while (size_bytes_ > capacity_bytes_ && !lru_.empty()) {
+        page_id_t victim = lru_.back();
+        lru_.pop_back();
+        auto it = entries_.find(victim);
+        size_bytes_ -= it->second.size;
+        entries_.erase(it);
+    }
+}
+
+} // namespace cmudb
@@ -0,0 +1,103 @@
+/**
+ * LRU-K implementation
+ */
+#include "buffer/lru_k_replacer.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+template <typename T> LRUKReplacer<T>::LRUKReplacer(size_t k) : k_(k) {}
+
+template <typename T> LRUKReplacer<T>::~LRUKReplacer() {}
+
+/*
+ * Record an access of value and make it eligible for eviction.
+ * Only the last K access timestamps are retained per value.
+ */
+template <typename T> void LRUKReplacer<T>::Insert(const T &value) {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    History &history = history_map[value];
+    history.accesses.push_back(++clock_);
+    if (history.accesses.size() > k_) {
+        history.accesses.pop_front();
+    }
+    history.evictable = true;
+}
+
+/*
+ * Evict the evictable value with the largest backward K-distance. Values
+ * with fewer than K recorded accesses have an infinite distance and are
+ * victimized first, oldest access first. Returns false if no value is
+ * evictable.
+ */
+template <typename T> bool LRUKReplacer<T>::Victim(T &value) {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    bool victim_is_cold = false;
+    size_t victim_stamp = 0;
+    auto victim = history_map.end();
+    for (auto it = history_map.begin(); it != history_map.end(); ++it) {
+        if (!it->second.evictable) {
+            continue;
+        }
+        bool cold = it->second.accesses.size() < k_;
+        // the K-th most recent access (or the earliest one for cold values)
+        size_t stamp = it->second.accesses.front();
+        // cold values always lose against values with a full history;
+        // within one class the smaller timestamp is the better victim
+        if (victim == history_map.end() || (cold && !victim_is_cold) ||
+            (cold == victim_is_cold && stamp < victim_stamp)) {
+            victim = it;
+            victim_is_cold = cold;
+            victim_stamp = stamp;
+        }
+    }
+
+    if (victim == history_map.end()) {
+        return false;
+    }
+
+    // the frame is recycled for a different page, drop the whole history
+    value = victim->first;
+    history_map.erase(victim);
+
+    return true;
+}
+
+/*
+ * Take value out of the victim candidate set (e.g. because its page got
+ * pinned again). The access history is kept so the value resumes with its
+ * full history on the next Insert.
+ */
+template <typename T> bool LRUKReplacer<T>::Erase(const T &value) {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    auto pos = history_map.find(value);
+    if (pos == history_map.end() || !pos->second.evictable) {
+        return false;
+    }
+
+    pos->second.evictable = false;
+
+    return true;
+}
+
+template <typename T> size_t LRUKReplacer<T>::Size() {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    size_t size = 0;
+    for (auto &entry : history_map) {
+        if (entry.second.evictable) {
+            ++size;
+        }
+    }
+
+    return size;
+}
+
+template class LRUKReplacer<Page *>;
+// test only
+template class LRUKReplacer<int>;
+
+} // namespace cmudb
@@ -16,10 +16,15 @@ template <typename T> LRUReplacer<T>::~LRUReplacer() {}
 template <typename T> void LRUReplacer<T>::Insert(const T &value) {
     std::lock_guard<std::mutex> guard(mutex);
 
-    // if value already exists, first erase it from the list then re-insert
+    // if value already exists, move it to the front of the list; the map
+    // entry must be repointed in place, emplace would keep the old (now
+    // dangling) iterator
     auto pos = value_map.find(value);
     if (pos != value_map.end()) {
         access_list.erase(pos->second);
+        access_list.push_front(value);
+        pos->second = access_list.begin();
+        return;
     }
 
     access_list.push_front(value);
@@ -0,0 +1,190 @@
+/**
+ * sampling_replacer.cpp
+ */
+
+#include <cassert>
+#include <chrono>
+#include <functional>
+
+#include "buffer/sampling_replacer.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+// per-thread xorshift so sampling needs no shared random state
+static inline uint64_t NextRandom() {
+    static thread_local uint64_t state =
+            std::chrono::steady_clock::now().time_since_epoch().count() ^
+            std::hash<const void *>()(&state);
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static inline size_t RoundUpPowerOfTwo(size_t n) {
+    size_t result = 1;
+    while (result < n)
+        result <<= 1;
+    return result;
+}
+
+template <typename T>
+SamplingReplacer<T>::SamplingReplacer(size_t capacity) {
+    head_ = new Table(RoundUpPowerOfTwo(capacity < 16 ? 16 : capacity));
+}
+
+template <typename T> SamplingReplacer<T>::~SamplingReplacer() {
+    Table *table = head_;
+    while (table != nullptr) {
+        Table *next = table->next.load();
+        delete table;
+        table = next;
+    }
+}
+
+template <typename T>
+typename SamplingReplacer<T>::Slot *
+SamplingReplacer<T>::FindOrClaimSlot(const T &value) {
+    assert(value != T());
+    size_t hash = std::hash<T>()(value);
+    Table *table = head_;
+    while (true) {
+        size_t mask = table->slots.size() - 1;
+        for (size_t i = 0; i <= mask; ++i) {
+            Slot &slot = table->slots[(hash + i) & mask];
+            T current = slot.value.load(std::memory_order_acquire);
+            if (current == value)
+                return &slot;
+            if (current == T()) {
+                T expected = T();
+                if (slot.value.compare_exchange_strong(expected, value))
+                    return &slot;
+                if (expected == value)
+                    return &slot;
+            }
+        }
+        // table is full: chain a doubled one; losers adopt the winner's
+        Table *next = table->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            Table *grown = new Table(table->slots.size() * 2);
+            Table *expected = nullptr;
+            if (!table->next.compare_exchange_strong(expected, grown)) {
+                delete grown;
+                next = expected;
+            } else {
+                next = grown;
+            }
+        }
+        table = next;
+    }
+}
+
+template <typename T>
+typename SamplingReplacer<T>::Slot *
+SamplingReplacer<T>::FindSlot(const T &value) {
+    size_t hash = std::hash<T>()(value);
+    for (Table *table = head_; table != nullptr;
+         table = table->next.load(std::memory_order_acquire)) {
+        size_t mask = table->slots.size() - 1;
+        for (size_t i = 0; i <= mask; ++i) {
+            Slot &slot = table->slots[(hash + i) & mask];
+            T current = slot.value.load(std::memory_order_acquire);
+            if (current == value)
+                return &slot;
+            if (current == T())
+                break;
+        }
+    }
+    return nullptr;
+}
+
+template <typename T> void SamplingReplacer<T>::Insert(const T &value) {
+    Slot *slot = FindOrClaimSlot(value);
+    slot->last_access.store(clock_.fetch_add(1, std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+    if (!slot->evictable.exchange(true, std::memory_order_relaxed))
+        evictable_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename T> bool SamplingReplacer<T>::ClaimVictim(Slot *slot) {
+    if (!slot->evictable.exchange(false, std::memory_order_relaxed))
+        return false;
+    evictable_count_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+template <typename T> bool SamplingReplacer<T>::Victim(T &value) {
+    while (evictable_count_.load(std::memory_order_relaxed) > 0) {
+        // oldest of a handful of random slots approximates the LRU choice
+        for (int round = 0; round < SAMPLE_ROUNDS; ++round) {
+            Slot *oldest = nullptr;
+            uint64_t oldest_access = 0;
+            for (int i = 0; i < SAMPLE_SIZE; ++i) {
+                uint64_t random = NextRandom();
+                Table *table = head_;
+                // spread samples across chained tables, if any
+                while (table->next.load(std::memory_order_acquire) !=
+                               nullptr &&
+                       (random & 1) != 0) {
+                    table = table->next.load(std::memory_order_acquire);
+                    random >>= 1;
+                }
+                Slot &slot =
+                        table->slots[random & (table->slots.size() - 1)];
+                if (!slot.evictable.load(std::memory_order_relaxed))
+                    continue;
+                uint64_t access =
+                        slot.last_access.load(std::memory_order_relaxed);
+                if (oldest == nullptr || access < oldest_access) {
+                    oldest = &slot;
+                    oldest_access = access;
+                }
+            }
+            if (oldest != nullptr && ClaimVictim(oldest)) {
+                value = oldest->value.load(std::memory_order_acquire);
+                return true;
+            }
+        }
+        // sampling found nothing (sparse table or lost races): sweep for
+        // the globally oldest evictable slot so none is ever stranded
+        Slot *oldest = nullptr;
+        uint64_t oldest_access = 0;
+        for (Table *table = head_; table != nullptr;
+             table = table->next.load(std::memory_order_acquire)) {
+            for (auto &slot : table->slots) {
+                if (!slot.evictable.load(std::memory_order_relaxed))
+                    continue;
+                uint64_t access =
+                        slot.last_access.load(std::memory_order_relaxed);
+                if (oldest == nullptr || access < oldest_access) {
+                    oldest = &slot;
+                    oldest_access = access;
+                }
+            }
+        }
+        if (oldest != nullptr && ClaimVictim(oldest)) {
+            value = oldest->value.load(std::memory_order_acquire);
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T> bool SamplingReplacer<T>::Erase(const T &value) {
+    Slot *slot = FindSlot(value);
+    if (slot == nullptr)
+        return false;
+    ClaimVictim(slot);
+    return true;
+}
+
+template <typename T> size_t SamplingReplacer<T>::Size() {
+    return evictable_count_.load(std::memory_order_relaxed);
+}
+
+template class SamplingReplacer<Page *>;
+// test only
+template class SamplingReplacer<int>;
+
+} // namespace cmudb
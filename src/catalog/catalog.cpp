@@ -0,0 +1,151 @@
+/**
+ * catalog.cpp
+ */
+#include <cassert>
+
+#include "catalog/catalog.h"
+
+namespace cmudb {
+
+/*
+ * Walk the header page chain once and cache every record together with the
+ * page it lives on. A fresh database file reads as all zeroes, which yields
+ * record count 0 and a next page id of 0; any next pointer at or below the
+ * header page id terminates the chain so such a page cannot link to itself
+ */
+void Catalog::EnsureLoaded() {
+    if (loaded_) {
+        return;
+    }
+
+    page_id_t page_id = HEADER_PAGE_ID;
+    while (page_id != INVALID_PAGE_ID) {
+        auto page = static_cast<HeaderPage *>(
+                buffer_pool_manager_->FetchPage(page_id));
+        if (page == nullptr) {
+            break;
+        }
+        int record_count = page->GetRecordCount();
+        for (int i = 0; i < record_count; ++i) {
+            std::string name;
+            page_id_t root_id;
+            page->GetRecord(i, name, root_id);
+            entries_[name] = {root_id, page_id};
+        }
+        chain_.push_back(page_id);
+
+        page_id_t next_page_id = page->GetNextPageId();
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        if (next_page_id <= HEADER_PAGE_ID) {
+            break;
+        }
+        page_id = next_page_id;
+    }
+    loaded_ = true;
+}
+
+bool Catalog::InsertRecord(const std::string &name, page_id_t root_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+    EnsureLoaded();
+
+    if (entries_.count(name) != 0) {
+        return false;
+    }
+
+    // find a chain page with a free slot
+    for (page_id_t page_id : chain_) {
+        auto page = static_cast<HeaderPage *>(
+                buffer_pool_manager_->FetchPage(page_id));
+        bool inserted = page->InsertRecord(name, root_id);
+        buffer_pool_manager_->UnpinPage(page_id, inserted);
+        if (inserted) {
+            entries_[name] = {root_id, page_id};
+            return true;
+        }
+    }
+
+    // every page is full, chain a new one
+    page_id_t new_page_id;
+    auto new_page = static_cast<HeaderPage *>(
+            buffer_pool_manager_->NewPage(new_page_id));
+    if (new_page == nullptr) {
+        return false;
+    }
+    new_page->Init();
+    new_page->InsertRecord(name, root_id);
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+
+    if (!chain_.empty()) {
+        page_id_t tail_id = chain_.back();
+        auto tail = static_cast<HeaderPage *>(
+                buffer_pool_manager_->FetchPage(tail_id));
+        tail->SetNextPageId(new_page_id);
+        buffer_pool_manager_->UnpinPage(tail_id, true);
+    }
+    chain_.push_back(new_page_id);
+    entries_[name] = {root_id, new_page_id};
+    return true;
+}
+
+bool Catalog::DeleteRecord(const std::string &name) {
+    std::lock_guard<std::mutex> guard(latch_);
+    EnsureLoaded();
+
+    auto pos = entries_.find(name);
+    if (pos == entries_.end()) {
+        return false;
+    }
+
+    auto page = static_cast<HeaderPage *>(
+            buffer_pool_manager_->FetchPage(pos->second.page_id));
+    bool deleted = page->DeleteRecord(name);
+    buffer_pool_manager_->UnpinPage(pos->second.page_id, deleted);
+    entries_.erase(pos);
+    return deleted;
+}
+
+bool Catalog::UpdateRecord(const std::string &name, page_id_t root_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+    EnsureLoaded();
+
+    auto pos = entries_.find(name);
+    if (pos == entries_.end()) {
+        return false;
+    }
+
+    auto page = static_cast<HeaderPage *>(
+            buffer_pool_manager_->FetchPage(pos->second.page_id));
+    bool updated = page->UpdateRecord(name, root_id);
+    buffer_pool_manager_->UnpinPage(pos->second.page_id, updated);
+    if (updated) {
+        pos->second.root_id = root_id;
+    }
+    return updated;
+}
+
+bool Catalog::GetRootId(const std::string &name, page_id_t &root_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+    EnsureLoaded();
+
+    auto pos = entries_.find(name);
+    if (pos == entries_.end()) {
+        return false;
+    }
+    root_id = pos->second.root_id;
+    return true;
+}
+
+int Catalog::GetRecordCount() {
+    std::lock_guard<std::mutex> guard(latch_);
+    EnsureLoaded();
+    return static_cast<int>(entries_.size());
+}
+
+void Catalog::Invalidate() {
+    std::lock_guard<std::mutex> guard(latch_);
+    loaded_ = false;
+    entries_.clear();
+    chain_.clear();
+}
+
+} // namespace cmudb
@@ -24,6 +24,10 @@ Schema::Schema(const std::vector<Column> &columns) : tuple_is_inlined(true) {
         column.column_offset = column_offset;
         column_offset += column.GetFixedLength();
 
+        // cache offset and type in flat arrays for fast column extraction
+        column_offsets.push_back(column.GetOffset());
+        column_types.push_back(column.GetType());
+
         // add column
         this->columns.push_back(std::move(column));
     }
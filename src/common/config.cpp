@@ -4,5 +4,8 @@ namespace cmudb {
 
 std::atomic<bool> ENABLE_LOGGING(false);  // for virtual table
 std::chrono::duration<long long int> LOG_TIMEOUT = std::chrono::seconds(1);
+std::chrono::duration<long long int> FLUSH_TIMEOUT = std::chrono::seconds(1);
+std::chrono::duration<long long int> CHECKPOINT_TIMEOUT = std::chrono::seconds(30);
+std::chrono::milliseconds DEADLOCK_TIMEOUT = std::chrono::milliseconds(50);
 
 }
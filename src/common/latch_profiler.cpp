@@ -0,0 +1,76 @@
+/**
+ * latch_profiler.cpp
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "common/latch_profiler.h"
+
+namespace cmudb {
+
+std::atomic<bool> LatchProfiler::enabled_{false};
+std::atomic<int> LatchProfiler::sample_interval_{1};
+
+void LatchProfiler::Enable(int sample_interval) {
+    sample_interval_.store(sample_interval < 1 ? 1 : sample_interval,
+                           std::memory_order_relaxed);
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void LatchProfiler::Disable() {
+    enabled_.store(false, std::memory_order_relaxed);
+}
+
+void LatchProfiler::OnContended(page_id_t page_id, bool is_write,
+                                uint64_t wait_ticks, void *call_site) {
+    // per-thread decimation so sampling needs no shared state
+    static thread_local int skip_counter = 0;
+    if (++skip_counter % sample_interval_.load(std::memory_order_relaxed) != 0)
+        return;
+
+    std::lock_guard<std::mutex> guard(latch_);
+    PageContention &contention = pages_[page_id];
+    if (is_write)
+        contention.write_waits++;
+    else
+        contention.read_waits++;
+    contention.total_ticks += wait_ticks;
+    contention.max_ticks = std::max(contention.max_ticks, wait_ticks);
+    contention.sites[reinterpret_cast<uintptr_t>(call_site)]++;
+}
+
+void LatchProfiler::Report(std::ostream &os, size_t top_n) {
+    std::lock_guard<std::mutex> guard(latch_);
+    std::vector<std::pair<page_id_t, const PageContention *>> ranked;
+    for (auto &entry : pages_)
+        ranked.emplace_back(entry.first, &entry.second);
+    std::sort(ranked.begin(), ranked.end(),
+              [](const std::pair<page_id_t, const PageContention *> &lhs,
+                 const std::pair<page_id_t, const PageContention *> &rhs) {
+                  return lhs.second->total_ticks > rhs.second->total_ticks;
+              });
+    if (ranked.size() > top_n)
+        ranked.resize(top_n);
+
+    os << "=== latch contention: top " << ranked.size() << " pages ===\n";
+    for (auto &entry : ranked) {
+        const PageContention &contention = *entry.second;
+        os << "page " << entry.first
+           << " r_waits:" << contention.read_waits
+           << " w_waits:" << contention.write_waits
+           << " total_ticks:" << contention.total_ticks
+           << " max_ticks:" << contention.max_ticks << " sites:";
+        for (auto &site : contention.sites)
+            os << " 0x" << std::hex << site.first << std::dec << "("
+               << site.second << ")";
+        os << "\n";
+    }
+}
+
+void LatchProfiler::Reset() {
+    std::lock_guard<std::mutex> guard(latch_);
+    pages_.clear();
+}
+
+} // namespace cmudb
@@ -0,0 +1,102 @@
+/**
+ * perf_trace.cpp
+ */
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#include "common/perf_trace.h"
+
+namespace cmudb {
+
+PerfCounterCell perf_counters[static_cast<int>(PerfCounter::NUM_COUNTERS)];
+
+static const char *const counter_names[] = {
+        "latch_wait", "log_flush_stall", "bplus_restart", "buffer_pool_miss"};
+
+void PerfResetCounters() {
+    for (auto &cell : perf_counters) {
+        cell.value.store(0, std::memory_order_relaxed);
+    }
+}
+
+namespace {
+
+// per-thread ring buffer; registered on first event, unregistered when the
+// thread exits. The registry mutex is only touched at registration and
+// dump time, never on the event path
+struct PerfThreadTrace {
+    static const int CAPACITY = 4096; // power of two
+
+    PerfEvent events[CAPACITY];
+    std::atomic<uint64_t> next{0};
+
+    PerfThreadTrace();
+    ~PerfThreadTrace();
+
+    void Record(uint16_t event_id, uint64_t arg) {
+        uint64_t slot = next.fetch_add(1, std::memory_order_relaxed);
+        PerfEvent &event = events[slot & (CAPACITY - 1)];
+        event.tsc = __rdtsc();
+        event.event_id = event_id;
+        event.arg = arg;
+    }
+};
+
+std::mutex &TraceRegistryLatch() {
+    static std::mutex latch;
+    return latch;
+}
+
+std::vector<PerfThreadTrace *> &TraceRegistry() {
+    static std::vector<PerfThreadTrace *> registry;
+    return registry;
+}
+
+PerfThreadTrace::PerfThreadTrace() {
+    std::lock_guard<std::mutex> guard(TraceRegistryLatch());
+    TraceRegistry().push_back(this);
+}
+
+PerfThreadTrace::~PerfThreadTrace() {
+    std::lock_guard<std::mutex> guard(TraceRegistryLatch());
+    auto &registry = TraceRegistry();
+    registry.erase(std::remove(registry.begin(), registry.end(), this),
+                   registry.end());
+}
+
+PerfThreadTrace &LocalTrace() {
+    static thread_local PerfThreadTrace trace;
+    return trace;
+}
+
+} // namespace
+
+void PerfTraceEvent(uint16_t event_id, uint64_t arg) {
+    LocalTrace().Record(event_id, arg);
+}
+
+void PerfDump(std::ostream &os) {
+    os << "--- counters ---\n";
+    for (int i = 0; i < static_cast<int>(PerfCounter::NUM_COUNTERS); i++) {
+        os << counter_names[i] << " = "
+           << perf_counters[i].value.load(std::memory_order_relaxed) << "\n";
+    }
+
+    std::lock_guard<std::mutex> guard(TraceRegistryLatch());
+    int thread_index = 0;
+    for (PerfThreadTrace *trace : TraceRegistry()) {
+        uint64_t end = trace->next.load(std::memory_order_relaxed);
+        uint64_t count = std::min<uint64_t>(end, PerfThreadTrace::CAPACITY);
+        os << "--- thread " << thread_index++ << " (" << count
+           << " events) ---\n";
+        for (uint64_t i = end - count; i < end; i++) {
+            const PerfEvent &event =
+                    trace->events[i & (PerfThreadTrace::CAPACITY - 1)];
+            os << event.tsc << " id=" << event.event_id
+               << " arg=" << event.arg << "\n";
+        }
+    }
+}
+
+} // namespace cmudb
@@ -0,0 +1,83 @@
+/**
+ * thread_pool.cpp
+ */
+
+#include "common/thread_pool.h"
+
+#include <cassert>
+
+namespace cmudb {
+
+ThreadPool::ThreadPool(size_t num_workers) {
+    if (num_workers == 0) {
+        num_workers = std::thread::hardware_concurrency();
+        if (num_workers < 2) {
+            num_workers = 2;
+        }
+    }
+    workers_.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+        workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() { Shutdown(); }
+
+ThreadPool &ThreadPool::Instance() {
+    // constructed on first use, torn down at process exit after it drained
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::Submit(std::function<void()> task, Priority priority) {
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        assert(!shutdown_);
+        if (priority == Priority::HIGH) {
+            high_lane_.push_back(std::move(task));
+        } else {
+            low_lane_.push_back(std::move(task));
+        }
+    }
+    cv_.notify_one();
+}
+
+void ThreadPool::Shutdown() {
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        if (shutdown_) {
+            return;
+        }
+        shutdown_ = true;
+    }
+    cv_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::WorkerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(latch_);
+            cv_.wait(lock, [this] {
+                return shutdown_ || !high_lane_.empty() || !low_lane_.empty();
+            });
+            // drain both lanes before honoring shutdown, so queued work is
+            // never dropped on the floor
+            if (!high_lane_.empty()) {
+                task = std::move(high_lane_.front());
+                high_lane_.pop_front();
+            } else if (!low_lane_.empty()) {
+                task = std::move(low_lane_.front());
+                low_lane_.pop_front();
+            } else {
+                return; // shutdown and nothing left
+            }
+        }
+        task();
+    }
+}
+
+} // namespace cmudb
@@ -2,49 +2,128 @@
  * lock_manager.cpp
  */
 
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <unordered_set>
+
 #include "concurrency/lock_manager.h"
 
 namespace cmudb {
 
 bool LockManager::LockShared(Transaction *txn, const RID &rid) {
+    return LockSharedImpl(txn, rid, true, std::chrono::steady_clock::time_point());
+}
+
+bool LockManager::TryLockShared(Transaction *txn, const RID &rid) {
+    return LockSharedImpl(txn, rid, false, std::chrono::steady_clock::now());
+}
+
+bool LockManager::LockShared(Transaction *txn, const RID &rid,
+                             std::chrono::milliseconds timeout) {
+    return LockSharedImpl(txn, rid, false,
+                          std::chrono::steady_clock::now() + timeout);
+}
+
+bool LockManager::LockExclusive(Transaction *txn, const RID &rid) {
+    return LockExclusiveImpl(txn, rid, true, std::chrono::steady_clock::time_point());
+}
+
+bool LockManager::TryLockExclusive(Transaction *txn, const RID &rid) {
+    return LockExclusiveImpl(txn, rid, false, std::chrono::steady_clock::now());
+}
+
+bool LockManager::LockExclusive(Transaction *txn, const RID &rid,
+                                std::chrono::milliseconds timeout) {
+    return LockExclusiveImpl(txn, rid, false,
+                             std::chrono::steady_clock::now() + timeout);
+}
+
+bool LockManager::LockSharedImpl(Transaction *txn, const RID &rid,
+                                 bool wait_forever,
+                                 std::chrono::steady_clock::time_point deadline) {
+    // an escalated page lock already covers the row, even during rollback
+    // when the txn is no longer allowed to acquire new locks
+    if (txn->GetExclusiveLockSet()->count(
+            RID(rid.GetPageId(), PAGE_LOCK_SLOT)) != 0) {
+        return true;
+    }
+
     if (!TxnStateValidForLock(txn)) {
         return false;
     }
 
+    // row locks imply an intention on their page; the page may already be
+    // held exclusively through escalation, covering this row
+    bool covered = false;
+    if (!LockPageIntention(txn, rid.GetPageId(), PAGE_IS, covered, true,
+                           wait_forever, deadline)) {
+        return false;
+    }
+    if (covered) {
+        return true;
+    }
+
     txn_id_t txn_id = txn->GetTransactionId();
-    std::unique_lock<std::mutex> lock(mutex_);
+    LockShard &shard = ShardFor(rid);
+    std::unique_lock<std::mutex> lock(shard.mutex_);
 
     // tuple is locked in exlusive mode
-    if (lock_table_.find(rid) != lock_table_.end()) {
-        auto grantedTxns = lock_table_[rid];
+    if (shard.lock_table_.find(rid) != shard.lock_table_.end()) {
+        auto grantedTxns = shard.lock_table_[rid];
         assert(!grantedTxns->granted_set_.empty());
         if (grantedTxns->lockType_ == LockType::EXCLUSIVE) {
-            // tuple locked in exclusive mode, txn is yonger, abort
-            if (txn_id >= *grantedTxns->granted_set_.begin()) {
-                txn->SetState(TransactionState::ABORTED);
+            // tuple locked in exclusive mode, txn is yonger, abort (wait-die)
+            if (wait_forever
+                && ShouldDieWaitingFor(txn, grantedTxns->OldestGranted())) {
+                lock.unlock();
+                ReleasePageIntention(txn, rid.GetPageId());
                 return false;
             }
-            // tuple locked in exlusive mode, txn is older, wait
-            if (cv_table_.find(rid) == cv_table_.end()) {
-                cv_table_.emplace(rid, std::make_shared<std::condition_variable>());
+            // tuple locked in exlusive mode, wait
+            if (shard.cv_table_.find(rid) == shard.cv_table_.end()) {
+                shard.cv_table_.emplace(rid, std::make_shared<WaitQueue>());
             }
             // increase shared_ptr reference, used by unlock to remove cv from cv table
-            auto cv = cv_table_[rid];
-            cv->wait(lock, [&] { return lock_table_.find(rid) == lock_table_.end()
-                                 || lock_table_[rid]->lockType_ == LockType::SHARED; });
+            auto wq = shard.cv_table_[rid];
+            AddWaiter(shard, txn, rid);
+            ++wq->shared_waiters_;
+            auto granted = [&] { return txn->GetState() == TransactionState::ABORTED
+                                 || shard.lock_table_.find(rid) == shard.lock_table_.end()
+                                 || shard.lock_table_[rid]->lockType_ == LockType::SHARED; };
+            bool in_time = true;
+            if (wait_forever) {
+                wq->cv_.wait(lock, granted);
+            } else {
+                in_time = wq->cv_.wait_until(lock, deadline, granted);
+            }
+            --wq->shared_waiters_;
+            RemoveWaiter(shard, txn, rid);
+            // timed out: fail without aborting so the caller can retry
+            if (!in_time) {
+                lock.unlock();
+                ReleasePageIntention(txn, rid.GetPageId());
+                return false;
+            }
+            // picked as a deadlock victim while waiting
+            if (txn->GetState() == TransactionState::ABORTED) {
+                lock.unlock();
+                ReleasePageIntention(txn, rid.GetPageId());
+                return false;
+            }
         }
     }
 
     // tuple is not locked by other txn, this check is needed as we might
     // just come out of wait and lock table becomes empty due to unlock
-    if (lock_table_.find(rid) == lock_table_.end()) {
-        lock_table_.emplace(rid, std::make_shared<GrantedTxns>(LockType::SHARED, txn_id));
+    if (shard.lock_table_.find(rid) == shard.lock_table_.end()) {
+        shard.lock_table_.emplace(rid, std::make_shared<GrantedTxns>(LockType::SHARED, txn_id));
         txn->GetSharedLockSet()->emplace(rid);
         return true;
     }
 
     // tuple is locked in shared mode
-    auto grantedTxns = lock_table_[rid];
+    auto grantedTxns = shard.lock_table_[rid];
     assert(!grantedTxns->granted_set_.empty());
     if (grantedTxns->lockType_ == LockType::SHARED) {
         grantedTxns->granted_set_.emplace(txn_id);
@@ -54,41 +133,97 @@ bool LockManager::LockShared(Transaction *txn, const RID &rid) {
 
     // this should not happen as we already waited for exclusive lock to be unlocked
     assert(false);
+    return false;
 }
 
-bool LockManager::LockExclusive(Transaction *txn, const RID &rid) {
+bool LockManager::LockExclusiveImpl(Transaction *txn, const RID &rid,
+                                    bool wait_forever,
+                                    std::chrono::steady_clock::time_point deadline) {
+    // an escalated page lock already covers the row, even during rollback
+    // when the txn is no longer allowed to acquire new locks
+    if (txn->GetExclusiveLockSet()->count(
+            RID(rid.GetPageId(), PAGE_LOCK_SLOT)) != 0) {
+        return true;
+    }
+
     if (!TxnStateValidForLock(txn)) {
         return false;
     }
 
+    // row locks imply an intention on their page; the page may already be
+    // held exclusively through escalation, covering this row
+    bool covered = false;
+    if (!LockPageIntention(txn, rid.GetPageId(), PAGE_IX, covered, true,
+                           wait_forever, deadline)) {
+        return false;
+    }
+    if (covered) {
+        return true;
+    }
+
     txn_id_t txn_id = txn->GetTransactionId();
-    std::unique_lock<std::mutex> lock(mutex_);
+    LockShard &shard = ShardFor(rid);
+    std::unique_lock<std::mutex> lock(shard.mutex_);
 
     // tuple is not locked by other txn
-    if (lock_table_.find(rid) == lock_table_.end()) {
-        lock_table_.emplace(rid, std::make_shared<GrantedTxns>(LockType::EXCLUSIVE, txn_id));
+    if (shard.lock_table_.find(rid) == shard.lock_table_.end()) {
+        shard.lock_table_.emplace(rid, std::make_shared<GrantedTxns>(LockType::EXCLUSIVE, txn_id));
         txn->GetExclusiveLockSet()->emplace(rid);
+        lock.unlock();
+        TryEscalate(txn, rid.GetPageId());
         return true;
     }
 
-    // tuple locked, txn is yonger, abort
-    auto grantedTxns = lock_table_[rid];
+    // tuple locked, txn is yonger, abort (wait-die)
+    auto grantedTxns = shard.lock_table_[rid];
     assert(!grantedTxns->granted_set_.empty());
-    if (txn_id >= *grantedTxns->granted_set_.begin()) {
-        txn->SetState(TransactionState::ABORTED);
+    if (wait_forever
+        && ShouldDieWaitingFor(txn, grantedTxns->OldestGranted())) {
+        lock.unlock();
+        ReleasePageIntention(txn, rid.GetPageId());
         return false;
     }
 
-    // tuple locked, txn is older, wait
-    if (cv_table_.find(rid) == cv_table_.end()) {
-        cv_table_.emplace(rid, std::make_shared<std::condition_variable>());
+    // tuple locked, wait
+    if (shard.cv_table_.find(rid) == shard.cv_table_.end()) {
+        shard.cv_table_.emplace(rid, std::make_shared<WaitQueue>());
     }
 
     // increase shared_ptr reference, used by unlock to remove cv from cv table
-    auto cv = cv_table_[rid];
-    cv->wait(lock, [&] { return lock_table_.find(rid) == lock_table_.end(); });
-    lock_table_.emplace(rid, std::make_shared<GrantedTxns>(LockType::EXCLUSIVE, txn_id));
+    auto wq = shard.cv_table_[rid];
+    AddWaiter(shard, txn, rid);
+    ++wq->exclusive_waiters_;
+    auto granted = [&] { return txn->GetState() == TransactionState::ABORTED
+                         || shard.lock_table_.find(rid) == shard.lock_table_.end(); };
+    bool in_time = true;
+    if (wait_forever) {
+        wq->cv_.wait(lock, granted);
+    } else {
+        in_time = wq->cv_.wait_until(lock, deadline, granted);
+    }
+    --wq->exclusive_waiters_;
+    RemoveWaiter(shard, txn, rid);
+    // timed out: fail without aborting so the caller can retry
+    if (!in_time) {
+        lock.unlock();
+        ReleasePageIntention(txn, rid.GetPageId());
+        return false;
+    }
+    // picked as a deadlock victim while waiting
+    if (txn->GetState() == TransactionState::ABORTED) {
+        // a notify_one may have been spent waking this victim; pass it on
+        // if the tuple is free so another exclusive waiter is not stranded
+        if (shard.lock_table_.find(rid) == shard.lock_table_.end()) {
+            WakeEligibleWaiters(shard, rid);
+        }
+        lock.unlock();
+        ReleasePageIntention(txn, rid.GetPageId());
+        return false;
+    }
+    shard.lock_table_.emplace(rid, std::make_shared<GrantedTxns>(LockType::EXCLUSIVE, txn_id));
     txn->GetExclusiveLockSet()->emplace(rid);
+    lock.unlock();
+    TryEscalate(txn, rid.GetPageId());
 
     return true;
 }
@@ -98,16 +233,27 @@ bool LockManager::LockUpgrade(Transaction *txn, const RID &rid) {
         return false;
     }
 
-    std::unique_lock<std::mutex> lock(mutex_);
+    // upgrading a row to exclusive strengthens the page intention to IX;
+    // the row itself is already counted by its shared lock
+    bool covered = false;
+    if (!LockPageIntention(txn, rid.GetPageId(), PAGE_IX, covered, false)) {
+        return false;
+    }
+    if (covered) {
+        return true;
+    }
+
+    LockShard &shard = ShardFor(rid);
+    std::unique_lock<std::mutex> lock(shard.mutex_);
 
     // lock upgrade requires tuple to be locked before
-    if (lock_table_.find(rid) == lock_table_.end()) {
+    if (shard.lock_table_.find(rid) == shard.lock_table_.end()) {
         txn->SetState(TransactionState::ABORTED);
         return false;
     }
 
     // lock upgrade requires tuple to be locked in shared mode
-    auto grantedTxns = lock_table_[rid];
+    auto grantedTxns = shard.lock_table_[rid];
     auto txn_id = txn->GetTransactionId();
     if (grantedTxns->lockType_ != LockType::SHARED
         || grantedTxns->granted_set_.count(txn_id) == 0) {
@@ -120,28 +266,49 @@ bool LockManager::LockUpgrade(Transaction *txn, const RID &rid) {
     txn->GetSharedLockSet()->erase(rid);
     grantedTxns->granted_set_.erase(txn_id);
     if (grantedTxns->granted_set_.empty()) {
-        lock_table_[rid] = std::make_shared<GrantedTxns>(LockType::EXCLUSIVE, txn_id);
+        shard.lock_table_[rid] = std::make_shared<GrantedTxns>(LockType::EXCLUSIVE, txn_id);
         txn->GetExclusiveLockSet()->emplace(rid);
         return true;
     }
 
-    // other txns also hold this shared lock, txn is yonger, abort
+    // other txns also hold this shared lock, txn is yonger, abort (wait-die)
     // need to make sure this txn is already removed from lock table
-    if (txn_id >= *grantedTxns->granted_set_.begin()) {
-        txn->SetState(TransactionState::ABORTED);
+    if (ShouldDieWaitingFor(txn, grantedTxns->OldestGranted())) {
+        // the shared row lock was already released above
+        lock.unlock();
+        ReleasePageIntention(txn, rid.GetPageId());
         return false;
     }
 
-    // other txns also hold this shared lock, txn is older, wait
-    if (cv_table_.find(rid) == cv_table_.end()) {
-        cv_table_.emplace(rid, std::make_shared<std::condition_variable>());
+    // other txns also hold this shared lock, wait
+    if (shard.cv_table_.find(rid) == shard.cv_table_.end()) {
+        shard.cv_table_.emplace(rid, std::make_shared<WaitQueue>());
     }
 
     // increase shared_ptr reference, used by unlock to remove cv from cv table
-    auto cv = cv_table_[rid];
-    cv->wait(lock, [&] { return lock_table_.find(rid) == lock_table_.end(); });
-    lock_table_.emplace(rid, std::make_shared<GrantedTxns>(LockType::EXCLUSIVE, txn_id));
+    auto wq = shard.cv_table_[rid];
+    AddWaiter(shard, txn, rid);
+    ++wq->exclusive_waiters_;
+    wq->cv_.wait(lock, [&] { return txn->GetState() == TransactionState::ABORTED
+                             || shard.lock_table_.find(rid) == shard.lock_table_.end(); });
+    --wq->exclusive_waiters_;
+    RemoveWaiter(shard, txn, rid);
+    // picked as a deadlock victim while waiting
+    if (txn->GetState() == TransactionState::ABORTED) {
+        // a notify_one may have been spent waking this victim; pass it on
+        // if the tuple is free so another exclusive waiter is not stranded
+        if (shard.lock_table_.find(rid) == shard.lock_table_.end()) {
+            WakeEligibleWaiters(shard, rid);
+        }
+        // the shared row lock was already released above
+        lock.unlock();
+        ReleasePageIntention(txn, rid.GetPageId());
+        return false;
+    }
+    shard.lock_table_.emplace(rid, std::make_shared<GrantedTxns>(LockType::EXCLUSIVE, txn_id));
     txn->GetExclusiveLockSet()->emplace(rid);
+    lock.unlock();
+    TryEscalate(txn, rid.GetPageId());
 
     return true;
 }
@@ -154,16 +321,28 @@ bool LockManager::Unlock(Transaction *txn, const RID &rid) {
         return false;
     }
 
-    std::unique_lock<std::mutex> lock(mutex_);
+    // a rid with the page lock slot is an escalated page lock
+    if (rid.GetSlotNum() == PAGE_LOCK_SLOT) {
+        return UnlockPage(txn, rid);
+    }
+
+    LockShard &shard = ShardFor(rid);
+    std::unique_lock<std::mutex> lock(shard.mutex_);
 
     // tuple has not been locked
-    if (lock_table_.find(rid) == lock_table_.end()) {
+    if (shard.lock_table_.find(rid) == shard.lock_table_.end()) {
+        // escalation may have replaced this row lock with a page lock; the
+        // page lock is released through the txn's lock set at txn end
+        if (txn->GetExclusiveLockSet()->count(
+                RID(rid.GetPageId(), PAGE_LOCK_SLOT)) != 0) {
+            return true;
+        }
         txn->SetState(TransactionState::ABORTED);
         return false;
     }
 
     // remove txn from granted set
-    auto grantedTxns = lock_table_[rid];
+    auto grantedTxns = shard.lock_table_[rid];
     auto txn_id = txn->GetTransactionId();
     if (grantedTxns->granted_set_.erase(txn_id) == 0) {
         txn->SetState(TransactionState::ABORTED);
@@ -182,19 +361,16 @@ bool LockManager::Unlock(Transaction *txn, const RID &rid) {
         txn->GetExclusiveLockSet()->erase(rid);
     }
 
-    // notify all waiting txns if no txn is holding this tuple
+    // wake eligible waiting txns if no txn is holding this tuple
     // and remove rid from lock table and cv table if possible
     if (grantedTxns->granted_set_.empty()) {
-        lock_table_.erase(rid);
-        if (cv_table_.find(rid) != cv_table_.end()) {
-            cv_table_[rid]->notify_all();
-            // if no one is waiting on cv, can be removed from table
-            if (cv_table_[rid].unique()) {
-                cv_table_.erase(rid);
-            }
-        }
+        shard.lock_table_.erase(rid);
+        WakeEligibleWaiters(shard, rid);
     }
 
+    lock.unlock();
+    ReleasePageIntention(txn, rid.GetPageId());
+
     return true;
 }
 
@@ -207,4 +383,445 @@ bool LockManager::TxnStateValidForLock(Transaction *txn) {
     return true;
 }
 
+LockManager::LockShard &LockManager::ShardFor(const RID &rid) {
+    return shards_[std::hash<RID>()(rid) % LOCK_TABLE_SHARDS];
+}
+
+LockManager::PageShard &LockManager::PageShardFor(page_id_t page_id) {
+    return page_shards_[std::hash<page_id_t>()(page_id) % LOCK_TABLE_SHARDS];
+}
+
+bool LockManager::LockPageIntention(Transaction *txn, page_id_t page_id,
+                                    int mode, bool &covered, bool count_row,
+                                    bool wait_forever,
+                                    std::chrono::steady_clock::time_point deadline) {
+    txn_id_t txn_id = txn->GetTransactionId();
+    PageShard &ps = PageShardFor(page_id);
+    std::unique_lock<std::mutex> lock(ps.mutex_);
+
+    // an intention only conflicts with an exclusive page lock held by
+    // another txn
+    auto conflicting_holder = [&]() -> txn_id_t {
+        auto page_iter = ps.page_table_.find(page_id);
+        if (page_iter == ps.page_table_.end()) {
+            return INVALID_TXN_ID;
+        }
+        for (auto &entry : page_iter->second.txns_) {
+            if (entry.first != txn_id && (entry.second.mode_mask_ & PAGE_X) != 0) {
+                return entry.first;
+            }
+        }
+        return INVALID_TXN_ID;
+    };
+
+    txn_id_t holder = conflicting_holder();
+    if (holder != INVALID_TXN_ID) {
+        // page locked exclusively, txn is yonger, abort (wait-die)
+        if (wait_forever && ShouldDieWaitingFor(txn, holder)) {
+            return false;
+        }
+        if (ps.cv_table_.find(page_id) == ps.cv_table_.end()) {
+            ps.cv_table_.emplace(page_id, std::make_shared<std::condition_variable>());
+        }
+        auto cv = ps.cv_table_[page_id];
+        if (deadlock_detection_) {
+            ps.waiter_table_[page_id].push_back(txn);
+        }
+        auto granted = [&] { return txn->GetState() == TransactionState::ABORTED
+                             || conflicting_holder() == INVALID_TXN_ID; };
+        bool in_time = true;
+        if (wait_forever) {
+            cv->wait(lock, granted);
+        } else {
+            in_time = cv->wait_until(lock, deadline, granted);
+        }
+        if (deadlock_detection_) {
+            auto &waiters = ps.waiter_table_[page_id];
+            waiters.remove(txn);
+            if (waiters.empty()) {
+                ps.waiter_table_.erase(page_id);
+            }
+        }
+        // timed out: fail without aborting so the caller can retry
+        if (!in_time) {
+            return false;
+        }
+        // picked as a deadlock victim while waiting
+        if (txn->GetState() == TransactionState::ABORTED) {
+            return false;
+        }
+    }
+
+    auto &entry = ps.page_table_[page_id].txns_[txn_id];
+    if ((entry.mode_mask_ & PAGE_X) != 0) {
+        covered = true;
+        return true;
+    }
+    entry.mode_mask_ |= mode;
+    if (count_row) {
+        ++entry.row_count_;
+    }
+
+    return true;
+}
+
+void LockManager::ReleasePageIntention(Transaction *txn, page_id_t page_id) {
+    PageShard &ps = PageShardFor(page_id);
+    std::unique_lock<std::mutex> lock(ps.mutex_);
+
+    auto page_iter = ps.page_table_.find(page_id);
+    if (page_iter == ps.page_table_.end()) {
+        return;
+    }
+    auto txn_iter = page_iter->second.txns_.find(txn->GetTransactionId());
+    if (txn_iter == page_iter->second.txns_.end()) {
+        return;
+    }
+    if (--txn_iter->second.row_count_ > 0) {
+        return;
+    }
+    // keep the entry while the txn holds the page exclusively
+    if ((txn_iter->second.mode_mask_ & PAGE_X) != 0) {
+        return;
+    }
+
+    page_iter->second.txns_.erase(txn_iter);
+    if (page_iter->second.txns_.empty()) {
+        ps.page_table_.erase(page_iter);
+    }
+}
+
+/*
+ * Opportunistic lock escalation: once a txn holds
+ * LOCK_ESCALATION_THRESHOLD row locks on a page and no other txn touches
+ * that page, grant it the exclusive page lock and give back its row
+ * locks so large transactions stop accumulating lock table entries. If
+ * the page is shared with anyone the attempt is simply skipped and
+ * retried on the next row lock
+ */
+void LockManager::TryEscalate(Transaction *txn, page_id_t page_id) {
+    txn_id_t txn_id = txn->GetTransactionId();
+    PageShard &ps = PageShardFor(page_id);
+    std::unique_lock<std::mutex> page_lock(ps.mutex_);
+
+    auto page_iter = ps.page_table_.find(page_id);
+    if (page_iter == ps.page_table_.end()) {
+        return;
+    }
+    auto txn_iter = page_iter->second.txns_.find(txn_id);
+    if (txn_iter == page_iter->second.txns_.end()) {
+        return;
+    }
+    PageLockState::TxnEntry &entry = txn_iter->second;
+    if ((entry.mode_mask_ & PAGE_X) != 0
+        || entry.row_count_ < LOCK_ESCALATION_THRESHOLD
+        || page_iter->second.txns_.size() > 1) {
+        return;
+    }
+    entry.mode_mask_ |= PAGE_X;
+    entry.row_count_ = 0;
+
+    // give back this txn's row locks on the page, the page lock covers
+    // them; page shard mutexes are always taken before row shard mutexes
+    std::vector<RID> owned;
+    for (auto &locked : *txn->GetSharedLockSet()) {
+        if (locked.GetPageId() == page_id) {
+            owned.push_back(locked);
+        }
+    }
+    for (auto &locked : *txn->GetExclusiveLockSet()) {
+        if (locked.GetPageId() == page_id) {
+            owned.push_back(locked);
+        }
+    }
+    for (auto &row : owned) {
+        LockShard &shard = ShardFor(row);
+        std::unique_lock<std::mutex> lock(shard.mutex_);
+        auto iter = shard.lock_table_.find(row);
+        if (iter == shard.lock_table_.end()) {
+            continue;
+        }
+        auto grantedTxns = iter->second;
+        if (grantedTxns->granted_set_.erase(txn_id) == 0) {
+            continue;
+        }
+        if (grantedTxns->lockType_ == LockType::SHARED) {
+            txn->GetSharedLockSet()->erase(row);
+        } else {
+            txn->GetExclusiveLockSet()->erase(row);
+        }
+        if (grantedTxns->granted_set_.empty()) {
+            shard.lock_table_.erase(row);
+            WakeEligibleWaiters(shard, row);
+        }
+    }
+
+    // released through the txn's lock set at txn end, like a row lock
+    txn->GetExclusiveLockSet()->emplace(RID(page_id, PAGE_LOCK_SLOT));
+}
+
+bool LockManager::UnlockPage(Transaction *txn, const RID &rid) {
+    page_id_t page_id = rid.GetPageId();
+    PageShard &ps = PageShardFor(page_id);
+    std::unique_lock<std::mutex> lock(ps.mutex_);
+
+    auto page_iter = ps.page_table_.find(page_id);
+    if (page_iter == ps.page_table_.end()) {
+        txn->SetState(TransactionState::ABORTED);
+        return false;
+    }
+    if (page_iter->second.txns_.erase(txn->GetTransactionId()) == 0) {
+        txn->SetState(TransactionState::ABORTED);
+        return false;
+    }
+    if (page_iter->second.txns_.empty()) {
+        ps.page_table_.erase(page_iter);
+    }
+
+    // update txn state to SHRINKING if current state is GROWING
+    if (!strict_2PL_ && txn->GetState() == TransactionState::GROWING) {
+        txn->SetState(TransactionState::SHRINKING);
+    }
+
+    txn->GetExclusiveLockSet()->erase(rid);
+
+    // wake txns blocked on the exclusive page lock
+    if (ps.cv_table_.find(page_id) != ps.cv_table_.end()) {
+        ps.cv_table_[page_id]->notify_all();
+        if (ps.cv_table_[page_id].unique()) {
+            ps.cv_table_.erase(page_id);
+        }
+    }
+
+    return true;
+}
+
+bool LockManager::ShouldDieWaitingFor(Transaction *txn, txn_id_t oldest_granted) {
+    // detection mode never aborts on age, the detector aborts real victims
+    if (deadlock_detection_) {
+        return false;
+    }
+
+    if (txn->GetTransactionId() >= oldest_granted) {
+        txn->SetState(TransactionState::ABORTED);
+        return true;
+    }
+
+    return false;
+}
+
+void LockManager::AddWaiter(LockShard &shard, Transaction *txn, const RID &rid) {
+    if (!deadlock_detection_) {
+        return;
+    }
+    shard.waiter_table_[rid].push_back(txn);
+}
+
+void LockManager::RemoveWaiter(LockShard &shard, Transaction *txn, const RID &rid) {
+    if (!deadlock_detection_) {
+        return;
+    }
+    auto &waiters = shard.waiter_table_[rid];
+    waiters.remove(txn);
+    if (waiters.empty()) {
+        shard.waiter_table_.erase(rid);
+    }
+}
+
+/*
+ * Wake only the waiters that can take the now-free rid. Queued readers
+ * can only have been blocked on an exclusive holder (readers never wait
+ * behind readers), so its release admits all of them at once; otherwise
+ * the last reader left and exactly one writer or upgrader can have the
+ * tuple, so only one is woken and the rest sleep until the next release.
+ * Caller must hold the shard mutex with rid erased from the lock table
+ */
+void LockManager::WakeEligibleWaiters(LockShard &shard, const RID &rid) {
+    auto cv_iter = shard.cv_table_.find(rid);
+    if (cv_iter == shard.cv_table_.end()) {
+        return;
+    }
+    WaitQueue &wq = *cv_iter->second;
+    if (wq.shared_waiters_ > 0) {
+        wq.cv_.notify_all();
+    } else if (wq.exclusive_waiters_ > 0) {
+        wq.cv_.notify_one();
+    }
+    // if no one is waiting on cv, can be removed from table
+    if (cv_iter->second.unique()) {
+        shard.cv_table_.erase(cv_iter);
+    }
+}
+
+void LockManager::RunDetectionThread() {
+    if (detection_running_) {
+        return;
+    }
+    detection_running_ = true;
+    detection_thread_ = new std::thread(&LockManager::DetectionThread, this);
+}
+
+void LockManager::StopDetectionThread() {
+    if (!detection_running_) {
+        return;
+    }
+    detection_running_ = false;
+    detection_cv_.notify_one();
+    if (detection_thread_ != nullptr && detection_thread_->joinable()) {
+        detection_thread_->join();
+    }
+    delete detection_thread_;
+    detection_thread_ = nullptr;
+}
+
+/**
+ * background detection loop, wakes up every DEADLOCK_TIMEOUT
+ */
+void LockManager::DetectionThread() {
+    while (detection_running_) {
+        std::unique_lock<std::mutex> lock(detection_latch_);
+        detection_cv_.wait_for(lock, DEADLOCK_TIMEOUT);
+        if (detection_running_) {
+            DetectDeadlocks();
+        }
+    }
+}
+
+/*
+ * Build the wait-for graph from the lock and waiter tables of every
+ * shard: each waiting txn points to every txn currently granted the rid
+ * it is blocked on. While the graph has a cycle, abort the youngest txn
+ * on it and wake that txn's condition variable so its lock call returns
+ * false
+ */
+void LockManager::DetectDeadlocks() {
+    // take every shard in index order, page shards before row shards as
+    // everywhere else; the detector is the only path that holds more than
+    // one shard mutex at a time
+    std::vector<std::unique_lock<std::mutex>> shard_locks;
+    for (auto &page_shard : page_shards_) {
+        shard_locks.emplace_back(page_shard.mutex_);
+    }
+    for (auto &shard : shards_) {
+        shard_locks.emplace_back(shard.mutex_);
+    }
+
+    std::unordered_map<txn_id_t, std::vector<txn_id_t>> wait_for;
+    std::unordered_map<txn_id_t, Transaction *> waiting_txns;
+    std::unordered_map<txn_id_t, RID> waiting_on;
+    std::unordered_map<txn_id_t, page_id_t> waiting_on_page;
+
+    for (auto &shard : shards_) {
+        for (auto &entry : shard.waiter_table_) {
+            auto granted_iter = shard.lock_table_.find(entry.first);
+            if (granted_iter == shard.lock_table_.end()) {
+                continue;
+            }
+            for (Transaction *waiter : entry.second) {
+                // already a victim of an earlier pass, about to wake up
+                if (waiter->GetState() == TransactionState::ABORTED) {
+                    continue;
+                }
+                txn_id_t waiter_id = waiter->GetTransactionId();
+                for (txn_id_t holder : granted_iter->second->granted_set_) {
+                    if (holder != waiter_id) {
+                        wait_for[waiter_id].push_back(holder);
+                    }
+                }
+                waiting_txns[waiter_id] = waiter;
+                waiting_on.emplace(waiter_id, entry.first);
+            }
+        }
+    }
+
+    // txns blocked on an escalated page lock wait for its exclusive holder
+    for (auto &page_shard : page_shards_) {
+        for (auto &entry : page_shard.waiter_table_) {
+            auto page_iter = page_shard.page_table_.find(entry.first);
+            if (page_iter == page_shard.page_table_.end()) {
+                continue;
+            }
+            for (Transaction *waiter : entry.second) {
+                if (waiter->GetState() == TransactionState::ABORTED) {
+                    continue;
+                }
+                txn_id_t waiter_id = waiter->GetTransactionId();
+                for (auto &holder : page_iter->second.txns_) {
+                    if (holder.first != waiter_id
+                        && (holder.second.mode_mask_ & PAGE_X) != 0) {
+                        wait_for[waiter_id].push_back(holder.first);
+                    }
+                }
+                waiting_txns[waiter_id] = waiter;
+                waiting_on_page.emplace(waiter_id, entry.first);
+            }
+        }
+    }
+
+    std::unordered_set<txn_id_t> victims;
+    while (true) {
+        // depth-first search for one cycle, skipping victims already chosen
+        std::unordered_map<txn_id_t, int> color;
+        std::vector<txn_id_t> path;
+        std::vector<txn_id_t> cycle;
+        std::function<bool(txn_id_t)> dfs = [&](txn_id_t node) -> bool {
+            color[node] = 1;
+            path.push_back(node);
+            auto edge_iter = wait_for.find(node);
+            if (edge_iter != wait_for.end()) {
+                for (txn_id_t next : edge_iter->second) {
+                    if (victims.count(next) != 0) {
+                        continue;
+                    }
+                    if (color[next] == 1) {
+                        cycle.assign(std::find(path.begin(), path.end(), next),
+                                     path.end());
+                        return true;
+                    }
+                    if (color[next] == 0 && dfs(next)) {
+                        return true;
+                    }
+                }
+            }
+            color[node] = 2;
+            path.pop_back();
+            return false;
+        };
+
+        bool found = false;
+        for (auto &entry : wait_for) {
+            if (color[entry.first] == 0 && victims.count(entry.first) == 0
+                && dfs(entry.first)) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            break;
+        }
+
+        // every node on a cycle has an outgoing edge, so it is a waiter
+        txn_id_t victim_id = *std::max_element(cycle.begin(), cycle.end());
+        victims.emplace(victim_id);
+        waiting_txns[victim_id]->SetState(TransactionState::ABORTED);
+        auto rid_iter = waiting_on.find(victim_id);
+        if (rid_iter != waiting_on.end()) {
+            LockShard &victim_shard = ShardFor(rid_iter->second);
+            auto cv_iter = victim_shard.cv_table_.find(rid_iter->second);
+            if (cv_iter != victim_shard.cv_table_.end()) {
+                // broadcast: only the victim's predicate turns true, the
+                // others re-check and sleep again
+                cv_iter->second->cv_.notify_all();
+            }
+        } else {
+            page_id_t page_id = waiting_on_page.at(victim_id);
+            PageShard &victim_shard = PageShardFor(page_id);
+            auto cv_iter = victim_shard.cv_table_.find(page_id);
+            if (cv_iter != victim_shard.cv_table_.end()) {
+                cv_iter->second->notify_all();
+            }
+        }
+    }
+}
+
 } // namespace cmudb
@@ -8,9 +8,36 @@
 #include <cassert>
 namespace cmudb {
 
-Transaction *TransactionManager::Begin() {
-    Transaction *txn = new Transaction(next_txn_id_++);
+// recycled transactions kept around for reuse; beyond this Recycle frees
+static const size_t TXN_POOL_CAPACITY = 64;
 
+Transaction *TransactionManager::Begin(bool read_only) {
+    Transaction *txn = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(txn_pool_latch_);
+        if (!txn_pool_.empty()) {
+            txn = txn_pool_.back();
+            txn_pool_.pop_back();
+        }
+    }
+    if (txn != nullptr) {
+        txn->Reinit(next_txn_id_++, read_only);
+    } else {
+        txn = new Transaction(next_txn_id_++, read_only);
+    }
+
+    // a read-only transaction writes no log records and never blocks a
+    // checkpoint, so it is not registered at all; it reads from the
+    // snapshot captured here instead of taking locks
+    if (read_only) {
+        txn->SetSnapshotTS(version_manager_.BeginSnapshot());
+        return txn;
+    }
+
+    // register and log under the table latch so a concurrent checkpoint
+    // either sees this transaction or is ordered before its BEGIN record
+    std::lock_guard<std::mutex> guard(txn_table_latch_);
+    active_txns_.insert(txn->GetTransactionId());
     if (ENABLE_LOGGING) {
         AppendLogRecord(txn, LogRecordType::BEGIN);
     }
@@ -20,6 +47,26 @@ Transaction *TransactionManager::Begin() {
 
 void TransactionManager::Commit(Transaction *txn) {
     txn->SetState(TransactionState::COMMITTED);
+
+    // read-only: nothing written, locked, logged or registered
+    if (txn->IsReadOnly()) {
+        version_manager_.EndSnapshot(txn->GetSnapshotTS());
+        return;
+    }
+
+    // publish the private workspace of a declared batch transaction: its
+    // staged rows touch the live pages only now, still ahead of the COMMIT
+    // record so a crash in between is undone by recovery as usual
+    if (txn->IsDeferredWrites()) {
+        txn->SetDeferredWrites(false); // inserts below go to the pages
+        auto staged_inserts = txn->GetStagedInserts();
+        for (auto &entry : *staged_inserts) {
+            std::vector<RID> rids;
+            entry.first->InsertTuples(entry.second, rids, txn);
+        }
+        staged_inserts->clear();
+    }
+
     // truly delete before commit
     auto write_set = txn->GetWriteSet();
     while (!write_set->empty()) {
@@ -35,11 +82,22 @@ void TransactionManager::Commit(Transaction *txn) {
 
     if (ENABLE_LOGGING) {
         lsn_t lsn = AppendLogRecord(txn, LogRecordType::COMMIT);
-        while (lsn > log_manager_->GetPersistentLSN()) {
-            log_manager_->WaitForLogFlush();
+        // async commit: the record is in the log buffer and the periodic
+        // LOG_TIMEOUT flush will persist it; only sync commits block here
+        if (txn->GetDurabilityLevel() == DurabilityLevel::SYNC) {
+            log_manager_->GroupCommitAndWait(lsn);
         }
     }
 
+    // stamp the saved versions: snapshots begun from here on read this
+    // transaction's values from the pages
+    version_manager_.CommitTxn(txn);
+
+    {
+        std::lock_guard<std::mutex> guard(txn_table_latch_);
+        active_txns_.erase(txn->GetTransactionId());
+    }
+
     // release all the lock
     std::unordered_set<RID> lock_set;
     for (auto item : *txn->GetSharedLockSet())
@@ -54,6 +112,20 @@ void TransactionManager::Commit(Transaction *txn) {
 
 void TransactionManager::Abort(Transaction *txn) {
     txn->SetState(TransactionState::ABORTED);
+
+    // read-only: nothing written, locked, logged or registered
+    if (txn->IsReadOnly()) {
+        version_manager_.EndSnapshot(txn->GetSnapshotTS());
+        return;
+    }
+
+    // a declared batch never let its staged inserts near the pages, so
+    // dropping the workspace is their entire undo; no locks, no page walk
+    if (txn->IsDeferredWrites()) {
+        txn->GetStagedInserts()->clear();
+        txn->SetDeferredWrites(false);
+    }
+
     // rollback before releasing lock
     auto write_set = txn->GetWriteSet();
     while (!write_set->empty()) {
@@ -75,9 +147,15 @@ void TransactionManager::Abort(Transaction *txn) {
 
     if (ENABLE_LOGGING) {
         lsn_t lsn = AppendLogRecord(txn, LogRecordType::ABORT);
-        while (lsn > log_manager_->GetPersistentLSN()) {
-            log_manager_->WaitForLogFlush();
-        }
+        log_manager_->GroupCommitAndWait(lsn);
+    }
+
+    // rollback restored the pages, the saved versions are redundant
+    version_manager_.AbortTxn(txn);
+
+    {
+        std::lock_guard<std::mutex> guard(txn_table_latch_);
+        active_txns_.erase(txn->GetTransactionId());
     }
 
     // release all the lock
@@ -92,10 +170,49 @@ void TransactionManager::Abort(Transaction *txn) {
     }
 }
 
+void TransactionManager::Recycle(Transaction *txn) {
+    std::lock_guard<std::mutex> guard(txn_pool_latch_);
+    if (txn_pool_.size() >= TXN_POOL_CAPACITY) {
+        delete txn;
+        return;
+    }
+    txn_pool_.push_back(txn);
+}
+
+/*
+ * Append a CHECKPOINT record if no transaction is active. Holding the table
+ * latch across the quiescence check and the append guarantees every record
+ * of every transaction either precedes the checkpoint (and is covered by
+ * it) or follows it entirely, so recovery never needs the log before it
+ */
+bool TransactionManager::LogCheckpoint(lsn_t &lsn, int &log_offset) {
+    if (!ENABLE_LOGGING || log_manager_ == nullptr) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(txn_table_latch_);
+    if (!active_txns_.empty()) {
+        return false;
+    }
+
+    // no transaction can append concurrently, so the running byte count is
+    // exactly where this record lands in the log file
+    log_offset = static_cast<int>(log_manager_->GetTotalAppended());
+    LogRecord record(INVALID_TXN_ID, INVALID_LSN, LogRecordType::CHECKPOINT);
+    lsn = log_manager_->AppendLogRecord(record);
+
+    return true;
+}
+
 lsn_t TransactionManager::AppendLogRecord(Transaction *txn,
                                          LogRecordType recordType) {
-    LogRecord record(txn->GetTransactionId(), txn->GetPrevLSN(), recordType);
-    lsn_t lsn = log_manager_->AppendLogRecord(record);
+    // BEGIN/COMMIT/ABORT records are header-only, so the reservation
+    // itself writes the whole record; there is no payload to fill
+    lsn_t lsn;
+    log_manager_->ReserveLogRecord(LogRecord::HEADER_SIZE,
+                                   txn->GetTransactionId(), txn->GetPrevLSN(),
+                                   recordType, lsn);
+    log_manager_->FinishAppend();
     txn->SetPrevLSN(lsn);
 
     return lsn;
@@ -0,0 +1,161 @@
+/**
+ * version_manager.cpp
+ */
+
+#include "concurrency/version_manager.h"
+
+namespace cmudb {
+
+VersionManager::VersionShard &VersionManager::ShardFor(const RID &rid) {
+    return shards_[std::hash<RID>()(rid) % LOCK_TABLE_SHARDS];
+}
+
+int64_t VersionManager::BeginSnapshot() {
+    std::lock_guard<std::mutex> guard(commit_latch_);
+    snapshots_.insert(commit_ts_);
+    return commit_ts_;
+}
+
+void VersionManager::EndSnapshot(int64_t snapshot_ts) {
+    std::lock_guard<std::mutex> guard(commit_latch_);
+    auto iter = snapshots_.find(snapshot_ts);
+    if (iter != snapshots_.end()) {
+        snapshots_.erase(iter);
+    }
+    // the finished snapshot may have been the one keeping old versions
+    PruneBelow(snapshots_.empty() ? commit_ts_ : *snapshots_.begin());
+}
+
+void VersionManager::RecordOldVersion(Transaction *txn, const RID &rid,
+                                      const Tuple &old_tuple, bool absent) {
+    txn_id_t txn_id = txn->GetTransactionId();
+    {
+        VersionShard &shard = ShardFor(rid);
+        std::lock_guard<std::mutex> guard(shard.mutex_);
+        auto &chain = shard.chains_[rid];
+        // only the state before the txn's first write matters
+        for (auto &version : chain) {
+            if (version.txn_id_ == txn_id) {
+                return;
+            }
+        }
+        chain.push_back(Version{txn_id, -1, old_tuple, absent});
+    }
+
+    std::lock_guard<std::mutex> guard(pending_latch_);
+    pending_[txn_id].push_back(rid);
+}
+
+void VersionManager::CommitTxn(Transaction *txn) {
+    txn_id_t txn_id = txn->GetTransactionId();
+    std::vector<RID> rids;
+    {
+        std::lock_guard<std::mutex> guard(pending_latch_);
+        auto iter = pending_.find(txn_id);
+        if (iter == pending_.end()) {
+            return;
+        }
+        rids = std::move(iter->second);
+        pending_.erase(iter);
+    }
+
+    std::lock_guard<std::mutex> commit_guard(commit_latch_);
+    int64_t ts = ++commit_ts_;
+    for (auto &rid : rids) {
+        VersionShard &shard = ShardFor(rid);
+        std::lock_guard<std::mutex> guard(shard.mutex_);
+        auto iter = shard.chains_.find(rid);
+        if (iter == shard.chains_.end()) {
+            continue;
+        }
+        for (auto &version : iter->second) {
+            if (version.txn_id_ == txn_id) {
+                version.commit_ts_ = ts;
+                version.txn_id_ = INVALID_TXN_ID;
+            }
+        }
+    }
+    PruneBelow(snapshots_.empty() ? commit_ts_ : *snapshots_.begin());
+}
+
+void VersionManager::AbortTxn(Transaction *txn) {
+    txn_id_t txn_id = txn->GetTransactionId();
+    std::vector<RID> rids;
+    {
+        std::lock_guard<std::mutex> guard(pending_latch_);
+        auto iter = pending_.find(txn_id);
+        if (iter == pending_.end()) {
+            return;
+        }
+        rids = std::move(iter->second);
+        pending_.erase(iter);
+    }
+
+    for (auto &rid : rids) {
+        VersionShard &shard = ShardFor(rid);
+        std::lock_guard<std::mutex> guard(shard.mutex_);
+        auto iter = shard.chains_.find(rid);
+        if (iter == shard.chains_.end()) {
+            continue;
+        }
+        auto &chain = iter->second;
+        for (auto version = chain.begin(); version != chain.end();) {
+            if (version->txn_id_ == txn_id) {
+                version = chain.erase(version);
+            } else {
+                ++version;
+            }
+        }
+        if (chain.empty()) {
+            shard.chains_.erase(iter);
+        }
+    }
+}
+
+bool VersionManager::GetVisibleTuple(const RID &rid, int64_t snapshot_ts,
+                                     Tuple &tuple, bool &absent) {
+    VersionShard &shard = ShardFor(rid);
+    std::lock_guard<std::mutex> guard(shard.mutex_);
+    auto iter = shard.chains_.find(rid);
+    if (iter == shard.chains_.end()) {
+        return false;
+    }
+    // the visible value is the oldest version superseded after the
+    // snapshot; pending versions count as after every snapshot
+    for (auto &version : iter->second) {
+        if (version.txn_id_ != INVALID_TXN_ID
+            || version.commit_ts_ > snapshot_ts) {
+            absent = version.absent_;
+            if (!version.absent_) {
+                tuple = version.tuple_;
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void VersionManager::PruneBelow(int64_t min_snapshot) {
+    for (auto &shard : shards_) {
+        std::lock_guard<std::mutex> guard(shard.mutex_);
+        for (auto chain = shard.chains_.begin(); chain != shard.chains_.end();) {
+            auto &versions = chain->second;
+            for (auto version = versions.begin(); version != versions.end();) {
+                if (version->txn_id_ == INVALID_TXN_ID
+                    && version->commit_ts_ <= min_snapshot) {
+                    version = versions.erase(version);
+                } else {
+                    ++version;
+                }
+            }
+            if (versions.empty()) {
+                chain = shard.chains_.erase(chain);
+            } else {
+                ++chain;
+            }
+        }
+    }
+}
+
+} // namespace cmudb
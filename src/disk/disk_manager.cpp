@@ -1,45 +1,126 @@
 /**
  * disk_manager.cpp
  */
+#include <algorithm>
 #include <assert.h>
+#include <cstdlib>
 #include <cstring>
+#include <fcntl.h>
 #include <iostream>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <thread>
+#include <unistd.h>
 
+#include "common/crc32c.h"
+#include "common/exception.h"
 #include "common/logger.h"
 #include "disk/disk_manager.h"
 
 namespace cmudb {
 
-static char *buffer_used = nullptr;
+// O_DIRECT transfers must be aligned to the logical block size; 4KB covers
+// every common device
+static const size_t DIRECT_IO_ALIGNMENT = 4096;
 
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-        : file_name_(db_file), next_page_id_(0), num_flushes_(0), flush_log_(false),
-          flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, bool direct_io,
+                         bool verify_checksums, bool double_write,
+                         const std::vector<std::string> &stripe_paths)
+        : file_name_(db_file), next_page_id_(0), db_fd_(-1),
+          aligned_buffer_(nullptr), double_write_(double_write),
+          verify_checksums_(verify_checksums), num_flushes_(0),
+          flush_log_(false), flush_log_f_(nullptr) {
     std::string::size_type n = file_name_.find(".");
     if (n == std::string::npos) {
         LOG_DEBUG("wrong file format");
         return;
     }
     log_name_ = file_name_.substr(0, n) + ".log";
+    fpm_name_ = file_name_.substr(0, n) + ".fpm";
+    ckp_name_ = file_name_.substr(0, n) + ".ckp";
+    cln_name_ = file_name_.substr(0, n) + ".cln";
 
-    log_io_.open(log_name_,
+    // consume the previous run's clean-shutdown marker right away: from
+    // here on only another MarkCleanShutdown can claim the next stop was
+    // clean, so a crash after this point is never mistaken for one
+    clean_shutdown_ = GetFileSize(cln_name_) >= 0;
+    if (clean_shutdown_) {
+        remove(cln_name_.c_str());
+    }
+
+    // discover existing log segments. Recycling only ever deletes a prefix,
+    // so live segments are the contiguous range starting at the checkpoint's
+    // segment; every segment but the last is exactly LOG_SEGMENT_SIZE, which
+    // keeps logical offsets stable across restarts
+    int first_seg = GetCheckpointOffset() / LOG_SEGMENT_SIZE;
+    if (GetFileSize(LogSegmentName(first_seg)) <= 0) {
+        // fresh log: drop leftovers of an older database, including any
+        // checkpoint taken against it
+        std::ofstream ckp_trunc(ckp_name_, std::ios::binary | std::ios::trunc);
+        for (int seg = 1; GetFileSize(LogSegmentName(seg)) >= 0; ++seg) {
+            remove(LogSegmentName(seg).c_str());
+        }
+    } else {
+        log_segment_ = first_seg;
+        while (GetFileSize(LogSegmentName(log_segment_ + 1)) >= 0) {
+            ++log_segment_;
+        }
+        log_size_ = static_cast<size_t>(log_segment_) * LOG_SEGMENT_SIZE +
+                    GetFileSize(LogSegmentName(log_segment_));
+    }
+
+    // resume the page id space of an existing database file and reload the
+    // ids freed in earlier runs
+    int db_size = GetFileSize(file_name_);
+    if (db_size > 0) {
+        // a file written by a build with a different PAGE_SIZE is not a
+        // whole number of pages; refuse it instead of serving torn pages
+        if (db_size % PAGE_SIZE != 0) {
+            throw Exception("database file size is not a multiple of the "
+                            "configured page size");
+        }
+        next_page_id_ = (db_size + PAGE_SIZE - 1) / PAGE_SIZE;
+    }
+    std::ifstream fpm_in(fpm_name_, std::ios::binary);
+    if (fpm_in.is_open()) {
+        page_id_t freed;
+        while (fpm_in.read(reinterpret_cast<char *>(&freed), sizeof(freed))) {
+            if (freed < next_page_id_) {
+                free_pages_.insert(freed);
+            }
+        }
+    }
+
+    if (verify_checksums_) {
+        cks_name_ = file_name_.substr(0, n) + ".cks";
+        cks_io_.open(cks_name_, std::ios::binary | std::ios::in | std::ios::out);
+        if (!cks_io_.is_open()) {
+            cks_io_.clear();
+            cks_io_.open(cks_name_,
+                         std::ios::binary | std::ios::trunc | std::ios::out);
+            cks_io_.close();
+            cks_io_.open(cks_name_,
+                         std::ios::binary | std::ios::in | std::ios::out);
+        }
+    }
+
+    std::string active_segment = LogSegmentName(log_segment_);
+    log_io_.open(active_segment,
                  std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
     // directory or file does not exist
     if (!log_io_.is_open()) {
         log_io_.clear();
         // create a new file
-        log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::app |
-                                std::ios::out);
+        log_io_.open(active_segment, std::ios::binary | std::ios::trunc |
+                                     std::ios::app | std::ios::out);
         log_io_.close();
         // reopen with original mode
-        log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app |
-                                std::ios::out);
+        log_io_.open(active_segment, std::ios::binary | std::ios::in |
+                                     std::ios::app | std::ios::out);
     }
 
     db_io_.open(db_file,
@@ -53,11 +134,407 @@ DiskManager::DiskManager(const std::string &db_file)
         // reopen with original mode
         db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
     }
+
+    // tablespace striping: open one stream per stripe file and resume the
+    // page id space from the rows they already hold; a single path keeps
+    // the one-file layout untouched. Opened before the double-write replay
+    // below, which writes recovered pages in place through the stripes
+    if (stripe_paths.size() >= 2) {
+        page_id_t num_stripes = static_cast<page_id_t>(stripe_paths.size());
+        for (page_id_t s = 0; s < num_stripes; ++s) {
+            const std::string &path = stripe_paths[s];
+            int size = GetFileSize(path);
+            if (size > 0) {
+                if (size % PAGE_SIZE != 0) {
+                    throw Exception("stripe file size is not a multiple of "
+                                    "the configured page size");
+                }
+                // highest page id this many rows can hold in stripe s
+                page_id_t rows = size / PAGE_SIZE;
+                page_id_t beyond = (rows - 1) * num_stripes + s + 1;
+                if (beyond > next_page_id_) {
+                    next_page_id_ = beyond;
+                }
+            }
+            auto io = std::unique_ptr<std::fstream>(new std::fstream());
+            io->open(path, std::ios::binary | std::ios::in | std::ios::out);
+            if (!io->is_open()) {
+                io->clear();
+                io->open(path,
+                         std::ios::binary | std::ios::trunc | std::ios::out);
+                io->close();
+                io->open(path, std::ios::binary | std::ios::in | std::ios::out);
+            }
+            stripe_names_.push_back(path);
+            stripe_io_.push_back(std::move(io));
+            stripe_latches_.push_back(
+                    std::unique_ptr<std::mutex>(new std::mutex()));
+        }
+        if (direct_io) {
+            LOG_DEBUG("direct I/O is single-file only, ignored with striping");
+            direct_io = false;
+        }
+    }
+
+    if (double_write_) {
+        dwb_name_ = file_name_.substr(0, n) + ".dwb";
+        dwb_io_.open(dwb_name_, std::ios::binary | std::ios::in | std::ios::out);
+        if (!dwb_io_.is_open()) {
+            dwb_io_.clear();
+            dwb_io_.open(dwb_name_,
+                         std::ios::binary | std::ios::trunc | std::ios::out);
+            dwb_io_.close();
+            dwb_io_.open(dwb_name_,
+                         std::ios::binary | std::ios::in | std::ios::out);
+        } else {
+            // scratch file survived the last run: replay any intact staged
+            // pages over the database file before anyone reads it
+            RecoverFromDoubleWriteBuffer();
+        }
+    }
+
+    if (direct_io) {
+#ifdef O_DIRECT
+        db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+#endif
+        if (db_fd_ < 0) {
+            LOG_DEBUG("direct I/O not supported, falling back to buffered");
+        } else {
+            // bounce buffer of at least one alignment unit
+            size_t buffer_size =
+                    PAGE_SIZE > DIRECT_IO_ALIGNMENT ? PAGE_SIZE : DIRECT_IO_ALIGNMENT;
+            if (posix_memalign(reinterpret_cast<void **>(&aligned_buffer_),
+                               DIRECT_IO_ALIGNMENT, buffer_size) != 0) {
+                aligned_buffer_ = nullptr;
+                FallbackToBufferedIO();
+            }
+        }
+    }
+}
+
+/**
+ * Rewrite the free-page sidecar file from the in-memory set.
+ * Caller must hold alloc_latch_.
+ */
+void DiskManager::PersistFreePages() {
+    std::ofstream out(fpm_name_, std::ios::binary | std::ios::trunc);
+    for (page_id_t page_id : free_pages_) {
+        out.write(reinterpret_cast<const char *>(&page_id), sizeof(page_id));
+    }
+}
+
+/**
+ * Persist the byte offset of the last completed checkpoint record so the
+ * next recovery starts its log scan there
+ */
+void DiskManager::SetCheckpointOffset(int offset) {
+    {
+        std::lock_guard<std::mutex> guard(ckp_latch_);
+        std::ofstream out(ckp_name_, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(&offset), sizeof(offset));
+    }
+    // segments entirely below the checkpoint will never be read again
+    RecycleLogSegments(offset);
+}
+
+/**
+ * Leave the clean-shutdown marker. An empty sidecar file is enough: its
+ * existence is the statement that every logged effect reached the pages
+ * and no transaction was in flight when the process stopped
+ */
+void DiskManager::MarkCleanShutdown() {
+    std::ofstream out(cln_name_, std::ios::binary | std::ios::trunc);
+}
+
+/**
+ * Read back the persisted checkpoint offset, 0 when none exists
+ */
+int DiskManager::GetCheckpointOffset() {
+    std::lock_guard<std::mutex> guard(ckp_latch_);
+    std::ifstream in(ckp_name_, std::ios::binary);
+    int offset = 0;
+    if (in.is_open()) {
+        in.read(reinterpret_cast<char *>(&offset), sizeof(offset));
+        if (!in || offset < 0) {
+            offset = 0;
+        }
+    }
+    return offset;
 }
 
 DiskManager::~DiskManager() {
+    {
+        std::unique_lock<std::mutex> lock(io_queue_latch_);
+        if (io_thread_ != nullptr) {
+            io_thread_running_ = false;
+            io_queue_cv_.notify_one();
+            lock.unlock();
+            io_thread_->join();
+            delete io_thread_;
+            io_thread_ = nullptr;
+        }
+    }
+    ReleaseMMap();
+    if (db_fd_ >= 0) {
+        close(db_fd_);
+    }
+    free(aligned_buffer_);
     db_io_.close();
     log_io_.close();
+    if (cks_io_.is_open()) {
+        cks_io_.close();
+    }
+    if (dwb_io_.is_open()) {
+        dwb_io_.close();
+    }
+    for (auto &stripe : stripe_io_) {
+        if (stripe->is_open()) {
+            stripe->close();
+        }
+    }
+}
+
+/**
+ * Stage a batch of pages in the double-write scratch file: an entry count
+ * followed by (page id, CRC32C, page data) entries, flushed before the
+ * caller writes the pages in place. Caller must hold dwb_latch_.
+ */
+void DiskManager::StageDoubleWrite(
+        const std::vector<std::pair<page_id_t, const char *>> &pages) {
+    int32_t count = static_cast<int32_t>(pages.size());
+    dwb_io_.seekp(0);
+    dwb_io_.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    for (auto &entry : pages) {
+        uint32_t crc = Crc32c(entry.second, PAGE_SIZE);
+        dwb_io_.write(reinterpret_cast<const char *>(&entry.first),
+                      sizeof(entry.first));
+        dwb_io_.write(reinterpret_cast<const char *>(&crc), sizeof(crc));
+        dwb_io_.write(entry.second, PAGE_SIZE);
+    }
+    if (dwb_io_.bad()) {
+        LOG_DEBUG("I/O error while staging double-write batch");
+        return;
+    }
+    dwb_io_.flush();
+}
+
+/**
+ * Replay staged pages left behind by a crash. Entries whose CRC32C does not
+ * match are staged copies that were themselves torn; the corresponding
+ * in-place write never started, so they are safely skipped. Re-applying an
+ * entry whose in-place write did complete is a harmless rewrite of
+ * identical bytes.
+ */
+void DiskManager::RecoverFromDoubleWriteBuffer() {
+    int32_t count = 0;
+    dwb_io_.seekg(0);
+    if (!dwb_io_.read(reinterpret_cast<char *>(&count), sizeof(count)) ||
+        count <= 0) {
+        dwb_io_.clear();
+        return;
+    }
+
+    char page_data[PAGE_SIZE];
+    for (int32_t i = 0; i < count; ++i) {
+        page_id_t page_id;
+        uint32_t crc;
+        if (!dwb_io_.read(reinterpret_cast<char *>(&page_id), sizeof(page_id)) ||
+            !dwb_io_.read(reinterpret_cast<char *>(&crc), sizeof(crc)) ||
+            !dwb_io_.read(page_data, PAGE_SIZE)) {
+            break;
+        }
+        if (crc != Crc32c(page_data, PAGE_SIZE)) {
+            LOG_DEBUG("skipping torn double-write entry for page %d", page_id);
+            continue;
+        }
+        if (!stripe_io_.empty()) {
+            WritePageStriped(page_id, page_data);
+        } else {
+            db_io_.seekp(static_cast<size_t>(page_id) * PAGE_SIZE);
+            db_io_.write(page_data, PAGE_SIZE);
+        }
+    }
+    db_io_.flush();
+    dwb_io_.clear();
+
+    // truncate the scratch file so the entries are not replayed again
+    std::ofstream trunc(dwb_name_, std::ios::binary | std::ios::trunc);
+}
+
+/**
+ * Record the CRC32C of a page in the sidecar file (one checksum per page,
+ * indexed by page id)
+ */
+void DiskManager::StoreChecksum(page_id_t page_id, const char *page_data) {
+    if (!verify_checksums_) {
+        return;
+    }
+    uint32_t crc = Crc32c(page_data, PAGE_SIZE);
+
+    std::lock_guard<std::mutex> guard(cks_latch_);
+    cks_io_.seekp(page_id * sizeof(uint32_t));
+    cks_io_.write(reinterpret_cast<const char *>(&crc), sizeof(crc));
+    if (cks_io_.bad()) {
+        LOG_DEBUG("I/O error while writing checksum");
+        return;
+    }
+    cks_io_.flush();
+}
+
+/**
+ * Verify a page read against its stored CRC32C; a page that was never
+ * checksummed (sidecar shorter than page id) is skipped. Mismatches are
+ * logged and counted but the read result is left to the caller, who may
+ * still want the bytes for repair
+ */
+void DiskManager::VerifyChecksum(page_id_t page_id, const char *page_data) {
+    if (!verify_checksums_) {
+        return;
+    }
+
+    uint32_t stored;
+    {
+        std::lock_guard<std::mutex> guard(cks_latch_);
+        if ((page_id + 1) * sizeof(uint32_t) >
+            static_cast<size_t>(GetFileSize(cks_name_))) {
+            return;
+        }
+        cks_io_.seekg(page_id * sizeof(uint32_t));
+        cks_io_.read(reinterpret_cast<char *>(&stored), sizeof(stored));
+        if (cks_io_.gcount() < static_cast<int>(sizeof(stored))) {
+            cks_io_.clear();
+            return;
+        }
+    }
+
+    if (Crc32c(page_data, PAGE_SIZE) != stored) {
+        num_checksum_failures_++;
+        LOG_DEBUG("checksum mismatch on page %d", page_id);
+    }
+}
+
+/**
+ * Map the database file read-only for zero-copy page access. The mapping
+ * covers the file size at call time; pages written after that are served
+ * through the regular read path until the next call remaps
+ */
+bool DiskManager::EnableReadOnlyMMap() {
+    std::lock_guard<std::mutex> guard(mmap_latch_);
+
+    // a striped page space has no single file to map
+    if (!stripe_names_.empty()) {
+        return false;
+    }
+
+    int size = GetFileSize(file_name_);
+    if (size <= 0) {
+        return false;
+    }
+
+    int fd = open(file_name_.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    void *base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        LOG_DEBUG("mmap failed, staying on the read path");
+        return false;
+    }
+
+    if (mmap_base_ != nullptr) {
+        munmap(mmap_base_, mmap_size_);
+    }
+    mmap_base_ = static_cast<char *>(base);
+    mmap_size_ = size;
+    return true;
+}
+
+/**
+ * Pointer straight into the read-only mapping; the caller must not write
+ * through it and must not cache it across EnableReadOnlyMMap calls
+ */
+const char *DiskManager::GetMMapData(page_id_t page_id) {
+    std::lock_guard<std::mutex> guard(mmap_latch_);
+
+    size_t offset = page_id * PAGE_SIZE;
+    if (mmap_base_ == nullptr || offset + PAGE_SIZE > mmap_size_) {
+        return nullptr;
+    }
+    return mmap_base_ + offset;
+}
+
+/**
+ * Drop the current read-only mapping, if any
+ */
+void DiskManager::ReleaseMMap() {
+    std::lock_guard<std::mutex> guard(mmap_latch_);
+
+    if (mmap_base_ != nullptr) {
+        munmap(mmap_base_, mmap_size_);
+        mmap_base_ = nullptr;
+        mmap_size_ = 0;
+    }
+}
+
+/**
+ * Give up on direct I/O (e.g. the filesystem rejected an aligned transfer)
+ * and resume all page I/O through the buffered stream
+ */
+void DiskManager::FallbackToBufferedIO() {
+    if (db_fd_ >= 0) {
+        close(db_fd_);
+        db_fd_ = -1;
+    }
+    free(aligned_buffer_);
+    aligned_buffer_ = nullptr;
+}
+
+/**
+ * Write one page to its stripe file: page id modulo the stripe count picks
+ * the file, the quotient is the row within it. Only this stripe's latch is
+ * held, so writes to other stripes (devices) proceed concurrently
+ */
+void DiskManager::WritePageStriped(page_id_t page_id, const char *page_data) {
+    size_t stripe = page_id % stripe_io_.size();
+    size_t offset =
+            static_cast<size_t>(page_id / stripe_io_.size()) * PAGE_SIZE;
+
+    std::lock_guard<std::mutex> guard(*stripe_latches_[stripe]);
+    std::fstream &io = *stripe_io_[stripe];
+    io.seekp(offset);
+    io.write(page_data, PAGE_SIZE);
+    if (io.bad()) {
+        LOG_DEBUG("I/O error while writing stripe %d", (int)stripe);
+        return;
+    }
+    io.flush();
+}
+
+/**
+ * Read one page from its stripe file, zero-filling past the end like the
+ * single-file path
+ */
+void DiskManager::ReadPageStriped(page_id_t page_id, char *page_data) {
+    size_t stripe = page_id % stripe_io_.size();
+    size_t offset =
+            static_cast<size_t>(page_id / stripe_io_.size()) * PAGE_SIZE;
+
+    std::lock_guard<std::mutex> guard(*stripe_latches_[stripe]);
+    std::fstream &io = *stripe_io_[stripe];
+    if (offset > static_cast<size_t>(
+                         std::max(GetFileSize(stripe_names_[stripe]), 0))) {
+        LOG_DEBUG("I/O error while reading stripe %d", (int)stripe);
+        memset(page_data, 0, PAGE_SIZE);
+        return;
+    }
+    io.seekg(offset);
+    io.read(page_data, PAGE_SIZE);
+    int read_count = static_cast<int>(io.gcount());
+    if (read_count < PAGE_SIZE) {
+        io.clear();
+        memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    }
 }
 
 /**
@@ -65,6 +542,37 @@ DiskManager::~DiskManager() {
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
     size_t offset = page_id * PAGE_SIZE;
+
+    StoreChecksum(page_id, page_data);
+
+    // stage the page first and keep the latch until the in-place write is
+    // done, so the scratch copy stays valid while the page may be torn
+    std::unique_lock<std::mutex> dwb_lock;
+    if (double_write_) {
+        dwb_lock = std::unique_lock<std::mutex>(dwb_latch_);
+        StageDoubleWrite({{page_id, page_data}});
+    }
+
+    if (!stripe_io_.empty()) {
+        WritePageStriped(page_id, page_data);
+        return;
+    }
+
+    if (db_fd_ >= 0) {
+        std::lock_guard<std::mutex> guard(direct_io_latch_);
+        if (db_fd_ >= 0) {
+            memcpy(aligned_buffer_, page_data, PAGE_SIZE);
+            ssize_t written = pwrite(db_fd_, aligned_buffer_, PAGE_SIZE, offset);
+            if (written == PAGE_SIZE) {
+                return;
+            }
+            // EINVAL etc.: this filesystem rejects our alignment, fall back
+            LOG_DEBUG("direct write failed, falling back to buffered");
+            FallbackToBufferedIO();
+        }
+    }
+
+    std::lock_guard<std::mutex> guard(db_io_latch_);
     // set write cursor to offset
     db_io_.seekp(offset);
     db_io_.write(page_data, PAGE_SIZE);
@@ -77,16 +585,171 @@ void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
     db_io_.flush();
 }
 
+/**
+ * Write a batch of pages to the disk file. The batch is sorted by page id
+ * and split into runs of adjacent pages; each run is transferred with a
+ * single seek and a single flush (one large aligned write in direct mode),
+ * which is dramatically cheaper than per-page 4KB writes on flash
+ */
+void DiskManager::WritePages(
+        std::vector<std::pair<page_id_t, const char *>> pages) {
+    if (pages.empty()) {
+        return;
+    }
+
+    std::sort(pages.begin(), pages.end());
+
+    for (auto &entry : pages) {
+        StoreChecksum(entry.first, entry.second);
+    }
+
+    // the whole batch is staged once, then written in place run by run
+    std::unique_lock<std::mutex> dwb_lock;
+    if (double_write_) {
+        dwb_lock = std::unique_lock<std::mutex>(dwb_latch_);
+        StageDoubleWrite(pages);
+    }
+
+    if (!stripe_io_.empty()) {
+        // group by stripe; within one, ids a stripe-count apart sit on
+        // adjacent rows and share one seek and one flush, and the stripes
+        // themselves are written back to back under independent latches
+        size_t num_stripes = stripe_io_.size();
+        std::vector<std::vector<std::pair<page_id_t, const char *>>>
+                per_stripe(num_stripes);
+        for (auto &entry : pages) {
+            per_stripe[entry.first % num_stripes].push_back(entry);
+        }
+        for (size_t s = 0; s < num_stripes; ++s) {
+            auto &stripe_pages = per_stripe[s];
+            if (stripe_pages.empty()) {
+                continue;
+            }
+            std::lock_guard<std::mutex> guard(*stripe_latches_[s]);
+            std::fstream &io = *stripe_io_[s];
+            size_t begin = 0;
+            while (begin < stripe_pages.size()) {
+                size_t end = begin + 1;
+                while (end < stripe_pages.size() &&
+                       stripe_pages[end].first ==
+                               stripe_pages[end - 1].first +
+                                       (page_id_t)num_stripes) {
+                    ++end;
+                }
+                io.seekp(static_cast<size_t>(stripe_pages[begin].first /
+                                             num_stripes) *
+                         PAGE_SIZE);
+                for (size_t i = begin; i < end; ++i) {
+                    io.write(stripe_pages[i].second, PAGE_SIZE);
+                }
+                begin = end;
+            }
+            if (io.bad()) {
+                LOG_DEBUG("I/O error while writing stripe %d batch", (int)s);
+            } else {
+                io.flush();
+            }
+        }
+        return;
+    }
+
+    size_t begin = 0;
+    while (begin < pages.size()) {
+        // extend the run while page ids stay adjacent
+        size_t end = begin + 1;
+        while (end < pages.size() &&
+               pages[end].first == pages[end - 1].first + 1) {
+            ++end;
+        }
+        size_t run_pages = end - begin;
+        size_t offset = pages[begin].first * PAGE_SIZE;
+
+        if (db_fd_ >= 0) {
+            // direct mode: gather the run into one aligned buffer and issue
+            // a single large write
+            char *run_buffer = nullptr;
+            if (posix_memalign(reinterpret_cast<void **>(&run_buffer),
+                               DIRECT_IO_ALIGNMENT, run_pages * PAGE_SIZE) == 0) {
+                for (size_t i = 0; i < run_pages; ++i) {
+                    memcpy(run_buffer + i * PAGE_SIZE, pages[begin + i].second,
+                           PAGE_SIZE);
+                }
+                std::lock_guard<std::mutex> guard(direct_io_latch_);
+                ssize_t written = pwrite(db_fd_, run_buffer,
+                                         run_pages * PAGE_SIZE, offset);
+                free(run_buffer);
+                if (written ==
+                    static_cast<ssize_t>(run_pages * PAGE_SIZE)) {
+                    begin = end;
+                    continue;
+                }
+                LOG_DEBUG("direct batch write failed, falling back");
+                FallbackToBufferedIO();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(db_io_latch_);
+            db_io_.seekp(offset);
+            for (size_t i = 0; i < run_pages; ++i) {
+                db_io_.write(pages[begin + i].second, PAGE_SIZE);
+            }
+            if (db_io_.bad()) {
+                LOG_DEBUG("I/O error while writing batch");
+            } else {
+                db_io_.flush();
+            }
+        }
+        begin = end;
+    }
+}
+
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
     int offset = page_id * PAGE_SIZE;
-    // check if read beyond file length
-    if (offset > GetFileSize(file_name_)) {
-        LOG_DEBUG("I/O error while reading");
-        // std::cerr << "I/O error while reading" << std::endl;
-    } else {
+
+    // serve reads from the read-only mapping when one is active
+    const char *mapped = GetMMapData(page_id);
+    if (mapped != nullptr) {
+        memcpy(page_data, mapped, PAGE_SIZE);
+        VerifyChecksum(page_id, page_data);
+        return;
+    }
+
+    if (!stripe_io_.empty()) {
+        ReadPageStriped(page_id, page_data);
+        VerifyChecksum(page_id, page_data);
+        return;
+    }
+
+    if (db_fd_ >= 0) {
+        std::lock_guard<std::mutex> guard(direct_io_latch_);
+        if (db_fd_ >= 0) {
+            ssize_t nread = pread(db_fd_, aligned_buffer_, PAGE_SIZE, offset);
+            if (nread >= 0) {
+                // if file ends before reading PAGE_SIZE
+                if (nread < PAGE_SIZE) {
+                    memset(aligned_buffer_ + nread, 0, PAGE_SIZE - nread);
+                }
+                memcpy(page_data, aligned_buffer_, PAGE_SIZE);
+                VerifyChecksum(page_id, page_data);
+                return;
+            }
+            LOG_DEBUG("direct read failed, falling back to buffered");
+            FallbackToBufferedIO();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(db_io_latch_);
+        // check if read beyond file length
+        if (offset > GetFileSize(file_name_)) {
+            LOG_DEBUG("I/O error while reading");
+            // std::cerr << "I/O error while reading" << std::endl;
+            return;
+        }
         // set read cursor to offset
         db_io_.seekp(offset);
         db_io_.read(page_data, PAGE_SIZE);
@@ -98,6 +761,81 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
             memset(page_data + read_count, 0, PAGE_SIZE - read_count);
         }
     }
+    VerifyChecksum(page_id, page_data);
+}
+
+/**
+ * Queue an asynchronous page read; the future becomes ready once page_data
+ * has been filled
+ */
+std::future<void> DiskManager::ReadPageAsync(page_id_t page_id,
+                                             char *page_data) {
+    IORequest request;
+    request.is_write = false;
+    request.page_id = page_id;
+    request.read_data = page_data;
+    request.write_data = nullptr;
+    return SubmitIORequest(std::move(request));
+}
+
+/**
+ * Queue an asynchronous page write; the future becomes ready once the page
+ * has been handed to the filesystem (and flushed, same as WritePage)
+ */
+std::future<void> DiskManager::WritePageAsync(page_id_t page_id,
+                                              const char *page_data) {
+    IORequest request;
+    request.is_write = true;
+    request.page_id = page_id;
+    request.read_data = nullptr;
+    request.write_data = page_data;
+    return SubmitIORequest(std::move(request));
+}
+
+/**
+ * Append a request to the submission queue, lazily starting the I/O thread
+ * on first use
+ */
+std::future<void> DiskManager::SubmitIORequest(IORequest &&request) {
+    std::future<void> future = request.done.get_future();
+
+    std::lock_guard<std::mutex> guard(io_queue_latch_);
+    io_queue_.push_back(std::move(request));
+    if (io_thread_ == nullptr) {
+        io_thread_running_ = true;
+        io_thread_ = new std::thread(&DiskManager::ServeIORequests, this);
+    }
+    io_queue_cv_.notify_one();
+
+    return future;
+}
+
+/**
+ * I/O thread loop: drain the submission queue and execute the transfers
+ * through the synchronous paths (which pick direct or buffered I/O). All
+ * requests still pending at shutdown are completed before the thread exits.
+ */
+void DiskManager::ServeIORequests() {
+    std::unique_lock<std::mutex> lock(io_queue_latch_);
+    while (io_thread_running_ || !io_queue_.empty()) {
+        if (io_queue_.empty()) {
+            io_queue_cv_.wait(lock);
+            continue;
+        }
+
+        IORequest request = std::move(io_queue_.front());
+        io_queue_.pop_front();
+        lock.unlock();
+
+        if (request.is_write) {
+            WritePage(request.page_id, request.write_data);
+        } else {
+            ReadPage(request.page_id, request.read_data);
+        }
+        request.done.set_value();
+
+        lock.lock();
+    }
 }
 
 /**
@@ -105,9 +843,10 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
  * Only return when sync is done, and only perform sequence write
  */
 void DiskManager::WriteLog(char *log_data, int size) {
-    // enforce swap log buffer
-    assert(log_data != buffer_used);
-    buffer_used = log_data;
+    // enforce swap log buffer; per-instance so a freshly constructed manager
+    // is not confused by a heap address recycled from an earlier one
+    assert(log_data != buffer_used_);
+    buffer_used_ = log_data;
 
     if (size == 0) // no effect on num_flushes_ if log buffer is empty
         return;
@@ -120,36 +859,107 @@ void DiskManager::WriteLog(char *log_data, int size) {
                std::future_status::ready);
 
     num_flushes_ += 1;
-    // sequence write
-    log_io_.write(log_data, size);
-
-    // check for I/O error
-    if (log_io_.bad()) {
-        LOG_DEBUG("I/O error while writing log");
-        return;
+    // sequence write, spilling into the next segment when this one fills
+    while (size > 0) {
+        int space = LOG_SEGMENT_SIZE -
+                    static_cast<int>(log_size_ % LOG_SEGMENT_SIZE);
+        int chunk = size < space ? size : space;
+        log_io_.write(log_data, chunk);
+        // check for I/O error
+        if (log_io_.bad()) {
+            LOG_DEBUG("I/O error while writing log");
+            return;
+        }
+        log_size_ += chunk;
+        log_data += chunk;
+        size -= chunk;
+        if (log_size_ % LOG_SEGMENT_SIZE == 0) {
+            RotateLogSegment();
+        }
     }
     // needs to flush to keep disk file in sync
     log_io_.flush();
     flush_log_ = false;
 }
 
+/**
+ * Close the segment that just filled, hand it to the archive hook and open
+ * the next one
+ */
+void DiskManager::RotateLogSegment() {
+    log_io_.flush();
+    log_io_.close();
+    if (log_archive_hook_) {
+        log_archive_hook_(LogSegmentName(log_segment_));
+    }
+    ++log_segment_;
+    std::string next_segment = LogSegmentName(log_segment_);
+    log_io_.open(next_segment, std::ios::binary | std::ios::trunc |
+                               std::ios::app | std::ios::out);
+    log_io_.close();
+    log_io_.open(next_segment, std::ios::binary | std::ios::in |
+                               std::ios::app | std::ios::out);
+}
+
+/**
+ * Delete log segments lying entirely below the given logical offset; their
+ * records precede the last checkpoint and will never be read again
+ */
+void DiskManager::RecycleLogSegments(int below_offset) {
+    for (int seg = 0; seg < log_segment_; ++seg) {
+        if (static_cast<size_t>(seg + 1) * LOG_SEGMENT_SIZE <=
+            static_cast<size_t>(below_offset)) {
+            remove(LogSegmentName(seg).c_str());
+        }
+    }
+}
+
+/**
+ * File name of a log segment; segment 0 keeps the bare .log name
+ */
+std::string DiskManager::LogSegmentName(int index) {
+    if (index == 0) {
+        return log_name_;
+    }
+    return log_name_ + "." + std::to_string(index);
+}
+
 /**
  * Read the contents of the log into the given memory area
  * Always read from the beginning and perform sequence read
  * @return: false means already reach the end
  */
 bool DiskManager::ReadLog(char *log_data, int size, int offset) {
-    if (offset >= GetFileSize(log_name_)) {
+    if (offset >= static_cast<int>(log_size_)) {
         // LOG_DEBUG("end of log file");
-        // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
         return false;
     }
-    log_io_.seekp(offset);
-    log_io_.read(log_data, size);
-    // if log file ends before reading "size"
-    int read_count = log_io_.gcount();
+    // gather across segment boundaries; a recycled segment ends the read
+    int read_count = 0;
+    while (read_count < size && offset + read_count < static_cast<int>(log_size_)) {
+        int seg = (offset + read_count) / LOG_SEGMENT_SIZE;
+        int seg_off = (offset + read_count) % LOG_SEGMENT_SIZE;
+        std::ifstream segment_in(LogSegmentName(seg), std::ios::binary);
+        if (!segment_in.is_open()) {
+            break;
+        }
+        int want = size - read_count;
+        if (want > LOG_SEGMENT_SIZE - seg_off) {
+            want = LOG_SEGMENT_SIZE - seg_off;
+        }
+        segment_in.seekg(seg_off);
+        segment_in.read(log_data + read_count, want);
+        int got = static_cast<int>(segment_in.gcount());
+        if (got <= 0) {
+            break;
+        }
+        read_count += got;
+    }
+    if (read_count == 0) {
+        return false;
+    }
+    // if the log ends before reading "size"
     if (read_count < size) {
-        log_io_.clear();
         memset(log_data + read_count, 0, size - read_count);
     }
 
@@ -158,16 +968,70 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
 
 /**
  * Allocate new page (operations like create index/table)
- * For now just keep an increasing counter
+ * Reuse the lowest deallocated page id first so the file stays dense and
+ * sequential scans do not skip over holes; only extend the id space when no
+ * freed page is available
  */
-page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
+page_id_t DiskManager::AllocatePage() {
+    std::lock_guard<std::mutex> guard(alloc_latch_);
+
+    if (!free_pages_.empty()) {
+        page_id_t page_id = *free_pages_.begin();
+        free_pages_.erase(free_pages_.begin());
+        PersistFreePages();
+        return page_id;
+    }
+
+    // entering a new extent: reserve its blocks in one go so bulk loads do
+    // not extend the file one page at a time (metadata churn, fragmentation).
+    // KEEP_SIZE leaves the logical file size at the write high-water mark,
+    // which next_page_id_ recovery and the read-beyond-EOF check depend on
+    if (next_page_id_ % DISK_EXTENT_PAGES == 0) {
+        if (!stripe_names_.empty()) {
+            // an extent spreads evenly across the stripes, each gets its share
+            off_t rows_per_stripe = DISK_EXTENT_PAGES / stripe_names_.size();
+            off_t row_start = static_cast<off_t>(
+                    next_page_id_ / stripe_names_.size());
+            for (auto &name : stripe_names_) {
+                int fd = open(name.c_str(), O_WRONLY);
+                if (fd >= 0) {
+                    if (fallocate(fd, FALLOC_FL_KEEP_SIZE,
+                                  row_start * PAGE_SIZE,
+                                  rows_per_stripe * PAGE_SIZE) != 0) {
+                        LOG_DEBUG("extent preallocation failed");
+                    }
+                    close(fd);
+                }
+            }
+        } else {
+            int fd = open(file_name_.c_str(), O_WRONLY);
+            if (fd >= 0) {
+                off_t extent_start =
+                        static_cast<off_t>(next_page_id_) * PAGE_SIZE;
+                off_t extent_len =
+                        static_cast<off_t>(DISK_EXTENT_PAGES) * PAGE_SIZE;
+                if (fallocate(fd, FALLOC_FL_KEEP_SIZE, extent_start,
+                              extent_len) != 0) {
+                    LOG_DEBUG("extent preallocation failed");
+                }
+                close(fd);
+            }
+        }
+    }
+
+    return next_page_id_++;
+}
 
 /**
  * Deallocate page (operations like drop index/table)
- * Need bitmap in header page for tracking pages
+ * The id goes into the free-page map and its sidecar file, so the space is
+ * reused by a later AllocatePage instead of leaking forever
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    return;
+void DiskManager::DeallocatePage(page_id_t page_id) {
+    std::lock_guard<std::mutex> guard(alloc_latch_);
+
+    free_pages_.insert(page_id);
+    PersistFreePages();
 }
 
 /**
@@ -1,3 +1,4 @@
+#include <cassert>
 #include <list>
 
 #include "hash/extendible_hash.h"
@@ -9,25 +10,27 @@ namespace cmudb {
  * constructor
  * array_size: fixed array size for each bucket
  */
-template <typename K, typename V>
-ExtendibleHash<K, V>::ExtendibleHash(size_t size) : global_depth(0), bucket_size(size) {
-    directory.push_back(std::make_shared<Bucket>(0));
+template <typename K, typename V, typename HashFn>
+ExtendibleHash<K, V, HashFn>::ExtendibleHash(size_t size)
+        : global_depth(0), bucket_size(size) {
+    segments.push_back(std::make_shared<Segment>());
+    segments[0]->entries[0] = std::make_shared<Bucket>(0, bucket_size);
 }
 
 /*
  * helper function to calculate the hashing address of input key
  */
-template <typename K, typename V>
-size_t ExtendibleHash<K, V>::HashKey(const K &key) {
-    return std::hash<K>()(key);
+template <typename K, typename V, typename HashFn>
+size_t ExtendibleHash<K, V, HashFn>::HashKey(const K &key) {
+    return HashFn()(key);
 }
 
 /*
  * helper function to return global depth of hash table
  * NOTE: you must implement this function in order to pass test
  */
-template <typename K, typename V>
-int ExtendibleHash<K, V>::GetGlobalDepth() const {
+template <typename K, typename V, typename HashFn>
+int ExtendibleHash<K, V, HashFn>::GetGlobalDepth() const {
     return global_depth;
 }
 
@@ -35,35 +38,39 @@ int ExtendibleHash<K, V>::GetGlobalDepth() const {
  * helper function to return local depth of one specific bucket
  * NOTE: you must implement this function in order to pass test
  */
-template <typename K, typename V>
-int ExtendibleHash<K, V>::GetLocalDepth(int bucket_id) const {
-    assert(bucket_id >= 0 && bucket_id < (int) directory.size());
-    return directory.at(bucket_id)->local_depth;
+template <typename K, typename V, typename HashFn>
+int ExtendibleHash<K, V, HashFn>::GetLocalDepth(int bucket_id) const {
+    assert(bucket_id >= 0 && static_cast<size_t>(bucket_id) < DirSize());
+    return segments.at(bucket_id / DIRECTORY_SEGMENT_SIZE)
+            ->entries.at(bucket_id % DIRECTORY_SEGMENT_SIZE)
+            ->local_depth;
 }
 
 /*
  * helper function to return current number of bucket in hash table
  */
-template <typename K, typename V>
-int ExtendibleHash<K, V>::GetNumBuckets() const {
-    return static_cast<int>(directory.size());
+template <typename K, typename V, typename HashFn>
+int ExtendibleHash<K, V, HashFn>::GetNumBuckets() const {
+    return static_cast<int>(DirSize());
 }
 
 /*
  * lookup function to find value associate with input key
  */
-template <typename K, typename V>
-bool ExtendibleHash<K, V>::Find(const K &key, V &value) {
-    std::lock_guard<std::mutex> guard(mutex);
-
-    // find the bucket by key
-    int bucket_id = GetBucketIndex(key);
-    auto bucket = directory.at(bucket_id);
+template <typename K, typename V, typename HashFn>
+bool ExtendibleHash<K, V, HashFn>::Find(const K &key, V &value) {
+    // hold the directory latch only long enough to pin down the bucket; the
+    // bucket latch is taken before it is released so a concurrent split
+    // cannot repoint the directory entry under us
+    std::unique_lock<std::mutex> dir_guard(mutex);
+    auto bucket = DirAt(GetBucketIndex(key));
+    std::lock_guard<std::mutex> bucket_guard(bucket->latch);
+    dir_guard.unlock();
 
     // iterate over the bucket slots to find a matching key
-    for (auto it : bucket->slots) {
-        if (it.first == key) {
-            value = it.second;
+    for (size_t i = 0; i < bucket->size; ++i) {
+        if (bucket->slots[i].first == key) {
+            value = bucket->slots[i].second;
             return true;
         }
     }
@@ -75,19 +82,20 @@ bool ExtendibleHash<K, V>::Find(const K &key, V &value) {
  * delete <key,value> entry in hash table
  * Shrink & Combination is not required for this project
  */
-template <typename K, typename V>
-bool ExtendibleHash<K, V>::Remove(const K &key) {
-    std::lock_guard<std::mutex> guard(mutex);
-
-    // find the bucket by key
-    int bucket_id = GetBucketIndex(key);
-    auto bucket = directory.at(bucket_id);
-    auto &slots = bucket->slots;
-
-    // remove the pair from the bucket if key exists
-    for (auto it = bucket->slots.begin(); it != bucket->slots.end(); ++it) {
-        if (it->first == key) {
-            slots.erase(it);
+template <typename K, typename V, typename HashFn>
+bool ExtendibleHash<K, V, HashFn>::Remove(const K &key) {
+    // same latching protocol as Find
+    std::unique_lock<std::mutex> dir_guard(mutex);
+    auto bucket = DirAt(GetBucketIndex(key));
+    std::lock_guard<std::mutex> bucket_guard(bucket->latch);
+    dir_guard.unlock();
+
+    // remove the pair from the bucket if key exists, filling the hole with
+    // the last entry (slot order carries no meaning)
+    for (size_t i = 0; i < bucket->size; ++i) {
+        if (bucket->slots[i].first == key) {
+            bucket->slots[i] = bucket->slots[bucket->size - 1];
+            --bucket->size;
             return true;
         }
     }
@@ -95,79 +103,119 @@ bool ExtendibleHash<K, V>::Remove(const K &key) {
     return false;
 }
 
+/*
+ * double the directory in place, without touching any bucket pointer the
+ * table already holds. While the directory still fits in one segment the
+ * new half aliases the old entry by entry (bounded by the segment size);
+ * past that, whole segment pointers are duplicated, so the pause is
+ * directory size over segment size instead of directory size. The aliased
+ * halves stay shared until a split clones the segment it repoints
+ */
+template <typename K, typename V, typename HashFn>
+void ExtendibleHash<K, V, HashFn>::ExpandDirectory() {
+    size_t old_size = DirSize();
+    global_depth++;
+    if (old_size < DIRECTORY_SEGMENT_SIZE) {
+        for (size_t i = 0; i < old_size; ++i) {
+            segments[0]->entries[old_size + i] = segments[0]->entries[i];
+        }
+    } else {
+        size_t old_segments = segments.size();
+        segments.reserve(old_segments * 2);
+        for (size_t i = 0; i < old_segments; ++i) {
+            segments.push_back(segments[i]);
+        }
+    }
+}
+
 /*
  * insert <key,value> entry in hash table
  * Split & Redistribute bucket when there is overflow and if necessary increase
  * global depth
  */
-template <typename K, typename V>
-void ExtendibleHash<K, V>::Insert(const K &key, const V &value) {
-    std::lock_guard<std::mutex> guard(mutex);
-
-    // find the bucket by key
-    int bucket_id = GetBucketIndex(key);
-    auto bucket = directory.at(bucket_id);
-
-    // replace the value if the key exists
-    for (auto & it : bucket->slots) {
-        if (it.first == key) {
-            it.second = value;
+template <typename K, typename V, typename HashFn>
+void ExtendibleHash<K, V, HashFn>::Insert(const K &key, const V &value) {
+    // NOTE: loop is needed in case the bucket is still full after split
+    while (true) {
+        // fast path: only the target bucket is latched while inserting
+        std::unique_lock<std::mutex> dir_guard(mutex);
+        auto bucket = DirAt(GetBucketIndex(key));
+        std::unique_lock<std::mutex> bucket_guard(bucket->latch);
+        dir_guard.unlock();
+
+        // replace the value if the key exists
+        for (size_t i = 0; i < bucket->size; ++i) {
+            if (bucket->slots[i].first == key) {
+                bucket->slots[i].second = value;
+                return;
+            }
+        }
+
+        if (bucket->size < bucket_size) {
+            bucket->slots[bucket->size++] = std::make_pair(key, value);
             return;
         }
-    }
 
-    // whether the bucket needs to split
-    // NOTE: while is needed in case the bucket is still full after split
-    while (bucket->slots.size() >= bucket_size) {
+        // the bucket is full and must split, which repoints directory
+        // entries; lock order is directory then bucket, so drop the bucket
+        // latch, retake the directory latch and re-find the bucket
+        bucket_guard.unlock();
+        dir_guard.lock();
+        bucket = DirAt(GetBucketIndex(key));
+        std::lock_guard<std::mutex> split_guard(bucket->latch);
+        if (bucket->size < bucket_size) {
+            // another thread split this bucket in the meantime, retry
+            continue;
+        }
+
         // whether the directory needs to expand
         assert(bucket->local_depth <= global_depth);
         if (bucket->local_depth == global_depth) {
-            // increase global depth and expand directory
-            global_depth++;
-            size_t size = directory.size();
-            for (size_t i = 0; i < size; ++i) {
-                directory.push_back(directory.at(i));
-            }
+            ExpandDirectory();
         }
-        // increase local depth and split the old bucket
+        // increase local depth and split the old bucket; the new buckets are
+        // private until the directory is repointed below, all while the
+        // directory latch is held
         int local_depth = bucket->local_depth + 1;
         int mask = 1 << (local_depth - 1);
-        auto bucket0 = std::make_shared<Bucket>(local_depth);
-        auto bucket1 = std::make_shared<Bucket>(local_depth);
-        for (auto it : bucket->slots) {
-            if (HashKey(it.first) & mask) {
-                bucket1->slots.push_back(it);
+        auto bucket0 = std::make_shared<Bucket>(local_depth, bucket_size);
+        auto bucket1 = std::make_shared<Bucket>(local_depth, bucket_size);
+        for (size_t i = 0; i < bucket->size; ++i) {
+            if (HashKey(bucket->slots[i].first) & mask) {
+                bucket1->slots[bucket1->size++] = bucket->slots[i];
             } else {
-                bucket0->slots.push_back(it);
+                bucket0->slots[bucket0->size++] = bucket->slots[i];
             }
         }
-        // update the directory pointing to new buckets
-        for (size_t i = HashKey(key) & (mask - 1); i < directory.size(); i += mask) {
-            directory[i] = (i & mask) ? bucket1 : bucket0;
+        // update the directory pointing to new buckets; only the touched
+        // segments are cloned out of their aliases
+        size_t dir_size = DirSize();
+        for (size_t i = HashKey(key) & (mask - 1); i < dir_size; i += mask) {
+            EnsurePrivateSegment(i);
+            DirAt(i) = (i & mask) ? bucket1 : bucket0;
         }
 
-        // update bucket reference to check if bucket is still full
-        bucket_id = GetBucketIndex(key);
-        bucket = directory.at(bucket_id);
+        // retry: the key may hash to either half of the split
     }
-
-    bucket->slots.push_back(std::make_pair(key, value));
 }
 
 /*
  * get the index of the bucket by key
  */
-template <typename K, typename V>
-int ExtendibleHash<K, V>::GetBucketIndex(const K &key) {
+template <typename K, typename V, typename HashFn>
+int ExtendibleHash<K, V, HashFn>::GetBucketIndex(const K &key) {
     size_t hash = HashKey(key);
     // use the last global_depth bits
-    return static_cast<int>(hash & ((1 << global_depth) - 1));
+    return static_cast<int>(hash & (DirSize() - 1));
 }
 
 template class ExtendibleHash<page_id_t, Page *>;
 template class ExtendibleHash<Page *, std::list<Page *>::iterator>;
+// faster integer mixer variant, see IntegerMixHash
+template class ExtendibleHash<page_id_t, Page *, IntegerMixHash>;
 // test purpose
 template class ExtendibleHash<int, std::string>;
 template class ExtendibleHash<int, std::list<int>::iterator>;
 template class ExtendibleHash<int, int>;
+template class ExtendibleHash<int, int, IntegerMixHash>;
 } // namespace cmudb
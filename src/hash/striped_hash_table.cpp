@@ -0,0 +1,95 @@
+/**
+ * striped_hash_table.cpp
+ */
+#include <list>
+#include <string>
+
+#include "hash/striped_hash_table.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+/*
+ * constructor
+ * num_stripes: number of independently locked partitions, rounded up to a
+ * power of two so stripe selection is a mask instead of a modulo
+ */
+template <typename K, typename V>
+StripedHashTable<K, V>::StripedHashTable(size_t num_stripes) {
+    size_t rounded = 1;
+    while (rounded < num_stripes) {
+        rounded <<= 1;
+    }
+    stripes_.reserve(rounded);
+    for (size_t i = 0; i < rounded; ++i) {
+        stripes_.push_back(new Stripe);
+    }
+}
+
+template <typename K, typename V> StripedHashTable<K, V>::~StripedHashTable() {
+    for (Stripe *stripe : stripes_) {
+        delete stripe;
+    }
+}
+
+/*
+ * map key to its stripe
+ */
+template <typename K, typename V>
+typename StripedHashTable<K, V>::Stripe &
+StripedHashTable<K, V>::GetStripe(const K &key) {
+    return *stripes_[hash_fn_(key) & (stripes_.size() - 1)];
+}
+
+/*
+ * lookup function to find value associate with input key
+ * readers of the same stripe proceed in parallel
+ */
+template <typename K, typename V>
+bool StripedHashTable<K, V>::Find(const K &key, V &value) {
+    Stripe &stripe = GetStripe(key);
+    stripe.mutex.RLock();
+
+    auto pos = stripe.map.find(key);
+    bool found = pos != stripe.map.end();
+    if (found) {
+        value = pos->second;
+    }
+
+    stripe.mutex.RUnlock();
+    return found;
+}
+
+/*
+ * delete <key, value> entry in hash table
+ * Shrink & Combination is not required for this project
+ */
+template <typename K, typename V>
+bool StripedHashTable<K, V>::Remove(const K &key) {
+    Stripe &stripe = GetStripe(key);
+    stripe.mutex.WLock();
+
+    bool removed = stripe.map.erase(key) != 0;
+
+    stripe.mutex.WUnlock();
+    return removed;
+}
+
+/*
+ * insert <key, value> entry in hash table, an existing key is overwritten
+ */
+template <typename K, typename V>
+void StripedHashTable<K, V>::Insert(const K &key, const V &value) {
+    Stripe &stripe = GetStripe(key);
+    stripe.mutex.WLock();
+
+    stripe.map[key] = value;
+
+    stripe.mutex.WUnlock();
+}
+
+template class StripedHashTable<page_id_t, Page *>;
+// test purpose
+template class StripedHashTable<int, std::string>;
+template class StripedHashTable<int, int>;
+} // namespace cmudb
@@ -4,47 +4,244 @@
  * Functionality: The simplified Buffer Manager interface allows a client to
  * new/delete pages on disk, to read a disk page into the buffer pool and pin
  * it, also to unpin a page in the buffer pool.
+ *
+ * The pool can optionally be partitioned into independent shards keyed by
+ * page id. Each shard owns its own page table, replacer, free list and latch,
+ * so concurrent fetch/unpin traffic on different pages does not serialize
+ * behind a single global mutex.
  */
 
 #pragma once
+#include <atomic>
+#include <condition_variable>
 #include <list>
 #include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
+#include "buffer/compressed_page_cache.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/sampling_replacer.h"
 #include "disk/disk_manager.h"
-#include "hash/extendible_hash.h"
+#include "hash/striped_hash_table.h"
 #include "logging/log_manager.h"
 #include "page/page.h"
 
 namespace cmudb {
+
+// replacement policy used by each pool shard
+enum class ReplacerType { LRU, LRU_K, SAMPLING };
+
+// point-in-time snapshot of the pool counters, aggregated over all shards
+struct BufferPoolStats {
+    size_t hits = 0;             // page table hits
+    size_t misses = 0;           // pages read from disk
+    size_t evictions = 0;        // frames recycled through the replacer
+    size_t dirty_writebacks = 0; // dirty pages written back to disk
+    size_t fetch_failures = 0;   // fetches that found no usable frame
+    size_t compressed_hits = 0;  // misses served from the compressed tier
+    size_t read_ahead_pages = 0; // pages prefetched by sequential read-ahead
+
+    std::string ToString() const;
+};
+
 class BufferPoolManager {
 public:
     BufferPoolManager(size_t pool_size, DiskManager *disk_manager,
                       LogManager *log_manager = nullptr);
 
+    // partitioned mode: pool frames are split across num_shards independent
+    // shards and pages are assigned to shards by page id
+    BufferPoolManager(size_t pool_size, size_t num_shards,
+                      DiskManager *disk_manager,
+                      LogManager *log_manager = nullptr,
+                      ReplacerType replacer_type = ReplacerType::LRU);
+
     ~BufferPoolManager();
 
     Page *FetchPage(page_id_t page_id);
 
+    // fetch and pin a batch of pages, resolving all ids that map to the same
+    // shard under a single latch acquisition; result[i] corresponds to
+    // page_ids[i] and is nullptr if no frame was available for that page
+    std::vector<Page *> FetchPages(const std::vector<page_id_t> &page_ids);
+
+    // zero-copy read path for read-only replicas: returns a pointer straight
+    // into the disk manager's read-only mapping (no frame, no pin, no copy),
+    // or nullptr when no mapping is active. Must not be used on a node that
+    // writes pages, the mapping would not see changes buffered in the pool
+    const char *FetchPageZeroCopy(page_id_t page_id) {
+        return disk_manager_->GetMMapData(page_id);
+    }
+
+    // best-effort: pull the page into the pool without pinning it, so a
+    // subsequent FetchPage is a cheap hit; silently does nothing if the page
+    // is already cached or no frame is available
+    void PrefetchPage(page_id_t page_id);
+
     bool UnpinPage(page_id_t page_id, bool is_dirty);
 
     bool FlushPage(page_id_t page_id);
 
+    // write back every dirty unpinned page; used by checkpoints to make all
+    // logged effects so far durable
+    void FlushAllPages();
+
     Page *NewPage(page_id_t &page_id);
 
     bool DeletePage(page_id_t page_id);
 
+    // retain compressed copies of evicted pages in a second in-memory tier
+    // bounded by capacity_bytes; fetch misses consult it before hitting disk
+    void EnableCompressedCache(size_t capacity_bytes) {
+        compressed_cache_.reset(new CompressedPageCache(capacity_bytes));
+    }
+
+    // spawn a background thread that periodically writes back cold (unpinned
+    // and dirty) pages so cache misses usually find a clean victim
+    void RunFlushThread();
+    void StopFlushThread();
+
+    // stop and join the sequential read-ahead worker; started lazily by the
+    // first detected fetch streak, safe to call when it never ran
+    void StopReadAheadThread();
+
+    // warmup persistence: dump the resident page ids to a sidecar file, and
+    // prefetch the ids found there in ascending order so a restart faults
+    // the previous working set back in with near-sequential reads instead
+    // of one random miss per query. Loading remembers the file so the
+    // background flusher keeps the sidecar fresh
+    void SaveWarmupInfo(const std::string &file_name);
+    void LoadWarmupInfo(const std::string &file_name);
+
+    // aggregate the per-shard counters into one snapshot; counters are kept
+    // per shard so updating them never causes cross-shard cache traffic
+    BufferPoolStats GetStats() const;
+
+    // online resize: grow adds new frames, shrink retires up to the requested
+    // number of unpinned frames (evicting them if needed). Neither direction
+    // quiesces in-flight transactions; shrinking stops early if not enough
+    // frames are free or victimizable and returns the new effective size
+    size_t Resize(size_t new_pool_size);
+
+    size_t GetPoolSize() const { return pool_size_; }
+
 private:
-    // select a page from free list or a victim from lru
-    Page *SelectPage();
+    // background flusher loop
+    void FlushDirtyPages();
+    // one writeback sweep over every frame, shared by the flusher thread
+    // and FlushAllPages
+    void FlushPass();
+    // one partition of the buffer pool; frames assigned to a shard at
+    // construction never migrate to another shard
+    struct Shard {
+        HashTable<page_id_t, Page *> *page_table_; // to keep track of pages
+        Replacer<Page *> *replacer_; // to find an unpinned page for replacement
+        std::list<Page *> free_list_; // to find a free page for replacement
+        // frames retired by DeletePage, waiting for every reader that might
+        // still hold the raw pointer to leave its epoch; drained into the
+        // free list by SelectPage
+        std::list<std::pair<uint64_t, Page *>> limbo_list_;
+        std::mutex latch_;            // to protect shared data structure
+        // monitoring counters, cheap enough to stay on in production
+        std::atomic<size_t> hits_{0};
+        std::atomic<size_t> misses_{0};
+        std::atomic<size_t> evictions_{0};
+        std::atomic<size_t> dirty_writebacks_{0};
+        std::atomic<size_t> fetch_failures_{0};
+        std::atomic<size_t> compressed_hits_{0};
+    };
+
+    // read the page either from the compressed tier or from disk; caller
+    // must hold the shard latch (the tier itself is thread safe, but the
+    // counters belong to the shard)
+    void LoadPage(Shard &shard, page_id_t page_id, char *page_data);
+
+    // map page id to its owning shard
+    Shard &GetShard(page_id_t page_id);
+
+    // allocate and construct num_frames frames and record the segment in
+    // the bookkeeping vectors (caller must hold resize_latch_ or be the
+    // constructor). Frames are first-touched on the CPU assigned to
+    // shard_index so the memory lands on that CPU's NUMA node, and backed
+    // by a 2MB-aligned anonymous mapping advised to use transparent huge
+    // pages, falling back to a plain allocation when mmap fails
+    Page *AllocateFrameSegment(size_t num_frames, size_t shard_index);
+
+    // epoch-based frame reclamation. The latch-free fetch path runs inside
+    // an epoch: a thread publishes the current global epoch in its slot
+    // before probing the page table and clears it when done. DeletePage
+    // stamps retired frames with the epoch at retirement; a frame becomes
+    // reusable once every active slot has moved past that stamp, so page
+    // deletion never has to coordinate with concurrent fetchers directly
+    // padded to a cache line by hand: alignas would give the whole manager
+    // extended alignment, which plain (C++14) operator new cannot honor
+    struct EpochSlot {
+        std::atomic<uint64_t> epoch{0}; // 0 while the owning thread is idle
+        char padding_[64 - sizeof(std::atomic<uint64_t>)];
+    };
+
+    // this thread's slot, or nullptr when more threads than slots exist
+    // (those threads fall back to the latched fetch path)
+    EpochSlot *LocalEpochSlot();
+    // smallest epoch published by any active reader; global epoch + 1 when
+    // no reader is active
+    uint64_t MinActiveEpoch();
+    // move limbo frames every reader has passed to the free list; caller
+    // must hold the shard latch
+    void DrainLimbo(Shard &shard);
+    // select a page from the shard's free list or a victim from its replacer,
+    // caller must hold the shard latch
+    Page *SelectPage(Shard &shard);
+    // sequential read-ahead: FetchPage feeds every page id through the
+    // per-thread streak detector, which hands windows to the worker
+    void NoteFetchForReadAhead(page_id_t page_id);
+    void ScheduleReadAhead(page_id_t start_page_id);
+    void ReadAheadLoop();
     // private fields
-    size_t pool_size_; // number of pages in buffer pool
-    Page *pages_;      // array of pages
+    std::atomic<size_t> pool_size_; // number of pages in circulation
+    size_t num_shards_; // number of independent pool partitions
+    // frames are allocated in segments so the pool can grow without
+    // relocating pages that are already handed out to callers
+    std::vector<Page *> page_segments_;  // segment base pointers
+    std::vector<size_t> segment_sizes_;  // frames per segment
+    // huge-page mapping behind each segment: base/bytes to munmap, or a
+    // null base when the segment fell back to operator new[]
+    std::vector<void *> segment_map_bases_;
+    std::vector<size_t> segment_map_bytes_;
+    std::list<Page *> retired_frames_;   // frames parked by a shrink
+    std::mutex resize_latch_;            // protects the three members above
     DiskManager *disk_manager_;
     LogManager *log_manager_;
-    HashTable<page_id_t, Page *> *page_table_; // to keep track of pages
-    Replacer<Page *> *replacer_;   // to find an unpinned page for replacement
-    std::list<Page *> *free_list_; // to find a free page for replacement
-    std::mutex latch_;             // to protect shared data structure
+    Shard *shards_; // array of pool partitions
+    // optional compressed second tier for evicted pages
+    std::unique_ptr<CompressedPageCache> compressed_cache_;
+    // background flush thread related
+    std::atomic<bool> flusher_running_{false};
+    std::thread *flush_thread_ = nullptr;
+    std::mutex flush_latch_;
+    std::condition_variable flush_cv_;
+    // sequential read-ahead related. A fetch streak of READ_AHEAD_STREAK
+    // consecutive page ids schedules the next READ_AHEAD_WINDOW pages; the
+    // trigger then re-arms one window later, so the prefetcher stays one
+    // window ahead of a sequential scan
+    static const int READ_AHEAD_STREAK = 4;
+    static const int READ_AHEAD_WINDOW = 8;
+    std::atomic<bool> read_ahead_running_{false};
+    std::thread *read_ahead_thread_ = nullptr;
+    std::mutex read_ahead_latch_;
+    std::condition_variable read_ahead_cv_;
+    // pending window start ids, protected by read_ahead_latch_
+    std::list<page_id_t> read_ahead_queue_;
+    std::atomic<uint64_t> read_ahead_pages_{0};
+    static const int MAX_EPOCH_SLOTS = 64;
+    EpochSlot epoch_slots_[MAX_EPOCH_SLOTS];
+    std::atomic<uint64_t> global_epoch_{1};
+    // sidecar file holding the hot page-id set, empty if warmup is unused
+    std::string warmup_file_;
+    // flush passes since the sidecar was last rewritten
+    int passes_since_warmup_save_ = 0;
 };
 } // namespace cmudb
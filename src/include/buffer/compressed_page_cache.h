@@ -0,0 +1,71 @@
+/**
+ * compressed_page_cache.h
+ *
+ * A compressed second tier for the buffer pool. Evicted pages are kept in
+ * memory in compressed form (bounded by a byte budget, evicted LRU), and a
+ * fetch miss consults this tier before going to disk — cold TablePage data
+ * is mostly zero padding, so the tier holds several times more pages than
+ * the same memory spent on raw frames.
+ *
+ * Compression is a dependency-free zero-run RLE over the page bytes: a
+ * control byte c < 128 copies the next c+1 literal bytes, c >= 128 expands
+ * to a run of (c - 128 + 3) zero bytes. Pages that do not shrink are simply
+ * not cached.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+class CompressedPageCache {
+public:
+    explicit CompressedPageCache(size_t capacity_bytes);
+
+    // compress the page and retain a copy, evicting the least recently
+    // touched entries if the byte budget is exceeded; pages that do not
+    // compress below PAGE_SIZE are skipped
+    void Put(page_id_t page_id, const char *page_data);
+
+    // on a hit, decompress into page_data and drop the entry (the caller is
+    // promoting the page back into a raw frame); false on a miss
+    bool Get(page_id_t page_id, char *page_data);
+
+    // discard any cached copy, e.g. when the page is deleted
+    void Remove(page_id_t page_id);
+
+    size_t GetSizeBytes() const;
+    size_t GetEntryCount() const;
+
+    // zero-run RLE; Compress returns the compressed size, or 0 when the
+    // input does not fit in out_capacity bytes
+    static size_t Compress(const char *in, size_t in_size, char *out,
+                           size_t out_capacity);
+    static void Decompress(const char *in, size_t in_size, char *out,
+                           size_t out_size);
+
+private:
+    struct Entry {
+        std::unique_ptr<char[]> data;
+        size_t size;
+        std::list<page_id_t>::iterator lru_it;
+    };
+
+    // caller must hold latch_
+    void EvictToFit();
+
+    mutable std::mutex latch_;
+    size_t capacity_bytes_;
+    size_t size_bytes_ = 0;
+    std::list<page_id_t> lru_; // front = most recently inserted
+    std::unordered_map<page_id_t, Entry> entries_;
+};
+
+} // namespace cmudb
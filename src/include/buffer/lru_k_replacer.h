@@ -0,0 +1,60 @@
+/**
+ * lru_k_replacer.h
+ *
+ * Functionality: Scan-resistant alternative to LRUReplacer. The victim is the
+ * value with the largest backward K-distance, i.e. the one whose K-th most
+ * recent access lies furthest in the past. Values seen fewer than K times are
+ * evicted first (in FIFO order of their earliest access), so the pages touched
+ * once by a large sequential scan are recycled before the hot set that has
+ * accumulated a real access history.
+ *
+ * Erase() only marks a value as not evictable (the buffer pool calls it
+ * whenever a page gets pinned again); its access history survives until the
+ * value is actually victimized, otherwise every value would be back to one
+ * recorded access after each pin/unpin cycle and the policy would degrade to
+ * FIFO.
+ */
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include "buffer/replacer.h"
+
+namespace cmudb {
+
+template <typename T> class LRUKReplacer : public Replacer<T> {
+public:
+    explicit LRUKReplacer(size_t k = 2);
+
+    ~LRUKReplacer();
+
+    void Insert(const T &value);
+
+    bool Victim(T &value);
+
+    bool Erase(const T &value);
+
+    size_t Size();
+
+private:
+    // per-value access bookkeeping
+    struct History {
+        // timestamps of up to the last K accesses, oldest first
+        std::deque<size_t> accesses;
+        // whether the value may currently be victimized
+        bool evictable = false;
+    };
+
+    // number of historic accesses to track per value
+    size_t k_;
+    // logical clock, advanced on every Insert
+    size_t clock_ = 0;
+    // mutex to protect critical sections
+    std::mutex mutex;
+    // hash map of access histories, evictable entries are victim candidates
+    std::unordered_map<T, History> history_map;
+};
+
+} // namespace cmudb
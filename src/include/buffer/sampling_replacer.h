@@ -0,0 +1,77 @@
+/**
+ * sampling_replacer.h
+ *
+ * Lock-free alternative to LRUReplacer's exact list. The exact LRU pays a
+ * mutex plus list splice on every pin and unpin; here each value owns a
+ * fixed slot holding a last-access timestamp and an evictable flag, both
+ * plain atomics, so recording an access is one relaxed store and no lock.
+ * Victim approximates LRU by sampling a handful of random slots and
+ * evicting the oldest evictable one (with a full sweep as the fallback so
+ * an evictable value is never missed).
+ *
+ * Slots live in a chain of open-addressed tables: the common case is one
+ * fixed table sized for the pool, and if it ever fills (the pool grew) a
+ * doubled table is linked on with a CAS, so lookups stay lock-free. Values
+ * keep their slot for the replacer's lifetime, like LRUKReplacer keeps
+ * access history; the default-constructed T marks an empty slot and must
+ * not be inserted.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "buffer/replacer.h"
+
+namespace cmudb {
+
+template <typename T> class SamplingReplacer : public Replacer<T> {
+    // slots inspected per eviction attempt; 5 random samples approximate
+    // true LRU closely while touching a constant number of cache lines
+    static const int SAMPLE_SIZE = 5;
+    // sampling rounds before falling back to the exhaustive sweep
+    static const int SAMPLE_ROUNDS = 4;
+
+public:
+    explicit SamplingReplacer(size_t capacity = 1024);
+
+    ~SamplingReplacer();
+
+    void Insert(const T &value);
+
+    bool Victim(T &value);
+
+    bool Erase(const T &value);
+
+    size_t Size();
+
+private:
+    struct Slot {
+        std::atomic<T> value{T()};
+        std::atomic<uint64_t> last_access{0};
+        std::atomic<bool> evictable{false};
+    };
+
+    struct Table {
+        explicit Table(size_t capacity) : slots(capacity) {}
+        std::vector<Slot> slots;
+        std::atomic<Table *> next{nullptr};
+    };
+
+    // find the slot owning "value", claiming an empty one (or chaining a
+    // doubled table) when it is new; never fails
+    Slot *FindOrClaimSlot(const T &value);
+
+    // find the slot owning "value", nullptr when it was never inserted
+    Slot *FindSlot(const T &value);
+
+    // mark "slot" not evictable; true when this call made the transition
+    bool ClaimVictim(Slot *slot);
+
+    std::atomic<uint64_t> clock_{1};
+    std::atomic<size_t> evictable_count_{0};
+    Table *head_;
+};
+
+} // namespace cmudb
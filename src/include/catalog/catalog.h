@@ -0,0 +1,68 @@
+/**
+ * catalog.h
+ *
+ * In-memory catalog over the on-disk header page chain. The first page
+ * (HEADER_PAGE_ID) and its overflow pages store <name, root_id> records;
+ * the catalog loads the chain once and serves every lookup from a hash
+ * map, so VtabConnect and index opens stop paying a linear page scan per
+ * name. Writes go through to the owning page immediately, which keeps the
+ * cache coherent for everyone sharing the buffer pool; Invalidate() drops
+ * the cache so the next access rereads the chain (used when the engine
+ * goes idle and the file could change underneath us).
+ */
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "page/header_page.h"
+
+namespace cmudb {
+
+class Catalog {
+public:
+    explicit Catalog(BufferPoolManager *buffer_pool_manager)
+            : buffer_pool_manager_(buffer_pool_manager) {}
+
+    // insert a <name, root_id> record, chaining a new catalog page when
+    // every existing one is full; false when the name already exists
+    bool InsertRecord(const std::string &name, page_id_t root_id);
+
+    // remove a record; false when the name is unknown
+    bool DeleteRecord(const std::string &name);
+
+    // point the record at a new root page; false when the name is unknown
+    bool UpdateRecord(const std::string &name, page_id_t root_id);
+
+    // O(1) cached lookup; false when the name is unknown
+    bool GetRootId(const std::string &name, page_id_t &root_id);
+
+    int GetRecordCount();
+
+    // forget the cached chain; the next access reloads it from the pages
+    void Invalidate();
+
+private:
+    // where a cached record lives on disk
+    struct CatalogEntry {
+        page_id_t root_id;
+        page_id_t page_id; // catalog page holding the record
+    };
+
+    // load the page chain into entries_ if not cached yet; caller must
+    // hold latch_
+    void EnsureLoaded();
+
+    BufferPoolManager *buffer_pool_manager_;
+    std::mutex latch_;
+    bool loaded_ = false;
+    std::unordered_map<std::string, CatalogEntry> entries_;
+    // the chain in order, so inserts can find a page with room
+    std::vector<page_id_t> chain_;
+};
+
+} // namespace cmudb
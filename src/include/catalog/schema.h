@@ -33,11 +33,11 @@ public:
     //===--------------------------------------------------------------------===//
 
     inline int32_t GetOffset(const int column_id) const {
-        return columns[column_id].GetOffset();
+        return column_offsets[column_id];
     }
 
     inline TypeId GetType(const int column_id) const {
-        return columns[column_id].GetType();
+        return column_types[column_id];
     }
 
     // Return appropriate length based on whether column is inlined
@@ -114,6 +114,11 @@ private:
     // are all columns inlined
     bool tuple_is_inlined;
 
+    // flat per-column offset/type arrays, precomputed at construction so
+    // column extraction does not chase through the Column objects
+    std::vector<int32_t> column_offsets;
+    std::vector<TypeId> column_types;
+
     // keeps track of unlined columns, using logical position(start with 0)
     std::vector<int> uninlined_columns;
 
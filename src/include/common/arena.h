@@ -0,0 +1,69 @@
+/**
+ * arena.h
+ *
+ * Bump allocator for short-lived row materialization. Allocations come out
+ * of large chunks and are never freed individually; Reset() reclaims
+ * everything at once, keeping the first chunk warm for reuse. Scope one
+ * arena per scan or transaction — it is not thread safe.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace cmudb {
+
+class Arena {
+public:
+    explicit Arena(size_t chunk_size = 4096)
+            : chunk_size_(chunk_size), cur_(nullptr), remaining_(0) {}
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    // allocations are 8-byte aligned; requests larger than the chunk size
+    // get a dedicated chunk of their own
+    char *Allocate(size_t size) {
+        size = (size + 7) & ~static_cast<size_t>(7);
+        if (size > remaining_) {
+            size_t alloc_size = size > chunk_size_ ? size : chunk_size_;
+            chunks_.emplace_back(new char[alloc_size], alloc_size);
+            cur_ = chunks_.back().first.get();
+            remaining_ = alloc_size;
+        }
+        char *result = cur_;
+        cur_ += size;
+        remaining_ -= size;
+        return result;
+    }
+
+    // invalidates every allocation made so far in one shot
+    void Reset() {
+        if (chunks_.size() > 1) {
+            chunks_.resize(1);
+        }
+        if (!chunks_.empty()) {
+            cur_ = chunks_[0].first.get();
+            remaining_ = chunks_[0].second;
+        }
+    }
+
+    size_t MemoryUsage() const {
+        size_t total = 0;
+        for (auto &chunk : chunks_) {
+            total += chunk.second;
+        }
+        return total;
+    }
+
+private:
+    const size_t chunk_size_;
+    char *cur_;
+    size_t remaining_;
+    // chunk storage together with each chunk's size
+    std::vector<std::pair<std::unique_ptr<char[]>, size_t>> chunks_;
+};
+
+} // namespace cmudb
@@ -14,17 +14,40 @@ namespace cmudb {
 
 extern std::chrono::duration<long long int> LOG_TIMEOUT;
 
+extern std::chrono::duration<long long int> FLUSH_TIMEOUT;
+
+extern std::chrono::duration<long long int> CHECKPOINT_TIMEOUT;
+
+extern std::chrono::milliseconds DEADLOCK_TIMEOUT;
+
 extern std::atomic<bool> ENABLE_LOGGING;
 
 #define INVALID_PAGE_ID -1 // representing an invalid page id
 #define INVALID_TXN_ID -1  // representing an invalid txn id
 #define INVALID_LSN -1     // representing an invalid lsn
 #define HEADER_PAGE_ID 0   // the header page id
-#define PAGE_SIZE 512     // size of a data page in byte
+// size of a data page in bytes; a build-time parameter (cmake
+// -DSQLITE_VTABLE_PAGE_SIZE=...) so page layouts can match the device's
+// indivisible write size without forking the source
+#ifndef SQLITE_VTABLE_PAGE_SIZE
+#define SQLITE_VTABLE_PAGE_SIZE 512
+#endif
+#define PAGE_SIZE SQLITE_VTABLE_PAGE_SIZE
+static_assert(PAGE_SIZE >= 512 && (PAGE_SIZE & (PAGE_SIZE - 1)) == 0,
+              "PAGE_SIZE must be a power of two of at least 512 bytes");
 #define LOG_BUFFER_SIZE                                                            \
   ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE) // size of a log buffer in byte
+#define LOG_RING_BUFFERS 4             // log buffers in the append/flush ring
+#define LOG_SEGMENT_SIZE (1 << 20)     // bytes per log segment file
 #define BUCKET_SIZE 50                 // size of extendible hash bucket
+#define PAGE_TABLE_STRIPES 16          // lock stripes per page table
+#define LOCK_TABLE_SHARDS 16           // shards per tuple lock table
+#define LOCK_ESCALATION_THRESHOLD 16   // row locks on a page before escalation
+#define DISK_EXTENT_PAGES 64           // pages preallocated per file extent
 #define BUFFER_POOL_SIZE 10            // size of buffer pool
+// byte budget of the compressed second tier behind the buffer pool;
+// sized at several times the raw pool so warm evictees stay in memory
+#define COMPRESSED_CACHE_SIZE (8 * BUFFER_POOL_SIZE * PAGE_SIZE)
 
 typedef int32_t page_id_t; // page id type
 typedef int32_t txn_id_t;  // transaction id type
@@ -0,0 +1,48 @@
+/**
+ * crc32c.h
+ *
+ * CRC32C (Castagnoli) checksum over a byte buffer. Uses the SSE4.2 crc32
+ * instruction when the build targets it (-march=native on any recent x86)
+ * and falls back to a bitwise software loop elsewhere. Used by DiskManager
+ * to detect torn or corrupted pages on read.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+namespace cmudb {
+
+inline uint32_t Crc32c(const char *data, size_t length) {
+    uint32_t crc = 0xFFFFFFFFu;
+
+#ifdef __SSE4_2__
+    const char *end = data + length;
+    // bulk of the page, eight bytes per instruction
+    while (data + sizeof(uint64_t) <= end) {
+        uint64_t chunk;
+        __builtin_memcpy(&chunk, data, sizeof(chunk));
+        crc = static_cast<uint32_t>(_mm_crc32_u64(crc, chunk));
+        data += sizeof(chunk);
+    }
+    while (data < end) {
+        crc = _mm_crc32_u8(crc, static_cast<uint8_t>(*data++));
+    }
+#else
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= static_cast<uint8_t>(data[i]);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+        }
+    }
+#endif
+
+    return crc ^ 0xFFFFFFFFu;
+}
+
+} // namespace cmudb
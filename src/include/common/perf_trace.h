@@ -0,0 +1,65 @@
+/**
+ * perf_trace.h
+ *
+ * Always-on performance counters and a per-thread event trace. Unlike the
+ * LOG_DEBUG text logging this is cheap enough to stay compiled in under
+ * load: counters are one relaxed atomic add, trace events are one RDTSC
+ * plus a store into a fixed thread-local ring buffer (no locks, no
+ * allocation on the hot path; old events are overwritten). PerfDump
+ * renders both for post-mortem inspection when latency spikes.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <x86intrin.h>
+
+namespace cmudb {
+
+enum class PerfCounter : int {
+    LATCH_WAIT = 0,      // RWMutex spin budget exhausted, blocked in kernel
+    LOG_FLUSH_STALL,     // commits waiting on a forced log flush
+    BPLUS_RESTART,       // optimistic B+ tree descent retried pessimistically
+    BUFFER_POOL_MISS,    // FetchPage had to read from disk
+    NUM_COUNTERS
+};
+
+// cache-line padded so hot counters on different cores do not false-share
+struct alignas(64) PerfCounterCell {
+    std::atomic<uint64_t> value{0};
+};
+
+extern PerfCounterCell
+        perf_counters[static_cast<int>(PerfCounter::NUM_COUNTERS)];
+
+inline void PerfCount(PerfCounter counter, uint64_t delta = 1) {
+    perf_counters[static_cast<int>(counter)].value.fetch_add(
+            delta, std::memory_order_relaxed);
+}
+
+inline uint64_t PerfCounterValue(PerfCounter counter) {
+    return perf_counters[static_cast<int>(counter)].value.load(
+            std::memory_order_relaxed);
+}
+
+void PerfResetCounters();
+
+// one trace event: what happened, when (TSC ticks), and a caller-defined
+// payload (a page id, a wait duration, ...)
+struct PerfEvent {
+    uint64_t tsc;
+    uint16_t event_id;
+    uint64_t arg;
+};
+
+// record an event in this thread's ring buffer; the buffer registers
+// itself on first use and holds the most recent PerfThreadTrace::CAPACITY
+// events
+void PerfTraceEvent(uint16_t event_id, uint64_t arg = 0);
+
+// dump counter values and every live thread's ring, oldest event first
+void PerfDump(std::ostream &os);
+
+} // namespace cmudb
@@ -2,68 +2,68 @@
  * rwmutex.h
  *
  * Reader-Writer lock
+ *
+ * Thin wrapper over std::shared_timed_mutex with a bounded spin phase in
+ * front of it. Page latches are the innermost locks in the engine, so the
+ * uncontended path matters most: try_lock_shared/try_lock resolve with a
+ * single atomic operation, where the previous condition-variable design
+ * paid for a pthread mutex on every acquire and release. Under short
+ * contention the spin keeps waiters off the scheduler; only after the spin
+ * budget runs out do we fall back to the blocking acquire, which parks in
+ * the kernel (futex on Linux) and wakes pending readers in one batch.
  */
 
 #pragma once
 
-#include <climits>
-#include <condition_variable>
-#include <mutex>
+#include <emmintrin.h>
+#include <shared_mutex>
+
+#include "common/perf_trace.h"
 
 namespace cmudb {
 class RWMutex {
 
-    typedef std::mutex mutex_t;
-    typedef std::condition_variable cond_t;
-    static const uint32_t max_readers_ = UINT_MAX;
+    // page latches are typically held for a few hundred instructions, so a
+    // short spin usually outlasts the current holder
+    static const int SPIN_LIMIT = 64;
 
 public:
-    RWMutex() : reader_count_(0), writer_entered_(false) {}
-
-    ~RWMutex() { std::lock_guard<mutex_t> guard(mutex_); }
+    RWMutex() = default;
 
     RWMutex(const RWMutex &) = delete;
     RWMutex &operator=(const RWMutex &) = delete;
 
     void WLock() {
-        std::unique_lock<mutex_t> lock(mutex_);
-        while (writer_entered_)
-            reader_.wait(lock);
-        writer_entered_ = true;
-        while (reader_count_ > 0)
-            writer_.wait(lock);
+        for (int i = 0; i < SPIN_LIMIT; i++) {
+            if (mutex_.try_lock())
+                return;
+            _mm_pause();
+        }
+        PerfCount(PerfCounter::LATCH_WAIT);
+        mutex_.lock();
     }
 
-    void WUnlock() {
-        std::lock_guard<mutex_t> guard(mutex_);
-        writer_entered_ = false;
-        reader_.notify_all();
-    }
+    // single-attempt acquires, used by the latch profiler to detect
+    // contention without paying the spin phase
+    bool TryWLock() { return mutex_.try_lock(); }
+    bool TryRLock() { return mutex_.try_lock_shared(); }
 
-    void RLock() {
-        std::unique_lock<mutex_t> lock(mutex_);
-        while (writer_entered_ || reader_count_ == max_readers_)
-            reader_.wait(lock);
-        reader_count_++;
-    }
+    void WUnlock() { mutex_.unlock(); }
 
-    void RUnlock() {
-        std::lock_guard<mutex_t> guard(mutex_);
-        reader_count_--;
-        if (writer_entered_) {
-            if (reader_count_ == 0)
-                writer_.notify_one();
-        } else {
-            if (reader_count_ == max_readers_ - 1)
-                reader_.notify_one();
+    void RLock() {
+        for (int i = 0; i < SPIN_LIMIT; i++) {
+            if (mutex_.try_lock_shared())
+                return;
+            _mm_pause();
         }
+        PerfCount(PerfCounter::LATCH_WAIT);
+        mutex_.lock_shared();
     }
 
+    void RUnlock() { mutex_.unlock_shared(); }
+
 private:
-    mutex_t mutex_;
-    cond_t writer_;
-    cond_t reader_;
-    uint32_t reader_count_;
-    bool writer_entered_;
+    // shared_timed_mutex is the C++14 spelling of shared_mutex
+    std::shared_timed_mutex mutex_;
 };
 } // namespace cmudb
@@ -0,0 +1,77 @@
+/**
+ * thread_pool.h
+ *
+ * Shared worker pool for internal background work (log flushing aides,
+ * vacuum passes, prefetching). Subsystems submit tasks into one of two
+ * priority lanes instead of each spawning its own thread, so the total
+ * thread count stays bounded regardless of how many features want
+ * background work. HIGH lane tasks (latency-critical) always run before
+ * anything queued in the LOW lane (throughput/maintenance).
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cmudb {
+
+class ThreadPool {
+public:
+    enum class Priority { HIGH = 0, LOW };
+
+    // 0 workers means one per hardware thread (at least 2)
+    explicit ThreadPool(size_t num_workers = 0);
+
+    // drains both lanes, then joins the workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // process-wide pool shared by all subsystems; prefer it over a private
+    // pool so the engine controls the total thread count
+    static ThreadPool &Instance();
+
+    // enqueue a task; HIGH lane tasks run before anything in the LOW lane
+    void Submit(std::function<void()> task,
+                Priority priority = Priority::LOW);
+
+    // enqueue a callable and get a future for its result
+    template <typename F>
+    std::future<typename std::result_of<F()>::type>
+    Async(F f, Priority priority = Priority::LOW) {
+        using R = typename std::result_of<F()>::type;
+        // packaged_task is move-only but std::function wants copyable,
+        // hence the shared_ptr indirection
+        auto task = std::make_shared<std::packaged_task<R()>>(std::move(f));
+        std::future<R> result = task->get_future();
+        Submit([task]() { (*task)(); }, priority);
+        return result;
+    }
+
+    // stop accepting tasks, finish what is queued and join; idempotent
+    void Shutdown();
+
+    inline size_t GetWorkerCount() const { return workers_.size(); }
+
+private:
+    void WorkerLoop();
+
+    std::mutex latch_;
+    std::condition_variable cv_;
+    bool shutdown_ = false;
+    // two lanes instead of one queue with comparator: pushing and popping
+    // stay O(1) and a lane never starves its own FIFO order
+    std::deque<std::function<void()>> high_lane_;
+    std::deque<std::function<void()>> low_lane_;
+    std::vector<std::thread> workers_;
+};
+
+} // namespace cmudb
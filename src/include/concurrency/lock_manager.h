@@ -1,18 +1,35 @@
 /**
  * lock_manager.h
  *
- * Tuple level lock manager, use wait-die to prevent deadlocks
+ * Tuple level lock manager, use wait-die to prevent deadlocks by default.
+ * In deadlock-detection mode requests never abort on age: transactions
+ * wait on the condition variables and a background detector builds a
+ * wait-for graph from the lock and waiter tables, aborting a victim only
+ * when a genuine cycle exists.
+ *
+ * Locking is multiple granularity: every row lock takes an intention
+ * (IS/IX) on its page first. Once a transaction holds
+ * LOCK_ESCALATION_THRESHOLD row locks on one page and no other
+ * transaction touches that page, its row locks are traded for a single
+ * exclusive page lock, recorded in the transaction's lock set as the rid
+ * (page_id, PAGE_LOCK_SLOT).
  */
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <list>
+#include <map>
 #include <memory>
 #include <mutex>
-#include <set>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+#include "common/config.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 
@@ -23,7 +40,18 @@ enum class LockType { SHARED, EXCLUSIVE };
 class LockManager {
 
 public:
-    LockManager(bool strict_2PL) : strict_2PL_(strict_2PL) {};
+    // slot number marking a rid as a page-level lock in a txn's lock set
+    static const int PAGE_LOCK_SLOT = -1;
+
+    LockManager(bool strict_2PL, bool deadlock_detection = false)
+            : strict_2PL_(strict_2PL), deadlock_detection_(deadlock_detection) {};
+
+    ~LockManager() { StopDetectionThread(); }
+
+    // spawn the background cycle detector (deadlock-detection mode only)
+    void RunDetectionThread();
+    // stop and join the cycle detector
+    void StopDetectionThread();
 
     /*** below are APIs need to implement ***/
     // lock:
@@ -35,6 +63,16 @@ public:
     bool LockExclusive(Transaction *txn, const RID &rid);
     bool LockUpgrade(Transaction *txn, const RID &rid);
 
+    // non-blocking and deadline-bounded variants: when the lock cannot be
+    // granted in time they return false with the txn left GROWING (not
+    // aborted), so callers can release, back off and retry
+    bool TryLockShared(Transaction *txn, const RID &rid);
+    bool TryLockExclusive(Transaction *txn, const RID &rid);
+    bool LockShared(Transaction *txn, const RID &rid,
+                    std::chrono::milliseconds timeout);
+    bool LockExclusive(Transaction *txn, const RID &rid,
+                       std::chrono::milliseconds timeout);
+
     // unlock:
     // release the lock hold by the txn
     bool Unlock(Transaction *txn, const RID &rid);
@@ -44,26 +82,142 @@ private:
     // check if transaction state is valid in order to acquire lock
     bool TxnStateValidForLock(Transaction *txn);
 
+    // shared implementation behind the blocking, try and timed variants;
+    // wait_forever selects the blocking behavior (including wait-die),
+    // otherwise waits are bounded by deadline and never abort the txn
+    bool LockSharedImpl(Transaction *txn, const RID &rid, bool wait_forever,
+                        std::chrono::steady_clock::time_point deadline);
+    bool LockExclusiveImpl(Transaction *txn, const RID &rid, bool wait_forever,
+                           std::chrono::steady_clock::time_point deadline);
+
+    // in wait-die mode, abort txn if it is younger than any granted txn;
+    // in detection mode, never abort here and let the detector decide
+    bool ShouldDieWaitingFor(Transaction *txn, txn_id_t oldest_granted);
+
+    // body of the detection thread
+    void DetectionThread();
+    // build the wait-for graph across all shards and abort one victim per
+    // cycle; acquires every shard mutex
+    void DetectDeadlocks();
+
     // txns that were granted a lock, used for lock table
     class GrantedTxns {
     public:
         GrantedTxns(LockType lockType, txn_id_t txn_id)
             : lockType_(lockType), granted_set_({txn_id}) {};
 
+        // smallest (oldest) granted txn id, needed only when a conflicting
+        // request decides whether to die (wait-die) or which holders the
+        // detector should point edges at — both already-blocking paths, so
+        // the scan stays off grant and release
+        txn_id_t OldestGranted() const {
+            txn_id_t oldest = *granted_set_.begin();
+            for (txn_id_t id : granted_set_) {
+                oldest = std::min(oldest, id);
+            }
+            return oldest;
+        }
+
         // type of the lock granted
         LockType lockType_;
-        // a set of txns that we granted this lock
-        std::set<txn_id_t> granted_set_;
+        // granted txn ids, hashed so grant, release and membership checks
+        // stay O(1) with hundreds of concurrent readers; its size is the
+        // reader count of a shared grant
+        std::unordered_set<txn_id_t> granted_set_;
+    };
+
+    // per-rid wait queue: one condition variable shared by all waiters plus
+    // counts of what they wait for, so a release wakes only eligible
+    // waiters — every reader when an exclusive holder leaves, one writer
+    // when the last reader leaves — instead of broadcasting
+    struct WaitQueue {
+        std::condition_variable cv_;
+        // waiters blocked on an exclusive holder, eligible together
+        int shared_waiters_ = 0;
+        // waiters (including upgraders) needing the rid to themselves,
+        // eligible one at a time
+        int exclusive_waiters_ = 0;
     };
 
+    // a shard of the lock table: rids hash to shards so lock traffic on
+    // unrelated tuples never touches the same mutex
+    struct LockShard {
+        // mutex to guard lock operations on this shard
+        std::mutex mutex_;
+        // lock table to record txns that were granted lock
+        std::unordered_map<RID, std::shared_ptr<GrantedTxns>> lock_table_;
+        // wait queues to block and wake waiting txns
+        std::unordered_map<RID, std::shared_ptr<WaitQueue>> cv_table_;
+        // txns blocked on each rid, the detector reads it for wait-for edges
+        std::unordered_map<RID, std::list<Transaction *>> waiter_table_;
+    };
+
+    // page-level lock modes, kept as a bitmask per txn
+    static const int PAGE_IS = 1;
+    static const int PAGE_IX = 2;
+    static const int PAGE_X = 4;
+
+    // page-level lock state for multiple granularity locking
+    struct PageLockState {
+        struct TxnEntry {
+            // bitmask of PAGE_* modes this txn holds
+            int mode_mask_ = 0;
+            // row locks this txn holds on the page
+            int row_count_ = 0;
+        };
+        std::map<txn_id_t, TxnEntry> txns_;
+    };
+
+    struct PageShard {
+        std::mutex mutex_;
+        std::unordered_map<page_id_t, PageLockState> page_table_;
+        std::unordered_map<page_id_t, std::shared_ptr<std::condition_variable>> cv_table_;
+        // txns blocked on a page lock, for the deadlock detector
+        std::unordered_map<page_id_t, std::list<Transaction *>> waiter_table_;
+    };
+
+    LockShard &ShardFor(const RID &rid);
+    PageShard &PageShardFor(page_id_t page_id);
+
+    // register/deregister txn as waiting on rid, caller must hold the
+    // shard mutex
+    void AddWaiter(LockShard &shard, Transaction *txn, const RID &rid);
+    void RemoveWaiter(LockShard &shard, Transaction *txn, const RID &rid);
+
+    // wake only the waiters that can take the now-free rid; caller must
+    // hold the shard mutex and have erased rid from the lock table
+    void WakeEligibleWaiters(LockShard &shard, const RID &rid);
+
+    // take an IS/IX intention on the page and count one row lock (unless
+    // count_row is false, used by upgrades of an already-counted row);
+    // covered is set when txn already holds the page exclusively, in which
+    // case no row lock is needed (or counted)
+    bool LockPageIntention(Transaction *txn, page_id_t page_id, int mode,
+                           bool &covered, bool count_row = true,
+                           bool wait_forever = true,
+                           std::chrono::steady_clock::time_point deadline =
+                                   std::chrono::steady_clock::time_point());
+    // give back one row lock's worth of intention on the page
+    void ReleasePageIntention(Transaction *txn, page_id_t page_id);
+    // trade txn's row locks on the page for one exclusive page lock once
+    // it reaches LOCK_ESCALATION_THRESHOLD and has the page to itself
+    void TryEscalate(Transaction *txn, page_id_t page_id);
+    // release an escalated page lock (rid with slot PAGE_LOCK_SLOT)
+    bool UnlockPage(Transaction *txn, const RID &rid);
+
     // whether to use strict 2PL
     bool strict_2PL_;
-    // mutex to guard lock operations
-    std::mutex mutex_;
-    // lock table to record txns that were granted lock
-    std::unordered_map<RID, std::shared_ptr<GrantedTxns>> lock_table_;
-    // table of condition variables to wait and notify waiting txns
-    std::unordered_map<RID, std::shared_ptr<std::condition_variable>> cv_table_;
+    // whether to use deadlock detection instead of wait-die prevention
+    bool deadlock_detection_;
+    // lock table shards, keyed by rid hash
+    LockShard shards_[LOCK_TABLE_SHARDS];
+    // page lock shards, keyed by page id hash
+    PageShard page_shards_[LOCK_TABLE_SHARDS];
+    // detection thread related
+    std::atomic<bool> detection_running_{false};
+    std::thread *detection_thread_ = nullptr;
+    std::mutex detection_latch_;
+    std::condition_variable detection_cv_;
 };
 
 } // namespace cmudb
@@ -8,7 +8,9 @@
 #include <deque>
 #include <memory>
 #include <thread>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "common/config.h"
 #include "common/logger.h"
@@ -28,6 +30,12 @@ namespace cmudb {
  **/
 enum class TransactionState { GROWING, SHRINKING, COMMITTED, ABORTED };
 
+// how Commit treats the commit record: SYNC waits until it reaches disk,
+// ASYNC returns once it sits in the log buffer and relies on the periodic
+// LOG_TIMEOUT flush, trading the tail of recently acked commits on a
+// crash for write throughput
+enum class DurabilityLevel { SYNC = 0, ASYNC };
+
 enum class WType { INSERT = 0, DELETE, UPDATE };
 
 class TableHeap;
@@ -49,10 +57,10 @@ public:
 class Transaction {
 public:
     Transaction(Transaction const &) = delete;
-    Transaction(txn_id_t txn_id)
+    Transaction(txn_id_t txn_id, bool read_only = false)
             : state_(TransactionState::GROWING),
               thread_id_(std::this_thread::get_id()),
-              txn_id_(txn_id), prev_lsn_(INVALID_LSN),
+              txn_id_(txn_id), read_only_(read_only), prev_lsn_(INVALID_LSN),
               root_page_id_(INVALID_PAGE_ID),
               shared_lock_set_{new std::unordered_set<RID>},
               exclusive_lock_set_{new std::unordered_set<RID>} {
@@ -60,10 +68,33 @@ public:
         write_set_.reset(new std::deque<WriteRecord>);
         page_set_.reset(new std::deque<Page *>);
         deleted_page_set_.reset(new std::unordered_set<page_id_t>);
+        staged_inserts_.reset(
+                new std::unordered_map<TableHeap *, std::vector<Tuple>>);
     }
 
     ~Transaction() {}
 
+    // reset for reuse from the transaction pool: same observable state as
+    // a freshly constructed transaction, but the containers are cleared in
+    // place instead of reallocated
+    void Reinit(txn_id_t txn_id, bool read_only) {
+        state_ = TransactionState::GROWING;
+        thread_id_ = std::this_thread::get_id();
+        txn_id_ = txn_id;
+        read_only_ = read_only;
+        snapshot_ts_ = -1;
+        durability_level_ = DurabilityLevel::SYNC;
+        deferred_writes_ = false;
+        staged_inserts_->clear();
+        prev_lsn_ = INVALID_LSN;
+        root_page_id_ = INVALID_PAGE_ID;
+        write_set_->clear();
+        page_set_->clear();
+        deleted_page_set_->clear();
+        shared_lock_set_->clear();
+        exclusive_lock_set_->clear();
+    }
+
     //===--------------------------------------------------------------------===//
     // Mutators and Accessors
     //===--------------------------------------------------------------------===//
@@ -71,6 +102,16 @@ public:
 
     inline txn_id_t GetTransactionId() const { return txn_id_; }
 
+    // declared read-only at begin: reads skip the lock manager, writes
+    // are rejected
+    inline bool IsReadOnly() const { return read_only_; }
+
+    // commit timestamp captured at begin for read-only transactions; -1
+    // when the transaction reads the live pages
+    inline int64_t GetSnapshotTS() const { return snapshot_ts_; }
+
+    inline void SetSnapshotTS(int64_t snapshot_ts) { snapshot_ts_ = snapshot_ts; }
+
     inline std::shared_ptr<std::deque<WriteRecord>> GetWriteSet() {
         return write_set_;
     }
@@ -107,12 +148,57 @@ public:
 
     inline void SetPrevLSN(lsn_t prev_lsn) { prev_lsn_ = prev_lsn; }
 
+    // declared batch mode: inserts are staged in the transaction-private
+    // workspace instead of touching live pages. The staged rows reach the
+    // pages only when the transaction commits, so an abort is a plain
+    // discard of the workspace with no pages to restore and no locks held
+    // for the undo. Staged rows are invisible to the transaction's own
+    // reads until commit; declare it only for blind batch loads
+    inline bool IsDeferredWrites() const { return deferred_writes_; }
+
+    inline void SetDeferredWrites(bool deferred_writes) {
+        deferred_writes_ = deferred_writes;
+    }
+
+    inline void StageInsert(TableHeap *table, const Tuple &tuple) {
+        auto &staged = (*staged_inserts_)[table];
+        staged.push_back(tuple);
+        // a scratch- or arena-backed row copies shallowly; it must own
+        // its bytes to outlive the statement that staged it
+        staged.back().Materialize();
+    }
+
+    inline std::shared_ptr<std::unordered_map<TableHeap *, std::vector<Tuple>>>
+    GetStagedInserts() {
+        return staged_inserts_;
+    }
+
+    inline DurabilityLevel GetDurabilityLevel() const {
+        return durability_level_;
+    }
+
+    inline void SetDurabilityLevel(DurabilityLevel durability_level) {
+        durability_level_ = durability_level;
+    }
+
 private:
     TransactionState state_;
     // thread id, single-threaded transactions
     std::thread::id thread_id_;
     // transaction id
     txn_id_t txn_id_;
+    // whether the transaction was declared read-only at begin
+    bool read_only_;
+    // snapshot timestamp for read-only transactions, -1 otherwise
+    int64_t snapshot_ts_ = -1;
+    // whether Commit waits for the commit record to hit disk
+    DurabilityLevel durability_level_ = DurabilityLevel::SYNC;
+    // whether inserts are staged in the private workspace (declared batch)
+    bool deferred_writes_ = false;
+    // private workspace of a declared batch transaction: staged inserts
+    // keyed by target table, published at commit, discarded on abort
+    std::shared_ptr<std::unordered_map<TableHeap *, std::vector<Tuple>>>
+            staged_inserts_;
     // Below are used by transaction, undo set
     std::shared_ptr<std::deque<WriteRecord>> write_set_;
     // prev lsn
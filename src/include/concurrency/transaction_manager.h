@@ -5,10 +5,13 @@
 
 #pragma once
 #include <atomic>
+#include <mutex>
 #include <unordered_set>
+#include <vector>
 
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
+#include "concurrency/version_manager.h"
 #include "logging/log_manager.h"
 
 namespace cmudb {
@@ -18,15 +21,46 @@ public:
                        LogManager *log_manager = nullptr)
             : next_txn_id_(0), lock_manager_(lock_manager),
               log_manager_(log_manager) {}
-    Transaction *Begin();
+
+    ~TransactionManager() {
+        for (auto *txn : txn_pool_) {
+            delete txn;
+        }
+    }
+    // a read-only transaction reads without locks, cannot write, and is
+    // never logged or tracked by checkpoints
+    Transaction *Begin(bool read_only = false);
     void Commit(Transaction *txn);
     void Abort(Transaction *txn);
 
+    // return a finished transaction for reuse by a later Begin instead of
+    // freeing it; Begin/Recycle on the hot path is then allocation-free
+    void Recycle(Transaction *txn);
+
+    // the version store backing snapshot reads; tables pass it through to
+    // their write and read paths
+    VersionManager *GetVersionManager() { return &version_manager_; }
+
+    // append a CHECKPOINT record while no transaction is active, reporting
+    // its lsn and its byte offset in the log file; returns false (without
+    // logging anything) when transactions are in flight, the caller is
+    // expected to retry later
+    bool LogCheckpoint(lsn_t &lsn, int &log_offset);
+
 private:
     lsn_t AppendLogRecord(Transaction *txn, LogRecordType recordType);
     std::atomic<txn_id_t> next_txn_id_;
+    // ids of transactions that have begun but not yet committed or aborted,
+    // guarded by txn_table_latch_; checkpoints must observe it empty
+    std::unordered_set<txn_id_t> active_txns_;
+    std::mutex txn_table_latch_;
+    // recycled transactions waiting for the next Begin, bounded so an
+    // occasional burst does not pin memory forever
+    std::vector<Transaction *> txn_pool_;
+    std::mutex txn_pool_latch_;
     LockManager *lock_manager_;
     LogManager *log_manager_;
+    VersionManager version_manager_;
 };
 
 } // namespace cmudb
@@ -0,0 +1,93 @@
+/**
+ * version_manager.h
+ *
+ * Multi-version store backing snapshot reads. Writers save the committed
+ * state of a tuple before their first write to it (pending, tagged with
+ * their txn id); at commit every pending version is stamped with a fresh
+ * commit timestamp. A read-only transaction captures the commit clock at
+ * begin and reads, for each rid, the oldest version superseded after its
+ * snapshot - or the page itself when no such version exists - so scans
+ * see a consistent snapshot without taking any RID locks and writers
+ * never wait for readers.
+ */
+
+#pragma once
+
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "concurrency/transaction.h"
+
+namespace cmudb {
+
+class VersionManager {
+public:
+    VersionManager() = default;
+
+    // capture and register a snapshot timestamp for a read-only txn
+    int64_t BeginSnapshot();
+    // deregister the snapshot when the read-only txn finishes
+    void EndSnapshot(int64_t snapshot_ts);
+
+    // save the committed state of rid as it was before txn's first write
+    // to it (absent for inserts); must be called while the table page is
+    // still write-latched so readers cannot miss the version
+    void RecordOldVersion(Transaction *txn, const RID &rid,
+                          const Tuple &old_tuple, bool absent);
+
+    // stamp txn's pending versions with a fresh commit timestamp
+    void CommitTxn(Transaction *txn);
+    // drop txn's pending versions, rollback already restored the pages
+    void AbortTxn(Transaction *txn);
+
+    // select the version of rid visible at snapshot_ts; returns true when
+    // an older version than the page's applies, with absent set when the
+    // tuple did not exist at the snapshot
+    bool GetVisibleTuple(const RID &rid, int64_t snapshot_ts, Tuple &tuple,
+                         bool &absent);
+
+private:
+    struct Version {
+        // txn that superseded this version while pending, INVALID_TXN_ID
+        // once committed
+        txn_id_t txn_id_;
+        // commit timestamp of the superseding txn, -1 while pending
+        int64_t commit_ts_;
+        // the tuple value before the write, empty when absent_
+        Tuple tuple_;
+        // true when the tuple did not exist before the write (insert)
+        bool absent_;
+    };
+
+    // version chains, sharded by rid hash like the lock table
+    struct VersionShard {
+        std::mutex mutex_;
+        // versions appended in write order (oldest first); writers on one
+        // rid serialize through their exclusive locks
+        std::unordered_map<RID, std::vector<Version>> chains_;
+    };
+
+    VersionShard &ShardFor(const RID &rid);
+
+    // drop committed versions no active snapshot can need, caller must
+    // hold commit_latch_
+    void PruneBelow(int64_t min_snapshot);
+
+    VersionShard shards_[LOCK_TABLE_SHARDS];
+
+    // rids with pending versions per txn
+    std::unordered_map<txn_id_t, std::vector<RID>> pending_;
+    std::mutex pending_latch_;
+
+    // commit clock and snapshot registry; commits and snapshot begins
+    // serialize on commit_latch_ so a snapshot never observes half of a
+    // commit's stamps
+    int64_t commit_ts_ = 0;
+    std::multiset<int64_t> snapshots_;
+    std::mutex commit_latch_;
+};
+
+} // namespace cmudb
@@ -9,9 +9,18 @@
 
 #pragma once
 #include <atomic>
+#include <condition_variable>
 #include <fstream>
+#include <functional>
 #include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 
@@ -19,32 +28,195 @@ namespace cmudb {
 
 class DiskManager {
 public:
-    DiskManager(const std::string &db_file);
+    // when direct_io is true, page reads and writes bypass the OS page cache
+    // (O_DIRECT with an aligned bounce buffer); silently falls back to
+    // buffered streams where the filesystem does not support it.
+    // when verify_checksums is true, every page write records a CRC32C in a
+    // sidecar file and every read verifies it.
+    // when double_write is true, pages are first staged (with a per-page
+    // CRC32C) in a sidecar scratch file and flushed before being written in
+    // place, so a crash mid-write cannot leave a torn page behind: on the
+    // next startup any intact staged copies are replayed over the database
+    // file before recovery runs.
+    // when stripe_paths names two or more files, the page space is striped
+    // across them (page id modulo the stripe count picks the file), one
+    // stream and latch per stripe so I/O against different devices runs in
+    // parallel; direct I/O and read-only mmap are single-file features and
+    // are ignored in striped mode
+    DiskManager(const std::string &db_file, bool direct_io = false,
+                bool verify_checksums = false, bool double_write = false,
+                const std::vector<std::string> &stripe_paths = {});
     ~DiskManager();
 
     void WritePage(page_id_t page_id, const char *page_data);
     void ReadPage(page_id_t page_id, char *page_data);
 
+    // write a batch of pages: the batch is sorted by page id and runs of
+    // adjacent pages go out as one large write instead of many small ones
+    void WritePages(std::vector<std::pair<page_id_t, const char *>> pages);
+
+    // asynchronous page I/O: the request is queued for a dedicated I/O
+    // thread and the returned future becomes ready once the transfer is
+    // done; the caller must keep page_data alive until then
+    std::future<void> ReadPageAsync(page_id_t page_id, char *page_data);
+    std::future<void> WritePageAsync(page_id_t page_id, const char *page_data);
+
+    // the log is a sequence of fixed-size segment files (<name>.log,
+    // <name>.log.1, ...) presenting one contiguous logical byte space;
+    // offsets passed to ReadLog and stored by checkpoints are logical
     void WriteLog(char *log_data, int size);
     bool ReadLog(char *log_data, int size, int offset);
 
+    // called with a segment's file name when it fills up (before any later
+    // recycling), e.g. to stream it to a replica
+    inline void SetLogArchiveHook(std::function<void(const std::string &)> hook) {
+        log_archive_hook_ = hook;
+    }
+
     page_id_t AllocatePage();
     void DeallocatePage(page_id_t page_id);
+    // first page id not yet backed by the database file
+    inline page_id_t GetNextPageId() { return next_page_id_; }
 
     int GetNumFlushes() const;
     bool GetFlushState() const;
     inline void SetFlushLogFuture(std::future<void> *f) { flush_log_f_ = f; }
     inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
+    inline bool IsDirectIO() const { return db_fd_ >= 0; }
+    inline int GetLogSize() { return static_cast<int>(log_size_); }
+    inline bool IsDoubleWriteEnabled() const { return double_write_; }
+    // pages whose checksum did not match on read since startup
+    inline int GetNumChecksumFailures() const { return num_checksum_failures_; }
+    // number of tablespace stripes, 1 when the page space is a single file
+    inline size_t GetNumStripes() const {
+        return stripe_names_.empty() ? 1 : stripe_names_.size();
+    }
+
+    // map the database file read-only; afterwards GetMMapData serves
+    // zero-copy page pointers and ReadPage copies from the mapping instead
+    // of issuing a syscall. Intended for read-mostly replicas; returns false
+    // if the file cannot be mapped
+    bool EnableReadOnlyMMap();
+    // pointer into the read-only mapping, or nullptr if mmap mode is off or
+    // the page lies beyond the mapped region
+    const char *GetMMapData(page_id_t page_id);
+    // persisted redo start point: byte offset into the log file of the last
+    // completed checkpoint record, 0 when no checkpoint has been taken
+    void SetCheckpointOffset(int offset);
+    int GetCheckpointOffset();
+    // leave the clean-shutdown marker; to be called only after the final
+    // checkpoint made every logged effect durable
+    void MarkCleanShutdown();
+    // whether the previous run of this database stopped cleanly; recovery
+    // skips redo/undo entirely when true
+    inline bool WasCleanShutdown() const { return clean_shutdown_; }
+    // number of deallocated pages currently awaiting reuse
+    inline size_t GetNumFreePages() {
+        std::lock_guard<std::mutex> guard(alloc_latch_);
+        return free_pages_.size();
+    }
 
 private:
     int GetFileSize(const std::string &name);
-    // stream to write log file
+    // file name of log segment index (index 0 is the bare .log file)
+    std::string LogSegmentName(int index);
+    // close the filled segment, hand it to the archive hook and open the next
+    void RotateLogSegment();
+    // delete segments lying entirely below the given logical offset
+    void RecycleLogSegments(int below_offset);
+    // give up on direct I/O and resume through the buffered stream
+    void FallbackToBufferedIO();
+    // striped page I/O: page id modulo the stripe count picks the file,
+    // the quotient is the row within it
+    void ReadPageStriped(page_id_t page_id, char *page_data);
+    void WritePageStriped(page_id_t page_id, const char *page_data);
+    // pending async page transfer
+    struct IORequest {
+        bool is_write;
+        page_id_t page_id;
+        char *read_data;
+        const char *write_data;
+        std::promise<void> done;
+    };
+    // queue a request, lazily starting the I/O thread
+    std::future<void> SubmitIORequest(IORequest &&request);
+    // drop the current mapping, if any
+    void ReleaseMMap();
+    // checksum sidecar helpers, no-ops unless verify_checksums was set
+    void StoreChecksum(page_id_t page_id, const char *page_data);
+    void VerifyChecksum(page_id_t page_id, const char *page_data);
+    // rewrite the free-page sidecar file, caller must hold alloc_latch_
+    void PersistFreePages();
+    // stage a batch of pages in the double-write scratch file and flush it,
+    // caller must hold dwb_latch_ until the in-place writes are done
+    void StageDoubleWrite(
+            const std::vector<std::pair<page_id_t, const char *>> &pages);
+    // replay intact staged pages over the database file after a crash,
+    // called once from the constructor
+    void RecoverFromDoubleWriteBuffer();
+    // I/O thread loop draining the submission queue
+    void ServeIORequests();
+    // stream to write the active log segment
     std::fstream log_io_;
     std::string log_name_;
+    int log_segment_ = 0;   // index of the active segment
+    size_t log_size_ = 0;   // logical log size across all segments
+    std::function<void(const std::string &)> log_archive_hook_;
     // stream to write db file
     std::fstream db_io_;
     std::string file_name_;
     std::atomic<page_id_t> next_page_id_;
+    // free-page map: deallocated page ids, lowest id is reused first to keep
+    // the file dense; mirrored in a sidecar file to survive restarts
+    std::set<page_id_t> free_pages_;
+    std::string fpm_name_;
+    std::mutex alloc_latch_;
+    // direct I/O state: O_DIRECT file descriptor (or -1 when buffered) and
+    // the block-aligned bounce buffer O_DIRECT transfers go through
+    int db_fd_;
+    char *aligned_buffer_;
+    std::mutex direct_io_latch_;
+    // serializes seek+transfer pairs on db_io_, page I/O can come from
+    // multiple pool shards at once
+    std::mutex db_io_latch_;
+    // tablespace striping state: one stream and latch per stripe file, so
+    // transfers against different stripes (devices) proceed concurrently
+    // instead of queueing on db_io_latch_; empty when not striped
+    std::vector<std::string> stripe_names_;
+    std::vector<std::unique_ptr<std::fstream>> stripe_io_;
+    std::vector<std::unique_ptr<std::mutex>> stripe_latches_;
+    // async submission queue state
+    std::list<IORequest> io_queue_;
+    std::mutex io_queue_latch_;
+    std::condition_variable io_queue_cv_;
+    std::thread *io_thread_ = nullptr;
+    bool io_thread_running_ = false;
+    // read-only mmap state
+    char *mmap_base_ = nullptr;
+    size_t mmap_size_ = 0;
+    std::mutex mmap_latch_;
+    // checkpoint master record: sidecar file holding the redo start offset
+    std::string ckp_name_;
+    std::mutex ckp_latch_;
+    // clean-shutdown marker: written by MarkCleanShutdown, consumed (and
+    // deleted) by the constructor so only a graceful stop leaves one behind
+    std::string cln_name_;
+    bool clean_shutdown_ = false;
+    // double-write state: scratch file pages are staged in (and flushed)
+    // before the in-place write; dwb_latch_ spans stage plus in-place write
+    // so concurrent writers cannot overwrite each other's staged copies
+    bool double_write_;
+    std::fstream dwb_io_;
+    std::string dwb_name_;
+    std::mutex dwb_latch_;
+    // checksum state: sidecar stream with one CRC32C per page
+    bool verify_checksums_;
+    std::fstream cks_io_;
+    std::string cks_name_;
+    std::mutex cks_latch_;
+    std::atomic<int> num_checksum_failures_{0};
+    // last log buffer handed to WriteLog, to assert callers alternate buffers
+    char *buffer_used_ = nullptr;
     int num_flushes_;
     bool flush_log_;
     std::future<void> *flush_log_f_;
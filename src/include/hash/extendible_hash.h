@@ -9,7 +9,9 @@
 
 #pragma once
 
+#include <array>
 #include <cstdlib>
+#include <memory>
 #include <vector>
 #include <string>
 #include <mutex>
@@ -18,7 +20,22 @@
 
 namespace cmudb {
 
-template <typename K, typename V>
+// drop-in replacement hasher for integral keys: one multiply-shift round
+// (the 64-bit murmur finalizer) spreads consecutive ids over all bits,
+// where std::hash on an integer is the identity and leaves the high bits
+// empty. Plugged in through the HashFn template parameter below
+struct IntegerMixHash {
+    size_t operator()(uint64_t key) const {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return static_cast<size_t>(key);
+    }
+};
+
+template <typename K, typename V, typename HashFn = std::hash<K>>
 class ExtendibleHash : public HashTable<K, V> {
 public:
     // constructor
@@ -41,21 +58,70 @@ private:
     // hash bucket storing key value pairs
     class Bucket {
     public:
+        // latch protecting the slots of this bucket only
+        std::mutex latch;
         // local depth of the bucket
         int local_depth;
-        // slots to store key value pairs
-        std::vector<std::pair<K, V>> slots;
+        // number of occupied slots
+        size_t size;
+        // flat array of key value pairs, allocated once at full capacity so
+        // a bucket scan walks contiguous memory without reallocation
+        std::unique_ptr<std::pair<K, V>[]> slots;
         // constructor
-        Bucket(int depth) : local_depth(depth) {}
+        Bucket(int depth, size_t capacity)
+                : local_depth(depth), size(0),
+                  slots(new std::pair<K, V>[capacity]) {}
+    };
+
+    // directory entries per segment; doubling the directory above this size
+    // copies segment pointers, not bucket pointers
+    static const size_t DIRECTORY_SEGMENT_SIZE = 512;
+
+    // one fixed-size chunk of the bucket directory. The two halves of a
+    // freshly doubled directory are aliases of each other, so expansion
+    // duplicates segment pointers — a cost smaller than a full directory
+    // copy by the segment factor — and a shared segment is only cloned
+    // (copy-on-write) once a split repoints one of its entries
+    struct Segment {
+        std::array<std::shared_ptr<Bucket>, DIRECTORY_SEGMENT_SIZE> entries;
     };
 
-    // mutex to protect critical sections
+    // number of live directory entries; indexes beyond it are unused slack
+    // in the last segment. Caller must hold the directory latch
+    inline size_t DirSize() const {
+        return static_cast<size_t>(1) << global_depth;
+    }
+
+    inline std::shared_ptr<Bucket> &DirAt(size_t index) {
+        return segments[index / DIRECTORY_SEGMENT_SIZE]
+                ->entries[index % DIRECTORY_SEGMENT_SIZE];
+    }
+
+    // clone the segment holding index when it is aliased elsewhere in the
+    // directory, so repointing its entries cannot leak through the alias.
+    // Caller must hold the directory latch
+    inline void EnsurePrivateSegment(size_t index) {
+        auto &slot = segments[index / DIRECTORY_SEGMENT_SIZE];
+        if (slot.use_count() > 1) {
+            auto clone = std::make_shared<Segment>();
+            clone->entries = slot->entries;
+            slot = clone;
+        }
+    }
+
+    // double the directory in place. Caller must hold the directory latch
+    void ExpandDirectory();
+
+    // latch protecting the directory and global depth; bucket contents are
+    // protected by the per-bucket latches so operations on different buckets
+    // proceed in parallel. Lock order is always directory then bucket
     std::mutex mutex;
     // global depth of the hash table
     int global_depth;
     // size of each bucket
     const size_t bucket_size;
-    // bucket directory with size power two of global depth
-    std::vector<std::shared_ptr<Bucket>> directory;
+    // bucket directory: segments of entry pointers, 2^global_depth live
+    // entries in total
+    std::vector<std::shared_ptr<Segment>> segments;
 };
 } // namespace cmudb
@@ -0,0 +1,53 @@
+/*
+ * striped_hash_table.h : hash table with per-stripe reader-writer locks
+ *
+ * Functionality: Drop-in replacement for ExtendibleHash as the buffer pool
+ * page table. Keys are spread over a fixed number of stripes, each stripe is
+ * an independent bucket map guarded by its own RWMutex, so concurrent
+ * lookups never block each other and writers only serialize within one
+ * stripe instead of behind a single table-wide mutex.
+ */
+
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "common/rwmutex.h"
+#include "hash/hash_table.h"
+
+namespace cmudb {
+
+template <typename K, typename V>
+class StripedHashTable : public HashTable<K, V> {
+public:
+    // constructor, num_stripes is rounded up to a power of two
+    StripedHashTable(size_t num_stripes);
+
+    ~StripedHashTable();
+
+    // lookup function, shared lock on the stripe only
+    bool Find(const K &key, V &value) override;
+    // delete <key, value> entry in hash table
+    bool Remove(const K &key) override;
+    // insert <key, value> entry in hash table, overwrites an existing key
+    void Insert(const K &key, const V &value) override;
+
+    size_t GetNumStripes() const { return stripes_.size(); }
+
+private:
+    // one lock-striped partition of the table
+    struct Stripe {
+        RWMutex mutex;
+        std::unordered_map<K, V> map;
+    };
+
+    // map key to its stripe
+    Stripe &GetStripe(const K &key);
+
+    std::hash<K> hash_fn_;
+    std::vector<Stripe *> stripes_;
+};
+
+} // namespace cmudb
@@ -11,6 +11,9 @@
 #pragma once
 
 #include <queue>
+#include <sstream>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "concurrency/transaction.h"
@@ -20,6 +23,8 @@
 
 namespace cmudb {
 
+class Catalog;
+
 #define BPLUSTREE_TYPE                                                         \
     BPlusTree<KeyType, ValueType, KeyComparator>
 
@@ -28,6 +33,27 @@ namespace cmudb {
 
 enum class OpType { SEARCH, INSERT, DELETE };
 
+// point-in-time leaf occupancy snapshot, see BPlusTree::GetOccupancyStats
+struct BPlusTreeStats {
+    int leaf_pages = 0;    // leaves in the chain
+    int leaf_entries = 0;  // entries stored across them
+    int leaf_capacity = 0; // sum of the leaves' max sizes
+
+    // average leaf fill factor, 0 for an empty tree
+    double FillFactor() const {
+        return leaf_capacity == 0
+                       ? 0.0
+                       : static_cast<double>(leaf_entries) / leaf_capacity;
+    }
+
+    std::string ToString() const {
+        std::ostringstream os;
+        os << "BPlusTreeStats[leaves:" << leaf_pages
+           << ", entries:" << leaf_entries << ", fill:" << FillFactor() << "]";
+        return os.str();
+    }
+};
+
 // Main class providing the API for the Interactive B+ Tree.
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -35,7 +61,8 @@ public:
     explicit BPlusTree(const std::string &name,
                        BufferPoolManager *buffer_pool_manager,
                        const KeyComparator &comparator,
-                       page_id_t root_page_id = INVALID_PAGE_ID);
+                       page_id_t root_page_id = INVALID_PAGE_ID,
+                       Catalog *catalog = nullptr);
 
     // Returns true if this B+ tree has no keys and values.
     bool IsEmpty() const;
@@ -45,7 +72,40 @@ public:
                 Transaction *transaction = nullptr);
 
     // Remove a key and its value from this B+ tree.
-    void Remove(const KeyType &key, Transaction *transaction = nullptr);
+    // @return: true when the key was present and removed
+    bool Remove(const KeyType &key, Transaction *transaction = nullptr);
+
+    // Remove every key in [low, high] with one descent and a rightward
+    // leaf walk, clearing each leaf's overlap in one pass instead of a
+    // per-key descent. Fully covered leaves are detached on the spot;
+    // merely underfull ones follow the lazy-reclaim rules. The whole
+    // range runs single-writer like BulkLoad/InsertBatch.
+    // @return: number of keys removed
+    int RemoveRange(const KeyType &low, const KeyType &high);
+
+    // Lazy reclamation for delete-heavy workloads: when enabled, Remove
+    // tolerates underfull (but non-empty) leaves instead of merging them
+    // on the spot, queueing them for a later cleanup pass. Toggle before
+    // the workload runs, not while operations are in flight.
+    void SetLazyReclaim(bool enable);
+
+    // Merge or rebalance every queued leaf that is still underfull; leaves
+    // an insert has touched since they were queued are skipped as warm.
+    // Meant to run from a maintenance pass, off the delete path.
+    // @return: number of leaves merged or rebalanced
+    int ReclaimUnderfullLeaves(Transaction *transaction = nullptr);
+
+    // Build the tree from key & value pairs sorted by key; the tree must be
+    // empty. Leaves are written packed left to right and internal levels are
+    // built bottom-up, avoiding the per-key descent and splits of Insert.
+    bool BulkLoad(const std::vector<std::pair<KeyType, ValueType>> &items);
+
+    // Insert many key & value pairs with one descent per leaf run instead
+    // of one per key: the input is sorted in place, and every entry that
+    // falls inside the current leaf's bound is applied under one pin. The
+    // whole batch runs single-writer like BulkLoad.
+    // @return: number of entries actually inserted (duplicates skipped)
+    int InsertBatch(std::vector<std::pair<KeyType, ValueType>> &items);
 
     // return the value associated with a given key
     bool GetValue(const KeyType &key, std::vector<ValueType> &result,
@@ -54,6 +114,14 @@ public:
     // index iterator
     INDEXITERATOR_TYPE Begin();
     INDEXITERATOR_TYPE Begin(const KeyType &key);
+    // reverse iterators for descending scans: start from the last key in
+    // the tree, or from the last entry with key <= the input key
+    INDEXITERATOR_TYPE RBegin();
+    INDEXITERATOR_TYPE RBegin(const KeyType &key);
+
+    // leaf occupancy snapshot, gathered by walking the leaf chain; used to
+    // monitor fill factor (see the split-high path in InsertIntoLeaf)
+    BPlusTreeStats GetOccupancyStats();
 
     // Print this B+ tree to stdout using a simple command-line
     std::string ToString(bool verbose = false);
@@ -81,7 +149,9 @@ private:
                           BPlusTreePage *new_node,
                           Transaction *transaction = nullptr);
 
-    template <typename N> N *Split(N *node);
+    // move_count > 0 moves that many trailing entries to the new page
+    // instead of half; used to split high on rightmost-leaf appends
+    template <typename N> N *Split(N *node, int move_count = 0);
 
     template <typename N>
     bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr);
@@ -101,6 +171,12 @@ private:
     template <typename PageType>
     PageType FetchPage(page_id_t page_id);
 
+    Page *FindLeafPageOptimistic(const KeyType &key, OpType op_type);
+
+    bool GetValueOptimistic(const KeyType &key, ValueType &value, bool &exists);
+
+    Page *MoveRight(Page *page, const KeyType &key);
+
     void AcquireLatchOnPage(Page *page, Transaction *transaction, OpType op_type);
 
     void ReleaseLatchedPages(Transaction *transaction, OpType op_type, bool is_dirty);
@@ -111,6 +187,13 @@ private:
     std::mutex root_pid_mutex;
     BufferPoolManager *buffer_pool_manager_;
     KeyComparator comparator_;
+    // root id registration goes through the catalog when one is supplied,
+    // falling back to a raw header page record otherwise
+    Catalog *catalog_;
+    // deferred merge of underfull leaves (see SetLazyReclaim)
+    bool lazy_reclaim_;
+    std::mutex underfull_mutex_;
+    std::unordered_set<page_id_t> underfull_leaves_;
 };
 
 } // namespace cmudb
@@ -5,10 +5,12 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "index/b_plus_tree.h"
+#include "index/bloom_filter.h"
 #include "index/index.h"
 
 namespace cmudb {
@@ -21,24 +23,90 @@ class BPlusTreeIndex : public Index {
 public:
     BPlusTreeIndex(IndexMetadata *metadata,
                    BufferPoolManager *buffer_pool_manager,
-                   page_id_t root_page_id = INVALID_PAGE_ID);
+                   page_id_t root_page_id = INVALID_PAGE_ID,
+                   Catalog *catalog = nullptr);
 
     ~BPlusTreeIndex() {}
 
     void InsertEntry(const Tuple &key, RID rid,
                      Transaction *transaction = nullptr) override;
 
+    void InsertEntries(std::vector<std::pair<Tuple, RID>> &entries,
+                       Transaction *transaction = nullptr) override;
+
     void DeleteEntry(const Tuple &key,
                      Transaction *transaction = nullptr) override;
 
     void ScanKey(const Tuple &key, std::vector<RID> &result,
                  Transaction *transaction = nullptr) override;
 
+    bool ScanKeyIndexOnly(const Tuple &key, std::vector<RID> &result,
+                          std::vector<std::vector<Value>> &values,
+                          Transaction *transaction = nullptr) override;
+
+    bool ScanRange(const Tuple *low, const Tuple *high, bool low_inclusive,
+                   bool high_inclusive, std::vector<RID> &result,
+                   Transaction *transaction = nullptr) override;
+
+    bool ScanRangeIndexOnly(const Tuple *low, const Tuple *high,
+                            bool low_inclusive, bool high_inclusive,
+                            std::vector<RID> &result,
+                            std::vector<std::vector<Value>> &values,
+                            Transaction *transaction = nullptr) override;
+
+    std::unique_ptr<OrderedScan> OpenOrderedScan(bool reverse) override;
+
+    // Attach an in-memory counting bloom filter sized for expected_keys
+    // and seed it from the current tree contents, so a ScanKey for a key
+    // that was never inserted returns after a few hash probes instead of
+    // a root-to-leaf descent. Enable before the workload runs, not while
+    // operations are in flight; once enabled, entry changes keep the
+    // filter current.
+    void EnableBloomFilter(size_t expected_keys);
+
 protected:
+    // range walk shared by the rid-only and index-only scans; a non-null
+    // "values" also collects the column values of each qualifying key
+    bool ScanRangeInternal(const Tuple *low, const Tuple *high,
+                           bool low_inclusive, bool high_inclusive,
+                           std::vector<RID> &result,
+                           std::vector<std::vector<Value>> *values);
+
+    // lazy ordered walk backing Index::OpenOrderedScan: owns the (pinned)
+    // leaf iterator and rebuilds indexed column values entry by entry as
+    // batches are pulled
+    class OrderedScanImpl : public OrderedScan {
+    public:
+        OrderedScanImpl(INDEXITERATOR_TYPE iterator, Schema *key_schema)
+                : iterator_(std::move(iterator)), key_schema_(key_schema) {}
+
+        size_t NextBatch(std::vector<RID> &result,
+                         std::vector<std::vector<Value>> &values,
+                         size_t n) override {
+            size_t appended = 0;
+            for (; appended < n && !iterator_.isEnd(); ++iterator_) {
+                const auto &entry = *iterator_;
+                result.push_back(entry.second);
+                std::vector<Value> key_values;
+                for (int i = 0; i < key_schema_->GetColumnCount(); i++)
+                    key_values.push_back(entry.first.ToValue(key_schema_, i));
+                values.push_back(std::move(key_values));
+                ++appended;
+            }
+            return appended;
+        }
+
+    private:
+        INDEXITERATOR_TYPE iterator_;
+        Schema *key_schema_;
+    };
+
     // comparator for key
     KeyComparator comparator_;
     // container
     BPlusTree<KeyType, ValueType, KeyComparator> container_;
+    // optional negative-lookup sidecar, see EnableBloomFilter
+    std::unique_ptr<BloomFilter> bloom_filter_;
 };
 
 } // namespace cmudb
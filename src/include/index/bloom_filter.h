@@ -0,0 +1,101 @@
+/**
+ * bloom_filter.h
+ *
+ * Counting bloom filter over raw key bytes, kept in memory as a sidecar
+ * for an index: a membership probe is a handful of hash lookups, so a
+ * point query for a key that was never inserted can return without
+ * descending the index at all. Counters (rather than bits) make deletes
+ * possible; they are 8-bit and stick at their maximum once saturated,
+ * which can only cause false positives, never false negatives. All
+ * operations are single relaxed atomic updates per probe, safe to run
+ * concurrently with each other.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "type/type_kernels.h"
+
+namespace cmudb {
+
+class BloomFilter {
+public:
+    // sized at roughly eight counters per expected key, which with four
+    // probes keeps the false positive rate in the low single digits even
+    // when the estimate is off by a factor of two
+    explicit BloomFilter(size_t expected_keys)
+            : counters_(NextPowerOfTwo(expected_keys * COUNTERS_PER_KEY)) {}
+
+    void Insert(const char *data, size_t len) {
+        uint64_t h1, h2;
+        HashPair(data, len, h1, h2);
+        for (int i = 0; i < NUM_PROBES; i++) {
+            auto &counter = counters_[(h1 + i * h2) & (counters_.size() - 1)];
+            // saturated counters are sticky, see Delete
+            uint8_t old_count = counter.load(std::memory_order_relaxed);
+            while (old_count < COUNTER_MAX &&
+                   !counter.compare_exchange_weak(old_count, old_count + 1,
+                                                  std::memory_order_relaxed)) {
+            }
+        }
+    }
+
+    void Delete(const char *data, size_t len) {
+        uint64_t h1, h2;
+        HashPair(data, len, h1, h2);
+        for (int i = 0; i < NUM_PROBES; i++) {
+            auto &counter = counters_[(h1 + i * h2) & (counters_.size() - 1)];
+            // never decrement a saturated counter: its true count is
+            // unknown, so dropping it could produce a false negative
+            uint8_t old_count = counter.load(std::memory_order_relaxed);
+            while (old_count > 0 && old_count < COUNTER_MAX &&
+                   !counter.compare_exchange_weak(old_count, old_count - 1,
+                                                  std::memory_order_relaxed)) {
+            }
+        }
+    }
+
+    // @return: false means the key was definitely never inserted; true
+    // means it is probably present
+    bool MayContain(const char *data, size_t len) const {
+        uint64_t h1, h2;
+        HashPair(data, len, h1, h2);
+        for (int i = 0; i < NUM_PROBES; i++) {
+            if (counters_[(h1 + i * h2) & (counters_.size() - 1)].load(
+                        std::memory_order_relaxed) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    static const int NUM_PROBES = 4;
+    static const size_t COUNTERS_PER_KEY = 8;
+    static const uint8_t COUNTER_MAX = 255;
+
+    // double hashing: two seeded passes of the multi-lane byte hash
+    // drive all probe positions, h2 forced odd so the probe sequence
+    // covers the power-of-two table
+    static void HashPair(const char *data, size_t len, uint64_t &h1,
+                         uint64_t &h2) {
+        h1 = HashBytes(data, len, 14695981039346656037ULL);
+        h2 = HashBytes(data, len, 0x5bd1e9955bd1e995ULL) | 1;
+    }
+
+    static size_t NextPowerOfTwo(size_t n) {
+        size_t power = 1;
+        while (power < n) {
+            power <<= 1;
+        }
+        return power;
+    }
+
+    std::vector<std::atomic<uint8_t>> counters_;
+};
+
+} // namespace cmudb
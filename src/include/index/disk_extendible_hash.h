@@ -0,0 +1,80 @@
+/**
+ * disk_extendible_hash.h
+ *
+ * Disk-backed extendible hash table: buckets live in buffer pool pages and
+ * the directory in a single header page, recorded under the index name in
+ * the catalog header page like a B+ tree root. A point lookup touches the
+ * directory page plus one bucket page (plus overflow pages once the
+ * directory is maxed out).
+ * (1) We only support unique key
+ * (2) Buckets split and the directory doubles on demand; buckets are not
+ *     merged back on deletes
+ * (3) Operations are serialized by a table mutex; point operations only
+ *     touch two pages so the critical sections stay short
+ */
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction.h"
+#include "page/hash_table_page.h"
+
+namespace cmudb {
+
+class Catalog;
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class DiskExtendibleHash {
+public:
+    explicit DiskExtendibleHash(const std::string &name,
+                                BufferPoolManager *buffer_pool_manager,
+                                const KeyComparator &comparator,
+                                page_id_t header_page_id = INVALID_PAGE_ID,
+                                Catalog *catalog = nullptr);
+
+    // Insert a key-value pair into the hash table.
+    // @return: false when the key already exists
+    bool Insert(const KeyType &key, const ValueType &value,
+                Transaction *transaction = nullptr);
+
+    // Remove a key and its value from the hash table.
+    // @return: true when an entry was removed
+    bool Remove(const KeyType &key, Transaction *transaction = nullptr);
+
+    // return the value associated with a given key
+    bool GetValue(const KeyType &key, std::vector<ValueType> &result,
+                  Transaction *transaction = nullptr);
+
+    // page id of the directory page, recorded in the catalog header page
+    page_id_t GetHeaderPageId() const { return header_page_id_; }
+
+private:
+    using BucketPage = HashTableBucketPage<KeyType, ValueType, KeyComparator>;
+
+    size_t HashKey(const KeyType &key) const;
+
+    BucketPage *NewBucketPage(int local_depth);
+
+    // split a bucket whose local depth is below the global depth and
+    // repoint the directory slots that now belong to the new bucket
+    void SplitBucket(HashTableHeaderPage *header, BucketPage *bucket);
+
+    void UpdateHeaderPageId(bool insert_record);
+
+    template <typename PageType>
+    PageType FetchPage(page_id_t page_id);
+
+    // member variable
+    std::string index_name_;
+    page_id_t header_page_id_;
+    std::mutex table_mutex_;
+    BufferPoolManager *buffer_pool_manager_;
+    KeyComparator comparator_;
+    // header id registration goes through the catalog when one is supplied
+    Catalog *catalog_;
+};
+
+} // namespace cmudb
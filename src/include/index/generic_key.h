@@ -6,6 +6,13 @@
  * This key type uses an fixed length array to hold data for indexing
  * purposes, the actual size of which is specified and instantiated
  * with a template argument.
+ *
+ * Keys over schemas made entirely of fixed-width integer-family columns
+ * are stored normalized: each column's bytes are rewritten big-endian
+ * with the sign bit flipped, an order-preserving encoding, so the
+ * comparator is a single memcmp instead of one Value materialization
+ * and virtual CompareLessThan per column per comparison. ToValue undoes
+ * the encoding, so index-only scans still reconstruct exact values.
  */
 #pragma once
 
@@ -17,16 +24,70 @@
 namespace cmudb {
 template <size_t KeySize> class GenericKey {
 public:
-    inline void SetFromKey(const Tuple &tuple) {
+    // true when every column is inlined with a byte-order-preserving
+    // normalized form, i.e. the whole key can be compared with memcmp
+    static bool IsNormalizable(Schema *schema) {
+        for (int i = 0; i < schema->GetColumnCount(); ++i) {
+            switch (schema->GetType(i)) {
+            case TypeId::BOOLEAN:
+            case TypeId::TINYINT:
+            case TypeId::SMALLINT:
+            case TypeId::INTEGER:
+            case TypeId::BIGINT:
+            case TypeId::TIMESTAMP:
+                break;
+            default:
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // rewrite one serialized column in place into its normalized form:
+    // most significant byte first, sign bit flipped so two's-complement
+    // order matches unsigned byte order (timestamps are unsigned and
+    // only get the byte swap)
+    static void NormalizeColumn(char *bytes, TypeId type) {
+        size_t size = Type::GetTypeSize(type);
+        for (size_t i = 0; i < size / 2; ++i)
+            std::swap(bytes[i], bytes[size - 1 - i]);
+        if (type != TypeId::TIMESTAMP)
+            bytes[0] ^= static_cast<char>(0x80);
+    }
+
+    // inverse of NormalizeColumn
+    static void DenormalizeColumn(char *bytes, TypeId type) {
+        size_t size = Type::GetTypeSize(type);
+        if (type != TypeId::TIMESTAMP)
+            bytes[0] ^= static_cast<char>(0x80);
+        for (size_t i = 0; i < size / 2; ++i)
+            std::swap(bytes[i], bytes[size - 1 - i]);
+    }
+
+    inline void SetFromKey(const Tuple &tuple, Schema *schema = nullptr) {
         // intialize to 0
         memset(data, 0, KeySize);
-        memcpy(data, tuple.GetData(), tuple.GetLength());
+        // the tuple's trailing null bitmap may push it past KeySize;
+        // clamping drops it consistently for every key, and comparisons
+        // go through the column values (or the normalized prefix), which
+        // always fit
+        size_t copy_len = static_cast<size_t>(tuple.GetLength());
+        if (copy_len > KeySize)
+            copy_len = KeySize;
+        memcpy(data, tuple.GetData(), copy_len);
+        if (schema != nullptr && IsNormalizable(schema)) {
+            for (int i = 0; i < schema->GetColumnCount(); ++i)
+                NormalizeColumn(data + schema->GetOffset(i),
+                                schema->GetType(i));
+        }
     }
 
-    // NOTE: for test purpose only
+    // NOTE: for test purpose only; writes the normalized encoding a
+    // single-BIGINT key schema would produce
     inline void SetFromInteger(int64_t key) {
         memset(data, 0, KeySize);
         memcpy(data, &key, sizeof(int64_t));
+        NormalizeColumn(data, TypeId::BIGINT);
     }
 
     inline Value ToValue(Schema *schema, int column_id) const {
@@ -40,13 +101,22 @@ public:
                     const_cast<char *>(data + schema->GetOffset(column_id)));
             data_ptr = (data + offset);
         }
+        if (IsNormalizable(schema)) {
+            char buffer[sizeof(int64_t)];
+            memcpy(buffer, data_ptr, Type::GetTypeSize(column_type));
+            DenormalizeColumn(buffer, column_type);
+            return Value::DeserializeFrom(buffer, column_type);
+        }
         return Value::DeserializeFrom(data_ptr, column_type);
     }
 
     // NOTE: for test purpose only
-    // interpret the first 8 bytes as int64_t from data vector
+    // interpret the first 8 bytes as a normalized int64_t
     inline int64_t ToString() const {
-        return *reinterpret_cast<int64_t *>(const_cast<char *>(data));
+        char buffer[sizeof(int64_t)];
+        memcpy(buffer, data, sizeof(int64_t));
+        DenormalizeColumn(buffer, TypeId::BIGINT);
+        return *reinterpret_cast<int64_t *>(buffer);
     }
 
     // NOTE: for test purpose only
@@ -67,6 +137,15 @@ template <size_t KeySize> class GenericComparator {
 public:
     inline int operator()(const GenericKey<KeySize> &lhs,
                           const GenericKey<KeySize> &rhs) const {
+        // hot path for normalized keys: the encoding is order-preserving
+        // under unsigned bytewise comparison, so one memcmp replaces a
+        // Value materialization and virtual compare per column on every
+        // level of every descent
+        if (normalized_) {
+            int result = memcmp(lhs.data, rhs.data, KeySize);
+            return (result > 0) - (result < 0);
+        }
+
         int column_count = key_schema_->GetColumnCount();
 
         for (int i = 0; i < column_count; i++) {
@@ -83,15 +162,68 @@ public:
         return 0;
     }
 
+    /**
+     * Build a minimal separator for a page split (suffix truncation): keep
+     * the leading columns of "rhs" (first key of the new right page) up to
+     * and including the first column that differs from "lhs" (last key of
+     * the left page), and reset the trailing columns to their type's
+     * minimum. The result still satisfies lhs < separator <= rhs, so it can
+     * be promoted in place of rhs, and comparisons against it short-circuit
+     * as soon as the search key diverges from the shared prefix.
+     */
+    inline GenericKey<KeySize> TruncateSeparator(
+            const GenericKey<KeySize> &lhs,
+            const GenericKey<KeySize> &rhs) const {
+        int column_count = key_schema_->GetColumnCount();
+
+        int keep = 0;
+        while (keep < column_count) {
+            Value lhs_value = (lhs.ToValue(key_schema_, keep));
+            Value rhs_value = (rhs.ToValue(key_schema_, keep));
+            ++keep;
+            if (lhs_value.CompareEquals(rhs_value) != CMP_TRUE) {
+                break;
+            }
+        }
+        // nothing to truncate when the keys only differ in the last column;
+        // non-inlined trailing columns cannot be rebuilt in place
+        if (keep == column_count) {
+            return rhs;
+        }
+        for (int i = keep; i < column_count; i++) {
+            if (!key_schema_->IsInlined(i)) {
+                return rhs;
+            }
+        }
+
+        GenericKey<KeySize> separator = rhs;
+        for (int i = keep; i < column_count; i++) {
+            Value min_value = Type::GetMinValue(key_schema_->GetType(i));
+            min_value.SerializeTo(separator.data + key_schema_->GetOffset(i));
+            if (normalized_) {
+                GenericKey<KeySize>::NormalizeColumn(
+                        separator.data + key_schema_->GetOffset(i),
+                        key_schema_->GetType(i));
+            }
+        }
+        return separator;
+    }
+
     GenericComparator(const GenericComparator &other) {
         this->key_schema_ = other.key_schema_;
+        this->normalized_ = other.normalized_;
     }
 
     // constructor
-    GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+    GenericComparator(Schema *key_schema) : key_schema_(key_schema) {
+        normalized_ = GenericKey<KeySize>::IsNormalizable(key_schema);
+    }
 
 private:
     Schema *key_schema_;
+    // true when the keys carry the normalized byte order and compare
+    // with memcmp instead of going through the type system
+    bool normalized_;
 };
 
 } // namespace cmudb
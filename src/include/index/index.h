@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "catalog/schema.h"
@@ -23,13 +24,19 @@ namespace cmudb {
  * mapping relation and does the conversion between tuple key and index key
  */
 class Transaction;
+
+// access method implementing the index; see ConstructIndex
+enum class IndexType { BPlusTree, Hash };
+
 class IndexMetadata {
     IndexMetadata() = delete;
 
 public:
     IndexMetadata(std::string index_name, std::string table_name,
-                  const Schema *tuple_schema, const std::vector<int> &key_attrs)
-            : name_(index_name), table_name_(table_name), key_attrs_(key_attrs) {
+                  const Schema *tuple_schema, const std::vector<int> &key_attrs,
+                  IndexType index_type = IndexType::BPlusTree)
+            : name_(index_name), table_name_(table_name), key_attrs_(key_attrs),
+              index_type_(index_type) {
         key_schema_ = Schema::CopySchema(tuple_schema, key_attrs_);
     }
 
@@ -51,13 +58,17 @@ public:
     //  columns
     inline const std::vector<int> &GetKeyAttrs() const { return key_attrs_; }
 
+    // Returns the access method implementing this index
+    inline IndexType GetIndexType() const { return index_type_; }
+
     // Get a string representation for debugging
     const std::string ToString() const {
         std::stringstream os;
 
         os << "IndexMetadata["
            << "Name = " << name_ << ", "
-           << "Type = B+Tree, "
+           << "Type = "
+           << (index_type_ == IndexType::Hash ? "Hash" : "B+Tree") << ", "
            << "Table name = " << table_name_ << "] :: ";
         os << key_schema_->ToString();
 
@@ -69,6 +80,8 @@ private:
     std::string table_name_;
     // The mapping relation between key schema and tuple schema
     const std::vector<int> key_attrs_;
+    // access method implementing the index
+    IndexType index_type_;
     // schema of the indexed key
     Schema *key_schema_;
 };
@@ -126,6 +139,15 @@ public:
     virtual void InsertEntry(const Tuple &key, RID rid,
                              Transaction *transaction = nullptr) = 0;
 
+    // insert a batch of entries collected by the caller; index types that
+    // can exploit sorted input override this, the default applies the batch
+    // entry by entry
+    virtual void InsertEntries(std::vector<std::pair<Tuple, RID>> &entries,
+                               Transaction *transaction = nullptr) {
+        for (auto &entry : entries)
+            InsertEntry(entry.first, entry.second, transaction);
+    }
+
     // delete the index entry linked to given tuple
     virtual void DeleteEntry(const Tuple &key,
                              Transaction *transaction = nullptr) = 0;
@@ -133,6 +155,66 @@ public:
     virtual void ScanKey(const Tuple &key, std::vector<RID> &result,
                          Transaction *transaction = nullptr) = 0;
 
+    // index-only variant of ScanKey: additionally returns, for every
+    // matching rid, the indexed column values reconstructed from the stored
+    // key, so a caller whose query touches only indexed columns never has
+    // to fetch the heap row the rid points at. Returns false when the index
+    // cannot reproduce column values from its keys (the default), in which
+    // case both output vectors are untouched
+    virtual bool ScanKeyIndexOnly(const Tuple & /*key*/,
+                                  std::vector<RID> & /*result*/,
+                                  std::vector<std::vector<Value>> & /*values*/,
+                                  Transaction * /*transaction*/ = nullptr) {
+        return false;
+    }
+
+    // collect the rids of every key between "low" and "high", honoring the
+    // inclusivity flags; a null bound leaves that side open. Returns false
+    // when the index type keeps keys unordered and cannot scan a range
+    // (e.g. the hash index), in which case "result" is untouched
+    virtual bool ScanRange(const Tuple * /*low*/, const Tuple * /*high*/,
+                           bool /*low_inclusive*/, bool /*high_inclusive*/,
+                           std::vector<RID> & /*result*/,
+                           Transaction * /*transaction*/ = nullptr) {
+        return false;
+    }
+
+    // index-only variant of ScanRange, with the same contract as
+    // ScanKeyIndexOnly: values[i] holds the indexed column values of the
+    // entry behind result[i]
+    virtual bool ScanRangeIndexOnly(const Tuple * /*low*/,
+                                    const Tuple * /*high*/,
+                                    bool /*low_inclusive*/,
+                                    bool /*high_inclusive*/,
+                                    std::vector<RID> & /*result*/,
+                                    std::vector<std::vector<Value>> & /*values*/,
+                                    Transaction * /*transaction*/ = nullptr) {
+        return false;
+    }
+
+    // a lazy walk over the whole index in key order, handed out by
+    // OpenOrderedScan: batches of rids and their indexed column values are
+    // pulled on demand, so a consumer that stops early (sqlite reads one
+    // row for a MIN/MAX it rewrote into an ordered scan) pays one descent
+    // plus the rows it consumed, never a materialized full scan
+    class OrderedScan {
+    public:
+        virtual ~OrderedScan() = default;
+
+        // append up to n entries to the outputs, values[i] holding the
+        // indexed column values behind result[i]; returns the number
+        // appended, 0 at the end of the index
+        virtual size_t NextBatch(std::vector<RID> &result,
+                                 std::vector<std::vector<Value>> &values,
+                                 size_t n) = 0;
+    };
+
+    // open a lazy full-index walk, ascending or descending; null when the
+    // index keeps keys unordered and cannot serve one (the default)
+    virtual std::unique_ptr<OrderedScan> OpenOrderedScan(bool /*reverse*/) {
+        return nullptr;
+    }
+
 private:
     //===--------------------------------------------------------------------===//
     //  Data members
@@ -3,6 +3,8 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <vector>
+
 #include "page/b_plus_tree_leaf_page.h"
 
 namespace cmudb {
@@ -15,15 +17,26 @@ class IndexIterator {
 public:
     // you may define your own constructor based on your member variables
     IndexIterator(int offset, B_PLUS_TREE_LEAF_PAGE_TYPE *curr_page,
-                  BufferPoolManager *buffer_pool_manager);
+                  BufferPoolManager *buffer_pool_manager,
+                  bool reverse = false);
     ~IndexIterator();
 
+    // an iterator owns a pinned leaf page, so it moves rather than
+    // copies; the moved-from iterator becomes an end iterator
+    IndexIterator(IndexIterator &&other);
+    IndexIterator &operator=(IndexIterator &&other);
+
     bool isEnd();
 
     const MappingType &operator*();
 
     IndexIterator &operator++();
 
+    // copy up to n entries into "out" and advance past them, a leaf at a
+    // time; returns the number copied, 0 at the end of the scan
+    // NOTE: only supported for forward iterators
+    size_t NextBatch(std::vector<MappingType> &out, size_t n);
+
 private:
     // offset of the current pair in page
     int offset_;
@@ -31,6 +44,9 @@ private:
     B_PLUS_TREE_LEAF_PAGE_TYPE *curr_page_;
     // buffer pool manager to fetch pages
     BufferPoolManager *buffer_pool_manager_;
+    // when true, operator++ walks leaves right to left through the
+    // previous page id so descending scans read entries in key order
+    bool reverse_;
 };
 
 } // namespace cmudb
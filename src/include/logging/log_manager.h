@@ -22,16 +22,26 @@ public:
             : offset_(0), next_lsn_(0),
             persistent_lsn_(INVALID_LSN),
             disk_manager_(disk_manager) {
-        // TODO: you may intialize your own defined memeber variables here
-        log_buffer_ = new char[LOG_BUFFER_SIZE];
-        flush_buffer_ = new char[LOG_BUFFER_SIZE];
+        for (size_t i = 0; i < LOG_RING_BUFFERS; ++i) {
+            ring_[i].data = new char[LOG_BUFFER_SIZE];
+            ring_[i].size = 0;
+            ring_[i].last_lsn = INVALID_LSN;
+        }
+        log_buffer_ = ring_[0].data;
+        // appended records land at the end of an existing log file, so the
+        // running byte count starts at its current size
+        int log_size = disk_manager_->GetLogSize();
+        if (log_size > 0) {
+            total_appended_ = log_size;
+        }
     }
 
     ~LogManager() {
-        delete[] log_buffer_;
-        delete[] flush_buffer_;
+        for (size_t i = 0; i < LOG_RING_BUFFERS; ++i) {
+            delete[] ring_[i].data;
+            ring_[i].data = nullptr;
+        }
         log_buffer_ = nullptr;
-        flush_buffer_ = nullptr;
     }
     // spawn a separate thread to wake up periodically to flush
     void RunFlushThread();
@@ -40,31 +50,105 @@ public:
     // append a log record into log buffer
     lsn_t AppendLogRecord(LogRecord &log_record);
 
+    // reserve `size` bytes of the append buffer for a record of the given
+    // type: the lsn is assigned and the 20-byte header written under the
+    // latch, and the returned pointer is where the caller serializes the
+    // payload in place (latch-free, exactly once) before FinishAppend.
+    // The slot cannot seal while a reservation is outstanding, so fills
+    // must be short: memcpys of bytes the caller already has in hand
+    char *ReserveLogRecord(int32_t size, txn_id_t txn_id, lsn_t prev_lsn,
+                           LogRecordType log_record_type, lsn_t &lsn);
+
+    // publish a filled reservation; the record becomes eligible to flush
+    void FinishAppend();
+
     // get/set helper functions
     inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
+    inline lsn_t GetNextLSN() { return next_lsn_; }
     inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
     inline char *GetLogBuffer() { return log_buffer_; }
 
+    // total bytes of log records appended so far, i.e. the file offset the
+    // next record will land on once flushed
+    inline size_t GetTotalAppended() {
+        std::lock_guard<std::mutex> guard(latch_);
+        return total_appended_;
+    }
+
+    // the flush cadence the thread is currently running at, i.e. the
+    // longest a record sits in the buffer before a periodic wakeup picks
+    // it up; shrinks under load and stretches back to LOG_TIMEOUT when idle
+    inline std::chrono::microseconds GetEffectiveFlushLatency() {
+        std::lock_guard<std::mutex> guard(latch_);
+        return flush_interval_;
+    }
+
     // force/wait for log flush to complete
     void ForceLogFlushAndWait();
     void WaitForLogFlush();
 
+    // group commit: register a committing transaction and block until a log
+    // flush covers its commit record. The flush thread batches everyone who
+    // registers within a short adaptive window into one disk write
+    void GroupCommitAndWait(lsn_t lsn);
+
 private:
-    // swap log buffer and flush buffer and return size of bytes to flush
-    int SwapBuffer();
+    // one slot of the buffer ring: a sealed slot holds size bytes of
+    // serialized records, the last of which has lsn last_lsn, and waits for
+    // the flush thread to write it out
+    struct LogBufferSlot {
+        char *data;
+        int size;
+        lsn_t last_lsn;
+    };
+    // serialize the delta body of an UPDATE record (or of a CLR wrapping
+    // one) into the staging buffer at pos; returns the position past it
+    static int SerializeUpdateDelta(const LogRecord &log_record, char *staging,
+                                    int pos);
+    // seal the append buffer and move appenders to the next free slot;
+    // returns false if the buffer is empty, a reservation is still being
+    // filled, or every other slot still awaits a flush. Caller must hold
+    // latch_
+    bool SealAppendBuffer();
+    // make room for `size` more bytes in the append buffer: seal and move
+    // to a fresh ring slot when one is free, otherwise wait for the flush
+    // thread to retire a slot. Caller must hold `lock`, held again on
+    // return
+    void WaitForAppendSpace(std::unique_lock<std::mutex> &lock, int32_t size);
     // flsuh log buffer to disk
     void FlushLog();
     // offset in the log buffer
     int offset_;
+    // running byte count of all records ever appended, guarded by latch_
+    size_t total_appended_ = 0;
+    // committers waiting for the next flush, guarded by latch_
+    int pending_commits_ = 0;
+    // reservations handed out but not yet finished; their bytes are still
+    // being written in place, so the append buffer must not seal while
+    // this is non-zero. Guarded by latch_
+    int inflight_fills_ = 0;
+    // how long the flush thread lingers for more commits to arrive once one
+    // is waiting; adapted between flushes based on how well batching works
+    std::chrono::microseconds group_commit_window_{200};
+    // how long the flush thread sleeps between wakeups; halved after a
+    // round that wrote something, doubled (up to LOG_TIMEOUT) after an
+    // idle one, guarded by latch_. See GetEffectiveFlushLatency
+    std::chrono::microseconds flush_interval_{
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::seconds(1))};
     // atomic counter, record the next log sequence number
     std::atomic<lsn_t> next_lsn_;
     // log records before & include persistent_lsn_ have been written to disk
     std::atomic<lsn_t> persistent_lsn_;
     // a future to wait on for log flush to complete
     std::shared_future<void> flush_future_;
-    // log buffer related
-    char *log_buffer_;
-    char *flush_buffer_;
+    // ring of log buffers: appenders fill ring_[append_slot_] through
+    // log_buffer_ while the flush thread drains sealed slots starting at
+    // flush_slot_, so appends keep going while flushes are in flight
+    LogBufferSlot ring_[LOG_RING_BUFFERS];
+    size_t append_slot_ = 0; // slot appenders are filling
+    size_t flush_slot_ = 0;  // oldest sealed slot awaiting flush
+    char *log_buffer_;       // alias of ring_[append_slot_].data
     // latch to protect shared member variables
     std::mutex latch_;
     // flush thread
@@ -14,18 +14,23 @@
  *-------------------------------------------------------------
  * | HEADER | tuple_rid | tuple_size | tuple_data(char[] array) |
  *-------------------------------------------------------------
- * For update type log record
+ * For update type log record, only the bytes that differ between the two
+ * images are logged (plus the length of the shared prefix/suffix); the full
+ * images are rebuilt during recovery from the page's current tuple
  *------------------------------------------------------------------------------
- * | HEADER | tuple_rid | tuple_size | old_tuple_data | tuple_size |
- * | new_tuple_data |
+ * | HEADER | tuple_rid | prefix_len | suffix_len | old_middle_len |
+ * | old_middle_data | new_middle_len | new_middle_data |
  *------------------------------------------------------------------------------
- * For new page type log record
+ * For new page type log record; the created page's own id is logged too,
+ * so replay can initialize that exact page instead of hoping a fresh
+ * allocation hands back the same id
  *-------------------------------------------------------------
- * | HEADER | prev_page_id |
+ * | HEADER | prev_page_id | page_id |
  *-------------------------------------------------------------
  */
 #pragma once
 #include <cassert>
+#include <string>
 
 #include "common/config.h"
 #include "table/tuple.h"
@@ -44,6 +49,17 @@ enum class LogRecordType {
     ABORT,
     // when create a new page in heap table
     NEWPAGE,
+    // written by CheckpointManager; every record before it is durable, so
+    // recovery may start its log scan here
+    CHECKPOINT,
+    // compensation log record: a redo-only record of the compensating
+    // action applied while undoing another record; undo never re-undoes a
+    // CLR, it jumps straight to the CLR's undo_next_lsn
+    CLR,
+    // bulk truncation of a table heap: one record (carrying the first page
+    // id) stands in for the per-row deletes of the whole chain. Written
+    // outside any transaction chain and never undone, like CHECKPOINT
+    TRUNCATE,
 };
 
 class LogRecord {
@@ -79,30 +95,79 @@ public:
         size_ = HEADER_SIZE + sizeof(RID) + sizeof(int32_t) + tuple.GetLength();
     }
 
-    // constructor for UPDATE type
+    // constructor for UPDATE type: the record stores a byte-level delta
+    // between the two images (shared prefix/suffix lengths plus the
+    // differing middle of each), so narrow updates of wide tuples log a
+    // handful of bytes instead of two full images
     LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type,
               const RID &update_rid, const Tuple &old_tuple,
               const Tuple &new_tuple)
             : lsn_(INVALID_LSN), txn_id_(txn_id), prev_lsn_(prev_lsn),
               log_record_type_(log_record_type), update_rid_(update_rid),
               old_tuple_(old_tuple), new_tuple_(new_tuple) {
+        const char *old_data = old_tuple.GetData();
+        const char *new_data = new_tuple.GetData();
+        const int32_t old_size = old_tuple.GetLength();
+        const int32_t new_size = new_tuple.GetLength();
+        const int32_t min_size = old_size < new_size ? old_size : new_size;
+
+        while (update_prefix_len_ < min_size &&
+               old_data[update_prefix_len_] == new_data[update_prefix_len_])
+            ++update_prefix_len_;
+        while (update_suffix_len_ < min_size - update_prefix_len_ &&
+               old_data[old_size - 1 - update_suffix_len_] ==
+                       new_data[new_size - 1 - update_suffix_len_])
+            ++update_suffix_len_;
+
+        old_middle_.assign(old_data + update_prefix_len_,
+                           old_size - update_prefix_len_ - update_suffix_len_);
+        new_middle_.assign(new_data + update_prefix_len_,
+                           new_size - update_prefix_len_ - update_suffix_len_);
         // calculate log record size
-        size_ = HEADER_SIZE + sizeof(RID) + old_tuple.GetLength() +
-                new_tuple.GetLength() + 2 * sizeof(int32_t);
+        size_ = HEADER_SIZE + sizeof(RID) + 4 * sizeof(int32_t) +
+                (int32_t)old_middle_.size() + (int32_t)new_middle_.size();
     }
 
-    // constructor for NEWPAGE type
+    // constructor for NEWPAGE/TRUNCATE type; NEWPAGE also carries the
+    // created page's id, TRUNCATE only the chain's first page id
     LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type,
-              page_id_t page_id)
+              page_id_t page_id, page_id_t new_page_id = INVALID_PAGE_ID)
             : size_(HEADER_SIZE), lsn_(INVALID_LSN), txn_id_(txn_id),
               prev_lsn_(prev_lsn), log_record_type_(log_record_type),
-              prev_page_id_(page_id) {
+              prev_page_id_(page_id), page_id_(new_page_id) {
         // calculate log record size
         size_ = HEADER_SIZE + sizeof(page_id_t);
+        if (log_record_type == LogRecordType::NEWPAGE) {
+            size_ += sizeof(page_id_t);
+        }
+    }
+
+    // constructor for CLR type: wraps the compensating action (built with
+    // one of the ctors above) and remembers which record to undo next
+    LogRecord(txn_id_t txn_id, lsn_t prev_lsn, lsn_t undo_next_lsn,
+              const LogRecord &action)
+            : lsn_(INVALID_LSN), txn_id_(txn_id), prev_lsn_(prev_lsn),
+              log_record_type_(LogRecordType::CLR),
+              delete_rid_(action.delete_rid_),
+              delete_tuple_(action.delete_tuple_),
+              insert_rid_(action.insert_rid_),
+              insert_tuple_(action.insert_tuple_),
+              update_rid_(action.update_rid_), old_tuple_(action.old_tuple_),
+              new_tuple_(action.new_tuple_),
+              update_prefix_len_(action.update_prefix_len_),
+              update_suffix_len_(action.update_suffix_len_),
+              old_middle_(action.old_middle_),
+              new_middle_(action.new_middle_),
+              undo_next_lsn_(undo_next_lsn),
+              clr_action_type_(action.log_record_type_) {
+        // the wrapped action's body plus undo_next_lsn and the action type
+        size_ = action.size_ + sizeof(lsn_t) + sizeof(int32_t);
     }
 
     ~LogRecord() {}
 
+    inline lsn_t GetUndoNextLSN() { return undo_next_lsn_; }
+
     inline RID &GetDeleteRID() { return delete_rid_; }
 
     inline Tuple &GetInserteTuple() { return insert_tuple_; }
@@ -134,6 +199,10 @@ public:
         return os.str();
     }
 
+    // serialized size of the common header fields, also the payload offset
+    // for callers filling a LogManager reservation in place
+    const static int HEADER_SIZE = 20;
+
 private:
     // the length of log record(for serialization, in bytes)
     int32_t size_ = 0;
@@ -151,14 +220,27 @@ private:
     RID insert_rid_;
     Tuple insert_tuple_;
 
-    // case3: for update opeartion
+    // case3: for update opeartion. The full images are only populated on
+    // the producing side (and rematerialized from the page during
+    // recovery); what is serialized is the byte delta below
     RID update_rid_;
     Tuple old_tuple_;
     Tuple new_tuple_;
+    int32_t update_prefix_len_ = 0; // bytes shared at the front of both images
+    int32_t update_suffix_len_ = 0; // bytes shared at the back of both images
+    std::string old_middle_;        // differing bytes of the before image
+    std::string new_middle_;        // differing bytes of the after image
 
-    // case4: for new page opeartion
+    // case4: for new page opeartion (prev_page_id_ doubles as the first
+    // page id of a TRUNCATE); page_id_ is the page the NEWPAGE created
     page_id_t prev_page_id_ = INVALID_PAGE_ID;
-    const static int HEADER_SIZE = 20;
+    page_id_t page_id_ = INVALID_PAGE_ID;
+
+    // case5: for CLR, the record to undo after this one (INVALID_LSN when
+    // the transaction is fully undone) and which of the cases above holds
+    // the compensating action's payload
+    lsn_t undo_next_lsn_ = INVALID_LSN;
+    LogRecordType clr_action_type_ = LogRecordType::INVALID;
 }; // namespace cmudb
 
 } // namespace cmudb
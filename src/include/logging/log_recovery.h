@@ -6,7 +6,9 @@
 #pragma once
 #include <algorithm>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
@@ -14,12 +16,18 @@
 
 namespace cmudb {
 
+class TablePage;
+
 class LogRecovery {
 public:
+    // when a log manager is supplied, Undo writes a CLR for every
+    // compensating action (and a closing ABORT record per transaction), so
+    // a crash during recovery resumes where the last flushed CLR left off
     LogRecovery(DiskManager *disk_manager,
-                BufferPoolManager *buffer_pool_manager)
+                BufferPoolManager *buffer_pool_manager,
+                LogManager *log_manager = nullptr)
             : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager),
-              offset_(0) {
+              log_manager_(log_manager), offset_(0) {
         // global transaction through recovery phase
         log_buffer_ = new char[LOG_BUFFER_SIZE];
     }
@@ -33,9 +41,39 @@ public:
     void Undo();
     bool DeserializeLogRecord(const char *data, LogRecord &log_record);
 
+    // rolling apply for a log-shipped standby: replay every complete
+    // record in the batch, in order, and return the bytes consumed. A
+    // trailing partial record is left for the caller to resend once the
+    // primary has flushed the rest of it. Unlike the startup Redo this is
+    // called repeatedly on a live replica, so records are applied serially
+    // on the caller's thread and no transaction table is kept: undo is the
+    // primary's job, the standby only ever mirrors flushed history
+    int ApplyBatch(const char *data, int size);
+
+    // lsn of the last record ApplyBatch replayed, INVALID_LSN before the
+    // first one
+    inline lsn_t GetAppliedLSN() const { return applied_lsn_; }
+
 private:
+    // delta update records: parse the serialized delta body, and rebuild
+    // the full before/after images against the page's current tuple
+    void DeserializeUpdateDelta(const char *data, LogRecord &log_record);
+    void MaterializeUpdateTuples(TablePage *page, LogRecord &record,
+                                 bool current_is_old);
+
+    // replay one tuple-level record against its page unless the page
+    // already carries its effect (page lsn >= record lsn)
+    void RedoPageRecord(LogRecord &log_record);
+
+    // replay the page-structure records; these rewrite the page chain and
+    // must stay ordered with respect to everything else
+    void ReplayNewPage(LogRecord &log_record);
+    void ReplayTruncate(LogRecord &log_record);
+
     DiskManager *disk_manager_;
     BufferPoolManager *buffer_pool_manager_;
+    // optional, for writing CLRs during undo
+    LogManager *log_manager_;
     // maintain active transactions and its corresponds latest lsn
     std::unordered_map<txn_id_t, lsn_t> active_txn_;
     // mapping log sequence number to log file offset, for undo purpose
@@ -43,6 +81,8 @@ private:
     // log buffer related
     int offset_;
     char *log_buffer_;
+    // lsn of the last record applied by ApplyBatch (rolling mode)
+    lsn_t applied_lsn_ = INVALID_LSN;
 };
 
 } // namespace cmudb
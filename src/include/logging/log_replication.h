@@ -0,0 +1,103 @@
+/**
+ * log_replication.h
+ * Log shipping for read replicas: a shipper on the primary follows the
+ * flushed log through the disk manager and forwards it, batch by batch,
+ * to an applier that replays it on the standby's buffer pool through
+ * LogRecovery's rolling mode. The primary's commit path is untouched —
+ * only bytes the flush thread already wrote are ever shipped — and the
+ * replica exposes the lsn it has caught up to, so scan traffic can be
+ * pointed at it with a known staleness bound.
+ */
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "logging/log_recovery.h"
+
+namespace cmudb {
+
+/**
+ * standby side: receives batches of raw log bytes, in log order and
+ * possibly cut mid-record, and replays every complete record against the
+ * replica's buffer pool. The transport hands batches in here directly;
+ * a network receiver slots in by forwarding the same byte stream
+ */
+class ReplicaApplier {
+public:
+    ReplicaApplier(DiskManager *disk_manager,
+                   BufferPoolManager *buffer_pool_manager)
+            : recovery_(disk_manager, buffer_pool_manager) {}
+
+    // replay the complete records of one batch; returns the bytes
+    // consumed, a trailing partial record is resent with the next batch
+    int ApplyBatch(const char *data, int size) {
+        std::lock_guard<std::mutex> guard(apply_latch_);
+        int consumed = recovery_.ApplyBatch(data, size);
+        if (consumed > 0) {
+            replication_lsn_ = recovery_.GetAppliedLSN();
+        }
+        return consumed;
+    }
+
+    // lsn of the last record applied, INVALID_LSN before the first batch;
+    // readable from any thread while the shipper keeps applying
+    inline lsn_t GetReplicationLSN() { return replication_lsn_; }
+
+private:
+    LogRecovery recovery_;
+    // batches must land in log order, so applies are serialized
+    std::mutex apply_latch_;
+    std::atomic<lsn_t> replication_lsn_{INVALID_LSN};
+};
+
+/**
+ * primary side: reads everything the flush thread has written but the
+ * replica has not consumed yet and ships it in LOG_BUFFER_SIZE batches,
+ * either on demand (ShipBatch) or continuously on a background thread
+ * that trails the flush cadence
+ */
+class LogShipper {
+public:
+    LogShipper(DiskManager *disk_manager, ReplicaApplier *replica)
+            : disk_manager_(disk_manager), replica_(replica) {
+        ship_buffer_ = new char[LOG_BUFFER_SIZE];
+    }
+
+    ~LogShipper() {
+        if (shipper_thread_ != nullptr) {
+            StopShipperThread();
+        }
+        delete[] ship_buffer_;
+        ship_buffer_ = nullptr;
+    }
+
+    // ship every flushed byte not yet consumed by the replica; returns
+    // the number of bytes it accepted
+    int ShipBatch();
+
+    // spawn/stop a thread that follows the log continuously; Stop drains
+    // whatever the final flush left behind before returning
+    void RunShipperThread();
+    void StopShipperThread();
+
+    // primary log offset up to which the replica has applied
+    inline int GetShippedOffset() { return shipped_offset_; }
+
+private:
+    DiskManager *disk_manager_;
+    ReplicaApplier *replica_;
+    char *ship_buffer_;
+    // advanced only by bytes the applier reports consumed, so a partial
+    // record tail is automatically re-read once the rest of it flushes
+    std::atomic<int> shipped_offset_{0};
+    std::thread *shipper_thread_ = nullptr;
+    std::atomic<bool> shipping_{false};
+    // for waking/stopping the shipper thread
+    std::mutex latch_;
+    std::condition_variable cv_;
+};
+
+} // namespace cmudb
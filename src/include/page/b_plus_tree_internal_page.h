@@ -12,6 +12,12 @@
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * The header additionally holds the right sibling page id and the high key
+ * (B-link style): the exclusive upper bound on keys under this page, only
+ * meaningful while a right sibling exists. A search finding its key beyond
+ * the high key chases the sibling instead of descending into the wrong
+ * subtree after a concurrent split.
  */
 
 #pragma once
@@ -31,6 +37,11 @@ public:
     // must call initialize method after "create" a new node
     void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID);
 
+    page_id_t GetNextPageId() const;
+    void SetNextPageId(page_id_t next_page_id);
+    bool HasHighKey() const;
+    KeyType GetHighKey() const;
+    void SetHighKey(const KeyType &high_key);
     KeyType KeyAt(int index) const;
     void SetKeyAt(int index, const KeyType &key);
     int ValueIndex(const ValueType &value) const;
@@ -44,8 +55,10 @@ public:
     void Remove(int index);
     ValueType RemoveAndReturnOnlyChild();
 
+    // a positive move_count moves that many trailing entries instead of half
     void MoveHalfTo(BPlusTreeInternalPage *recipient,
-                    BufferPoolManager *buffer_pool_manager);
+                    BufferPoolManager *buffer_pool_manager,
+                    int move_count = 0);
     void MoveAllTo(BPlusTreeInternalPage *recipient, int index_in_parent,
                    BufferPoolManager *buffer_pool_manager);
     void MoveFirstToEndOf(BPlusTreeInternalPage *recipient,
@@ -68,6 +81,8 @@ private:
                       BufferPoolManager *buffer_pool_manager);
     void CopyFirstFrom(const MappingType &pair,
                        BufferPoolManager *buffer_pool_manager);
+    page_id_t next_page_id_;
+    KeyType high_key_;
     MappingType array[0];
 };
 } // namespace cmudb
@@ -10,13 +10,18 @@
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 24 bytes in total):
+ *  Header format (size in byte, 24 bytes + one key in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | CurrentSize (4) | MaxSize (4) | ParentPageId (4) |
  *  ---------------------------------------------------------------------
- *  ------------------------------
- * | PageId (4) | NextPageId (4)
- *  ------------------------------
+ *  ----------------------------------------------------------------
+ * | PageId (4) | NextPageId (4) | PrevPageId (4) | HighKey (key)
+ *  ----------------------------------------------------------------
+ *
+ * The high key is the exclusive upper bound on keys in this page (B-link
+ * style); it is only meaningful while a right sibling exists and lets a
+ * search detect that a concurrent split carried its key range to the
+ * sibling.
  */
 #pragma once
 #include <utility>
@@ -41,6 +46,11 @@ public:
     // helper methods
     page_id_t GetNextPageId() const;
     void SetNextPageId(page_id_t next_page_id);
+    page_id_t GetPrevPageId() const;
+    void SetPrevPageId(page_id_t prev_page_id);
+    bool HasHighKey() const;
+    KeyType GetHighKey() const;
+    void SetHighKey(const KeyType &high_key);
     KeyType KeyAt(int index) const;
     ValueType ValueAt(int index) const;
     int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
@@ -53,11 +63,18 @@ public:
                 const KeyComparator &comparator) const;
     int RemoveAndDeleteRecord(const KeyType &key,
                               const KeyComparator &comparator);
-    // Split and Merge utility methods
+    // remove every entry whose key lies in [low, high] with one pass over
+    // the array instead of one shift per key
+    // @return: number of entries removed
+    int RemoveRange(const KeyType &low, const KeyType &high,
+                    const KeyComparator &comparator);
+    // Split and Merge utility methods; a positive move_count moves that
+    // many trailing entries instead of half
     void MoveHalfTo(BPlusTreeLeafPage *recipient,
-                    BufferPoolManager *buffer_pool_manager /* Unused */);
+                    BufferPoolManager *buffer_pool_manager,
+                    int move_count = 0);
     void MoveAllTo(BPlusTreeLeafPage *recipient, int /* Unused */,
-                   BufferPoolManager * /* Unused */);
+                   BufferPoolManager *buffer_pool_manager);
     void MoveFirstToEndOf(BPlusTreeLeafPage *recipient, int parent_index,
                           BufferPoolManager *buffer_pool_manager);
     void MoveLastToFrontOf(BPlusTreeLeafPage *recipient, int parent_index,
@@ -71,6 +88,8 @@ private:
     void CopyLastFrom(const MappingType &item);
     void CopyFirstFrom(const MappingType &item);
     page_id_t next_page_id_;
+    page_id_t prev_page_id_;
+    KeyType high_key_;
     MappingType array[0];
 };
 } // namespace cmudb
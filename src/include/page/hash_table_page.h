@@ -0,0 +1,86 @@
+/**
+ * hash_table_page.h
+ *
+ * Page layouts for the disk-backed extendible hash index.
+ *
+ * Header page format (size in byte):
+ *  ----------------------------------------------------------------------
+ * | PageId (4) | GlobalDepth (4) | BucketPageId(1) | BucketPageId(2) ... |
+ *  ----------------------------------------------------------------------
+ * The directory holds 2^GlobalDepth bucket page ids; the page size caps
+ * the global depth (see MaxGlobalDepth).
+ *
+ * Bucket page format (keys are unordered, size in byte, 20 byte header):
+ *  ---------------------------------------------------------------------
+ * | PageId (4) | CurrentSize (4) | MaxSize (4) | LocalDepth (4) |
+ *  ---------------------------------------------------------------------
+ *  ----------------------------------------------------------
+ * | NextPageId (4) | KEY(1) + VALUE(1) | ... | KEY(n) + VALUE(n)
+ *  ----------------------------------------------------------
+ * NextPageId chains overflow pages; the chain is only used once the
+ * directory cannot grow any further.
+ */
+#pragma once
+
+#include <utility>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+class HashTableHeaderPage {
+public:
+    void Init(page_id_t page_id);
+    page_id_t GetPageId() const;
+    int GetGlobalDepth() const;
+    void SetGlobalDepth(int global_depth);
+    // number of directory entries, 2^GlobalDepth
+    int GetDirectorySize() const;
+    page_id_t GetBucketPageId(int index) const;
+    void SetBucketPageId(int index, page_id_t page_id);
+    // largest global depth whose directory still fits in one page
+    static int MaxGlobalDepth();
+
+private:
+    page_id_t page_id_;
+    int32_t global_depth_;
+    page_id_t directory_[0];
+};
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class HashTableBucketPage {
+public:
+    // After creating a new bucket page from buffer pool, must call initialize
+    // method to set default values
+    void Init(page_id_t page_id, int local_depth);
+    // helper methods
+    page_id_t GetPageId() const;
+    int GetSize() const;
+    int GetMaxSize() const;
+    int GetLocalDepth() const;
+    void SetLocalDepth(int local_depth);
+    page_id_t GetNextPageId() const;
+    void SetNextPageId(page_id_t next_page_id);
+    KeyType KeyAt(int index) const;
+    ValueType ValueAt(int index) const;
+
+    // lookup, insert and delete methods
+    bool Lookup(const KeyType &key, ValueType &value,
+                const KeyComparator &comparator) const;
+    // @return: false when the key already exists or the page is full
+    bool Insert(const KeyType &key, const ValueType &value,
+                const KeyComparator &comparator);
+    bool Remove(const KeyType &key, const KeyComparator &comparator);
+    // remove the entry at "index", filling the hole with the last entry
+    void RemoveAt(int index);
+
+private:
+    page_id_t page_id_;
+    int32_t size_;
+    int32_t max_size_;
+    int32_t local_depth_;
+    page_id_t next_page_id_;
+    std::pair<KeyType, ValueType> array[0];
+};
+
+} // namespace cmudb
@@ -5,10 +5,14 @@
  * our case, we will contain information about table/index name (length less than
  * 32 bytes) and their corresponding root_id
  *
+ * When one page fills up the catalog continues on an overflow page, linked
+ * through NextPageId (INVALID_PAGE_ID terminates the chain); the Catalog
+ * class walks the chain and caches it, pages only store the records.
+ *
  * Format (size in byte):
- *  -----------------------------------------------------------------
- * | RecordCount (4) | Entry_1 name (32) | Entry_1 root_id (4) | ... |
- *  -----------------------------------------------------------------
+ *  ----------------------------------------------------------------------
+ * | RecordCount (4) | NextPageId (4) | Entry_1 name (32) | root_id (4) | ... |
+ *  ----------------------------------------------------------------------
  */
 
 #pragma once
@@ -21,7 +25,10 @@ namespace cmudb {
 
 class HeaderPage : public Page {
 public:
-    void Init() { SetRecordCount(0); }
+    void Init() {
+        SetRecordCount(0);
+        SetNextPageId(INVALID_PAGE_ID);
+    }
     /**
      * Record related
      */
@@ -33,6 +40,18 @@ public:
     bool GetRootId(const std::string &name, page_id_t &root_id);
     int GetRecordCount();
 
+    // read the name/root pair at a slot, for chain loading
+    void GetRecord(int index, std::string &name, page_id_t &root_id);
+
+    // overflow chain
+    page_id_t GetNextPageId();
+    void SetNextPageId(page_id_t next_page_id);
+
+    // records one page can hold before the catalog must chain
+    static constexpr int GetMaxRecordCount() {
+        return (PAGE_SIZE - 8) / 36;
+    }
+
 private:
     /**
      * helper functions
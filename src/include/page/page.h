@@ -8,10 +8,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
 
 #include "common/config.h"
+#include "common/latch_profiler.h"
 #include "common/rwmutex.h"
 
 namespace cmudb {
@@ -28,11 +31,45 @@ public:
     inline page_id_t GetPageId() { return page_id_; }
     // get page pin count
     inline int GetPinCount() { return pin_count_; }
-    // method use to latch/unlatch page content
-    inline void WUnlatch() { rwlatch_.WUnlock(); }
-    inline void WLatch() { rwlatch_.WLock(); }
+    // method use to latch/unlatch page content; the version counter is
+    // bumped when the write latch is taken and again when it is released,
+    // so it is odd exactly while a writer holds the page and optimistic
+    // readers can validate their reads without touching the latch
+    inline void WUnlatch() {
+        version_.fetch_add(1);
+        rwlatch_.WUnlock();
+    }
+    inline void WLatch() {
+        // with the profiler on, a failed single attempt marks the
+        // acquisition contended and its wait gets timed and attributed
+        bool profiled = LatchProfiler::IsEnabled();
+        if (!profiled) {
+            rwlatch_.WLock();
+        } else if (!rwlatch_.TryWLock()) {
+            uint64_t start = __rdtsc();
+            rwlatch_.WLock();
+            LatchProfiler::Instance().OnContended(
+                    page_id_, true, __rdtsc() - start,
+                    __builtin_return_address(0));
+        }
+        version_.fetch_add(1);
+    }
     inline void RUnlatch() { rwlatch_.RUnlock(); }
-    inline void RLatch() { rwlatch_.RLock(); }
+    inline void RLatch() {
+        bool profiled = LatchProfiler::IsEnabled();
+        if (!profiled) {
+            rwlatch_.RLock();
+        } else if (!rwlatch_.TryRLock()) {
+            uint64_t start = __rdtsc();
+            rwlatch_.RLock();
+            LatchProfiler::Instance().OnContended(
+                    page_id_, false, __rdtsc() - start,
+                    __builtin_return_address(0));
+        }
+    }
+
+    // page content version, see WLatch/WUnlatch above
+    inline uint64_t GetVersion() { return version_.load(); }
 
     inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + 4); }
     inline void SetLSN(lsn_t lsn) { memcpy(GetData() + 4, &lsn, 4); }
@@ -42,9 +79,12 @@ private:
     inline void ResetMemory() { memset(data_, 0, PAGE_SIZE); }
     // members
     char data_[PAGE_SIZE]; // actual data
-    page_id_t page_id_ = INVALID_PAGE_ID;
-    int pin_count_ = 0;
-    bool is_dirty_ = false;
+    // bookkeeping fields are atomic so the buffer pool can pin/unpin a
+    // cached page without holding its shard latch
+    std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+    std::atomic<int> pin_count_{0};
+    std::atomic<bool> is_dirty_{false};
+    std::atomic<uint64_t> version_{0};
     RWMutex rwlatch_;
 };
 
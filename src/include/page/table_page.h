@@ -37,11 +37,18 @@ public:
      */
     void Init(page_id_t page_id, size_t page_size, page_id_t prev_page_id,
               LogManager *log_manager, Transaction *txn);
+    // wipe the page back to freshly-initialized empty, detached from the
+    // chain and without logging; truncation (and its redo) covers the wipe
+    // with a single TRUNCATE record instead
+    void Reset(size_t page_size);
     page_id_t GetPageId();
     page_id_t GetPrevPageId();
     page_id_t GetNextPageId();
     void SetPrevPageId(page_id_t prev_page_id);
     void SetNextPageId(page_id_t next_page_id);
+    // bytes left between the slot array and the tuple area, consulted by the
+    // table heap's free space map
+    int32_t GetFreeSpaceSize();
 
     /**
      * Tuple related
@@ -65,6 +72,22 @@ public:
     bool GetTuple(const RID &rid, Tuple &tuple, Transaction *txn,
                   LockManager *lock_manager);
 
+    // copy out the slot contents even when the tuple is mark-deleted and
+    // without lock acquisition; used by the table heap to reclaim overflow
+    // chains at ApplyDelete time
+    bool GetTupleRaw(const RID &rid, Tuple &tuple);
+
+    // like GetTuple, but the returned tuple points straight into the page
+    // buffer instead of a heap copy; only valid while the caller keeps the
+    // page read-latched and pinned
+    bool GetTupleView(const RID &rid, Tuple &tuple, Transaction *txn,
+                      LockManager *lock_manager);
+
+    // drop trailing empty slots from the slot array. Interior empty slots
+    // must stay (rids embed slot numbers) but are reused by inserts; only
+    // the tail can shrink. Returns the number of slots reclaimed
+    int32_t TrimEmptySlots();
+
     /**
      * Tuple iterator
      */
@@ -75,9 +98,19 @@ private:
     /**
      * helper functions
      */
-    void AppendLogRecord(LogManager *log_manager,
-                         LogRecord &log_record,
-                         Transaction *txn);
+    // serialize an INSERT/DELETE-type record straight into the log buffer
+    // through a LogManager reservation: the rid and tuple bytes are copied
+    // exactly once, into the reserved slice, instead of into a LogRecord,
+    // a staging buffer and the log buffer in turn
+    void AppendTupleLogRecord(LogManager *log_manager,
+                              LogRecordType log_record_type, const RID &rid,
+                              const Tuple &tuple, Transaction *txn);
+    // same for an UPDATE record: the shared prefix/suffix of the two
+    // images is measured against the tuple data in place and only the
+    // differing middles are copied into the reservation
+    void AppendUpdateLogRecord(LogManager *log_manager, const RID &rid,
+                               const Tuple &old_tuple, const Tuple &new_tuple,
+                               Transaction *txn);
     int32_t GetTupleOffset(int slot_num);
     int32_t GetTupleSize(int slot_num);
     void SetTupleOffset(int slot_num, int32_t offset);
@@ -87,6 +120,5 @@ private:
     int32_t GetTupleCount(); // Note that this tuple count may be larger than # of
     // actual tuples because some slots may be empty
     void SetTupleCount(int32_t tuple_count);
-    int32_t GetFreeSpaceSize();
 };
 } // namespace cmudb
@@ -0,0 +1,78 @@
+/**
+ * column_dictionary.h
+ *
+ * Dictionary encoding for low-cardinality VARCHAR columns. A column opts
+ * in through the "dict_" name prefix (the same convention the "hash_"
+ * prefix uses to select an index type): its strings are mapped to int32
+ * codes through a ColumnDictionary, and DictionaryCodec rewrites tuples
+ * against an encoded schema where those columns are INTEGER. Encoded
+ * tuples are a fraction of the original size on disk and in the buffer
+ * pool, and equality predicates over them compare integer codes.
+ *
+ * The dictionary serializes as | Count (4) | [Len (4) | Bytes] ... | so a
+ * table can persist it in a single page next to its catalog entry.
+ */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "table/tuple.h"
+
+namespace cmudb {
+
+class ColumnDictionary {
+public:
+    ColumnDictionary() = default;
+
+    // return the code for "value", assigning the next one if it is new
+    int32_t GetOrAddCode(const std::string &value);
+    // return the code for "value", or -1 if it has never been seen
+    int32_t GetCode(const std::string &value) const;
+    const std::string &GetValue(int32_t code) const;
+    int32_t GetSize() const { return static_cast<int32_t>(values_.size()); }
+
+    int32_t GetSerializedSize() const;
+    void SerializeTo(char *storage) const;
+    void DeserializeFrom(const char *storage);
+
+private:
+    // code -> string; codes are assigned densely in insertion order
+    std::vector<std::string> values_;
+    // string -> code
+    std::unordered_map<std::string, int32_t> codes_;
+};
+
+class DictionaryCodec {
+public:
+    // discovers "dict_"-prefixed varchar columns and builds the encoded
+    // schema with those columns replaced by INTEGER codes
+    explicit DictionaryCodec(Schema *schema);
+    ~DictionaryCodec();
+
+    // whether any column in the schema opted into dictionary encoding
+    bool IsEncoded() const { return !dict_columns_.empty(); }
+    Schema *GetEncodedSchema() { return encoded_schema_; }
+    const std::vector<int> &GetDictionaryColumns() const {
+        return dict_columns_;
+    }
+    ColumnDictionary &GetDictionary(int column_id) {
+        return dictionaries_[column_id];
+    }
+
+    // rewrite a tuple between the original and the encoded schema; Encode
+    // assigns codes to unseen strings on the fly
+    Tuple Encode(const Tuple &tuple);
+    Tuple Decode(const Tuple &tuple);
+
+private:
+    Schema *schema_;
+    Schema *encoded_schema_;
+    std::vector<int> dict_columns_;
+    std::unordered_map<int, ColumnDictionary> dictionaries_;
+};
+
+} // namespace cmudb
@@ -0,0 +1,92 @@
+/**
+ * column_projection.h
+ *
+ * Columnar auxiliary projection for scan-heavy tables. A column opts in
+ * through the "proj_" name prefix (the same convention "dict_" and
+ * "hash_" use); the opted-in columns form one column group whose values
+ * are copied, row by row, into a dedicated page chain maintained
+ * synchronously from the table's write path. A narrow aggregate query
+ * can then scan just that chain instead of dragging every row's full
+ * forty columns through the buffer pool.
+ *
+ * Page format (on a raw buffer pool page):
+ *  -----------------------------------------------------------
+ * | NextPageId (4) | EntryCount (4) | FreeOffset (4) | entries |
+ *  -----------------------------------------------------------
+ * Each entry is | Rid (8) | Size (4) | projected tuple bytes |. Removes
+ * tombstone the entry in place (the rid field is negated) rather than
+ * compacting, so the chain is append-only and entry positions are
+ * stable; an update appends a fresh entry after tombstoning the old one.
+ */
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
+#include "table/tuple.h"
+
+namespace cmudb {
+
+class ColumnProjection {
+public:
+    // opens an existing chain when first_page_id is valid, otherwise
+    // allocates the first page of a new one
+    ColumnProjection(BufferPoolManager *buffer_pool_manager,
+                     Schema *table_schema, const std::vector<int> &proj_attrs,
+                     page_id_t first_page_id = INVALID_PAGE_ID);
+    ~ColumnProjection();
+
+    // project "tuple" (in the table schema) down to the column group and
+    // append it under "rid"; called from the table's insert path
+    void Append(const Tuple &tuple, const RID &rid);
+
+    // tombstone the live entry for "rid"; false when no such entry
+    bool Remove(const RID &rid);
+
+    // revive the oldest tombstoned entry for "rid"; undoes a Remove on
+    // transaction rollback. False when no such entry
+    bool Restore(const RID &rid);
+
+    // copy every live entry's narrow tuple into "tuples", in append
+    // order; returns the number of rows delivered
+    size_t Scan(std::vector<Tuple> &tuples);
+
+    // discover the "proj_"-prefixed column group of a schema; empty when
+    // no column opted in
+    static std::vector<int> FindProjectionColumns(Schema *schema);
+
+    inline Schema *GetProjectionSchema() { return projection_schema_; }
+    inline page_id_t GetFirstPageId() { return first_page_id_; }
+
+private:
+    // chain page header accessors over a raw page buffer
+    static page_id_t GetNextPageId(char *data);
+    static void SetNextPageId(char *data, page_id_t next_page_id);
+    static int32_t GetEntryCount(char *data);
+    static void SetEntryCount(char *data, int32_t count);
+    static int32_t GetFreeOffset(char *data);
+    static void SetFreeOffset(char *data, int32_t offset);
+
+    // wipe a freshly allocated page into an empty chain tail
+    static void InitPage(char *data);
+
+    // flip the live/tombstoned state of the first entry for "rid" that is
+    // in state "live"; caller must hold latch_
+    bool SetTombstone(const RID &rid, bool live);
+
+    BufferPoolManager *buffer_pool_manager_;
+    Schema *table_schema_;
+    // table column ids making up the group, in schema order
+    std::vector<int> proj_attrs_;
+    // the narrow schema the chain's entries are serialized against
+    Schema *projection_schema_;
+    page_id_t first_page_id_;
+    // append target: the last page of the chain
+    page_id_t tail_page_id_;
+    std::mutex latch_;
+};
+
+} // namespace cmudb
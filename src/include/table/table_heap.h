@@ -6,7 +6,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
+#include "concurrency/version_manager.h"
 #include "logging/log_manager.h"
 #include "page/table_page.h"
 #include "table/table_iterator.h"
@@ -14,23 +20,125 @@
 
 namespace cmudb {
 
+/**
+ * Zero-copy read handle: keeps a page read-latched and pinned while giving
+ * out a tuple whose data points straight into the page buffer, so the scan
+ * hot path skips the per-row allocate+copy. Falls back to an owned copy
+ * when the bytes cannot legally point into the page (snapshot overlay,
+ * overflow tuples). Get() is only valid until Release() or destruction.
+ */
+class PinnedTuple {
+    friend class TableHeap;
+
+public:
+    PinnedTuple() : buffer_pool_manager_(nullptr), page_(nullptr) {}
+    ~PinnedTuple() { Release(); }
+    // not copyable: a copy would double-unpin on destruction
+    PinnedTuple(const PinnedTuple &) = delete;
+    PinnedTuple &operator=(const PinnedTuple &) = delete;
+
+    const Tuple &Get() const { return tuple_; }
+
+    void Release() {
+        if (page_ != nullptr) {
+            page_->RUnlatch();
+            buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+            page_ = nullptr;
+        }
+        buffer_pool_manager_ = nullptr;
+    }
+
+private:
+    BufferPoolManager *buffer_pool_manager_;
+    TablePage *page_;
+    Tuple tuple_;
+};
+
+/**
+ * Handle on a circular shared scan, obtained through
+ * TableHeap::BeginSharedScan. NextPage() materializes the visible tuples of
+ * one heap page per call and returns false once the scan has gone full
+ * circle. A scan that starts while another is in flight attaches to the
+ * stream at its current position and wraps past the end of the chain back
+ * to its own start page, so N concurrent full scans ride one physical read
+ * pass instead of evicting each other's frames from the pool.
+ */
+class SharedScan {
+    friend class TableHeap;
+
+public:
+    SharedScan()
+            : table_heap_(nullptr), start_page_id_(INVALID_PAGE_ID),
+              next_page_id_(INVALID_PAGE_ID) {}
+    ~SharedScan() { Detach(); }
+    // not copyable: a copy would double-detach from the stream
+    SharedScan(const SharedScan &) = delete;
+    SharedScan &operator=(const SharedScan &) = delete;
+
+    // append the visible tuples of the next page in the stream; false once
+    // every page has been seen (nothing is appended then)
+    bool NextPage(std::vector<Tuple> &tuples, Transaction *txn);
+
+    // leave the stream early; harmless on a finished or unattached scan
+    void Detach();
+
+private:
+    TableHeap *table_heap_;
+    page_id_t start_page_id_;
+    page_id_t next_page_id_;
+};
+
+/**
+ * Partitioned parallel scan: unlike SharedScan, where every attached scan
+ * sees every row, the workers of one ParallelScan share a single cursor
+ * and each heap page is handed to exactly one caller. N workers calling
+ * NextPage stripe the table between them; tuple extraction runs outside
+ * the cursor latch, so only the page-chain walk is serialized.
+ */
+class ParallelScan {
+    friend class TableHeap;
+
+public:
+    explicit ParallelScan(TableHeap *table_heap);
+
+    // claim the next unclaimed page and append its visible tuples; false
+    // once every page has been claimed (nothing is appended then)
+    bool NextPage(std::vector<Tuple> &tuples, Transaction *txn);
+
+private:
+    TableHeap *table_heap_;
+    std::mutex latch_;
+    page_id_t next_page_id_;
+};
+
 class TableHeap {
     friend class TableIterator;
+    friend class SharedScan;
+    friend class ParallelScan;
 
 public:
     ~TableHeap() {}
 
-    // open a table heap
+    // open a table heap; with a version manager, writes save the prior
+    // tuple state and read-only transactions read their snapshot from it
     TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager,
-              LogManager *log_manager, page_id_t first_page_id);
+              LogManager *log_manager, page_id_t first_page_id,
+              VersionManager *version_manager = nullptr);
 
     // create table heap
     TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager,
-              LogManager *log_manager, Transaction *txn);
+              LogManager *log_manager, Transaction *txn,
+              VersionManager *version_manager = nullptr);
 
     // for insert, if tuple is too large (>~page_size), return false
     bool InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn);
 
+    // bulk insert: starts at the cached last-page-with-space hint instead of
+    // walking the chain from the first page per tuple, and fills each page
+    // before allocating the next; appends one rid per inserted tuple
+    bool InsertTuples(const std::vector<Tuple> &tuples, std::vector<RID> &rids,
+                      Transaction *txn);
+
     bool MarkDelete(const RID &rid, Transaction *txn); // for delete
 
     // if the new tuple is too large to fit in the old page, return false (will
@@ -44,8 +152,48 @@ public:
 
     bool GetTuple(const RID &rid, Tuple &tuple, Transaction *txn);
 
+    // zero-copy variant of GetTuple: on success "result" holds the page
+    // pinned and its tuple points into the page buffer until released
+    bool GetTupleView(const RID &rid, PinnedTuple &result, Transaction *txn);
+
+    // vectorized scan: append up to n tuples to "tuples", materializing a
+    // whole page per fetch/latch instead of once per row. Pass a default
+    // constructed rid as cursor to start; the cursor comes back pointing at
+    // the next unread tuple and returning fewer than n tuples means the
+    // scan reached the end of the table
+    size_t ScanBatch(RID &cursor, std::vector<Tuple> &tuples, size_t n,
+                     Transaction *txn);
+
+    // partitioned scan: split the page chain into up to num_partitions
+    // contiguous disjoint segments so workers on a thread pool can scan
+    // them in parallel, each with its own transaction and ScanPages call
+    std::vector<std::vector<page_id_t>> GetScanPartitions(size_t num_partitions);
+
+    // materialize every visible tuple from the given pages (one fetch and
+    // read latch per page); safe to run concurrently on disjoint partitions
+    size_t ScanPages(const std::vector<page_id_t> &pages,
+                     std::vector<Tuple> &tuples, Transaction *txn);
+
+    // attach "scan" to the shared page stream: it starts where the scans
+    // already in flight currently are (or at the first page when alone) and
+    // circles back around, covering every page exactly once
+    void BeginSharedScan(SharedScan &scan);
+
     bool DeleteTableHeap();
 
+    // bulk truncation for expiry passes: drops every page after the first
+    // back to the allocator and re-initializes the first page empty, all
+    // under a single TRUNCATE log record instead of one record per row.
+    // Not undoable -- treat it as committed the moment it returns -- and
+    // it requires quiescence: no concurrent scans, writers or snapshots
+    // @return: number of pages released, -1 on a read-only transaction
+    int32_t Truncate(Transaction *txn);
+
+    // vacuum pass for a background maintenance thread: walk the chain,
+    // trim dead slot-array tails and refresh the free space map. Returns
+    // the number of slots reclaimed across all pages
+    int32_t Vacuum();
+
     TableIterator begin(Transaction *txn);
 
     TableIterator end();
@@ -53,6 +201,34 @@ public:
     inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
 private:
+    // pages with fewer reclaimed bytes than this are not worth tracking
+    static constexpr int32_t FREE_SPACE_THRESHOLD = 64;
+
+    // record (or drop) a page in the free space map after its space changed
+    void RecordFreeSpace(page_id_t page_id, int32_t free_bytes);
+    // claim a page with at least need_bytes free, or INVALID_PAGE_ID
+    page_id_t FindPageWithSpace(int32_t need_bytes);
+
+    // shared scan bookkeeping, called from SharedScan
+    void EndSharedScan();
+    void PublishScanPosition(page_id_t page_id);
+
+    // read a tuple under the caller-held page read latch, applying the
+    // snapshot overlay for read-only transactions like GetTuple does
+    bool ReadVisibleTuple(TablePage *page, const RID &rid, Tuple &tuple,
+                          Transaction *txn);
+
+    /**
+     * Overflow (multi-page) tuple helpers. A tuple too large for one page
+     * is written across a chain of dedicated overflow pages and a small
+     * stub referencing the chain takes its slot; readers resolve the stub
+     * transparently and ApplyDelete reclaims the chain.
+     */
+    bool IsOverflowStub(const Tuple &tuple) const;
+    bool InsertOverflowTuple(const Tuple &tuple, RID &rid, Transaction *txn);
+    bool ResolveOverflowTuple(Tuple &tuple);
+    void FreeOverflowChain(page_id_t first_page_id);
+
     /**
      * Members
      */
@@ -60,6 +236,20 @@ private:
     LockManager *lock_manager_;
     LogManager *log_manager_;
     page_id_t first_page_id_;
+    VersionManager *version_manager_;
+    // page id of the most recent page known to have had free space; a stale
+    // hint only costs a longer walk, never correctness
+    std::atomic<page_id_t> last_page_hint_;
+    // free space map: pages whose space was reclaimed by ApplyDelete, so
+    // inserts can reuse it without walking the chain; in-memory only and
+    // repopulated as deletes occur after reopening the table
+    std::mutex free_space_mutex_;
+    std::unordered_map<page_id_t, int32_t> free_space_map_;
+    // shared scan stream: the page the in-flight scans most recently read,
+    // so a newly attached scan starts on frames that are already hot
+    std::mutex shared_scan_mutex_;
+    size_t active_shared_scans_;
+    page_id_t shared_scan_position_;
 };
 
 } // namespace cmudb
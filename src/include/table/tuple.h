@@ -2,19 +2,27 @@
  * tuple.h
  *
  * Tuple format:
- *  ------------------------------------------------------------------
- * | FIXED-SIZE or VARIED-SIZED OFFSET | PAYLOAD OF VARIED-SIZED FIELD|
- *  ------------------------------------------------------------------
+ *  ---------------------------------------------------------------------
+ * | FIXED-SIZE or VARIED-SIZED OFFSET | NULL BITMAP | VARIED-SIZED FIELDS|
+ *  ---------------------------------------------------------------------
+ * The bitmap carries one bit per column between the fixed-length section
+ * and the varlen payloads, so fixed column offsets are unchanged and
+ * varlen columns are still reached through their stored offsets. Null
+ * varlen columns keep their offset slot but write no payload.
  */
 
 #pragma once
 
+#include <cstring>
+
 #include "catalog/schema.h"
 #include "common/rid.h"
 #include "type/value.h"
 
 namespace cmudb {
 
+class Arena;
+
 class Tuple {
     friend class TablePage;
 
@@ -22,6 +30,8 @@ class Tuple {
 
     friend class TableIterator;
 
+    friend class RowBuilder;
+
 public:
     // Default constructor (to create a dummy tuple)
     inline Tuple() : allocated_(false), rid_(RID()), size_(0), data_(nullptr) {}
@@ -32,6 +42,13 @@ public:
     // constructor for creating a new tuple based on input value
     Tuple(std::vector<Value> values, Schema *schema);
 
+    // same, but materialized into an arena: the arena owns the bytes, so
+    // the tuple is non-allocated and must not outlive the arena
+    Tuple(std::vector<Value> values, Schema *schema, Arena *arena);
+
+    // deep copy whose bytes live in the arena
+    Tuple Clone(Arena *arena) const;
+
     // copy constructor, deep copy
     Tuple(const Tuple &other);
 
@@ -63,19 +80,43 @@ public:
     // checks the schema to see how to return the Value.
     Value GetValue(Schema *schema, const int column_id) const;
 
-    // Is the column value null ?
+    // Is the column value null? One bitmap bit, no Value construction
     inline bool IsNull(Schema *schema, const int column_id) const {
-        Value value = GetValue(schema, column_id);
-        return value.IsNull();
+        const char *bitmap = data_ + schema->GetLength();
+        return ((bitmap[column_id / 8] >> (column_id % 8)) & 1) != 0;
     }
     inline bool IsAllocated() { return allocated_; }
 
+    // force the tuple to own its bytes; a no-op when it already does.
+    // Required before storing a scratch- or arena-backed tuple beyond
+    // the lifetime of its backing buffer
+    inline void Materialize() {
+        if (allocated_ || data_ == nullptr)
+            return;
+        char *copy = new char[size_];
+        memcpy(copy, data_, size_);
+        data_ = copy;
+        allocated_ = true;
+    }
+
+    // write the type's null sentinel into an inlined column slot; equal
+    // nulls must stay byte-identical for raw-byte key comparisons
+    static void SerializeNullSentinel(char *storage, TypeId type);
+
     std::string ToString(Schema *schema) const;
 
 private:
+    // bytes of the per-tuple null bitmap, one bit per column
+    static inline int32_t NullBitmapSize(Schema *schema) {
+        return (schema->GetColumnCount() + 7) / 8;
+    }
+
     // Get the starting storage address of specific column
     const char *GetDataPtr(Schema *schema, const int column_id) const;
 
+    // serialize values into the already-sized data_ buffer
+    void SerializeValues(std::vector<Value> &values, Schema *schema);
+
     bool allocated_; // is allocated?
     RID rid_;        // if pointing to the table heap, the rid is valid
     int32_t size_;
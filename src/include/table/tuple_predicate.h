@@ -0,0 +1,58 @@
+/**
+ * tuple_predicate.h
+ *
+ * Batch predicate evaluation over materialized tuples. A predicate tree is
+ * either a leaf ("column op constant") or a conjunction of children. The
+ * column offset and typed comparator are resolved once per leaf per batch,
+ * then a tight loop over the serialized tuple bytes fills a selection
+ * bitmap — no per-row virtual dispatch or Value materialization. This is
+ * the engine for pushing WHERE filters below the vtable boundary.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "catalog/schema.h"
+#include "table/tuple.h"
+#include "type/type_kernels.h"
+
+namespace cmudb {
+
+enum class PredicateOp {
+    Equals,
+    NotEquals,
+    LessThan,
+    LessThanEquals,
+    GreaterThan,
+    GreaterThanEquals
+};
+
+class TuplePredicate {
+public:
+    // leaf: "column <op> constant"
+    TuplePredicate(int column_id, PredicateOp op, const Value &constant);
+
+    // conjunction: every child must pass
+    explicit TuplePredicate(std::vector<TuplePredicate> children);
+
+    // fill "selection" (one byte per tuple, 1 = selected) and return the
+    // number of selected tuples. Null column values are not expected; the
+    // vtable always materializes concrete values
+    size_t Evaluate(const std::vector<Tuple> &tuples, Schema *schema,
+                    std::vector<uint8_t> &selection) const;
+
+private:
+    // AND this node's result into an already-initialized selection bitmap
+    void Apply(const std::vector<Tuple> &tuples, Schema *schema,
+               std::vector<uint8_t> &selection) const;
+
+    int column_id_;
+    PredicateOp op_;
+    // the constant pre-serialized to the comparator's wire format
+    std::vector<char> constant_buf_;
+    // non-empty children make this node a conjunction
+    std::vector<TuplePredicate> children_;
+};
+
+} // namespace cmudb
@@ -0,0 +1,246 @@
+/**
+ * type_kernels.h
+ *
+ * Compile-time typed kernels over raw serialized column bytes.
+ *
+ * The regular comparison path costs Type::GetInstance + a virtual call +
+ * null checks for every value of every row. Batch code (scans, index
+ * maintenance) should instead resolve the column type ONCE per batch —
+ * either statically via the templates or with GetRawComparator — and then
+ * run a tight, fully-inlined loop over the raw bytes as laid out by
+ * Value::SerializeTo.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "type/type.h"
+
+namespace cmudb {
+
+/**
+ * Byte-string kernels. String comparison and hashing dominate the CPU
+ * profile of varchar-keyed index scans, so these run over 16-byte SIMD
+ * chunks where the target supports it and fall back to the scalar libc
+ * routines elsewhere. Comparison semantics match memcmp: bytes compare
+ * as unsigned.
+ */
+
+// three-way comparison of len bytes, 16 at a time: the first chunk with
+// any differing byte locates that byte through the movemask
+inline int CompareBytes(const char *lhs, const char *rhs, size_t len) {
+#if defined(__SSE2__)
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i l =
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs + i));
+        __m128i r =
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs + i));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(l, r));
+        if (mask != 0xFFFF) {
+            size_t byte = i + __builtin_ctz(~mask & 0xFFFF);
+            return static_cast<unsigned char>(lhs[byte]) <
+                                   static_cast<unsigned char>(rhs[byte])
+                           ? -1
+                           : 1;
+        }
+    }
+    if (i < len) {
+        int cmp = memcmp(lhs + i, rhs + i, len - i);
+        if (cmp != 0)
+            return cmp < 0 ? -1 : 1;
+    }
+    return 0;
+#else
+    int cmp = memcmp(lhs, rhs, len);
+    return (cmp > 0) - (cmp < 0);
+#endif
+}
+
+// chunked equality; callers comparing sized strings should test the
+// lengths first so unequal strings exit before touching any bytes
+inline bool EqualBytes(const char *lhs, const char *rhs, size_t len) {
+#if defined(__SSE2__)
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i l =
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs + i));
+        __m128i r =
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(l, r)) != 0xFFFF)
+            return false;
+    }
+    return memcmp(lhs + i, rhs + i, len - i) == 0;
+#else
+    return memcmp(lhs, rhs, len) == 0;
+#endif
+}
+
+/**
+ * xxHash64-style byte hash. FNV-1a forces a serial multiply per byte;
+ * this runs four independent 64-bit lanes over 32-byte blocks, so the
+ * multiplies pipeline (and the loads vectorize) instead of forming one
+ * long dependency chain. Seeded, for callers that derive probe pairs.
+ */
+inline uint64_t HashBytes(const char *data, size_t len, uint64_t seed) {
+    static const uint64_t P1 = 11400714785074694791ULL;
+    static const uint64_t P2 = 14029467366897019727ULL;
+    static const uint64_t P3 = 1609587929392839161ULL;
+    static const uint64_t P4 = 9650029242287828579ULL;
+    static const uint64_t P5 = 2870177450012600261ULL;
+    auto rotl = [](uint64_t x, int r) {
+        return (x << r) | (x >> (64 - r));
+    };
+    auto round = [&rotl](uint64_t acc, uint64_t input) {
+        return rotl(acc + input * P2, 31) * P1;
+    };
+    auto load64 = [](const char *p) {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    };
+
+    const char *p = data;
+    const char *end = data + len;
+    uint64_t h;
+    if (len >= 32) {
+        uint64_t v1 = seed + P1 + P2;
+        uint64_t v2 = seed + P2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - P1;
+        do {
+            v1 = round(v1, load64(p));
+            v2 = round(v2, load64(p + 8));
+            v3 = round(v3, load64(p + 16));
+            v4 = round(v4, load64(p + 24));
+            p += 32;
+        } while (p + 32 <= end);
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = (h ^ round(0, v1)) * P1 + P4;
+        h = (h ^ round(0, v2)) * P1 + P4;
+        h = (h ^ round(0, v3)) * P1 + P4;
+        h = (h ^ round(0, v4)) * P1 + P4;
+    } else {
+        h = seed + P5;
+    }
+    h += static_cast<uint64_t>(len);
+    while (p + 8 <= end) {
+        h = rotl(h ^ round(0, load64(p)), 27) * P1 + P4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        h = rotl(h ^ (static_cast<uint64_t>(v) * P1), 23) * P2 + P3;
+        p += 4;
+    }
+    while (p < end) {
+        h = rotl(h ^ (static_cast<unsigned char>(*p) * P5), 11) * P1;
+        ++p;
+    }
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+    return h;
+}
+
+// C++ storage type for each inlined SQL type
+template <TypeId> struct TypeOf;
+template <> struct TypeOf<TypeId::BOOLEAN> { using CppType = int8_t; };
+template <> struct TypeOf<TypeId::TINYINT> { using CppType = int8_t; };
+template <> struct TypeOf<TypeId::SMALLINT> { using CppType = int16_t; };
+template <> struct TypeOf<TypeId::INTEGER> { using CppType = int32_t; };
+template <> struct TypeOf<TypeId::BIGINT> { using CppType = int64_t; };
+template <> struct TypeOf<TypeId::DECIMAL> { using CppType = double; };
+template <> struct TypeOf<TypeId::TIMESTAMP> { using CppType = uint64_t; };
+
+template <TypeId T>
+inline typename TypeOf<T>::CppType LoadRaw(const char *data) {
+    typename TypeOf<T>::CppType value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+template <TypeId T>
+inline void StoreRaw(char *data, typename TypeOf<T>::CppType value) {
+    memcpy(data, &value, sizeof(value));
+}
+
+// three-way comparison of two serialized values of the same inlined type
+template <TypeId T>
+inline int CompareRaw(const char *lhs, const char *rhs) {
+    auto l = LoadRaw<T>(lhs);
+    auto r = LoadRaw<T>(rhs);
+    if (l < r)
+        return -1;
+    if (l > r)
+        return 1;
+    return 0;
+}
+
+// varchars are serialized as | Length (4) | Bytes |, compared like memcmp
+// with the shorter value ordered first on a tie
+inline int CompareRawVarchar(const char *lhs, const char *rhs) {
+    uint32_t lhs_len, rhs_len;
+    memcpy(&lhs_len, lhs, sizeof(uint32_t));
+    memcpy(&rhs_len, rhs, sizeof(uint32_t));
+    uint32_t min_len = lhs_len < rhs_len ? lhs_len : rhs_len;
+    int cmp = CompareBytes(lhs + sizeof(uint32_t), rhs + sizeof(uint32_t),
+                           min_len);
+    if (cmp != 0)
+        return cmp;
+    if (lhs_len < rhs_len)
+        return -1;
+    if (lhs_len > rhs_len)
+        return 1;
+    return 0;
+}
+
+// one switch at batch setup replaces a virtual dispatch per row; callers
+// that know the type statically should use CompareRaw<T> directly so the
+// comparison inlines into their loop
+using RawComparator = int (*)(const char *, const char *);
+
+inline RawComparator GetRawComparator(TypeId type_id) {
+    switch (type_id) {
+        case TypeId::BOOLEAN:
+            return CompareRaw<TypeId::BOOLEAN>;
+        case TypeId::TINYINT:
+            return CompareRaw<TypeId::TINYINT>;
+        case TypeId::SMALLINT:
+            return CompareRaw<TypeId::SMALLINT>;
+        case TypeId::INTEGER:
+            return CompareRaw<TypeId::INTEGER>;
+        case TypeId::BIGINT:
+            return CompareRaw<TypeId::BIGINT>;
+        case TypeId::DECIMAL:
+            return CompareRaw<TypeId::DECIMAL>;
+        case TypeId::TIMESTAMP:
+            return CompareRaw<TypeId::TIMESTAMP>;
+        case TypeId::VARCHAR:
+            return CompareRawVarchar;
+        default:
+            return nullptr;
+    }
+}
+
+// arithmetic kernel example: sum a fixed-stride column of n values; the
+// accumulator is the widest type of the same family
+template <TypeId T>
+inline double SumRaw(const char *base, size_t stride, size_t n) {
+    double sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += static_cast<double>(LoadRaw<T>(base + i * stride));
+    }
+    return sum;
+}
+
+} // namespace cmudb
@@ -7,6 +7,7 @@
 #include <cstring>
 
 #include "type/type.h"
+#include "type/type_kernels.h"
 
 namespace cmudb {
 /**
@@ -27,7 +28,8 @@ public:
         // PAVLO: 2017-04-04
         // The reason why we use memcmp here is that our inputs are
         // not null-terminated strings, so we can't use strncmp
-        int ret = memcmp(str1, str2, std::min(len1, len2));
+        // (CompareBytes keeps memcmp semantics, 16 bytes per step)
+        int ret = CompareBytes(str1, str2, std::min(len1, len2));
         if (ret == 0 && len1 != len2) {
             ret = len1 - len2;
         }
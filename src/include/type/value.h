@@ -4,10 +4,10 @@
 #pragma once
 
 #include <cstring>
+#include <utility>
 
 #include "type/limits.h"
 #include "type/type.h"
-#include <cstring>
 
 namespace cmudb {
 
@@ -57,6 +57,9 @@ public:
 
     Value();
     Value(const Value &other);
+    // move constructor: steals heap varlens, copies inlined ones; the
+    // unifying by-value operator= below covers move assignment
+    Value(Value &&other) noexcept;
     Value &operator=(Value other);
     ~Value();
     // nothrow
@@ -65,6 +68,12 @@ public:
         std::swap(first.size_, second.size_);
         std::swap(first.manage_data_, second.manage_data_);
         std::swap(first.type_id_, second.type_id_);
+        std::swap(first.sbo_buf_, second.sbo_buf_);
+        // re-point inlined varlens at their own buffer after the swap
+        if (first.IsInlinedVarlen())
+            first.value_.varlen = first.sbo_buf_;
+        if (second.IsInlinedVarlen())
+            second.value_.varlen = second.sbo_buf_;
     }
     // check whether value is integer
     bool CheckInteger() const;
@@ -164,6 +173,17 @@ public:
     inline Value Copy() const { return Type::GetInstance(type_id_)->Copy(*this); }
 
 protected:
+    // small-buffer threshold: varchars up to this many bytes (including the
+    // terminator) live inside the value itself instead of on the heap
+    static const uint32_t SBO_SIZE = 24;
+
+    // an owned varchar short enough for the inline buffer is always stored
+    // there, so this predicate is derivable from the plain fields
+    inline bool IsInlinedVarlen() const {
+        return type_id_ == TypeId::VARCHAR && manage_data_ &&
+               size_.len != PELOTON_VALUE_NULL && size_.len <= SBO_SIZE;
+    }
+
     // The actual value item
     union Val {
         int8_t boolean;
@@ -185,5 +205,7 @@ protected:
     bool manage_data_;
     // The data type
     TypeId type_id_;
+    // inline storage for short owned varchars (see IsInlinedVarlen)
+    char sbo_buf_[SBO_SIZE];
 };
 } // namespace cmudb
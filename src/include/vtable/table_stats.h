@@ -0,0 +1,54 @@
+/**
+ * table_stats.h
+ *
+ * Per-table statistics maintained on the write path. Row counts are exact
+ * (modulo process restarts, the counters rebuild as the table is written);
+ * distinct keys are a linear-counting estimate over a fixed bitmap of key
+ * hashes. VtabBestIndex turns these into estimatedCost/estimatedRows.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace cmudb {
+
+class TableStats {
+public:
+    inline void OnInsert() { ++row_count_; }
+
+    inline void OnDelete() {
+        if (row_count_ > 0)
+            --row_count_;
+    }
+
+    // fold one indexed key into the distinct-key estimator
+    inline void RecordKey(size_t key_hash) {
+        key_bitmap_[(key_hash >> 6) % BITMAP_WORDS] |= 1ULL << (key_hash & 63);
+    }
+
+    inline size_t GetRowCount() const { return row_count_; }
+
+    // linear counting: n = -m * ln(unset fraction), clamped to the row count
+    size_t GetDistinctKeys() const {
+        size_t set_bits = 0;
+        for (size_t i = 0; i < BITMAP_WORDS; ++i)
+            set_bits += __builtin_popcountll(key_bitmap_[i]);
+        const double m = BITMAP_WORDS * 64;
+        if (set_bits == 0)
+            return 0;
+        if (set_bits >= (size_t)m)
+            return row_count_;
+        size_t estimate = (size_t)(-m * std::log((m - set_bits) / m));
+        return std::min(std::max<size_t>(estimate, 1), row_count_);
+    }
+
+private:
+    static const size_t BITMAP_WORDS = 64; // 4096 bits
+    size_t row_count_ = 0;
+    uint64_t key_bitmap_[BITMAP_WORDS] = {};
+};
+
+} // namespace cmudb
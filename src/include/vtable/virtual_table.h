@@ -4,15 +4,31 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+
 #include "buffer/lru_replacer.h"
+#include "catalog/catalog.h"
 #include "catalog/schema.h"
+#include "common/thread_pool.h"
 #include "concurrency/transaction_manager.h"
 #include "index/b_plus_tree_index.h"
+#include "index/hash_table_index.h"
 #include "logging/log_manager.h"
 #include "sqlite/sqlite3ext.h"
+#include "table/column_projection.h"
 #include "table/table_heap.h"
 #include "table/tuple.h"
 #include "type/value.h"
+#include "vtable/table_stats.h"
 
 namespace cmudb {
 /* Helpers */
@@ -22,12 +38,14 @@ IndexMetadata *ParseIndexStatement(std::string &sql,
                                    const std::string &table_name,
                                    Schema *schema);
 
+Value ConstructValue(TypeId type, sqlite3_value *arg);
+
 Tuple ConstructTuple(Schema *schema, sqlite3_value **argv);
 
 Index *ConstructIndex(IndexMetadata *metadata,
                       BufferPoolManager *buffer_pool_manager,
-                      page_id_t root_id = INVALID_PAGE_ID);
-Transaction *GetTransaction();
+                      page_id_t root_id = INVALID_PAGE_ID,
+                      Catalog *catalog = nullptr);
 
 /* API declaration */
 int VtabCreate(sqlite3 *db, void *pAux, int argc, const char *const *argv,
@@ -57,12 +75,62 @@ int VtabRowid(sqlite3_vtab_cursor *cur, sqlite3_int64 *pRowid);
 
 int VtabCommit(sqlite3_vtab *pVTab);
 
+int VtabRollback(sqlite3_vtab *pVTab);
+
 int VtabBegin(sqlite3_vtab *pVTab);
 
 // storage engine
 class StorageEngine {
 public:
-    StorageEngine(std::string db_file_name) {
+    /*
+     * One shared engine per database file: connections are short-lived but
+     * the buffer pool is expensive to re-warm, so engines are kept in a
+     * process-wide registry and handed out by reference count instead of
+     * being rebuilt per connection
+     */
+    static StorageEngine *Acquire(const std::string &db_file_name) {
+        std::lock_guard<std::mutex> guard(RegistryLatch());
+        StorageEngine *engine = Lookup(db_file_name);
+        engine->ref_count_++;
+        return engine;
+    }
+
+    /*
+     * Drop a reference. The engine stays registered (and warm) for the next
+     * connection; once the last user detaches its dirty pages are forced
+     * out so the file is durable between connections
+     */
+    static void Release(StorageEngine *engine) {
+        if (engine == nullptr)
+            return;
+        std::lock_guard<std::mutex> guard(RegistryLatch());
+        if (--engine->ref_count_ == 0) {
+            engine->buffer_pool_manager_->FlushAllPages();
+            // remember the hot page set for the next process, too
+            engine->buffer_pool_manager_->SaveWarmupInfo(
+                    WarmupFileName(engine->file_name_));
+            // drop the cached catalog entries while idle; the next
+            // connection rereads the header chain from the file
+            engine->catalog_->Invalidate();
+        }
+    }
+
+    /*
+     * Drop a cached engine that has no users, e.g. because its database
+     * file was removed between connections and the cached pages now point
+     * at the unlinked inode. No-op while the engine is still referenced
+     */
+    static void Evict(const std::string &db_file_name) {
+        std::lock_guard<std::mutex> guard(RegistryLatch());
+        auto &registry = Registry();
+        auto pos = registry.find(db_file_name);
+        if (pos == registry.end() || pos->second->ref_count_ != 0)
+            return;
+        delete pos->second;
+        registry.erase(pos);
+    }
+
+    StorageEngine(std::string db_file_name) : file_name_(db_file_name) {
         ENABLE_LOGGING = false;
 
         // storage related
@@ -73,6 +141,15 @@ public:
 
         buffer_pool_manager_ =
                 new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+        // keep compressed copies of evicted pages in a larger second
+        // tier, so a warm miss decompresses instead of reading disk
+        buffer_pool_manager_->EnableCompressedCache(COMPRESSED_CACHE_SIZE);
+        // fault the previous run's working set back in before any query
+        // arrives, in near-sequential reads
+        buffer_pool_manager_->LoadWarmupInfo(WarmupFileName(db_file_name));
+
+        // catalog: hashed name -> root id lookups over the header page chain
+        catalog_ = new Catalog(buffer_pool_manager_);
 
         // txn related
         lock_manager_ = new LockManager(true); // S2PL
@@ -82,6 +159,7 @@ public:
     ~StorageEngine() {
         if (ENABLE_LOGGING)
             log_manager_->StopFlushThread();
+        delete catalog_;
         delete disk_manager_;
         delete buffer_pool_manager_;
         delete log_manager_;
@@ -89,16 +167,137 @@ public:
         delete transaction_manager_;
     }
 
+    inline const std::string &GetFileName() { return file_name_; }
+
     DiskManager *disk_manager_;
     BufferPoolManager *buffer_pool_manager_;
+    Catalog *catalog_;
     LockManager *lock_manager_;
     TransactionManager *transaction_manager_;
     LogManager *log_manager_;
+
+private:
+    // find or build the engine for a file; caller must hold the registry
+    // latch. Engines live for the rest of the process so reconnects find
+    // their pages still cached
+    static StorageEngine *Lookup(const std::string &db_file_name) {
+        auto &registry = Registry();
+        auto pos = registry.find(db_file_name);
+        if (pos == registry.end()) {
+            pos = registry.emplace(db_file_name, new StorageEngine(db_file_name))
+                          .first;
+        }
+        return pos->second;
+    }
+
+    // sidecar holding the resident page ids, named like the other
+    // per-database sidecars (.log/.fpm/...)
+    static std::string WarmupFileName(const std::string &db_file_name) {
+        return db_file_name.substr(0, db_file_name.find(".")) + ".wrm";
+    }
+
+    static std::map<std::string, StorageEngine *> &Registry() {
+        static std::map<std::string, StorageEngine *> registry;
+        return registry;
+    }
+
+    static std::mutex &RegistryLatch() {
+        static std::mutex latch;
+        return latch;
+    }
+
+    std::string file_name_;
+    // vtable instances currently using this engine
+    int ref_count_ = 0;
 };
 
 StorageEngine *storage_engine_;
-// global transaction, sqlite does not support concurrent transaction
-Transaction *global_transaction_ = nullptr;
+
+/**
+ * Per-connection transaction state. sqlite serializes statements within
+ * one connection, but independent connections used to funnel through a
+ * single global Transaction pointer, so their transactions could never
+ * overlap. Each connection (keyed by its sqlite3 handle) now owns a
+ * context whose active transaction VtabBegin/VtabCommit/VtabRollback
+ * manage, letting concurrent connections run concurrent transactions
+ * through the LockManager. Contexts are refcounted by the vtab
+ * instances connected through them, mirroring the StorageEngine
+ * registry.
+ */
+class TransactionContext {
+public:
+    static TransactionContext *Acquire(sqlite3 *db) {
+        std::lock_guard<std::mutex> guard(RegistryLatch());
+        auto &registry = Registry();
+        auto it = registry.find(db);
+        if (it == registry.end())
+            it = registry.emplace(db, new TransactionContext()).first;
+        it->second->ref_count_++;
+        return it->second;
+    }
+
+    static void Release(TransactionContext *context) {
+        std::lock_guard<std::mutex> guard(RegistryLatch());
+        if (--context->ref_count_ > 0)
+            return;
+        // a read-only transaction left behind by the connection's last
+        // statement is finished with the connection
+        if (context->active_transaction_ != nullptr) {
+            storage_engine_->transaction_manager_->Commit(
+                    context->active_transaction_);
+            storage_engine_->transaction_manager_->Recycle(
+                    context->active_transaction_);
+        }
+        auto &registry = Registry();
+        for (auto it = registry.begin(); it != registry.end(); ++it) {
+            if (it->second == context) {
+                registry.erase(it);
+                break;
+            }
+        }
+        delete context;
+    }
+
+    inline Transaction *Active() { return active_transaction_; }
+
+    inline void SetActive(Transaction *txn) { active_transaction_ = txn; }
+
+private:
+    static std::map<sqlite3 *, TransactionContext *> &Registry() {
+        static std::map<sqlite3 *, TransactionContext *> registry;
+        return registry;
+    }
+
+    static std::mutex &RegistryLatch() {
+        static std::mutex latch;
+        return latch;
+    }
+
+    Transaction *active_transaction_ = nullptr;
+    // vtab instances connected through this context
+    int ref_count_ = 0;
+};
+
+/**
+ * Serializes one sqlite row straight into a reusable scratch buffer in
+ * tuple wire format, replacing the ConstructTuple path (a Value vector,
+ * per-Value varlen copies, then a serialize into a fresh buffer) with
+ * zero per-row allocations once the buffer has grown to the table's
+ * steady-state row size.
+ */
+class RowBuilder {
+public:
+    explicit RowBuilder(Schema *schema) : schema_(schema) {}
+
+    // build a tuple aliasing the scratch buffer; it is only valid until
+    // the next Build call, and anything retaining it longer must
+    // Materialize it first (deferred-write staging does)
+    Tuple Build(sqlite3_value **argv);
+
+private:
+    Schema *schema_;
+    std::vector<char> buffer_;
+};
 
 class VirtualTable {
     friend class Cursor;
@@ -106,33 +305,64 @@ class VirtualTable {
 public:
     VirtualTable(Schema *schema, BufferPoolManager *buffer_pool_manager,
                  LockManager *lock_manager, LogManager *log_manager, Index *index,
-                 page_id_t first_page_id = INVALID_PAGE_ID)
-            : schema_(schema), index_(index) {
+                 page_id_t first_page_id = INVALID_PAGE_ID,
+                 page_id_t projection_page_id = INVALID_PAGE_ID,
+                 TransactionContext *txn_context = nullptr)
+            : schema_(schema), index_(index), row_builder_(schema),
+              txn_context_(txn_context) {
+        VersionManager *version_manager =
+                storage_engine_->transaction_manager_->GetVersionManager();
         if (first_page_id != INVALID_PAGE_ID) {
             // reopen an exist table
             table_heap_ = new TableHeap(buffer_pool_manager, lock_manager,
-                                        log_manager, first_page_id);
+                                        log_manager, first_page_id, version_manager);
         } else {
             // create table for the first time
             Transaction *txn = storage_engine_->transaction_manager_->Begin();
-            table_heap_ =
-                    new TableHeap(buffer_pool_manager, lock_manager, log_manager, txn);
+            table_heap_ = new TableHeap(buffer_pool_manager, lock_manager,
+                                        log_manager, txn, version_manager);
             storage_engine_->transaction_manager_->Commit(txn);
+            storage_engine_->transaction_manager_->Recycle(txn);
         }
+        // columns that opted in through the "proj_" name prefix get a
+        // columnar copy in a side chain, maintained from the write paths
+        std::vector<int> proj_attrs =
+                ColumnProjection::FindProjectionColumns(schema);
+        if (!proj_attrs.empty())
+            projection_ = new ColumnProjection(buffer_pool_manager, schema,
+                                               proj_attrs, projection_page_id);
     }
 
     ~VirtualTable() {
+        if (index_ != nullptr)
+            FlushIndexEntries();
         delete schema_;
         delete table_heap_;
         delete index_;
+        delete projection_;
     }
 
-    // insert into table heap
+    // insert into table heap; the projection chain is maintained
+    // synchronously so it never lags the heap (deferred-write
+    // transactions skip it: their rids are unassigned until publish)
     inline bool InsertTuple(const Tuple &tuple, RID &rid) {
-        return table_heap_->InsertTuple(tuple, rid, GetTransaction());
+        bool inserted = table_heap_->InsertTuple(tuple, rid, GetTransaction());
+        if (inserted) {
+            stats_.OnInsert();
+            if (projection_ != nullptr &&
+                !GetTransaction()->IsDeferredWrites()) {
+                projection_->Append(tuple, rid);
+                projection_undo_.push_back(
+                        ProjectionWriteRecord{WType::INSERT, rid});
+            }
+        }
+        return inserted;
     }
 
-    // insert into index
+    // insert into index; the write is deferred into the transaction's
+    // index write set and applied at pre-commit (or before the next index
+    // read), so multi-row transactions do one ordered pass over the
+    // leaves instead of a full descent per row
     inline void InsertEntry(const Tuple &tuple, const RID &rid) {
         if (index_ == nullptr)
             return;
@@ -142,16 +372,177 @@ public:
         for (auto &i : index_->GetKeyAttrs())
             key_values.push_back(tuple.GetValue(schema_, i));
         Tuple key(key_values, index_->GetKeySchema());
-        index_->InsertEntry(key, rid, GetTransaction());
+        stats_.RecordKey(std::hash<std::string>()(
+                std::string(key.GetData(), key.GetLength())));
+        pending_index_writes_.push_back(
+                IndexWriteRecord{WType::INSERT, std::move(key), rid});
+    }
+
+    // apply the deferred index writes in statement order, batching every
+    // consecutive run of inserts into one sorted pass; must run before
+    // anything reads from the index and before the transaction commits
+    inline void FlushIndexEntries() {
+        if (pending_index_writes_.empty())
+            return;
+        {
+            // while an online build is scanning the heap the tree is only
+            // half loaded: applying a delete there could no-op against a
+            // key the bulk load has not inserted yet, which would later
+            // resurrect as a stale entry. Park the writes in the build's
+            // side buffer instead; the build replays them once loaded
+            std::lock_guard<std::mutex> guard(build_latch_);
+            if (index_build_active_) {
+                for (auto &write : pending_index_writes_)
+                    index_build_delta_.push_back(std::move(write));
+                pending_index_writes_.clear();
+                return;
+            }
+        }
+        ApplyIndexWrites(pending_index_writes_, GetTransaction());
+        pending_index_writes_.clear();
+    }
+
+    // an aborted transaction drops its deferred index writes unapplied:
+    // the index never saw them, so there is nothing to undo there
+    inline void DiscardIndexEntries() { pending_index_writes_.clear(); }
+
+    // false while an online build is backfilling the index; the planner
+    // stays on the sequential scan until the captured delta is applied
+    inline bool IsIndexReady() { return index_ready_.load(); }
+
+    // backfill a freshly created index over an already-populated table
+    // with a parallel external sort: pool workers stripe the heap through
+    // one ParallelScan, each sorts a private run of (key, rid), and a
+    // k-way merge of the runs feeds sorted batches to the index's bulk
+    // insert path, so inner pages are descended once per run of keys
+    // instead of once per row.
+    //
+    // The build is online: it does not block writers. While it runs,
+    // FlushIndexEntries diverts index writes into a side buffer instead
+    // of the half-built tree; rows the snapshot scan misses arrive there,
+    // and rows it catches twice net out because the tree rejects
+    // duplicate keys. After the load the build drains the buffer until a
+    // pass finds it empty, then publishes the index to the planner by
+    // flipping the ready flag
+    void BuildIndexFromTable() {
+        if (index_ == nullptr)
+            return;
+        index_ready_.store(false);
+        {
+            std::lock_guard<std::mutex> guard(build_latch_);
+            index_build_active_ = true;
+        }
+        Transaction *txn = storage_engine_->transaction_manager_->Begin();
+        const std::vector<int> &key_attrs = index_->GetKeyAttrs();
+        Schema *key_schema = index_->GetKeySchema();
+        // column-wise key order, the same order the index comparator uses
+        auto key_less = [key_schema](const std::pair<Tuple, RID> &lhs,
+                                     const std::pair<Tuple, RID> &rhs) {
+            for (int i = 0; i < key_schema->GetColumnCount(); ++i) {
+                Value lhs_value = lhs.first.GetValue(key_schema, i);
+                Value rhs_value = rhs.first.GetValue(key_schema, i);
+                if (lhs_value.CompareLessThan(rhs_value) == CMP_TRUE)
+                    return true;
+                if (lhs_value.CompareGreaterThan(rhs_value) == CMP_TRUE)
+                    return false;
+            }
+            return false;
+        };
+
+        size_t worker_count = std::thread::hardware_concurrency();
+        worker_count = worker_count == 0 ? 2 : std::min<size_t>(worker_count, 4);
+        std::vector<std::vector<std::pair<Tuple, RID>>> runs(worker_count);
+        ParallelScan scan(table_heap_);
+        std::vector<std::future<void>> workers;
+        for (size_t w = 0; w < worker_count; ++w) {
+            workers.push_back(ThreadPool::Instance().Async(
+                    [this, &runs, &scan, &key_attrs, key_schema, key_less,
+                     txn, w] {
+                        std::vector<Tuple> tuples;
+                        while (scan.NextPage(tuples, txn)) {
+                            for (auto &tuple : tuples) {
+                                std::vector<Value> key_values;
+                                for (auto &attr : key_attrs)
+                                    key_values.push_back(
+                                            tuple.GetValue(schema_, attr));
+                                runs[w].emplace_back(
+                                        Tuple(key_values, key_schema),
+                                        tuple.GetRid());
+                            }
+                            tuples.clear();
+                        }
+                        std::sort(runs[w].begin(), runs[w].end(), key_less);
+                    },
+                    ThreadPool::Priority::HIGH));
+        }
+        for (auto &worker : workers)
+            worker.get();
+
+        // k-way merge of the sorted runs, flushed in sorted batches
+        using Cursor = std::pair<size_t, size_t>; // (run, offset)
+        auto cursor_after = [&runs, key_less](const Cursor &lhs,
+                                              const Cursor &rhs) {
+            return key_less(runs[rhs.first][rhs.second],
+                            runs[lhs.first][lhs.second]);
+        };
+        std::priority_queue<Cursor, std::vector<Cursor>,
+                            decltype(cursor_after)>
+                merge_heap(cursor_after);
+        for (size_t w = 0; w < worker_count; ++w) {
+            if (!runs[w].empty())
+                merge_heap.push(Cursor(w, 0));
+        }
+        const size_t batch_size = 1024;
+        std::vector<std::pair<Tuple, RID>> batch;
+        while (!merge_heap.empty()) {
+            Cursor cursor = merge_heap.top();
+            merge_heap.pop();
+            batch.push_back(runs[cursor.first][cursor.second]);
+            if (++cursor.second < runs[cursor.first].size())
+                merge_heap.push(cursor);
+            if (batch.size() >= batch_size) {
+                index_->InsertEntries(batch, txn);
+                batch.clear();
+            }
+        }
+        if (!batch.empty())
+            index_->InsertEntries(batch, txn);
+
+        // drain the writes captured while the scan ran; writers may keep
+        // adding during a pass, so loop until one finds the buffer empty
+        // and deactivate capture atomically with that observation
+        while (true) {
+            std::vector<IndexWriteRecord> delta;
+            {
+                std::lock_guard<std::mutex> guard(build_latch_);
+                if (index_build_delta_.empty()) {
+                    index_build_active_ = false;
+                    break;
+                }
+                delta.swap(index_build_delta_);
+            }
+            ApplyIndexWrites(delta, txn);
+        }
+        index_ready_.store(true);
+        storage_engine_->transaction_manager_->Commit(txn);
+        storage_engine_->transaction_manager_->Recycle(txn);
     }
 
     // delete from table heap
     // TODO: call makrdelete method from heaptable
     inline bool DeleteTuple(const RID &rid) {
-        return table_heap_->MarkDelete(rid, GetTransaction());
+        bool deleted = table_heap_->MarkDelete(rid, GetTransaction());
+        if (deleted) {
+            stats_.OnDelete();
+            if (projection_ != nullptr && projection_->Remove(rid))
+                projection_undo_.push_back(
+                        ProjectionWriteRecord{WType::DELETE, rid});
+        }
+        return deleted;
     }
 
-    // delete from index
+    // delete from index; the key is captured from the heap row now (it
+    // is gone by flush time) but the tree write is deferred like inserts
     inline void DeleteEntry(const RID &rid) {
         if (index_ == nullptr)
             return;
@@ -163,13 +554,53 @@ public:
         for (auto &i : index_->GetKeyAttrs())
             key_values.push_back(deleted_tuple.GetValue(schema_, i));
         Tuple key(key_values, index_->GetKeySchema());
-        index_->DeleteEntry(key, GetTransaction());
+        pending_index_writes_.push_back(
+                IndexWriteRecord{WType::DELETE, std::move(key), rid});
     }
 
     // update table heap tuple
     inline bool UpdateTuple(const Tuple &tuple, const RID &rid) {
         // if failed try to delete and insert
-        return table_heap_->UpdateTuple(tuple, rid, GetTransaction());
+        bool updated = table_heap_->UpdateTuple(tuple, rid, GetTransaction());
+        if (updated && projection_ != nullptr) {
+            // the chain is append-only: tombstone the old entry, then
+            // append the new values under the same rid
+            if (projection_->Remove(rid))
+                projection_undo_.push_back(
+                        ProjectionWriteRecord{WType::DELETE, rid});
+            projection_->Append(tuple, rid);
+            projection_undo_.push_back(
+                    ProjectionWriteRecord{WType::INSERT, rid});
+        }
+        return updated;
+    }
+
+    // serve a narrow scan straight from the projection chain, without
+    // touching the heap; false when no column group opted in, leaving
+    // the caller on the ordinary full-row scan
+    inline bool ScanProjection(std::vector<Tuple> &tuples) {
+        if (projection_ == nullptr)
+            return false;
+        projection_->Scan(tuples);
+        return true;
+    }
+
+    // a committed transaction's projection writes are already in place;
+    // just drop the undo records
+    inline void RetireProjectionWrites() { projection_undo_.clear(); }
+
+    // projection writes apply synchronously, so an aborted transaction
+    // replays its undo records in reverse: appends are tombstoned and
+    // removes revived
+    inline void RollbackProjectionWrites() {
+        for (auto it = projection_undo_.rbegin(); it != projection_undo_.rend();
+             ++it) {
+            if (it->wtype_ == WType::INSERT)
+                projection_->Remove(it->rid_);
+            else
+                projection_->Restore(it->rid_);
+        }
+        projection_undo_.clear();
     }
 
     inline TableIterator begin() { return table_heap_->begin(GetTransaction()); }
@@ -180,6 +611,19 @@ public:
 
     inline Index *GetIndex() { return index_; }
 
+    inline TableStats &GetStats() { return stats_; }
+
+    inline RowBuilder &GetRowBuilder() { return row_builder_; }
+
+    inline TransactionContext *GetTxnContext() { return txn_context_; }
+
+    // the connection's active transaction (null outside any statement)
+    inline Transaction *GetTransaction() {
+        return txn_context_ == nullptr ? nullptr : txn_context_->Active();
+    }
+
+    inline ColumnProjection *GetProjection() { return projection_; }
+
     inline TableHeap *GetTableHeap() { return table_heap_; }
 
     inline page_id_t GetFirstPageId() { return table_heap_->GetFirstPageId(); }
@@ -192,6 +636,61 @@ private:
     TableHeap *table_heap_;
     // to insert/delete index entry
     Index *index_ = nullptr;
+    // one deferred index write; statement order is preserved so a delete
+    // queued after an insert of the same key nets out correctly at flush
+    struct IndexWriteRecord {
+        WType wtype_;
+        Tuple key_;
+        RID rid_;
+    };
+    // the transaction's index write set, applied by FlushIndexEntries and
+    // dropped wholesale by DiscardIndexEntries on rollback
+    std::vector<IndexWriteRecord> pending_index_writes_;
+
+    // apply index writes in statement order, batching every consecutive
+    // run of inserts into one sorted pass; a delete must see every
+    // insert queued before it applied
+    inline void ApplyIndexWrites(std::vector<IndexWriteRecord> &writes,
+                                 Transaction *txn) {
+        std::vector<std::pair<Tuple, RID>> insert_batch;
+        for (auto &write : writes) {
+            if (write.wtype_ == WType::INSERT) {
+                insert_batch.emplace_back(write.key_, write.rid_);
+                continue;
+            }
+            if (!insert_batch.empty()) {
+                index_->InsertEntries(insert_batch, txn);
+                insert_batch.clear();
+            }
+            index_->DeleteEntry(write.key_, txn);
+        }
+        if (!insert_batch.empty())
+            index_->InsertEntries(insert_batch, txn);
+    }
+
+    // online index build state: while a build is in flight, flushed
+    // index writes divert into the delta buffer and the ready flag keeps
+    // the planner off the index until that delta has been applied
+    std::mutex build_latch_;
+    bool index_build_active_ = false;
+    std::vector<IndexWriteRecord> index_build_delta_;
+    std::atomic<bool> index_ready_{true};
+    // optional columnar copy of the "proj_"-prefixed column group
+    ColumnProjection *projection_ = nullptr;
+    // one record per projection write this transaction, replayed in
+    // reverse by RollbackProjectionWrites when the transaction aborts
+    struct ProjectionWriteRecord {
+        WType wtype_;
+        RID rid_;
+    };
+    std::vector<ProjectionWriteRecord> projection_undo_;
+    // cost-model input for VtabBestIndex
+    TableStats stats_;
+    // per-table scratch row builder for the write path
+    RowBuilder row_builder_;
+    // the owning connection's transaction context (shared by every
+    // vtab instance of that connection)
+    TransactionContext *txn_context_;
 };
 
 class Cursor {
@@ -219,13 +718,28 @@ public:
             return (*table_iterator_).GetRid().Get();
     }
 
-    // return tuple at which cursor is currently pointed
+    // return tuple at which cursor is currently pointed; for index scans
+    // indexed columns are served straight from the key values the scan
+    // reconstructed, so a query touching only indexed columns never
+    // fetches the heap row; other columns fetch the row once and cache it
     inline Value GetCurrentValue(Schema *schema, int column) {
         if (is_index_scan_) {
-            RID rid = results[offset_];
-            Tuple tuple(rid);
-            virtual_table_->table_heap_->GetTuple(rid, tuple, GetTransaction());
-            return tuple.GetValue(schema, column);
+            if (!index_only_values_.empty()) {
+                const std::vector<int> &key_attrs =
+                        virtual_table_->index_->GetKeyAttrs();
+                for (size_t i = 0; i < key_attrs.size(); ++i) {
+                    if (key_attrs[i] == column)
+                        return index_only_values_[offset_][i];
+                }
+            }
+            if (cached_offset_ != offset_) {
+                RID rid = results[offset_];
+                cached_tuple_ = Tuple(rid);
+                virtual_table_->table_heap_->GetTuple(
+                        rid, cached_tuple_, virtual_table_->GetTransaction());
+                cached_offset_ = offset_;
+            }
+            return cached_tuple_.GetValue(schema, column);
         } else {
             return table_iterator_->GetValue(schema, column);
         }
@@ -233,10 +747,17 @@ public:
 
     // move cursor up to next
     Cursor &operator++() {
-        if (is_index_scan_)
+        if (is_index_scan_) {
             ++offset_;
-        else
+            // an ordered scan pulls lazily: refill once the consumed
+            // batch runs out, so early-terminating queries never walk on
+            if (ordered_scan_ != nullptr &&
+                offset_ == static_cast<int>(results.size()))
+                ordered_scan_->NextBatch(results, index_only_values_,
+                                         ORDERED_BATCH_SIZE);
+        } else {
             ++table_iterator_;
+        }
         return *this;
     }
     // is end of cursor(no more tuple)
@@ -247,16 +768,59 @@ public:
             return table_iterator_ == virtual_table_->end();
     }
 
-    // wrapper around poit scan methods
+    // wrapper around poit scan methods; prefers the index-only variant,
+    // which also hands back the indexed column values per match
     inline void ScanKey(const Tuple &key) {
-        virtual_table_->index_->ScanKey(key, results);
+        virtual_table_->FlushIndexEntries();
+        if (!virtual_table_->index_->ScanKeyIndexOnly(key, results,
+                                                      index_only_values_))
+            virtual_table_->index_->ScanKey(key, results);
+    }
+
+    // wrapper around index range scan; false when the index cannot scan
+    // ranges, leaving the cursor in sequential-scan mode
+    inline bool ScanRange(const Tuple *low, const Tuple *high,
+                          bool low_inclusive, bool high_inclusive) {
+        virtual_table_->FlushIndexEntries();
+        if (virtual_table_->index_->ScanRangeIndexOnly(
+                    low, high, low_inclusive, high_inclusive, results,
+                    index_only_values_))
+            return true;
+        return virtual_table_->index_->ScanRange(low, high, low_inclusive,
+                                                 high_inclusive, results);
+    }
+
+    // open a lazy whole-index walk in key order (reverse for descending);
+    // rows are pulled in batches as sqlite consumes them, so MIN/MAX
+    // queries that stop after the first row pay one descent. False when
+    // the index keeps keys unordered, leaving the cursor sequential
+    inline bool ScanOrdered(bool reverse) {
+        virtual_table_->FlushIndexEntries();
+        ordered_scan_ = virtual_table_->index_->OpenOrderedScan(reverse);
+        if (ordered_scan_ == nullptr)
+            return false;
+        ordered_scan_->NextBatch(results, index_only_values_,
+                                 ORDERED_BATCH_SIZE);
+        return true;
     }
 
 private:
+    // rows pulled from an ordered scan per batch
+    static const size_t ORDERED_BATCH_SIZE = 64;
+
     sqlite3_vtab_cursor base_; /* Base class - must be first */
     // for index scan
     std::vector<RID> results;
+    // lazy whole-index walk feeding "results" batch by batch, see
+    // ScanOrdered; null for point, range and sequential scans
+    std::unique_ptr<Index::OrderedScan> ordered_scan_;
+    // per-result indexed column values when the scan ran index-only;
+    // parallel to "results", empty when the index could not provide them
+    std::vector<std::vector<Value>> index_only_values_;
     int offset_ = 0;
+    // row cache for index scans, keyed by the offset it was read at
+    Tuple cached_tuple_;
+    int cached_offset_ = -1;
     // for sequential scan
     TableIterator table_iterator_;
     // flag to indicate which scan method is currently used
@@ -1,24 +1,32 @@
 /**
  * b_plus_tree.cpp
  */
+#include <algorithm>
 #include <iostream>
 #include <string>
 
+#include "catalog/catalog.h"
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/perf_trace.h"
 #include "common/rid.h"
 #include "index/b_plus_tree.h"
 #include "page/header_page.h"
 
 namespace cmudb {
 
+// how many times a latch-free GetValue descent retries after a version
+// conflict before falling back to the latched path
+static const int OPTIMISTIC_READ_RESTARTS = 3;
+
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(const std::string &name,
                           BufferPoolManager *buffer_pool_manager,
                           const KeyComparator &comparator,
-                          page_id_t root_page_id)
+                          page_id_t root_page_id, Catalog *catalog)
         : index_name_(name), root_page_id_(root_page_id),
-          buffer_pool_manager_(buffer_pool_manager), comparator_(comparator) {}
+          buffer_pool_manager_(buffer_pool_manager), comparator_(comparator),
+          catalog_(catalog), lazy_reclaim_(false) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
@@ -48,9 +56,37 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key,
         return false;
     }
 
-    result.resize(1);
+    // latch-free descent first: instead of taking read latches down the
+    // path, validate each page's version counter around the reads and
+    // restart when a writer raced the lookup. Transactions stay on the
+    // latched path so their page latch sets remain exact.
+    if (transaction == nullptr) {
+        for (int attempt = 0; attempt < OPTIMISTIC_READ_RESTARTS; ++attempt) {
+            ValueType value;
+            bool exists = false;
+            if (GetValueOptimistic(key, value, exists)) {
+                if (exists) {
+                    result.push_back(value);
+                }
+                return exists;
+            }
+            PerfCount(PerfCounter::BPLUS_RESTART);
+            root_pid_mutex.lock();
+            if (IsEmpty()) {
+                root_pid_mutex.unlock();
+                return false;
+            }
+        }
+    }
+
     auto leaf_page = FindLeafPage(key, transaction, OpType::SEARCH);
-    bool exists = leaf_page->Lookup(key, result[0], comparator_);
+    ValueType value;
+    bool exists = leaf_page->Lookup(key, value, comparator_);
+    // only a hit may touch the result vector, a probe for an absent key
+    // must leave it exactly as it came in
+    if (exists) {
+        result.push_back(value);
+    }
 
     if (transaction != nullptr) {
         ReleaseLatchedPages(transaction, OpType::SEARCH, false);
@@ -84,6 +120,34 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value,
         return true;
     }
 
+    // optimistic descent first: when the leaf has room the insert cannot
+    // split, so the write latches on the inner path are unnecessary
+    if (transaction != nullptr) {
+        Page *leaf_page = FindLeafPageOptimistic(key, OpType::INSERT);
+        if (leaf_page != nullptr) {
+            auto leaf_node =
+                    reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(leaf_page->GetData());
+            int old_size = leaf_node->GetSize();
+            bool inserted = leaf_node->Insert(key, value, comparator_) != old_size;
+            if (inserted && lazy_reclaim_) {
+                // the leaf is warm again, drop any pending cleanup for it
+                std::lock_guard<std::mutex> guard(underfull_mutex_);
+                underfull_leaves_.erase(leaf_page->GetPageId());
+            }
+            leaf_page->WUnlatch();
+            buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), inserted);
+            return inserted;
+        }
+        // the leaf was full, restart with write latches down the path
+        PerfCount(PerfCounter::BPLUS_RESTART);
+        root_pid_mutex.lock();
+        if (IsEmpty()) {
+            StartNewTree(key, value);
+            root_pid_mutex.unlock();
+            return true;
+        }
+    }
+
     return InsertIntoLeaf(key, value, transaction);
 }
 
@@ -124,10 +188,31 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
     int new_size = leaf_page->Insert(key, value, comparator_);
     bool inserted = new_size != old_size;
 
+    if (inserted && lazy_reclaim_) {
+        // the leaf is warm again, drop any pending cleanup for it
+        std::lock_guard<std::mutex> guard(underfull_mutex_);
+        underfull_leaves_.erase(leaf_page->GetPageId());
+    }
+
     if (new_size > leaf_page->GetMaxSize()) {
-        auto new_node = Split(leaf_page);
-        // copy the first key in the new node to parent
-        InsertIntoParent(leaf_page, new_node->KeyAt(0), new_node, transaction);
+        // an overflow caused by appending to the rightmost leaf means the
+        // key sequence is (locally) increasing; split high so the left
+        // page stays ~90% full instead of leaving it half empty forever
+        int move_count = 0;
+        if (leaf_page->GetNextPageId() == INVALID_PAGE_ID &&
+            comparator_(key, leaf_page->KeyAt(new_size - 1)) == 0) {
+            move_count = std::max(1, (leaf_page->GetMaxSize() + 1) / 10);
+        }
+        auto new_node = Split(leaf_page, move_count);
+        // promote a minimal separator instead of the full first key of the
+        // new node, so multi-column keys sharing a long prefix compare
+        // cheaply on the way down
+        KeyType separator = comparator_.TruncateSeparator(
+            leaf_page->KeyAt(leaf_page->GetSize() - 1), new_node->KeyAt(0));
+        // the high key must match the parent separator, otherwise a stale
+        // B-link descent and a fresh one would disagree on the split point
+        leaf_page->SetHighKey(separator);
+        InsertIntoParent(leaf_page, separator, new_node, transaction);
         buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);
     }
 
@@ -149,7 +234,7 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
  * of key & value pairs from input page to newly created page
  */
 INDEX_TEMPLATE_ARGUMENTS
-template <typename N> N *BPLUSTREE_TYPE::Split(N *node) {
+template <typename N> N *BPLUSTREE_TYPE::Split(N *node, int move_count) {
     page_id_t new_page_id;
     Page *new_page = buffer_pool_manager_->NewPage(new_page_id);
     if (new_page == nullptr) {
@@ -158,7 +243,7 @@ template <typename N> N *BPLUSTREE_TYPE::Split(N *node) {
 
     auto new_node = reinterpret_cast<N *>(new_page->GetData());
     new_node->Init(new_page_id, node->GetParentPageId());
-    node->MoveHalfTo(new_node, buffer_pool_manager_);
+    node->MoveHalfTo(new_node, buffer_pool_manager_, move_count);
 
     return new_node;
 }
@@ -207,6 +292,181 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node,
     }
 }
 
+/*
+ * Build the tree from pairs sorted by key. Leaf pages are filled packed from
+ * left to right (keeping the tail leaf at min size so removes stay legal),
+ * then each internal level is built bottom-up from the first keys of the
+ * level below, until a single node remains to become the root. No latching
+ * is needed beyond the root pid mutex since the pages are not reachable
+ * until the root page id is published at the end.
+ * @return: false when the tree is not empty, bulk load only builds from
+ * scratch
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoad(
+        const std::vector<std::pair<KeyType, ValueType>> &items) {
+    std::lock_guard<std::mutex> root_pid_lock(root_pid_mutex);
+
+    if (!IsEmpty()) {
+        return false;
+    }
+    if (items.empty()) {
+        return true;
+    }
+
+    // write packed leaves left to right, linked through next page id
+    std::vector<std::pair<KeyType, page_id_t>> level;
+    B_PLUS_TREE_LEAF_PAGE_TYPE *prev_leaf = nullptr;
+    size_t pos = 0;
+    while (pos < items.size()) {
+        page_id_t leaf_page_id;
+        Page *new_page = buffer_pool_manager_->NewPage(leaf_page_id);
+        if (new_page == nullptr) {
+            throw Exception("failed to allocate new page");
+        }
+        auto leaf_node =
+                reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(new_page->GetData());
+        leaf_node->Init(leaf_page_id, INVALID_PAGE_ID);
+
+        size_t remaining = items.size() - pos;
+        size_t take = std::min<size_t>(leaf_node->GetMaxSize(), remaining);
+        // leave the tail leaf at least min size by filling this one less
+        if (remaining > take &&
+            remaining - take < static_cast<size_t>(leaf_node->GetMinSize())) {
+            take = remaining - leaf_node->GetMinSize();
+        }
+        for (size_t i = 0; i < take; ++i, ++pos) {
+            leaf_node->Insert(items[pos].first, items[pos].second, comparator_);
+        }
+
+        if (prev_leaf != nullptr) {
+            prev_leaf->SetNextPageId(leaf_page_id);
+            prev_leaf->SetHighKey(leaf_node->KeyAt(0));
+            leaf_node->SetPrevPageId(prev_leaf->GetPageId());
+            buffer_pool_manager_->UnpinPage(prev_leaf->GetPageId(), true);
+        }
+        level.emplace_back(leaf_node->KeyAt(0), leaf_page_id);
+        prev_leaf = leaf_node;
+    }
+    buffer_pool_manager_->UnpinPage(prev_leaf->GetPageId(), true);
+
+    // build internal levels bottom-up until a single node remains
+    while (level.size() > 1) {
+        std::vector<std::pair<KeyType, page_id_t>> next_level;
+        BPLUSTREE_INTERNAL_TYPE *prev_internal = nullptr;
+        size_t i = 0;
+        while (i < level.size()) {
+            page_id_t internal_page_id;
+            Page *new_page = buffer_pool_manager_->NewPage(internal_page_id);
+            if (new_page == nullptr) {
+                throw Exception("failed to allocate new page");
+            }
+            auto internal_node =
+                    reinterpret_cast<BPLUSTREE_INTERNAL_TYPE *>(new_page->GetData());
+            internal_node->Init(internal_page_id, INVALID_PAGE_ID);
+
+            size_t remaining = level.size() - i;
+            size_t take = std::min<size_t>(internal_node->GetMaxSize(), remaining);
+            // never leave a node with a single child
+            if (remaining - take == 1) {
+                --take;
+            }
+
+            internal_node->PopulateNewRoot(level[i].second, level[i + 1].first,
+                                           level[i + 1].second);
+            for (size_t j = i + 2; j < i + take; ++j) {
+                internal_node->InsertNodeAfter(level[j - 1].second, level[j].first,
+                                               level[j].second);
+            }
+            for (size_t j = i; j < i + take; ++j) {
+                auto child_node = FetchPage<BPlusTreePage *>(level[j].second);
+                child_node->SetParentPageId(internal_page_id);
+                buffer_pool_manager_->UnpinPage(level[j].second, true);
+            }
+
+            if (prev_internal != nullptr) {
+                prev_internal->SetNextPageId(internal_page_id);
+                prev_internal->SetHighKey(level[i].first);
+                buffer_pool_manager_->UnpinPage(prev_internal->GetPageId(), true);
+            }
+            next_level.emplace_back(level[i].first, internal_page_id);
+            prev_internal = internal_node;
+            i += take;
+        }
+        buffer_pool_manager_->UnpinPage(prev_internal->GetPageId(), true);
+        level.swap(next_level);
+    }
+
+    root_page_id_ = level[0].second;
+    UpdateRootPageId(true);
+    return true;
+}
+
+/*
+ * Insert a batch of key & value pairs with one descent per leaf run: the
+ * input is sorted in place, and after each descent every entry below the
+ * leaf's bound is applied under the same pin, so nearly-sorted input turns
+ * into sequential leaf appends. Splits reuse the single-insert path. The
+ * root page id mutex is held for the whole batch, like BulkLoad.
+ * @return: number of entries actually inserted (duplicates are skipped)
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::InsertBatch(
+        std::vector<std::pair<KeyType, ValueType>> &items) {
+    std::sort(items.begin(), items.end(),
+              [this](const std::pair<KeyType, ValueType> &lhs,
+                     const std::pair<KeyType, ValueType> &rhs) {
+                  return comparator_(lhs.first, rhs.first) < 0;
+              });
+
+    std::lock_guard<std::mutex> root_pid_lock(root_pid_mutex);
+
+    int inserted = 0;
+    size_t pos = 0;
+    while (pos < items.size()) {
+        if (IsEmpty()) {
+            StartNewTree(items[pos].first, items[pos].second);
+            ++inserted;
+            ++pos;
+            continue;
+        }
+
+        auto leaf_page = FindLeafPage(items[pos].first, nullptr, OpType::INSERT);
+        bool dirty = false;
+        while (pos < items.size()) {
+            // the rest of the run belongs to a right sibling
+            if (leaf_page->HasHighKey() &&
+                comparator_(items[pos].first, leaf_page->GetHighKey()) >= 0) {
+                break;
+            }
+
+            int old_size = leaf_page->GetSize();
+            int new_size =
+                leaf_page->Insert(items[pos].first, items[pos].second, comparator_);
+            if (new_size != old_size) {
+                ++inserted;
+                dirty = true;
+            }
+            ++pos;
+
+            if (new_size > leaf_page->GetMaxSize()) {
+                // split exactly like InsertIntoLeaf, then re-descend since
+                // the run may continue in the new right sibling
+                auto new_node = Split(leaf_page);
+                KeyType separator = comparator_.TruncateSeparator(
+                    leaf_page->KeyAt(leaf_page->GetSize() - 1), new_node->KeyAt(0));
+                leaf_page->SetHighKey(separator);
+                InsertIntoParent(leaf_page, separator, new_node, nullptr);
+                buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);
+                break;
+            }
+        }
+        buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), dirty);
+    }
+
+    return inserted;
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -216,15 +476,46 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node,
  * If not, User needs to first find the right leaf page as deletion target, then
  * delete entry from leaf page. Remember to deal with redistribute or merge if
  * necessary.
+ * @return: true when the key was present and removed
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+bool BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
     // lock root pid until root page latch is released by a txn
     root_pid_mutex.lock();
 
     if (IsEmpty()) {
         root_pid_mutex.unlock();
-        return;
+        return false;
+    }
+
+    // optimistic descent first: when the leaf stays above min size the
+    // delete cannot coalesce, so only the leaf needs a write latch
+    if (transaction != nullptr) {
+        Page *leaf_page = FindLeafPageOptimistic(key, OpType::DELETE);
+        if (leaf_page != nullptr) {
+            auto leaf_node =
+                    reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(leaf_page->GetData());
+            int old_size = leaf_node->GetSize();
+            bool removed =
+                    leaf_node->RemoveAndDeleteRecord(key, comparator_) != old_size;
+            if (removed && lazy_reclaim_ &&
+                leaf_node->GetSize() < leaf_node->GetMinSize() &&
+                !leaf_node->IsRootPage()) {
+                // tolerate the underfull leaf, queue it for a cleanup pass
+                std::lock_guard<std::mutex> guard(underfull_mutex_);
+                underfull_leaves_.insert(leaf_page->GetPageId());
+            }
+            leaf_page->WUnlatch();
+            buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), removed);
+            return removed;
+        }
+        // the leaf could underflow, restart with write latches down the path
+        PerfCount(PerfCounter::BPLUS_RESTART);
+        root_pid_mutex.lock();
+        if (IsEmpty()) {
+            root_pid_mutex.unlock();
+            return false;
+        }
     }
 
     auto leaf_page = FindLeafPage(key, transaction, OpType::DELETE);
@@ -232,8 +523,17 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
     int new_size = leaf_page->RemoveAndDeleteRecord(key, comparator_);
     bool removed = new_size != old_size;
 
-    bool delete_page = removed && new_size < leaf_page->GetMinSize() &&
-                       CoalesceOrRedistribute(leaf_page, transaction);
+    bool underfull = removed && new_size < leaf_page->GetMinSize();
+    bool delete_page = false;
+    if (underfull && lazy_reclaim_ && new_size > 0 && !leaf_page->IsRootPage()) {
+        // deferred reclamation: leave the underfull leaf in place and queue
+        // it for a cleanup pass instead of merging under the parent write
+        // latches held right now; only an emptied leaf is merged eagerly
+        std::lock_guard<std::mutex> guard(underfull_mutex_);
+        underfull_leaves_.insert(leaf_page->GetPageId());
+    } else if (underfull) {
+        delete_page = CoalesceOrRedistribute(leaf_page, transaction);
+    }
 
     if (transaction != nullptr) {
         if (delete_page) {
@@ -247,6 +547,146 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
         }
         root_pid_mutex.unlock();
     }
+
+    return removed;
+}
+
+/*
+ * Bulk range removal for expiry passes. Each iteration descends once to
+ * the leaf holding the cursor key, clears that leaf's overlap with
+ * [low, high] in one pass, and notes the first key of the right sibling
+ * as the next cursor before any restructuring can move it. A leaf left
+ * empty is detached through the ordinary coalesce path (which unlinks it
+ * from both the chain and its parent); a merely underfull one follows
+ * the lazy-reclaim rules of Remove. Single-writer like InsertBatch.
+ * @return: number of keys removed
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::RemoveRange(const KeyType &low, const KeyType &high) {
+    if (comparator_(low, high) > 0) {
+        return 0;
+    }
+
+    int removed = 0;
+    KeyType cursor = low;
+    bool done = false;
+    while (!done) {
+        root_pid_mutex.lock();
+        if (IsEmpty()) {
+            root_pid_mutex.unlock();
+            break;
+        }
+
+        auto leaf_page = FindLeafPage(cursor, nullptr, OpType::DELETE);
+        int cleared = leaf_page->RemoveRange(low, high, comparator_);
+        removed += cleared;
+        int new_size = leaf_page->GetSize();
+
+        // the range ends here when no right sibling exists or the bound
+        // proves every key beyond this leaf is > high
+        page_id_t next_page_id = leaf_page->GetNextPageId();
+        done = next_page_id == INVALID_PAGE_ID ||
+               (leaf_page->HasHighKey() &&
+                comparator_(high, leaf_page->GetHighKey()) < 0);
+        if (!done) {
+            // the sibling's first key survives any merge below, and the
+            // next descent re-finds it wherever it ends up
+            auto next_leaf = FetchPage<B_PLUS_TREE_LEAF_PAGE_TYPE *>(next_page_id);
+            cursor = next_leaf->KeyAt(0);
+            buffer_pool_manager_->UnpinPage(next_page_id, false);
+        }
+
+        bool underfull = cleared > 0 && new_size < leaf_page->GetMinSize();
+        bool delete_page = false;
+        if (underfull && lazy_reclaim_ && new_size > 0 &&
+            !leaf_page->IsRootPage()) {
+            std::lock_guard<std::mutex> guard(underfull_mutex_);
+            underfull_leaves_.insert(leaf_page->GetPageId());
+        } else if (underfull) {
+            delete_page = CoalesceOrRedistribute(leaf_page, nullptr);
+        }
+
+        page_id_t leaf_id = leaf_page->GetPageId();
+        buffer_pool_manager_->UnpinPage(leaf_id, cleared > 0);
+        if (delete_page) {
+            buffer_pool_manager_->DeletePage(leaf_id);
+        }
+        root_pid_mutex.unlock();
+    }
+
+    return removed;
+}
+
+/*
+ * Enable or disable deferred merging of underfull leaves, see the header
+ * for the intended usage
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetLazyReclaim(bool enable) {
+    lazy_reclaim_ = enable;
+}
+
+/*
+ * Merge or rebalance every leaf queued by a deferred delete that is still
+ * underfull. Inserts drop touched leaves from the queue, so whatever is
+ * left has stayed cold since it was queued; each one is re-found through
+ * a pessimistic descent and revalidated under latches, since it may have
+ * been merged, refilled or recycled in the meantime.
+ * @return: number of leaves merged or rebalanced
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::ReclaimUnderfullLeaves(Transaction *transaction) {
+    std::vector<page_id_t> cold_leaves;
+    {
+        std::lock_guard<std::mutex> guard(underfull_mutex_);
+        cold_leaves.assign(underfull_leaves_.begin(), underfull_leaves_.end());
+        underfull_leaves_.clear();
+    }
+
+    int reclaimed = 0;
+    for (auto page_id : cold_leaves) {
+        root_pid_mutex.lock();
+        if (IsEmpty()) {
+            root_pid_mutex.unlock();
+            break;
+        }
+
+        // peek at the queued page for a key to descend with
+        auto peek_node = FetchPage<BPlusTreePage *>(page_id);
+        if (!peek_node->IsLeafPage() || peek_node->IsRootPage() ||
+            peek_node->GetSize() == 0 ||
+            peek_node->GetSize() >= peek_node->GetMinSize()) {
+            buffer_pool_manager_->UnpinPage(page_id, false);
+            root_pid_mutex.unlock();
+            continue;
+        }
+        KeyType key =
+            reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(peek_node)->KeyAt(0);
+        buffer_pool_manager_->UnpinPage(page_id, false);
+
+        auto leaf_page = FindLeafPage(key, transaction, OpType::DELETE);
+        bool delete_page = false;
+        if (leaf_page->GetPageId() == page_id &&
+            leaf_page->GetSize() < leaf_page->GetMinSize()) {
+            delete_page = CoalesceOrRedistribute(leaf_page, transaction);
+            ++reclaimed;
+        }
+
+        if (transaction != nullptr) {
+            if (delete_page) {
+                transaction->AddIntoDeletedPageSet(leaf_page->GetPageId());
+            }
+            ReleaseLatchedPages(transaction, OpType::DELETE, true);
+        } else {
+            buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
+            if (delete_page) {
+                buffer_pool_manager_->DeletePage(leaf_page->GetPageId());
+            }
+            root_pid_mutex.unlock();
+        }
+    }
+
+    return reclaimed;
 }
 
 /*
@@ -400,6 +840,35 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
  * index iterator
  * @return : index iterator
  */
+/*
+ * Walk the leaf chain and tally pages, entries and capacity; the resulting
+ * fill factor shows whether splits are leaving pages half empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+BPlusTreeStats BPLUSTREE_TYPE::GetOccupancyStats() {
+    BPlusTreeStats stats;
+    std::lock_guard<std::mutex> root_pid_lock(root_pid_mutex);
+
+    if (IsEmpty()) {
+        return stats;
+    }
+
+    KeyType empty_key;
+    auto leaf_page = FindLeafPage(empty_key, nullptr, OpType::SEARCH, true);
+    while (leaf_page != nullptr) {
+        stats.leaf_pages++;
+        stats.leaf_entries += leaf_page->GetSize();
+        stats.leaf_capacity += leaf_page->GetMaxSize();
+        page_id_t next_page_id = leaf_page->GetNextPageId();
+        buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+        leaf_page = next_page_id == INVALID_PAGE_ID
+                            ? nullptr
+                            : FetchPage<B_PLUS_TREE_LEAF_PAGE_TYPE *>(
+                                      next_page_id);
+    }
+    return stats;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
     std::lock_guard<std::mutex> root_pid_lock(root_pid_mutex);
@@ -436,6 +905,71 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
     return iterator;
 }
 
+/*
+ * Construct a reverse index iterator positioned at the last key in the
+ * tree; operator++ then walks leaves right to left through the previous
+ * page ids
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin() {
+    std::lock_guard<std::mutex> root_pid_lock(root_pid_mutex);
+
+    if (IsEmpty()) {
+        return INDEXITERATOR_TYPE(0, nullptr, buffer_pool_manager_, true);
+    }
+
+    // descend along the rightmost child on every level
+    auto curr_page = FetchPage<Page *>(root_page_id_);
+    auto curr_btree_page = reinterpret_cast<BPlusTreePage *>(curr_page->GetData());
+    while (!curr_btree_page->IsLeafPage()) {
+        auto internal_page = reinterpret_cast<BPLUSTREE_INTERNAL_TYPE *>(curr_page);
+        page_id_t next_page_id = internal_page->ValueAt(internal_page->GetSize() - 1);
+        curr_page = FetchPage<Page *>(next_page_id);
+        curr_btree_page = reinterpret_cast<BPlusTreePage *>(curr_page->GetData());
+        buffer_pool_manager_->UnpinPage(internal_page->GetPageId(), false);
+    }
+
+    auto leaf_page = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(curr_btree_page);
+    return INDEXITERATOR_TYPE(leaf_page->GetSize() - 1, leaf_page,
+                              buffer_pool_manager_, true);
+}
+
+/*
+ * Input parameter is high key, find the last entry whose key <= input key,
+ * then construct a reverse index iterator from there
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin(const KeyType &key) {
+    std::lock_guard<std::mutex> root_pid_lock(root_pid_mutex);
+
+    if (IsEmpty()) {
+        return INDEXITERATOR_TYPE(0, nullptr, buffer_pool_manager_, true);
+    }
+
+    auto leaf_page = FindLeafPage(key, nullptr, OpType::SEARCH);
+    // KeyIndex returns the first entry >= key, so step back when it lands
+    // past the input key (or past the end of the page)
+    int index = leaf_page->KeyIndex(key, comparator_);
+    if (index >= leaf_page->GetSize() ||
+        comparator_(key, leaf_page->KeyAt(index)) < 0) {
+        --index;
+    }
+    if (index < 0) {
+        // every entry in this leaf is greater than the key, back up one leaf
+        page_id_t prev_page_id = leaf_page->GetPrevPageId();
+        buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+        if (prev_page_id == INVALID_PAGE_ID) {
+            return INDEXITERATOR_TYPE(0, nullptr, buffer_pool_manager_, true);
+        }
+        leaf_page = FetchPage<B_PLUS_TREE_LEAF_PAGE_TYPE *>(prev_page_id);
+        index = leaf_page->GetSize() - 1;
+    }
+
+    return INDEXITERATOR_TYPE(index, leaf_page, buffer_pool_manager_, true);
+}
+
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
@@ -475,6 +1009,195 @@ B_PLUS_TREE_LEAF_PAGE_TYPE *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key,
     return reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(curr_btree_page);
 }
 
+/*
+ * Latch-free point lookup: descend without latching any page, validating
+ * each page's version counter around the reads instead (see Page::WLatch).
+ * An odd version means a writer holds the page; a version that changed
+ * between reading a page and acting on what was read means the read may be
+ * torn. Either way the method returns false so the caller can restart. The
+ * child is pinned before its parent is revalidated, so an unchanged parent
+ * proves the child pointer was current when the pin was taken. Splits that
+ * race the descent are absorbed by chasing B-link high keys, same as the
+ * latched paths. On success exists reports whether the key was found.
+ * root page id mutex must be locked before this; it is always released
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::GetValueOptimistic(const KeyType &key, ValueType &value,
+                                        bool &exists) {
+    auto curr_page = FetchPage<Page *>(root_page_id_);
+    uint64_t curr_version = curr_page->GetVersion();
+    root_pid_mutex.unlock();
+
+    while (true) {
+        if (curr_version % 2 == 1) {
+            // a writer holds the page right now
+            buffer_pool_manager_->UnpinPage(curr_page->GetPageId(), false);
+            return false;
+        }
+
+        auto btree_page = reinterpret_cast<BPlusTreePage *>(curr_page->GetData());
+        page_id_t next_page_id;
+        if (btree_page->IsLeafPage()) {
+            auto leaf_page =
+                    reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(curr_page->GetData());
+            if (!leaf_page->HasHighKey() ||
+                comparator_(key, leaf_page->GetHighKey()) < 0) {
+                ValueType leaf_value;
+                bool found = leaf_page->Lookup(key, leaf_value, comparator_);
+                bool stable = curr_page->GetVersion() == curr_version;
+                buffer_pool_manager_->UnpinPage(curr_page->GetPageId(), false);
+                if (!stable) {
+                    return false;
+                }
+                if (found) {
+                    value = leaf_value;
+                }
+                exists = found;
+                return true;
+            }
+            next_page_id = leaf_page->GetNextPageId();
+        } else {
+            auto internal_page =
+                    reinterpret_cast<BPLUSTREE_INTERNAL_TYPE *>(curr_page->GetData());
+            if (!internal_page->HasHighKey() ||
+                comparator_(key, internal_page->GetHighKey()) < 0) {
+                next_page_id = internal_page->Lookup(key, comparator_);
+            } else {
+                next_page_id = internal_page->GetNextPageId();
+            }
+        }
+
+        // reject the pointer before fetching it in case it was torn
+        if (next_page_id == INVALID_PAGE_ID ||
+            curr_page->GetVersion() != curr_version) {
+            buffer_pool_manager_->UnpinPage(curr_page->GetPageId(), false);
+            return false;
+        }
+
+        auto next_page = FetchPage<Page *>(next_page_id);
+        uint64_t next_version = next_page->GetVersion();
+        if (curr_page->GetVersion() != curr_version) {
+            buffer_pool_manager_->UnpinPage(next_page->GetPageId(), false);
+            buffer_pool_manager_->UnpinPage(curr_page->GetPageId(), false);
+            return false;
+        }
+        buffer_pool_manager_->UnpinPage(curr_page->GetPageId(), false);
+        curr_page = next_page;
+        curr_version = next_version;
+    }
+}
+
+/*
+ * B-link move right: while the key falls at or beyond the node's high key a
+ * concurrent split has carried its range to a right sibling, so chase the
+ * sibling chain (latch coupled, write mode for leaves and read mode for
+ * inner pages) instead of descending into the wrong subtree. The input page
+ * must already be latched in the matching mode.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::MoveRight(Page *page, const KeyType &key) {
+    while (true) {
+        auto btree_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
+        page_id_t next_page_id;
+        if (btree_page->IsLeafPage()) {
+            auto leaf_page = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
+            if (!leaf_page->HasHighKey() ||
+                comparator_(key, leaf_page->GetHighKey()) < 0) {
+                break;
+            }
+            next_page_id = leaf_page->GetNextPageId();
+        } else {
+            auto internal_page = reinterpret_cast<BPLUSTREE_INTERNAL_TYPE *>(page->GetData());
+            if (!internal_page->HasHighKey() ||
+                comparator_(key, internal_page->GetHighKey()) < 0) {
+                break;
+            }
+            next_page_id = internal_page->GetNextPageId();
+        }
+
+        auto next_page = FetchPage<Page *>(next_page_id);
+        // siblings are always of the same type
+        if (btree_page->IsLeafPage()) {
+            next_page->WLatch();
+            page->WUnlatch();
+        } else {
+            next_page->RLatch();
+            page->RUnlatch();
+        }
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        page = next_page;
+    }
+
+    return page;
+}
+
+/*
+ * Optimistic descent for single-key updates: inner pages are latched in read
+ * mode (coupled parent to child) and only the leaf takes a write latch, so
+ * concurrent updates no longer serialize on a write-latched root. Returns
+ * the leaf write-latched and pinned when the update cannot propagate above
+ * it, otherwise releases everything and returns nullptr so the caller
+ * restarts with pessimistic latching.
+ * root page id mutex must be locked before this; it is always released
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageOptimistic(const KeyType &key,
+                                             OpType op_type) {
+    auto curr_page = FetchPage<Page *>(root_page_id_);
+    auto curr_btree_page = reinterpret_cast<BPlusTreePage *>(curr_page->GetData());
+
+    // the mutex keeps the root page id and the root's type stable until the
+    // first latch is held
+    if (curr_btree_page->IsLeafPage()) {
+        curr_page->WLatch();
+    } else {
+        curr_page->RLatch();
+    }
+    root_pid_mutex.unlock();
+    curr_page = MoveRight(curr_page, key);
+    curr_btree_page = reinterpret_cast<BPlusTreePage *>(curr_page->GetData());
+
+    while (!curr_btree_page->IsLeafPage()) {
+        auto internal_page = reinterpret_cast<BPLUSTREE_INTERNAL_TYPE *>(curr_page);
+        page_id_t next_page_id = internal_page->Lookup(key, comparator_);
+        auto next_page = FetchPage<Page *>(next_page_id);
+        auto next_btree_page = reinterpret_cast<BPlusTreePage *>(next_page->GetData());
+
+        next_page->RLatch();
+        if (next_btree_page->IsLeafPage()) {
+            // trade the read latch for a write latch; the parent's read
+            // latch keeps the leaf from being split or merged in between,
+            // only its entries can change
+            next_page->RUnlatch();
+            next_page->WLatch();
+        }
+        curr_page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(curr_page->GetPageId(), false);
+        curr_page = MoveRight(next_page, key);
+        curr_btree_page = reinterpret_cast<BPlusTreePage *>(curr_page->GetData());
+    }
+
+    // safe when the update stays within the leaf, mirroring the release
+    // conditions of AcquireLatchOnPage
+    bool safe;
+    if (op_type == OpType::INSERT) {
+        safe = curr_btree_page->GetSize() < curr_btree_page->GetMaxSize();
+    } else if (lazy_reclaim_) {
+        // deferred reclamation tolerates underfull leaves, so only a
+        // delete that would empty the leaf has to restart pessimistically
+        safe = curr_btree_page->GetSize() > 1;
+    } else {
+        safe = curr_btree_page->GetSize() > curr_btree_page->GetMinSize();
+    }
+    if (!safe) {
+        curr_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(curr_page->GetPageId(), false);
+        return nullptr;
+    }
+
+    return curr_page;
+}
+
 /*
  * Update/Insert root page id in header page(where page_id = 0, header_page is
  * defined under include/page/header_page.h)
@@ -485,6 +1208,17 @@ B_PLUS_TREE_LEAF_PAGE_TYPE *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key,
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
+    // with a catalog the record may live on any page of the chain and the
+    // cached copy must stay coherent, so route through it
+    if (catalog_ != nullptr) {
+        if (insert_record) {
+            catalog_->InsertRecord(index_name_, root_page_id_);
+        } else {
+            catalog_->UpdateRecord(index_name_, root_page_id_);
+        }
+        return;
+    }
+
     HeaderPage *header_page = static_cast<HeaderPage *>(
             buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
     if (insert_record) {
@@ -11,19 +11,57 @@ namespace cmudb {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(IndexMetadata *metadata,
                                      BufferPoolManager *buffer_pool_manager,
-                                     page_id_t root_page_id)
+                                     page_id_t root_page_id, Catalog *catalog)
         : Index(metadata), comparator_(metadata->GetKeySchema()),
           container_(metadata->GetName(), buffer_pool_manager, comparator_,
-                     root_page_id) {}
+                     root_page_id, catalog) {}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid,
                                        Transaction *transaction) {
     // construct insert index key
     KeyType index_key;
-    index_key.SetFromKey(key);
+    index_key.SetFromKey(key, GetKeySchema());
 
-    container_.Insert(index_key, rid, transaction);
+    // add to the filter before the tree so a concurrent probe can never
+    // see the key in the tree but not in the filter; a rejected duplicate
+    // is taken back out afterwards
+    if (bloom_filter_ != nullptr) {
+        bloom_filter_->Insert(reinterpret_cast<const char *>(&index_key),
+                              sizeof(KeyType));
+    }
+    bool inserted = container_.Insert(index_key, rid, transaction);
+    if (!inserted && bloom_filter_ != nullptr) {
+        bloom_filter_->Delete(reinterpret_cast<const char *>(&index_key),
+                              sizeof(KeyType));
+    }
+}
+
+/*
+ * Batch insert: the container sorts the batch and fills runs of keys into
+ * each leaf with a single descent, so multi-row statements touch the inner
+ * pages far less than one Insert per entry would
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::InsertEntries(
+        std::vector<std::pair<Tuple, RID>> &entries,
+        Transaction *transaction) {
+    std::vector<std::pair<KeyType, ValueType>> items;
+    items.reserve(entries.size());
+    for (auto &entry : entries) {
+        KeyType index_key;
+        index_key.SetFromKey(entry.first, GetKeySchema());
+        items.emplace_back(index_key, entry.second);
+        // the batch does not report which entries were duplicates, so a
+        // rejected one leaves its counters inflated: a false positive at
+        // worst, never a false negative
+        if (bloom_filter_ != nullptr) {
+            bloom_filter_->Insert(reinterpret_cast<const char *>(&index_key),
+                                  sizeof(KeyType));
+        }
+    }
+
+    container_.InsertBatch(items);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -31,9 +69,15 @@ void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key,
                                        Transaction *transaction) {
     // construct delete index key
     KeyType index_key;
-    index_key.SetFromKey(key);
+    index_key.SetFromKey(key, GetKeySchema());
 
-    container_.Remove(index_key, transaction);
+    // only a delete that actually removed the key may decrement the
+    // filter, otherwise an absent key could drain a present key's counters
+    bool removed = container_.Remove(index_key, transaction);
+    if (removed && bloom_filter_ != nullptr) {
+        bloom_filter_->Delete(reinterpret_cast<const char *>(&index_key),
+                              sizeof(KeyType));
+    }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -41,10 +85,137 @@ void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> &result,
                                    Transaction *transaction) {
     // construct scan index key
     KeyType index_key;
-    index_key.SetFromKey(key);
+    index_key.SetFromKey(key, GetKeySchema());
+
+    // a definite miss in the filter saves the whole descent
+    if (bloom_filter_ != nullptr &&
+        !bloom_filter_->MayContain(reinterpret_cast<const char *>(&index_key),
+                                   sizeof(KeyType))) {
+        return;
+    }
 
     container_.GetValue(index_key, result, transaction);
 }
+
+/*
+ * Attach the bloom filter and seed it from the tree: on open the filter
+ * starts empty while the index may not, so every existing key is fed in
+ * through one leaf chain walk. GenericKey is a fixed zero-padded byte
+ * array, so equal keys always hash identically.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::EnableBloomFilter(size_t expected_keys) {
+    bloom_filter_.reset(new BloomFilter(expected_keys));
+    if (container_.IsEmpty()) {
+        return;
+    }
+    for (auto iter = container_.Begin(); !iter.isEnd(); ++iter) {
+        KeyType index_key = (*iter).first;
+        bloom_filter_->Insert(reinterpret_cast<const char *>(&index_key),
+                              sizeof(KeyType));
+    }
+}
+
+/*
+ * Index-only point scan: every match carries exactly the probe key's
+ * column values, so they are rebuilt once from the probe and replicated
+ * per rid; the heap row is never touched
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::ScanKeyIndexOnly(
+        const Tuple &key, std::vector<RID> &result,
+        std::vector<std::vector<Value>> &values, Transaction *transaction) {
+    const size_t old_size = result.size();
+    ScanKey(key, result, transaction);
+
+    Schema *key_schema = GetKeySchema();
+    std::vector<Value> key_values;
+    for (int i = 0; i < key_schema->GetColumnCount(); i++)
+        key_values.push_back(key.GetValue(key_schema, i));
+    values.insert(values.end(), result.size() - old_size, key_values);
+    return true;
+}
+
+/*
+ * Range scan: position an iterator at the lower bound (or the first leaf
+ * when the range is open below) and walk forward until the key passes the
+ * upper bound
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::ScanRange(const Tuple *low, const Tuple *high,
+                                     bool low_inclusive, bool high_inclusive,
+                                     std::vector<RID> &result,
+                                     Transaction *transaction) {
+    return ScanRangeInternal(low, high, low_inclusive, high_inclusive, result,
+                             nullptr);
+}
+
+/*
+ * Index-only range scan: the leaves store the full key, so the indexed
+ * column values of every qualifying entry are rebuilt in place during the
+ * walk instead of re-fetched from the heap afterwards
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::ScanRangeIndexOnly(
+        const Tuple *low, const Tuple *high, bool low_inclusive,
+        bool high_inclusive, std::vector<RID> &result,
+        std::vector<std::vector<Value>> &values, Transaction *transaction) {
+    return ScanRangeInternal(low, high, low_inclusive, high_inclusive, result,
+                             &values);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::ScanRangeInternal(
+        const Tuple *low, const Tuple *high, bool low_inclusive,
+        bool high_inclusive, std::vector<RID> &result,
+        std::vector<std::vector<Value>> *values) {
+    KeyType low_key;
+    KeyType high_key;
+    if (low != nullptr)
+        low_key.SetFromKey(*low, GetKeySchema());
+    if (high != nullptr)
+        high_key.SetFromKey(*high, GetKeySchema());
+
+    auto iterator =
+            low != nullptr ? container_.Begin(low_key) : container_.Begin();
+    for (; !iterator.isEnd(); ++iterator) {
+        const auto &entry = *iterator;
+        // Begin(low_key) already starts at the first key >= low, only the
+        // boundary key itself may need to be skipped
+        if (low != nullptr && !low_inclusive &&
+            comparator_(entry.first, low_key) == 0)
+            continue;
+        if (high != nullptr) {
+            int cmp = comparator_(entry.first, high_key);
+            if (cmp > 0 || (cmp == 0 && !high_inclusive))
+                break;
+        }
+        result.push_back(entry.second);
+        if (values != nullptr) {
+            Schema *key_schema = GetKeySchema();
+            std::vector<Value> key_values;
+            for (int i = 0; i < key_schema->GetColumnCount(); i++)
+                key_values.push_back(entry.first.ToValue(key_schema, i));
+            values->push_back(std::move(key_values));
+        }
+    }
+    return true;
+}
+
+/*
+ * Ordered full-index walk: the leaf chain already holds the entries
+ * sorted, so ascending starts at the leftmost leaf and descending at the
+ * rightmost (both one root-to-leaf descent) and the consumer pulls rows
+ * lazily from there
+ */
+INDEX_TEMPLATE_ARGUMENTS
+std::unique_ptr<Index::OrderedScan>
+BPLUSTREE_INDEX_TYPE::OpenOrderedScan(bool reverse) {
+    return std::unique_ptr<Index::OrderedScan>(new OrderedScanImpl(
+            reverse ? container_.RBegin() : container_.Begin(),
+            GetKeySchema()));
+}
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
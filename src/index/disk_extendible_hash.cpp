@@ -0,0 +1,296 @@
+/**
+ * disk_extendible_hash.cpp
+ */
+
+#include <cassert>
+
+#include "catalog/catalog.h"
+#include "common/exception.h"
+#include "common/rid.h"
+#include "index/disk_extendible_hash.h"
+#include "index/generic_key.h"
+#include "page/header_page.h"
+#include "type/type_kernels.h"
+
+namespace cmudb {
+
+#define DISK_HASH_TYPE DiskExtendibleHash<KeyType, ValueType, KeyComparator>
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+DISK_HASH_TYPE::DiskExtendibleHash(const std::string &name,
+                                   BufferPoolManager *buffer_pool_manager,
+                                   const KeyComparator &comparator,
+                                   page_id_t header_page_id, Catalog *catalog)
+        : index_name_(name), header_page_id_(header_page_id),
+          buffer_pool_manager_(buffer_pool_manager), comparator_(comparator),
+          catalog_(catalog) {
+    if (header_page_id_ != INVALID_PAGE_ID) {
+        return;
+    }
+
+    // fresh table: one directory page with a single empty bucket
+    Page *new_page = buffer_pool_manager_->NewPage(header_page_id_);
+    if (new_page == nullptr) {
+        throw Exception("failed to allocate new page");
+    }
+    auto header = reinterpret_cast<HashTableHeaderPage *>(new_page->GetData());
+    header->Init(header_page_id_);
+
+    auto bucket = NewBucketPage(0);
+    header->SetBucketPageId(0, bucket->GetPageId());
+    buffer_pool_manager_->UnpinPage(bucket->GetPageId(), true);
+    buffer_pool_manager_->UnpinPage(header_page_id_, true);
+
+    UpdateHeaderPageId(true);
+}
+
+/*
+ * Hash the raw key bytes (FNV-1a); keys that compare equal are built by
+ * GenericKey::SetFromKey from a zeroed buffer, so they are byte-equal
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+size_t DISK_HASH_TYPE::HashKey(const KeyType &key) const {
+    // multi-lane kernel instead of byte-serial FNV-1a; key sizes are
+    // fixed per instantiation, so the length branches resolve uniformly
+    const char *bytes = reinterpret_cast<const char *>(&key);
+    return HashBytes(bytes, sizeof(KeyType), 14695981039346656037ULL);
+}
+
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
+/*
+ * Return the only value that associated with input key
+ * This method is used for point query
+ * @return : true means key exists
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool DISK_HASH_TYPE::GetValue(const KeyType &key,
+                              std::vector<ValueType> &result,
+                              Transaction *transaction) {
+    std::lock_guard<std::mutex> table_lock(table_mutex_);
+
+    auto header = FetchPage<HashTableHeaderPage *>(header_page_id_);
+    int index = HashKey(key) & (header->GetDirectorySize() - 1);
+    page_id_t bucket_page_id = header->GetBucketPageId(index);
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
+
+    result.resize(1);
+    bool exists = false;
+    while (bucket_page_id != INVALID_PAGE_ID && !exists) {
+        auto bucket = FetchPage<BucketPage *>(bucket_page_id);
+        exists = bucket->Lookup(key, result[0], comparator_);
+        page_id_t next_page_id = bucket->GetNextPageId();
+        buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+        bucket_page_id = next_page_id;
+    }
+
+    return exists;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Insert constant key & value pair into the hash table. When the target
+ * bucket is full it is split (doubling the directory first when its local
+ * depth has caught up with the global depth); once the directory cannot
+ * grow any further the bucket spills into an overflow chain.
+ * @return: since we only support unique key, if user try to insert
+ * duplicate keys return false, otherwise return true.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool DISK_HASH_TYPE::Insert(const KeyType &key, const ValueType &value,
+                            Transaction *transaction) {
+    std::lock_guard<std::mutex> table_lock(table_mutex_);
+
+    auto header = FetchPage<HashTableHeaderPage *>(header_page_id_);
+    size_t hash = HashKey(key);
+    bool header_dirty = false;
+
+    while (true) {
+        int index = hash & (header->GetDirectorySize() - 1);
+        page_id_t primary_page_id = header->GetBucketPageId(index);
+
+        // reject duplicates anywhere in the chain
+        ValueType existing;
+        bool duplicate = false;
+        for (page_id_t page_id = primary_page_id;
+             page_id != INVALID_PAGE_ID && !duplicate;) {
+            auto bucket = FetchPage<BucketPage *>(page_id);
+            duplicate = bucket->Lookup(key, existing, comparator_);
+            page_id_t next_page_id = bucket->GetNextPageId();
+            buffer_pool_manager_->UnpinPage(page_id, false);
+            page_id = next_page_id;
+        }
+        if (duplicate) {
+            buffer_pool_manager_->UnpinPage(header_page_id_, header_dirty);
+            return false;
+        }
+
+        auto bucket = FetchPage<BucketPage *>(primary_page_id);
+        if (bucket->Insert(key, value, comparator_)) {
+            buffer_pool_manager_->UnpinPage(primary_page_id, true);
+            buffer_pool_manager_->UnpinPage(header_page_id_, header_dirty);
+            return true;
+        }
+
+        // the primary bucket is full; split while the directory allows it
+        if (bucket->GetLocalDepth() < HashTableHeaderPage::MaxGlobalDepth()) {
+            if (bucket->GetLocalDepth() == header->GetGlobalDepth()) {
+                // double the directory, the new half mirrors the old one
+                int old_size = header->GetDirectorySize();
+                header->SetGlobalDepth(header->GetGlobalDepth() + 1);
+                for (int i = 0; i < old_size; ++i) {
+                    header->SetBucketPageId(old_size + i,
+                                            header->GetBucketPageId(i));
+                }
+            }
+            SplitBucket(header, bucket);
+            buffer_pool_manager_->UnpinPage(primary_page_id, true);
+            header_dirty = true;
+            continue;
+        }
+
+        // directory maxed out: append to the overflow chain
+        while (!bucket->Insert(key, value, comparator_)) {
+            page_id_t next_page_id = bucket->GetNextPageId();
+            if (next_page_id == INVALID_PAGE_ID) {
+                auto overflow = NewBucketPage(bucket->GetLocalDepth());
+                bucket->SetNextPageId(overflow->GetPageId());
+                buffer_pool_manager_->UnpinPage(bucket->GetPageId(), true);
+                bucket = overflow;
+            } else {
+                buffer_pool_manager_->UnpinPage(bucket->GetPageId(), false);
+                bucket = FetchPage<BucketPage *>(next_page_id);
+            }
+        }
+        buffer_pool_manager_->UnpinPage(bucket->GetPageId(), true);
+        buffer_pool_manager_->UnpinPage(header_page_id_, header_dirty);
+        return true;
+    }
+}
+
+/*
+ * Split a full bucket whose local depth is still below the global depth:
+ * entries whose distinguishing hash bit is set move to a new bucket, and
+ * every directory slot of the buddy group with that bit set is repointed.
+ * Overflow chains never appear here, they are only built once the
+ * directory is maxed out and splitting has stopped.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void DISK_HASH_TYPE::SplitBucket(HashTableHeaderPage *header,
+                                 BucketPage *bucket) {
+    assert(bucket->GetLocalDepth() < header->GetGlobalDepth() ||
+           header->GetGlobalDepth() <= HashTableHeaderPage::MaxGlobalDepth());
+    assert(bucket->GetNextPageId() == INVALID_PAGE_ID);
+
+    int old_depth = bucket->GetLocalDepth();
+    auto new_bucket = NewBucketPage(old_depth + 1);
+    bucket->SetLocalDepth(old_depth + 1);
+
+    for (int i = bucket->GetSize() - 1; i >= 0; --i) {
+        if ((HashKey(bucket->KeyAt(i)) >> old_depth) & 1) {
+            new_bucket->Insert(bucket->KeyAt(i), bucket->ValueAt(i),
+                               comparator_);
+            bucket->RemoveAt(i);
+        }
+    }
+
+    for (int i = 0; i < header->GetDirectorySize(); ++i) {
+        if (header->GetBucketPageId(i) == bucket->GetPageId() &&
+            ((i >> old_depth) & 1)) {
+            header->SetBucketPageId(i, new_bucket->GetPageId());
+        }
+    }
+    buffer_pool_manager_->UnpinPage(new_bucket->GetPageId(), true);
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * Delete key & value pair associated with input key; buckets are not
+ * merged back, mirroring how rarely hash tables shrink in practice
+ * @return: true when an entry was removed
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool DISK_HASH_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+    std::lock_guard<std::mutex> table_lock(table_mutex_);
+
+    auto header = FetchPage<HashTableHeaderPage *>(header_page_id_);
+    int index = HashKey(key) & (header->GetDirectorySize() - 1);
+    page_id_t bucket_page_id = header->GetBucketPageId(index);
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
+
+    bool removed = false;
+    while (bucket_page_id != INVALID_PAGE_ID && !removed) {
+        auto bucket = FetchPage<BucketPage *>(bucket_page_id);
+        removed = bucket->Remove(key, comparator_);
+        page_id_t next_page_id = bucket->GetNextPageId();
+        buffer_pool_manager_->UnpinPage(bucket_page_id, removed);
+        bucket_page_id = next_page_id;
+    }
+
+    return removed;
+}
+
+/*****************************************************************************
+ * UTILITIES
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+typename DISK_HASH_TYPE::BucketPage *
+DISK_HASH_TYPE::NewBucketPage(int local_depth) {
+    page_id_t page_id;
+    Page *new_page = buffer_pool_manager_->NewPage(page_id);
+    if (new_page == nullptr) {
+        throw Exception("failed to allocate new page");
+    }
+
+    auto bucket = reinterpret_cast<BucketPage *>(new_page->GetData());
+    bucket->Init(page_id, local_depth);
+    return bucket;
+}
+
+/*
+ * Record the directory page id under the index name in the catalog header
+ * page (where page_id = 0), like a B+ tree records its root page id
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void DISK_HASH_TYPE::UpdateHeaderPageId(bool insert_record) {
+    // keep the cached catalog coherent when one is in use
+    if (catalog_ != nullptr) {
+        if (insert_record) {
+            catalog_->InsertRecord(index_name_, header_page_id_);
+        } else {
+            catalog_->UpdateRecord(index_name_, header_page_id_);
+        }
+        return;
+    }
+
+    HeaderPage *header_page = static_cast<HeaderPage *>(
+            buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+    if (insert_record) {
+        header_page->InsertRecord(index_name_, header_page_id_);
+    } else {
+        header_page->UpdateRecord(index_name_, header_page_id_);
+    }
+    buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename PageType>
+PageType DISK_HASH_TYPE::FetchPage(page_id_t page_id) {
+    assert(page_id != INVALID_PAGE_ID);
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    assert(page != nullptr);
+    return reinterpret_cast<PageType>(page->GetData());
+}
+
+template class DiskExtendibleHash<GenericKey<4>, RID, GenericComparator<4>>;
+template class DiskExtendibleHash<GenericKey<8>, RID, GenericComparator<8>>;
+template class DiskExtendibleHash<GenericKey<16>, RID, GenericComparator<16>>;
+template class DiskExtendibleHash<GenericKey<32>, RID, GenericComparator<32>>;
+template class DiskExtendibleHash<GenericKey<64>, RID, GenericComparator<64>>;
+
+} // namespace cmudb
@@ -0,0 +1,55 @@
+/**
+ * hash_table_index.cpp
+ */
+
+#include "index/generic_key.h"
+#include "index/hash_table_index.h"
+
+namespace cmudb {
+/*
+ * Constructor
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HASH_TABLE_INDEX_TYPE::HashTableIndex(IndexMetadata *metadata,
+                                      BufferPoolManager *buffer_pool_manager,
+                                      page_id_t header_page_id, Catalog *catalog)
+        : Index(metadata), comparator_(metadata->GetKeySchema()),
+          container_(metadata->GetName(), buffer_pool_manager, comparator_,
+                     header_page_id, catalog) {}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid,
+                                        Transaction *transaction) {
+    // construct insert index key
+    KeyType index_key;
+    index_key.SetFromKey(key, GetKeySchema());
+
+    container_.Insert(index_key, rid, transaction);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key,
+                                        Transaction *transaction) {
+    // construct delete index key
+    KeyType index_key;
+    index_key.SetFromKey(key, GetKeySchema());
+
+    container_.Remove(index_key, transaction);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> &result,
+                                    Transaction *transaction) {
+    // construct scan index key
+    KeyType index_key;
+    index_key.SetFromKey(key, GetKeySchema());
+
+    container_.GetValue(index_key, result, transaction);
+}
+template class HashTableIndex<GenericKey<4>, RID, GenericComparator<4>>;
+template class HashTableIndex<GenericKey<8>, RID, GenericComparator<8>>;
+template class HashTableIndex<GenericKey<16>, RID, GenericComparator<16>>;
+template class HashTableIndex<GenericKey<32>, RID, GenericComparator<32>>;
+template class HashTableIndex<GenericKey<64>, RID, GenericComparator<64>>;
+
+} // namespace cmudb
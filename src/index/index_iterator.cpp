@@ -14,9 +14,10 @@ namespace cmudb {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator(int offset,
                                   B_PLUS_TREE_LEAF_PAGE_TYPE *curr_page,
-                                  BufferPoolManager *buffer_pool_manager)
+                                  BufferPoolManager *buffer_pool_manager,
+                                  bool reverse)
     : offset_(offset), curr_page_(curr_page),
-      buffer_pool_manager_(buffer_pool_manager) {}
+      buffer_pool_manager_(buffer_pool_manager), reverse_(reverse) {}
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::~IndexIterator() {
@@ -25,11 +26,39 @@ INDEXITERATOR_TYPE::~IndexIterator() {
     }
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other)
+    : offset_(other.offset_), curr_page_(other.curr_page_),
+      buffer_pool_manager_(other.buffer_pool_manager_),
+      reverse_(other.reverse_) {
+    other.curr_page_ = nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator=(IndexIterator &&other) {
+    if (this != &other) {
+        if (curr_page_ != nullptr) {
+            buffer_pool_manager_->UnpinPage(curr_page_->GetPageId(), false);
+        }
+        offset_ = other.offset_;
+        curr_page_ = other.curr_page_;
+        buffer_pool_manager_ = other.buffer_pool_manager_;
+        reverse_ = other.reverse_;
+        other.curr_page_ = nullptr;
+    }
+    return *this;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 bool INDEXITERATOR_TYPE::isEnd() {
-    return curr_page_ == nullptr ||
-           (curr_page_->GetNextPageId() == INVALID_PAGE_ID &&
-           offset_ >= curr_page_->GetSize());
+    if (curr_page_ == nullptr) {
+        return true;
+    }
+    if (reverse_) {
+        return curr_page_->GetPrevPageId() == INVALID_PAGE_ID && offset_ < 0;
+    }
+    return curr_page_->GetNextPageId() == INVALID_PAGE_ID &&
+           offset_ >= curr_page_->GetSize();
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -42,6 +71,22 @@ INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
     assert(!isEnd());
 
+    if (reverse_) {
+        if (--offset_ < 0) {
+            page_id_t prev_page_id = curr_page_->GetPrevPageId();
+            // if already at the front of the first page, just return
+            if (prev_page_id == INVALID_PAGE_ID) {
+                return *this;
+            }
+            buffer_pool_manager_->UnpinPage(curr_page_->GetPageId(), false);
+            curr_page_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(
+                buffer_pool_manager_->FetchPage(prev_page_id));
+            assert(curr_page_ != nullptr);
+            offset_ = curr_page_->GetSize() - 1;
+        }
+        return *this;
+    }
+
     if (++offset_ >= curr_page_->GetSize()) {
         page_id_t next_page_id = curr_page_->GetNextPageId();
         // if already at the end of last page, just return
@@ -58,6 +103,44 @@ INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
     return *this;
 }
 
+/*
+ * Copy up to n entries starting at the current position into "out" and
+ * advance past them. Entries are taken a whole leaf at a time, so a range
+ * scan pays the page lookup once per leaf instead of once per entry.
+ * @return: number of entries copied, 0 at the end of the scan
+ */
+INDEX_TEMPLATE_ARGUMENTS
+size_t INDEXITERATOR_TYPE::NextBatch(std::vector<MappingType> &out, size_t n) {
+    assert(!reverse_);
+
+    size_t copied = 0;
+    while (copied < n && !isEnd()) {
+        int take = curr_page_->GetSize() - offset_;
+        if (static_cast<size_t>(take) > n - copied) {
+            take = static_cast<int>(n - copied);
+        }
+        for (int i = 0; i < take; ++i) {
+            out.push_back(curr_page_->GetItem(offset_ + i));
+        }
+        copied += take;
+        offset_ += take;
+
+        if (offset_ >= curr_page_->GetSize()) {
+            page_id_t next_page_id = curr_page_->GetNextPageId();
+            if (next_page_id == INVALID_PAGE_ID) {
+                break;
+            }
+            buffer_pool_manager_->UnpinPage(curr_page_->GetPageId(), false);
+            curr_page_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(
+                buffer_pool_manager_->FetchPage(next_page_id));
+            assert(curr_page_ != nullptr);
+            offset_ = 0;
+        }
+    }
+
+    return copied;
+}
+
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 template class IndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
 template class IndexIterator<GenericKey<16>, RID, GenericComparator<16>>;
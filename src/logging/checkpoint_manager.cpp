@@ -0,0 +1,90 @@
+/**
+ * checkpoint_manager.cpp
+ */
+
+#include "logging/checkpoint_manager.h"
+
+namespace cmudb {
+
+/*
+ * Take one checkpoint:
+ * 1. append a CHECKPOINT record while no transaction is active
+ * 2. wait until a log flush makes it (and everything before it) durable
+ * 3. write back every dirty page, making all logged effects durable
+ * 4. persist the record's log offset as the next redo start point
+ * Transactions beginning after step 1 run concurrently with steps 2-4;
+ * all of their records follow the checkpoint, so redo still sees them
+ */
+bool CheckpointManager::TakeCheckpoint() {
+    lsn_t lsn;
+    int log_offset;
+    if (!transaction_manager_->LogCheckpoint(lsn, log_offset)) {
+        return false;
+    }
+
+    log_manager_->GroupCommitAndWait(lsn);
+    buffer_pool_manager_->FlushAllPages();
+    disk_manager_->SetCheckpointOffset(log_offset);
+
+    return true;
+}
+
+/*
+ * Final checkpoint for a graceful stop. TakeCheckpoint already makes every
+ * logged effect durable in the pages; with no transaction in flight either,
+ * the log holds nothing left to redo or undo, which the marker records.
+ * The deploy-rollout restart then comes up without scanning the log at all
+ */
+bool CheckpointManager::ShutdownCheckpoint() {
+    if (!TakeCheckpoint()) {
+        return false;
+    }
+    disk_manager_->MarkCleanShutdown();
+    return true;
+}
+
+/*
+ * Start a separate thread that attempts a checkpoint every
+ * CHECKPOINT_TIMEOUT; attempts while transactions are active simply fail
+ * and are retried on the next wakeup
+ */
+void CheckpointManager::RunCheckpointThread() {
+    if (checkpoint_running_) {
+        return;
+    }
+    checkpoint_running_ = true;
+    checkpoint_thread_ = new std::thread(&CheckpointManager::CheckpointLoop, this);
+}
+
+/*
+ * Stop and join the checkpoint thread
+ */
+void CheckpointManager::StopCheckpointThread() {
+    if (!checkpoint_running_) {
+        return;
+    }
+    checkpoint_running_ = false;
+    checkpoint_cv_.notify_one();
+    if (checkpoint_thread_ != nullptr && checkpoint_thread_->joinable()) {
+        checkpoint_thread_->join();
+    }
+    delete checkpoint_thread_;
+    checkpoint_thread_ = nullptr;
+}
+
+/**
+ * background checkpoint loop
+ */
+void CheckpointManager::CheckpointLoop() {
+    while (checkpoint_running_) {
+        {
+            std::unique_lock<std::mutex> lock(checkpoint_latch_);
+            checkpoint_cv_.wait_for(lock, CHECKPOINT_TIMEOUT);
+        }
+        if (checkpoint_running_) {
+            TakeCheckpoint();
+        }
+    }
+}
+
+} // namespace cmudb
@@ -2,10 +2,22 @@
  * log_manager.cpp
  */
 
+#include "common/perf_trace.h"
 #include "logging/log_manager.h"
 
 namespace cmudb {
 
+// bounds for the adaptive group commit window
+static const std::chrono::microseconds GROUP_COMMIT_WINDOW_MIN(50);
+static const std::chrono::microseconds GROUP_COMMIT_WINDOW_MAX(800);
+
+// floor for the adaptive flush cadence; the ceiling is LOG_TIMEOUT
+static const std::chrono::microseconds FLUSH_INTERVAL_MIN(1000);
+
+// appenders wake the flush thread early once the buffer is half full, so
+// it drains before appends overflow into a synchronous seal-and-wait
+static const int FLUSH_FILL_THRESHOLD = LOG_BUFFER_SIZE / 2;
+
 /*
  * set ENABLE_LOGGING = true
  * Start a separate thread to execute flush to disk operation periodically
@@ -15,6 +27,9 @@ namespace cmudb {
  */
 void LogManager::RunFlushThread() {
     ENABLE_LOGGING = true;
+    // start at the configured timeout; load shrinks the cadence from there
+    flush_interval_ =
+            std::chrono::duration_cast<std::chrono::microseconds>(LOG_TIMEOUT);
     flush_thread_ = new std::thread(&LogManager::FlushLog, this);
 }
 
@@ -24,29 +39,80 @@ void LogManager::RunFlushThread() {
 void LogManager::FlushLog() {
     while (ENABLE_LOGGING) {
         std::unique_lock<std::mutex> lock(latch_);
-        cv_.wait_for(lock, LOG_TIMEOUT);
-        int last_lsn = next_lsn_ - 1;
-        int flush_size = SwapBuffer();
-        std::promise<void> promise;
-        flush_future_ = promise.get_future().share();
-        // unlock latch before disk write
-        lock.unlock();
-        disk_manager_->WriteLog(flush_buffer_, flush_size);
-        lock.lock();
-        SetPersistentLSN(last_lsn);
-        promise.set_value();
+        cv_.wait_for(lock, flush_interval_);
+        // group commit: once a committer is waiting, linger briefly so the
+        // commits arriving right behind it ride the same disk write, then
+        // adapt the window to how much extra batching it actually bought
+        if (pending_commits_ > 0) {
+            int before = pending_commits_;
+            lock.unlock();
+            std::this_thread::sleep_for(group_commit_window_);
+            lock.lock();
+            if (pending_commits_ > before) {
+                group_commit_window_ =
+                        std::min(group_commit_window_ * 2, GROUP_COMMIT_WINDOW_MAX);
+            } else {
+                group_commit_window_ =
+                        std::max(group_commit_window_ / 2, GROUP_COMMIT_WINDOW_MIN);
+            }
+            pending_commits_ = 0;
+        }
+        SealAppendBuffer();
+        // drain every sealed slot; records appended while a slot is being
+        // written are sealed afterwards and go out in this round too
+        bool flushed = false;
+        while (flush_slot_ != append_slot_) {
+            LogBufferSlot &slot = ring_[flush_slot_];
+            std::promise<void> promise;
+            flush_future_ = promise.get_future().share();
+            // unlock latch before disk write
+            lock.unlock();
+            disk_manager_->WriteLog(slot.data, slot.size);
+            lock.lock();
+            flush_slot_ = (flush_slot_ + 1) % LOG_RING_BUFFERS;
+            SetPersistentLSN(slot.last_lsn);
+            promise.set_value();
+            flushed = true;
+            SealAppendBuffer();
+        }
+        // adapt the cadence to the traffic: a round that wrote something
+        // wakes up twice as often next time, an idle round backs off
+        // toward the configured timeout
+        if (flushed) {
+            flush_interval_ = std::max(flush_interval_ / 2, FLUSH_INTERVAL_MIN);
+        } else {
+            flush_interval_ = std::min(
+                    flush_interval_ * 2,
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                            LOG_TIMEOUT));
+        }
     }
 }
 
 /**
- * swap log buffer and flush buffer
+ * seal the append buffer and move appenders to the next slot of the ring
  */
-int LogManager::SwapBuffer() {
-    std::swap(log_buffer_, flush_buffer_);
-    int flush_size = offset_;
+bool LogManager::SealAppendBuffer() {
+    if (offset_ == 0) {
+        return false;
+    }
+    if (inflight_fills_ > 0) {
+        // a reservation is still being filled in place; its bytes must not
+        // be handed to the flush thread half-written
+        return false;
+    }
+    size_t next = (append_slot_ + 1) % LOG_RING_BUFFERS;
+    if (next == flush_slot_) {
+        // every other slot still awaits a flush
+        return false;
+    }
+    ring_[append_slot_].size = offset_;
+    ring_[append_slot_].last_lsn = next_lsn_ - 1;
+    append_slot_ = next;
+    log_buffer_ = ring_[append_slot_].data;
     offset_ = 0;
 
-    return flush_size;
+    return true;
 }
 
 /*
@@ -73,10 +139,27 @@ void LogManager::ForceLogFlushAndWait() {
 
     std::shared_future<void> future = flush_future_;
     if (future.valid()) {
+        PerfCount(PerfCounter::LOG_FLUSH_STALL);
         future.wait();
     }
 }
 
+/*
+ * Register a committing transaction and block until a flush covers its
+ * commit record. One WriteLog call typically retires every committer that
+ * registered within the flush thread's batching window
+ */
+void LogManager::GroupCommitAndWait(lsn_t lsn) {
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        ++pending_commits_;
+        cv_.notify_one();
+    }
+    while (lsn > GetPersistentLSN()) {
+        WaitForLogFlush();
+    }
+}
+
 /*
  * Wait for async log flush to complete
  */
@@ -107,10 +190,20 @@ void LogManager::WaitForLogFlush() {
  *  }
  *
  */
-lsn_t LogManager::AppendLogRecord(LogRecord &log_record) {
-    std::unique_lock<std::mutex> lock(latch_);
-
-    while (offset_ + log_record.size_ > LOG_BUFFER_SIZE) {
+/*
+ * make room for `size` more bytes in the append buffer
+ */
+void LogManager::WaitForAppendSpace(std::unique_lock<std::mutex> &lock,
+                                    int32_t size) {
+    while (offset_ + size > LOG_BUFFER_SIZE) {
+        if (SealAppendBuffer()) {
+            // moved to a fresh buffer; nudge the flush thread so the sealed
+            // one does not sit until the next timeout
+            cv_.notify_one();
+            continue;
+        }
+        // ring is full (or a fill is in flight): wait for the flush thread
+        // to retire a slot
         cv_.notify_one();
         lock.unlock();
         std::shared_future<void> future = flush_future_;
@@ -119,40 +212,156 @@ lsn_t LogManager::AppendLogRecord(LogRecord &log_record) {
         }
         lock.lock();
     }
+}
+
+/*
+ * reserve space in the append buffer for a record whose payload the
+ * caller serializes in place. The record is complete except for its
+ * payload once this returns: the lsn is taken and the header written, so
+ * the caller must follow up with FinishAppend before the bytes can flush
+ */
+char *LogManager::ReserveLogRecord(int32_t size, txn_id_t txn_id,
+                                   lsn_t prev_lsn,
+                                   LogRecordType log_record_type, lsn_t &lsn) {
+    std::unique_lock<std::mutex> lock(latch_);
+    WaitForAppendSpace(lock, size);
+
+    lsn = next_lsn_++;
+    char *data = log_buffer_ + offset_;
+    offset_ += size;
+    total_appended_ += size;
+    ++inflight_fills_;
+
+    // header layout: | size | LSN | transID | prevLSN | LogType |
+    memcpy(data, &size, sizeof(int32_t));
+    memcpy(data + 4, &lsn, sizeof(lsn_t));
+    memcpy(data + 8, &txn_id, sizeof(txn_id_t));
+    memcpy(data + 12, &prev_lsn, sizeof(lsn_t));
+    int32_t type = static_cast<int32_t>(log_record_type);
+    memcpy(data + 16, &type, sizeof(int32_t));
+
+    return data;
+}
+
+/*
+ * publish a filled reservation
+ */
+void LogManager::FinishAppend() {
+    std::lock_guard<std::mutex> guard(latch_);
+    --inflight_fills_;
+    // the last outstanding fill unblocks sealing; past the fill threshold
+    // the flush thread is woken ahead of its timer, same as AppendLogRecord
+    if (inflight_fills_ == 0 && offset_ >= FLUSH_FILL_THRESHOLD) {
+        cv_.notify_one();
+    }
+}
+
+/*
+ * serialize the delta body of an UPDATE record (or of a CLR wrapping one):
+ * rid, shared prefix/suffix lengths, then the differing middle bytes of
+ * the before and after images. Returns the position past the body
+ */
+int LogManager::SerializeUpdateDelta(const LogRecord &log_record,
+                                     char *staging, int pos) {
+    memcpy(staging + pos, &log_record.update_rid_, sizeof(RID));
+    pos += sizeof(RID);
+    memcpy(staging + pos, &log_record.update_prefix_len_, sizeof(int32_t));
+    pos += sizeof(int32_t);
+    memcpy(staging + pos, &log_record.update_suffix_len_, sizeof(int32_t));
+    pos += sizeof(int32_t);
+    int32_t old_middle_len = (int32_t)log_record.old_middle_.size();
+    memcpy(staging + pos, &old_middle_len, sizeof(int32_t));
+    pos += sizeof(int32_t);
+    memcpy(staging + pos, log_record.old_middle_.data(), old_middle_len);
+    pos += old_middle_len;
+    int32_t new_middle_len = (int32_t)log_record.new_middle_.size();
+    memcpy(staging + pos, &new_middle_len, sizeof(int32_t));
+    pos += sizeof(int32_t);
+    memcpy(staging + pos, log_record.new_middle_.data(), new_middle_len);
+    return pos + new_middle_len;
+}
+
+lsn_t LogManager::AppendLogRecord(LogRecord &log_record) {
+    // serialize into this thread's staging buffer first, so the expensive
+    // tuple copies happen outside the log latch; the lsn field is patched
+    // once it is assigned at publish time
+    static thread_local char staging[LOG_BUFFER_SIZE];
 
     size_t rid_size = sizeof(RID);
-    log_record.lsn_ = next_lsn_++;
-    memcpy(log_buffer_ + offset_, &log_record, log_record.HEADER_SIZE);
-    int pos = offset_ + log_record.HEADER_SIZE;
+    memcpy(staging, &log_record, log_record.HEADER_SIZE);
+    int pos = log_record.HEADER_SIZE;
 
     switch (log_record.log_record_type_) {
         case LogRecordType::INSERT:
-            memcpy(log_buffer_ + pos, &log_record.insert_rid_, rid_size);
+            memcpy(staging + pos, &log_record.insert_rid_, rid_size);
             pos += rid_size;
-            log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
+            log_record.insert_tuple_.SerializeTo(staging + pos);
             break;
         case LogRecordType::UPDATE:
-            memcpy(log_buffer_ + pos, &log_record.update_rid_, rid_size);
-            pos += rid_size;
-            log_record.old_tuple_.SerializeTo(log_buffer_ + pos);
-            pos += sizeof(int32_t) + log_record.old_tuple_.GetLength();
-            log_record.new_tuple_.SerializeTo(log_buffer_ + pos);
+            pos = SerializeUpdateDelta(log_record, staging, pos);
             break;
         case LogRecordType::NEWPAGE:
-            memcpy(log_buffer_ + pos, &log_record.prev_page_id_, sizeof(page_id_t));
+            memcpy(staging + pos, &log_record.prev_page_id_, sizeof(page_id_t));
+            pos += sizeof(page_id_t);
+            memcpy(staging + pos, &log_record.page_id_, sizeof(page_id_t));
+            break;
+        case LogRecordType::TRUNCATE:
+            memcpy(staging + pos, &log_record.prev_page_id_, sizeof(page_id_t));
             break;
         case LogRecordType::APPLYDELETE:
         case LogRecordType::MARKDELETE:
         case LogRecordType::ROLLBACKDELETE:
-            memcpy(log_buffer_ + pos, &log_record.delete_rid_, rid_size);
+            memcpy(staging + pos, &log_record.delete_rid_, rid_size);
             pos += rid_size;
-            log_record.delete_tuple_.SerializeTo(log_buffer_ + pos);
+            log_record.delete_tuple_.SerializeTo(staging + pos);
+            break;
+        case LogRecordType::CLR: {
+            memcpy(staging + pos, &log_record.undo_next_lsn_, sizeof(lsn_t));
+            pos += sizeof(lsn_t);
+            int32_t action_type =
+                    static_cast<int32_t>(log_record.clr_action_type_);
+            memcpy(staging + pos, &action_type, sizeof(int32_t));
+            pos += sizeof(int32_t);
+            // compensating action body, same layout as the action type
+            switch (log_record.clr_action_type_) {
+                case LogRecordType::INSERT:
+                    memcpy(staging + pos, &log_record.insert_rid_, rid_size);
+                    pos += rid_size;
+                    log_record.insert_tuple_.SerializeTo(staging + pos);
+                    break;
+                case LogRecordType::UPDATE:
+                    pos = SerializeUpdateDelta(log_record, staging, pos);
+                    break;
+                default:
+                    memcpy(staging + pos, &log_record.delete_rid_, rid_size);
+                    pos += rid_size;
+                    log_record.delete_tuple_.SerializeTo(staging + pos);
+                    break;
+            }
             break;
+        }
         default:
             // BEGIN/COMMIT/ABORT record only has header
             break;
     }
+
+    // publish: assign the lsn and copy the staged record into the shared
+    // buffer in one go
+    std::unique_lock<std::mutex> lock(latch_);
+    WaitForAppendSpace(lock, log_record.size_);
+
+    log_record.lsn_ = next_lsn_++;
+    memcpy(staging + sizeof(int32_t), &log_record.lsn_, sizeof(lsn_t));
+    memcpy(log_buffer_ + offset_, staging, log_record.size_);
     offset_ += log_record.size_;
+    total_appended_ += log_record.size_;
+
+    // crossing the fill threshold wakes the flush thread ahead of its
+    // timer, before appends start overflowing into synchronous waits
+    if (offset_ >= FLUSH_FILL_THRESHOLD &&
+        offset_ - log_record.size_ < FLUSH_FILL_THRESHOLD) {
+        cv_.notify_one();
+    }
 
     return log_record.lsn_;
 }
@@ -12,6 +12,60 @@ namespace cmudb {
  * @return: true means deserialize succeed, otherwise can't deserialize cause
  * incomplete log record
  */
+/*
+ * deserialize the delta body of an UPDATE record (or of a CLR wrapping
+ * one); the full images stay empty until the record meets its page, see
+ * MaterializeUpdateTuples
+ */
+void LogRecovery::DeserializeUpdateDelta(const char *data,
+                                         LogRecord &log_record) {
+    log_record.update_rid_ = *reinterpret_cast<const RID *>(data);
+    data += sizeof(RID);
+    log_record.update_prefix_len_ = *reinterpret_cast<const int32_t *>(data);
+    data += sizeof(int32_t);
+    log_record.update_suffix_len_ = *reinterpret_cast<const int32_t *>(data);
+    data += sizeof(int32_t);
+    int32_t old_middle_len = *reinterpret_cast<const int32_t *>(data);
+    data += sizeof(int32_t);
+    log_record.old_middle_.assign(data, old_middle_len);
+    data += old_middle_len;
+    int32_t new_middle_len = *reinterpret_cast<const int32_t *>(data);
+    data += sizeof(int32_t);
+    log_record.new_middle_.assign(data, new_middle_len);
+}
+
+/*
+ * rebuild the full before/after images of a delta update record from the
+ * page's current tuple. During redo the page still holds the before image
+ * (earlier records for the page were replayed first); during the undo walk
+ * it holds the after image
+ */
+void LogRecovery::MaterializeUpdateTuples(TablePage *page, LogRecord &record,
+                                          bool current_is_old) {
+    Tuple current;
+    assert(page->GetTupleRaw(record.update_rid_, current));
+
+    const std::string &other_middle =
+            current_is_old ? record.new_middle_ : record.old_middle_;
+    const int32_t prefix_len = record.update_prefix_len_;
+    const int32_t suffix_len = record.update_suffix_len_;
+
+    // the other image is the current one with its middle bytes swapped out
+    int32_t other_size = prefix_len + (int32_t)other_middle.size() + suffix_len;
+    std::string buffer;
+    buffer.append(reinterpret_cast<const char *>(&other_size),
+                  sizeof(int32_t));
+    buffer.append(current.GetData(), prefix_len);
+    buffer.append(other_middle);
+    buffer.append(current.GetData() + current.GetLength() - suffix_len,
+                  suffix_len);
+    Tuple other;
+    other.DeserializeFrom(buffer.data());
+
+    record.old_tuple_ = current_is_old ? current : other;
+    record.new_tuple_ = current_is_old ? other : current;
+}
+
 bool LogRecovery::DeserializeLogRecord(const char *data,
                                        LogRecord &log_record) {
     if (offset_ + LogRecord::HEADER_SIZE > LOG_BUFFER_SIZE) {
@@ -37,12 +91,14 @@ bool LogRecovery::DeserializeLogRecord(const char *data,
             log_record.insert_tuple_.DeserializeFrom(data + rid_size);
             break;
         case LogRecordType::UPDATE:
-            log_record.update_rid_ = *reinterpret_cast<const RID *>(data);
-            log_record.old_tuple_.DeserializeFrom(data + rid_size);
-            log_record.new_tuple_.DeserializeFrom(data + rid_size +
-                sizeof(int32_t) + log_record.old_tuple_.GetLength());
+            DeserializeUpdateDelta(data, log_record);
             break;
         case LogRecordType::NEWPAGE:
+            log_record.prev_page_id_ = *reinterpret_cast<const page_id_t *>(data);
+            log_record.page_id_ = *reinterpret_cast<const page_id_t *>(
+                    data + sizeof(page_id_t));
+            break;
+        case LogRecordType::TRUNCATE:
             log_record.prev_page_id_ = *reinterpret_cast<const page_id_t *>(data);
             break;
         case LogRecordType::APPLYDELETE:
@@ -51,6 +107,26 @@ bool LogRecovery::DeserializeLogRecord(const char *data,
             log_record.delete_rid_ = *reinterpret_cast<const RID *>(data);
             log_record.delete_tuple_.DeserializeFrom(data + rid_size);
             break;
+        case LogRecordType::CLR: {
+            log_record.undo_next_lsn_ = *reinterpret_cast<const lsn_t *>(data);
+            log_record.clr_action_type_ = *reinterpret_cast<const LogRecordType *>(
+                    data + sizeof(lsn_t));
+            const char *body = data + sizeof(lsn_t) + sizeof(int32_t);
+            switch (log_record.clr_action_type_) {
+                case LogRecordType::INSERT:
+                    log_record.insert_rid_ = *reinterpret_cast<const RID *>(body);
+                    log_record.insert_tuple_.DeserializeFrom(body + rid_size);
+                    break;
+                case LogRecordType::UPDATE:
+                    DeserializeUpdateDelta(body, log_record);
+                    break;
+                default:
+                    log_record.delete_rid_ = *reinterpret_cast<const RID *>(body);
+                    log_record.delete_tuple_.DeserializeFrom(body + rid_size);
+                    break;
+            }
+            break;
+        }
         default:
             break;
     }
@@ -58,19 +134,192 @@ bool LogRecovery::DeserializeLogRecord(const char *data,
     return true;
 }
 
+/*
+ * replay one tuple-level record against its page, skipping it when the
+ * page's lsn shows the effect already made it to disk
+ */
+void LogRecovery::RedoPageRecord(LogRecord &record) {
+    // CLRs redo their wrapped compensating action
+    LogRecordType type = record.log_record_type_ == LogRecordType::CLR
+                                 ? record.clr_action_type_
+                                 : record.log_record_type_;
+    page_id_t page_id;
+    switch (type) {
+        case LogRecordType::INSERT:
+            page_id = record.insert_rid_.GetPageId();
+            break;
+        case LogRecordType::UPDATE:
+            page_id = record.update_rid_.GetPageId();
+            break;
+        default:
+            page_id = record.delete_rid_.GetPageId();
+            break;
+    }
+
+    auto page = reinterpret_cast<TablePage *>(
+            buffer_pool_manager_->FetchPage(page_id));
+    bool redo = record.lsn_ > page->GetLSN();
+    if (redo) {
+        switch (type) {
+            case LogRecordType::INSERT:
+                page->InsertTuple(record.insert_tuple_, record.insert_rid_,
+                                  nullptr, nullptr, nullptr);
+                break;
+            case LogRecordType::UPDATE:
+                // the page still holds the before image at this point, the
+                // delta record is materialized against it
+                MaterializeUpdateTuples(page, record, true);
+                page->UpdateTuple(record.new_tuple_, record.old_tuple_,
+                                  record.update_rid_, nullptr, nullptr, nullptr);
+                break;
+            case LogRecordType::APPLYDELETE:
+                page->ApplyDelete(record.delete_rid_, nullptr, nullptr);
+                break;
+            case LogRecordType::MARKDELETE:
+                page->MarkDelete(record.delete_rid_, nullptr, nullptr, nullptr);
+                break;
+            case LogRecordType::ROLLBACKDELETE:
+                page->RollbackDelete(record.delete_rid_, nullptr, nullptr);
+                break;
+            default:
+                break;
+        }
+    }
+    buffer_pool_manager_->UnpinPage(page_id, redo);
+}
+
+/*
+ * replay a NEWPAGE record: the record names the page it created, so
+ * replay initializes that exact page in place (lsn permitting; a page
+ * that never reached disk reads back zeroed with lsn 0) and hangs it off
+ * its predecessor's next pointer when that link is not there yet
+ */
+void LogRecovery::ReplayNewPage(LogRecord &record) {
+    page_id_t prev_page_id = record.prev_page_id_;
+    page_id_t new_page_id = record.page_id_;
+    auto page = reinterpret_cast<TablePage *>(
+            buffer_pool_manager_->FetchPage(new_page_id));
+    bool redo = record.lsn_ > page->GetLSN();
+    if (redo) {
+        page->Init(new_page_id, PAGE_SIZE, prev_page_id, nullptr, nullptr);
+        page->SetLSN(record.lsn_);
+    }
+    buffer_pool_manager_->UnpinPage(new_page_id, redo);
+    if (prev_page_id != INVALID_PAGE_ID) {
+        auto prev_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(prev_page_id));
+        bool link = prev_page->GetNextPageId() == INVALID_PAGE_ID;
+        if (link) {
+            prev_page->SetNextPageId(new_page_id);
+        } else {
+            assert(new_page_id == prev_page->GetNextPageId());
+        }
+        buffer_pool_manager_->UnpinPage(prev_page_id, link);
+    }
+}
+
+/*
+ * replay a TRUNCATE record: the first page of the chain goes back to
+ * empty (lsn permitting) and its successors become unreachable
+ */
+void LogRecovery::ReplayTruncate(LogRecord &record) {
+    auto page = reinterpret_cast<TablePage *>(
+            buffer_pool_manager_->FetchPage(record.prev_page_id_));
+    if (page->GetLSN() < record.lsn_) {
+        page->Reset(PAGE_SIZE);
+        page->SetLSN(record.lsn_);
+        buffer_pool_manager_->UnpinPage(record.prev_page_id_, true);
+    } else {
+        buffer_pool_manager_->UnpinPage(record.prev_page_id_, false);
+    }
+}
+
+/*
+ * rolling apply of one shipped batch for a log-shipped standby, see the
+ * declaration for the contract. The replica process never runs its own
+ * log manager, so the same ENABLE_LOGGING precondition as Redo holds:
+ * page-level replay calls pass null txn/lock/log and must not try to log
+ */
+int LogRecovery::ApplyBatch(const char *data, int size) {
+    assert(ENABLE_LOGGING == false);
+    if (size <= 0) {
+        return 0;
+    }
+    if (size > LOG_BUFFER_SIZE) {
+        size = LOG_BUFFER_SIZE;
+    }
+    // stage into the (zero-padded) recovery buffer so DeserializeLogRecord
+    // never parses past what the shipper actually sent
+    memcpy(log_buffer_, data, size);
+    if (size < LOG_BUFFER_SIZE) {
+        memset(log_buffer_ + size, 0, LOG_BUFFER_SIZE - size);
+    }
+
+    offset_ = 0;
+    LogRecord record;
+    while (size - offset_ >= LogRecord::HEADER_SIZE) {
+        // only the body of a complete record may be parsed: a partial tail
+        // would deserialize its tuples from the padding
+        int record_size = *reinterpret_cast<const int32_t *>(log_buffer_ + offset_);
+        if (record_size <= 0 || offset_ + record_size > size) {
+            break;
+        }
+        assert(DeserializeLogRecord(log_buffer_ + offset_, record));
+
+        switch (record.log_record_type_) {
+            case LogRecordType::NEWPAGE:
+                ReplayNewPage(record);
+                break;
+            case LogRecordType::TRUNCATE:
+                ReplayTruncate(record);
+                break;
+            case LogRecordType::INSERT:
+            case LogRecordType::UPDATE:
+            case LogRecordType::APPLYDELETE:
+            case LogRecordType::MARKDELETE:
+            case LogRecordType::ROLLBACKDELETE:
+            case LogRecordType::CLR:
+                RedoPageRecord(record);
+                break;
+            default:
+                // BEGIN/COMMIT/ABORT/CHECKPOINT carry no page effect
+                break;
+        }
+
+        applied_lsn_ = record.lsn_;
+        offset_ += record.size_;
+    }
+
+    return offset_;
+}
+
 /*
  *redo phase on TABLE PAGE level(table/table_page.h)
  *read log file from the beginning to end (you must prefetch log records into
  *log buffer to reduce unnecessary I/O operations), remember to compare page's
  *LSN with log_record's sequence number, and also build active_txn_ table &
  *lsn_mapping_ table
+ *
+ *the scan itself is serial (it orders NEWPAGE replay and builds the maps),
+ *but tuple-level records only need ordering per page, so they are
+ *partitioned by page id and replayed by a pool of worker threads
  */
 void LogRecovery::Redo() {
     assert(ENABLE_LOGGING == false);
-    int read_offset = 0;
+    // a clean shutdown flushed every page behind a quiescent checkpoint:
+    // there is nothing to redo, and with no transaction in flight the
+    // active_txn_ table stays empty so the following Undo is a no-op too
+    if (disk_manager_->WasCleanShutdown()) {
+        return;
+    }
+    // every record before the last completed checkpoint is already durable,
+    // so the scan starts there (offset 0 when no checkpoint exists)
+    int read_offset = disk_manager_->GetCheckpointOffset();
     active_txn_.clear();
     lsn_mapping_.clear();
 
+    // tuple-level records grouped by the page they touch, in log order
+    std::unordered_map<page_id_t, std::vector<LogRecord>> page_work;
+
     while (disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, read_offset)) {
         offset_ = 0;
         LogRecord record;
@@ -78,79 +327,91 @@ void LogRecovery::Redo() {
             if (record.log_record_type_ == LogRecordType::COMMIT ||
                 record.log_record_type_ == LogRecordType::ABORT) {
                 active_txn_.erase(record.txn_id_);
-            } else {
+            } else if (record.log_record_type_ != LogRecordType::CHECKPOINT &&
+                       record.log_record_type_ != LogRecordType::TRUNCATE) {
+                // checkpoint and truncate records carry no transaction
                 active_txn_[record.txn_id_] = record.lsn_;
             }
 
             if (record.log_record_type_ == LogRecordType::INSERT) {
-                page_id_t page_id = record.insert_rid_.GetPageId();
-                auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
-                bool redo = record.lsn_ > page->GetLSN();
-                if (redo) {
-                    page->InsertTuple(record.insert_tuple_, record.insert_rid_, nullptr, nullptr, nullptr);
-                }
-                buffer_pool_manager_->UnpinPage(page_id, redo);
+                page_work[record.insert_rid_.GetPageId()].push_back(record);
             } else if (record.log_record_type_ == LogRecordType::UPDATE) {
-                page_id_t page_id = record.update_rid_.GetPageId();
-                auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
-                bool redo = record.lsn_ > page->GetLSN();
-                if (record.lsn_ > page->GetLSN()) {
-                    page->UpdateTuple(
-                        record.new_tuple_, record.old_tuple_, record.update_rid_, nullptr, nullptr, nullptr);
+                page_work[record.update_rid_.GetPageId()].push_back(record);
+            } else if (record.log_record_type_ == LogRecordType::APPLYDELETE ||
+                       record.log_record_type_ == LogRecordType::MARKDELETE ||
+                       record.log_record_type_ == LogRecordType::ROLLBACKDELETE) {
+                page_work[record.delete_rid_.GetPageId()].push_back(record);
+            } else if (record.log_record_type_ == LogRecordType::CLR) {
+                if (record.clr_action_type_ == LogRecordType::INSERT) {
+                    page_work[record.insert_rid_.GetPageId()].push_back(record);
+                } else if (record.clr_action_type_ == LogRecordType::UPDATE) {
+                    page_work[record.update_rid_.GetPageId()].push_back(record);
+                } else {
+                    page_work[record.delete_rid_.GetPageId()].push_back(record);
                 }
-                buffer_pool_manager_->UnpinPage(page_id, redo);
-            } else if (record.log_record_type_ == LogRecordType::APPLYDELETE) {
-                page_id_t page_id = record.delete_rid_.GetPageId();
-                auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
-                bool redo = record.lsn_ > page->GetLSN();
-                if (redo) {
-                    page->ApplyDelete(record.delete_rid_, nullptr, nullptr);
-                }
-                buffer_pool_manager_->UnpinPage(page_id, redo);
-            } else if (record.log_record_type_ == LogRecordType::MARKDELETE) {
-                page_id_t page_id = record.delete_rid_.GetPageId();
-                auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
-                bool redo = record.lsn_ > page->GetLSN();
-                if (redo) {
-                    page->MarkDelete(record.delete_rid_, nullptr, nullptr, nullptr);
-                }
-                buffer_pool_manager_->UnpinPage(page_id, redo);
-            } else if (record.log_record_type_ == LogRecordType::ROLLBACKDELETE) {
-                page_id_t page_id = record.delete_rid_.GetPageId();
-                auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
-                bool redo = record.lsn_ > page->GetLSN();
-                if (redo) {
-                    page->RollbackDelete(record.delete_rid_, nullptr, nullptr);
-                }
-                buffer_pool_manager_->UnpinPage(page_id, redo);
             } else if (record.log_record_type_ == LogRecordType::NEWPAGE) {
-                page_id_t prev_page_id = record.prev_page_id_;
-                page_id_t new_page_id;
-                auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
-                page->Init(new_page_id, PAGE_SIZE, prev_page_id, nullptr, nullptr);
-                if (prev_page_id != INVALID_PAGE_ID) {
-                    auto prev_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(prev_page_id));
-                    bool redo = prev_page->GetNextPageId() == INVALID_PAGE_ID;
-                    if (redo) {
-                        prev_page->SetNextPageId(new_page_id);
-                    } else {
-                        assert(new_page_id == prev_page->GetNextPageId());
-                    }
-                    buffer_pool_manager_->UnpinPage(prev_page_id, redo);
-                }
-                buffer_pool_manager_->UnpinPage(new_page_id, true);
+                ReplayNewPage(record);
+            } else if (record.log_record_type_ == LogRecordType::TRUNCATE) {
+                // replayed serially like NEWPAGE since it rewrites the chain
+                // structure: the first page goes back to empty and the
+                // successors simply become unreachable. Later tuple records
+                // against the first page lose to its (newer) truncate lsn
+                ReplayTruncate(record);
             }
 
             lsn_mapping_[record.lsn_] = read_offset;
             read_offset += record.size_;
             offset_ += record.size_;
         }
+        if (offset_ == 0) {
+            // the very first record of the read failed to parse: a record
+            // torn by a crash mid-flush, which nothing after can be
+            // reached past -- rereading would spin on it forever
+            break;
+        }
+    }
+
+    if (page_work.empty()) {
+        return;
+    }
+
+    // replay each page's records on a worker pool; a page is owned by
+    // exactly one worker, so per-page order is preserved without latching
+    size_t num_workers = std::thread::hardware_concurrency();
+    if (num_workers == 0) {
+        num_workers = 1;
+    }
+    num_workers = std::min(num_workers, page_work.size());
+
+    std::vector<std::vector<std::vector<LogRecord> *>> worker_lists(num_workers);
+    for (auto &entry : page_work) {
+        worker_lists[entry.first % num_workers].push_back(&entry.second);
+    }
+
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < num_workers; ++w) {
+        workers.emplace_back([this, &worker_lists, w] {
+            for (auto *records : worker_lists[w]) {
+                for (auto &page_record : *records) {
+                    RedoPageRecord(page_record);
+                }
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
     }
 }
 
 /*
  *undo phase on TABLE PAGE level(table/table_page.h)
  *iterate through active txn map and undo each operation
+ *
+ *every compensating action is logged as a CLR (when a log manager was
+ *supplied) whose undo_next_lsn points at the record before the one just
+ *undone; a CLR found in a chain is never re-undone, the walk jumps
+ *straight to its undo_next_lsn, so a crash during undo never repeats
+ *work that already has a flushed CLR
  */
 void LogRecovery::Undo() {
     assert(ENABLE_LOGGING == false);
@@ -159,6 +420,8 @@ void LogRecovery::Undo() {
 
     for (auto entry : active_txn_) {
         next_offset = lsn_mapping_[entry.second];
+        // chain our CLRs off the transaction's last record
+        lsn_t last_lsn = entry.second;
         while (disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, next_offset)) {
             LogRecord record;
             assert(DeserializeLogRecord(log_buffer_, record));
@@ -167,28 +430,109 @@ void LogRecovery::Undo() {
                 break;
             }
 
-            page_id_t page_id = record.insert_rid_.GetPageId();
-            auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+            if (record.log_record_type_ == LogRecordType::CLR) {
+                // already compensated by an earlier (crashed) undo pass
+                if (record.undo_next_lsn_ == INVALID_LSN) {
+                    break;
+                }
+                next_offset = lsn_mapping_[record.undo_next_lsn_];
+                continue;
+            }
+
+            if (record.log_record_type_ == LogRecordType::NEWPAGE) {
+                // a page created by a doomed transaction simply stays empty
+                // once its tuples are undone; there is nothing to compensate
+                next_offset = lsn_mapping_[record.prev_lsn_];
+                continue;
+            }
+
+            // the compensating action, applied below and wrapped in a CLR
+            LogRecord action;
             if (record.log_record_type_ == LogRecordType::INSERT) {
-                page->ApplyDelete(record.insert_rid_, nullptr, nullptr);
-                buffer_pool_manager_->UnpinPage(page_id, true);
+                action = LogRecord(record.txn_id_, last_lsn,
+                                   LogRecordType::APPLYDELETE,
+                                   record.insert_rid_, record.insert_tuple_);
             } else if (record.log_record_type_ == LogRecordType::UPDATE) {
-                page->UpdateTuple(record.old_tuple_, record.new_tuple_, record.update_rid_, nullptr, nullptr, nullptr);
-                buffer_pool_manager_->UnpinPage(page_id, true);
+                // rebuild the images of the delta record from the page,
+                // whose tuple holds the after image at this point of the
+                // backwards walk
+                page_id_t update_page_id = record.update_rid_.GetPageId();
+                auto update_page = reinterpret_cast<TablePage *>(
+                        buffer_pool_manager_->FetchPage(update_page_id));
+                MaterializeUpdateTuples(update_page, record, false);
+                buffer_pool_manager_->UnpinPage(update_page_id, false);
+                action = LogRecord(record.txn_id_, last_lsn, LogRecordType::UPDATE,
+                                   record.update_rid_, record.new_tuple_,
+                                   record.old_tuple_);
             } else if (record.log_record_type_ == LogRecordType::APPLYDELETE) {
-                page->InsertTuple(record.delete_tuple_, record.delete_rid_, nullptr, nullptr, nullptr);
-                buffer_pool_manager_->UnpinPage(page_id, true);
+                action = LogRecord(record.txn_id_, last_lsn, LogRecordType::INSERT,
+                                   record.delete_rid_, record.delete_tuple_);
             } else if (record.log_record_type_ == LogRecordType::MARKDELETE) {
-                page->RollbackDelete(record.delete_rid_, nullptr, nullptr);
-                buffer_pool_manager_->UnpinPage(page_id, true);
+                action = LogRecord(record.txn_id_, last_lsn,
+                                   LogRecordType::ROLLBACKDELETE,
+                                   record.delete_rid_, record.delete_tuple_);
             } else if (record.log_record_type_ == LogRecordType::ROLLBACKDELETE) {
-                page->MarkDelete(record.delete_rid_, nullptr, nullptr, nullptr);
-                buffer_pool_manager_->UnpinPage(page_id, true);
+                action = LogRecord(record.txn_id_, last_lsn,
+                                   LogRecordType::MARKDELETE,
+                                   record.delete_rid_, record.delete_tuple_);
             } else {
                 throw Exception("unexpected log record type");
             }
+
+            LogRecord clr(record.txn_id_, last_lsn, record.prev_lsn_, action);
+            if (log_manager_ != nullptr) {
+                last_lsn = log_manager_->AppendLogRecord(clr);
+            }
+
+            // apply the compensating action unconditionally, as before
+            page_id_t page_id;
+            TablePage *page;
+            switch (action.log_record_type_) {
+                case LogRecordType::INSERT:
+                    page_id = action.insert_rid_.GetPageId();
+                    page = reinterpret_cast<TablePage *>(
+                            buffer_pool_manager_->FetchPage(page_id));
+                    page->InsertTuple(action.insert_tuple_, action.insert_rid_,
+                                      nullptr, nullptr, nullptr);
+                    break;
+                case LogRecordType::UPDATE:
+                    page_id = action.update_rid_.GetPageId();
+                    page = reinterpret_cast<TablePage *>(
+                            buffer_pool_manager_->FetchPage(page_id));
+                    page->UpdateTuple(action.new_tuple_, action.old_tuple_,
+                                      action.update_rid_, nullptr, nullptr,
+                                      nullptr);
+                    break;
+                case LogRecordType::APPLYDELETE:
+                    page_id = action.delete_rid_.GetPageId();
+                    page = reinterpret_cast<TablePage *>(
+                            buffer_pool_manager_->FetchPage(page_id));
+                    page->ApplyDelete(action.delete_rid_, nullptr, nullptr);
+                    break;
+                case LogRecordType::MARKDELETE:
+                    page_id = action.delete_rid_.GetPageId();
+                    page = reinterpret_cast<TablePage *>(
+                            buffer_pool_manager_->FetchPage(page_id));
+                    page->MarkDelete(action.delete_rid_, nullptr, nullptr,
+                                     nullptr);
+                    break;
+                default:
+                    page_id = action.delete_rid_.GetPageId();
+                    page = reinterpret_cast<TablePage *>(
+                            buffer_pool_manager_->FetchPage(page_id));
+                    page->RollbackDelete(action.delete_rid_, nullptr, nullptr);
+                    break;
+            }
+            buffer_pool_manager_->UnpinPage(page_id, true);
+
             next_offset = lsn_mapping_[record.prev_lsn_];
         }
+
+        if (log_manager_ != nullptr) {
+            // close the chain so redo stops tracking this transaction
+            LogRecord abort_record(entry.first, last_lsn, LogRecordType::ABORT);
+            log_manager_->AppendLogRecord(abort_record);
+        }
     }
 
     active_txn_.clear();
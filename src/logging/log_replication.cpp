@@ -0,0 +1,71 @@
+/**
+ * log_replication.cpp
+ */
+
+#include "logging/log_replication.h"
+
+namespace cmudb {
+
+/*
+ * ship every flushed byte the replica has not consumed yet. The loop
+ * advances by what the applier reports consumed: when a record straddles
+ * the flushed frontier the applier leaves it unconsumed, the loop stops,
+ * and the next round re-reads it from the same offset once the flush
+ * thread has written the rest
+ */
+int LogShipper::ShipBatch() {
+    int shipped = 0;
+    while (true) {
+        int available = disk_manager_->GetLogSize() - shipped_offset_;
+        if (available <= 0) {
+            break;
+        }
+        int batch = std::min(available, LOG_BUFFER_SIZE);
+        if (!disk_manager_->ReadLog(ship_buffer_, batch, shipped_offset_)) {
+            break;
+        }
+        int consumed = replica_->ApplyBatch(ship_buffer_, batch);
+        if (consumed == 0) {
+            // partial record at the flushed frontier
+            break;
+        }
+        shipped_offset_ += consumed;
+        shipped += consumed;
+    }
+    return shipped;
+}
+
+/*
+ * follow the log continuously: wake up at the flush cadence (or when
+ * Stop pokes us) and ship whatever arrived since the last round
+ */
+void LogShipper::RunShipperThread() {
+    if (shipping_) {
+        return;
+    }
+    shipping_ = true;
+    shipper_thread_ = new std::thread([this] {
+        while (shipping_) {
+            ShipBatch();
+            std::unique_lock<std::mutex> lock(latch_);
+            cv_.wait_for(lock, LOG_TIMEOUT, [this] { return !shipping_; });
+        }
+    });
+}
+
+void LogShipper::StopShipperThread() {
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        shipping_ = false;
+    }
+    cv_.notify_all();
+    if (shipper_thread_ != nullptr && shipper_thread_->joinable()) {
+        shipper_thread_->join();
+    }
+    delete shipper_thread_;
+    shipper_thread_ = nullptr;
+    // drain what the final flush left behind
+    ShipBatch();
+}
+
+} // namespace cmudb
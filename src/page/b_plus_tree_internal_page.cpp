@@ -23,9 +23,41 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id,
     SetPageId(page_id);
     SetParentPageId(parent_id);
     SetSize(0);
+    SetNextPageId(INVALID_PAGE_ID);
     SetMaxSize((PAGE_SIZE - sizeof(*this)) / sizeof(MappingType) - 1);
 }
 
+/*
+ * Helper methods for the right sibling page id and the high key, the
+ * exclusive upper bound on keys under this page; the high key is only
+ * meaningful while a right sibling exists
+ */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetNextPageId() const {
+    return next_page_id_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {
+    next_page_id_ = next_page_id;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::HasHighKey() const {
+    return next_page_id_ != INVALID_PAGE_ID;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetHighKey() const {
+    assert(HasHighKey());
+    return high_key_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetHighKey(const KeyType &high_key) {
+    high_key_ = high_key;
+}
+
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
@@ -150,14 +182,24 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(
         BPlusTreeInternalPage *recipient,
-        BufferPoolManager *buffer_pool_manager) {
+        BufferPoolManager *buffer_pool_manager, int move_count) {
     assert(GetSize() == GetMaxSize() + 1);
     assert(recipient->GetSize() == 0);
 
-    // the first key moved to recipient will be invalid
-    int size = GetSize(), half = GetMinSize();
+    // the first key moved to recipient will be invalid; a positive
+    // move_count moves that many trailing entries instead of half
+    int size = GetSize(),
+        half = move_count > 0 ? size - move_count : GetMinSize();
     recipient->CopyHalfFrom(array + half, size - half, buffer_pool_manager);
     SetSize(half);
+    // chain the high keys: recipient takes over this page's bound and this
+    // page is now bounded by the separator about to be promoted
+    if (HasHighKey()) {
+        recipient->SetHighKey(GetHighKey());
+    }
+    recipient->SetNextPageId(GetNextPageId());
+    SetNextPageId(recipient->GetPageId());
+    SetHighKey(recipient->KeyAt(0));
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -227,6 +269,11 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(
     array[0].first = parent->KeyAt(index_in_parent);
     buffer_pool_manager->UnpinPage(parent->GetPageId(), true);
     recipient->CopyAllFrom(array, GetSize(), buffer_pool_manager);
+    // recipient absorbs this page's key range, bound included
+    if (HasHighKey()) {
+        recipient->SetHighKey(GetHighKey());
+    }
+    recipient->SetNextPageId(GetNextPageId());
     SetSize(0);
 }
 
@@ -270,7 +317,9 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(
     }
     IncreaseSize(-1);
 
+    // the left sibling's high key follows the separator
     parent->SetKeyAt(parent_index, KeyAt(0));
+    recipient->SetHighKey(KeyAt(0));
     buffer_pool_manager->UnpinPage(parent->GetPageId(), true);
 }
 
@@ -306,7 +355,9 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(
     recipient->CopyFirstFrom(pair, buffer_pool_manager);
     IncreaseSize(-1);
 
+    // this (left) page's high key follows the separator
     parent->SetKeyAt(parent_index, KeyAt(GetSize() - 1));
+    SetHighKey(KeyAt(GetSize() - 1));
     buffer_pool_manager->UnpinPage(parent->GetPageId(), true);
 }
 
@@ -27,6 +27,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id) {
     SetParentPageId(parent_id);
     SetSize(0);
     SetNextPageId(INVALID_PAGE_ID);
+    SetPrevPageId(INVALID_PAGE_ID);
     SetMaxSize((PAGE_SIZE - sizeof(*this)) / sizeof(MappingType) - 1);
 }
 
@@ -43,6 +44,39 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {
     next_page_id_ = next_page_id;
 }
 
+/**
+ * Helper methods to set/get previous page id, for reverse scans
+ */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const {
+    return prev_page_id_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) {
+    prev_page_id_ = prev_page_id;
+}
+
+/**
+ * Helper methods for the high key, the exclusive upper bound on keys in
+ * this page; only meaningful while a right sibling exists
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::HasHighKey() const {
+    return next_page_id_ != INVALID_PAGE_ID;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::GetHighKey() const {
+    assert(HasHighKey());
+    return high_key_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetHighKey(const KeyType &high_key) {
+    high_key_ = high_key;
+}
+
 /**
  * Helper method to find the first index i so that array[i].first >= key
  * NOTE: This method is only used when generating index iterator
@@ -129,20 +163,36 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key,
  * SPLIT
  *****************************************************************************/
 /*
- * Remove half of key & value pairs from this page to "recipient" page
+ * Remove half of key & value pairs from this page to "recipient" page;
+ * a positive move_count moves that many trailing entries instead of half
+ * (the split-high path for rightmost-leaf appends)
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(
-        BPlusTreeLeafPage *recipient,
-        __attribute__((unused)) BufferPoolManager *buffer_pool_manager) {
+        BPlusTreeLeafPage *recipient, BufferPoolManager *buffer_pool_manager,
+        int move_count) {
     assert(GetSize() == GetMaxSize() + 1);
     assert(recipient->GetSize() == 0);
 
-    int size = GetSize(), half = GetMinSize();
+    int size = GetSize(), half = move_count > 0 ? move_count : GetMinSize();
     recipient->CopyHalfFrom(array + size - half, half);
     SetSize(size - half);
+    // chain the high keys: recipient takes over this page's bound and this
+    // page is now bounded by the first key that moved right
+    if (HasHighKey()) {
+        recipient->SetHighKey(GetHighKey());
+    }
     recipient->SetNextPageId(GetNextPageId());
     SetNextPageId(recipient->GetPageId());
+    SetHighKey(recipient->KeyAt(0));
+    // splice recipient into the doubly-linked leaf chain
+    recipient->SetPrevPageId(GetPageId());
+    if (recipient->GetNextPageId() != INVALID_PAGE_ID) {
+        auto next_leaf = FetchPage<BPlusTreeLeafPage *>(
+            buffer_pool_manager, recipient->GetNextPageId());
+        next_leaf->SetPrevPageId(recipient->GetPageId());
+        buffer_pool_manager->UnpinPage(next_leaf->GetPageId(), true);
+    }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -200,6 +250,32 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(
     return GetSize();
 }
 
+/*
+ * Remove every entry whose key lies in [low, high]: the covered span is
+ * located once and the tail is shifted over it in a single pass
+ * @return   number of entries removed
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveRange(const KeyType &low,
+                                            const KeyType &high,
+                                            const KeyComparator &comparator) {
+    int begin = KeyIndex(low, comparator);
+    int end = begin;
+    while (end < GetSize() && comparator(KeyAt(end), high) <= 0) {
+        ++end;
+    }
+
+    int removed = end - begin;
+    if (removed > 0) {
+        for (int i = end; i < GetSize(); ++i) {
+            array[i - removed].first = array[i].first;
+            array[i - removed].second = array[i].second;
+        }
+        IncreaseSize(-removed);
+    }
+    return removed;
+}
+
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
@@ -209,11 +285,22 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient,
-                                           int, BufferPoolManager *) {
+                                           int, BufferPoolManager *buffer_pool_manager) {
     assert(GetSize() <= GetMinSize() && recipient->GetSize() <= recipient->GetMinSize());
 
     recipient->CopyAllFrom(array, GetSize());
+    // recipient absorbs this page's key range, bound included
+    if (HasHighKey()) {
+        recipient->SetHighKey(GetHighKey());
+    }
     recipient->SetNextPageId(GetNextPageId());
+    // unlink this page from the doubly-linked leaf chain
+    if (GetNextPageId() != INVALID_PAGE_ID) {
+        auto next_leaf = FetchPage<BPlusTreeLeafPage *>(
+            buffer_pool_manager, GetNextPageId());
+        next_leaf->SetPrevPageId(recipient->GetPageId());
+        buffer_pool_manager->UnpinPage(next_leaf->GetPageId(), true);
+    }
     SetSize(0);
 }
 
@@ -247,10 +334,12 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(
     }
     IncreaseSize(-1);
 
-    // update parent page key to first key in this page after move
+    // update parent page key to first key in this page after move, the
+    // left sibling's high key follows the separator
     auto parent = FetchPage<B_PLUS_TREE_LEAF_PARENT_PAGE_TYPE *>(
         buffer_pool_manager, GetParentPageId());
     parent->SetKeyAt(parent_index, KeyAt(0));
+    recipient->SetHighKey(KeyAt(0));
     buffer_pool_manager->UnpinPage(parent->GetPageId(), true);
 }
 
@@ -275,10 +364,12 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(
     recipient->CopyFirstFrom(GetItem(GetSize() - 1));
     IncreaseSize(-1);
 
-    // update parent page key to first key in recipient after move
+    // update parent page key to first key in recipient after move, this
+    // (left) page's high key follows the separator
     auto parent = FetchPage<B_PLUS_TREE_LEAF_PARENT_PAGE_TYPE *>(
         buffer_pool_manager, GetParentPageId());
     parent->SetKeyAt(parent_index, recipient->KeyAt(0));
+    SetHighKey(recipient->KeyAt(0));
     buffer_pool_manager->UnpinPage(parent->GetPageId(), true);
 }
 
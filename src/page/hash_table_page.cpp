@@ -0,0 +1,204 @@
+/**
+ * hash_table_page.cpp
+ */
+
+#include <cassert>
+
+#include "common/rid.h"
+#include "index/generic_key.h"
+#include "page/hash_table_page.h"
+
+namespace cmudb {
+
+/*****************************************************************************
+ * HEADER (DIRECTORY) PAGE
+ *****************************************************************************/
+void HashTableHeaderPage::Init(page_id_t page_id) {
+    page_id_ = page_id;
+    global_depth_ = 0;
+    directory_[0] = INVALID_PAGE_ID;
+}
+
+page_id_t HashTableHeaderPage::GetPageId() const { return page_id_; }
+
+int HashTableHeaderPage::GetGlobalDepth() const { return global_depth_; }
+
+void HashTableHeaderPage::SetGlobalDepth(int global_depth) {
+    assert(global_depth <= MaxGlobalDepth());
+    global_depth_ = global_depth;
+}
+
+int HashTableHeaderPage::GetDirectorySize() const {
+    return 1 << global_depth_;
+}
+
+page_id_t HashTableHeaderPage::GetBucketPageId(int index) const {
+    assert(index >= 0 && index < GetDirectorySize());
+    return directory_[index];
+}
+
+void HashTableHeaderPage::SetBucketPageId(int index, page_id_t page_id) {
+    assert(index >= 0 && index < GetDirectorySize());
+    directory_[index] = page_id;
+}
+
+int HashTableHeaderPage::MaxGlobalDepth() {
+    int max_entries = (PAGE_SIZE - sizeof(HashTableHeaderPage)) /
+                      sizeof(page_id_t);
+    int depth = 0;
+    while ((1 << (depth + 1)) <= max_entries) {
+        ++depth;
+    }
+    return depth;
+}
+
+/*****************************************************************************
+ * BUCKET PAGE
+ *****************************************************************************/
+/**
+ * Init method after creating a new bucket page
+ * Including set page id, set current size to zero, set local depth, set
+ * next page id and set max size
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HashTableBucketPage<KeyType, ValueType, KeyComparator>::Init(
+        page_id_t page_id, int local_depth) {
+    page_id_ = page_id;
+    size_ = 0;
+    local_depth_ = local_depth;
+    next_page_id_ = INVALID_PAGE_ID;
+    max_size_ = (PAGE_SIZE - sizeof(*this)) / sizeof(std::pair<KeyType, ValueType>);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+page_id_t HashTableBucketPage<KeyType, ValueType, KeyComparator>::GetPageId()
+        const {
+    return page_id_;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+int HashTableBucketPage<KeyType, ValueType, KeyComparator>::GetSize() const {
+    return size_;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+int HashTableBucketPage<KeyType, ValueType, KeyComparator>::GetMaxSize()
+        const {
+    return max_size_;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+int HashTableBucketPage<KeyType, ValueType, KeyComparator>::GetLocalDepth()
+        const {
+    return local_depth_;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HashTableBucketPage<KeyType, ValueType, KeyComparator>::SetLocalDepth(
+        int local_depth) {
+    local_depth_ = local_depth;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+page_id_t
+HashTableBucketPage<KeyType, ValueType, KeyComparator>::GetNextPageId() const {
+    return next_page_id_;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HashTableBucketPage<KeyType, ValueType, KeyComparator>::SetNextPageId(
+        page_id_t next_page_id) {
+    next_page_id_ = next_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+KeyType HashTableBucketPage<KeyType, ValueType, KeyComparator>::KeyAt(
+        int index) const {
+    assert(index >= 0 && index < GetSize());
+    return array[index].first;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ValueType HashTableBucketPage<KeyType, ValueType, KeyComparator>::ValueAt(
+        int index) const {
+    assert(index >= 0 && index < GetSize());
+    return array[index].second;
+}
+
+/*
+ * For the given key, check to see whether it exists in the bucket page. If
+ * it does, then store its corresponding value in input "value" and return
+ * true. If the key does not exist, then return false
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HashTableBucketPage<KeyType, ValueType, KeyComparator>::Lookup(
+        const KeyType &key, ValueType &value,
+        const KeyComparator &comparator) const {
+    for (int i = 0; i < GetSize(); ++i) {
+        if (comparator(key, array[i].first) == 0) {
+            value = array[i].second;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Insert key & value pair into the bucket page; entries are unordered so
+ * the pair is appended at the end
+ * @return: false when the key already exists or the page is full
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HashTableBucketPage<KeyType, ValueType, KeyComparator>::Insert(
+        const KeyType &key, const ValueType &value,
+        const KeyComparator &comparator) {
+    if (GetSize() >= GetMaxSize()) {
+        return false;
+    }
+    for (int i = 0; i < GetSize(); ++i) {
+        if (comparator(key, array[i].first) == 0) {
+            return false;
+        }
+    }
+
+    array[size_].first = key;
+    array[size_].second = value;
+    ++size_;
+
+    return true;
+}
+
+/*
+ * Look through the bucket page to see whether the delete key exists. If it
+ * does, remove it and fill the hole with the last entry
+ * @return: true when an entry was removed
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HashTableBucketPage<KeyType, ValueType, KeyComparator>::Remove(
+        const KeyType &key, const KeyComparator &comparator) {
+    for (int i = 0; i < GetSize(); ++i) {
+        if (comparator(key, array[i].first) == 0) {
+            RemoveAt(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HashTableBucketPage<KeyType, ValueType, KeyComparator>::RemoveAt(
+        int index) {
+    assert(index >= 0 && index < GetSize());
+    array[index].first = array[size_ - 1].first;
+    array[index].second = array[size_ - 1].second;
+    --size_;
+}
+
+template class HashTableBucketPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class HashTableBucketPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class HashTableBucketPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class HashTableBucketPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class HashTableBucketPage<GenericKey<64>, RID, GenericComparator<64>>;
+} // namespace cmudb
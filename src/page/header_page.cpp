@@ -8,6 +8,11 @@
 
 namespace cmudb {
 
+// record slots start after RecordCount (4) and NextPageId (4)
+static const int RECORD_BASE_OFFSET = 8;
+// 32 bytes of name followed by a 4 byte root id
+static const int RECORD_SIZE = 36;
+
 /**
  * Record related
  */
@@ -17,7 +22,9 @@ bool HeaderPage::InsertRecord(const std::string &name,
     assert(root_id > INVALID_PAGE_ID);
 
     int record_num = GetRecordCount();
-    int offset = 4 + record_num * 36;
+    if (record_num >= GetMaxRecordCount())
+        return false;
+    int offset = RECORD_BASE_OFFSET + record_num * RECORD_SIZE;
     // check for duplicate name
     if (FindRecord(name) != -1)
         return false;
@@ -37,9 +44,9 @@ bool HeaderPage::DeleteRecord(const std::string &name) {
     // record does not exsit
     if (index == -1)
         return false;
-    int offset = index * 36 + 4;
-    memmove(GetData() + offset, GetData() + offset + 36,
-            (record_num - index - 1) * 36);
+    int offset = index * RECORD_SIZE + RECORD_BASE_OFFSET;
+    memmove(GetData() + offset, GetData() + offset + RECORD_SIZE,
+            (record_num - index - 1) * RECORD_SIZE);
 
     SetRecordCount(record_num - 1);
     return true;
@@ -53,7 +60,7 @@ bool HeaderPage::UpdateRecord(const std::string &name,
     // record does not exsit
     if (index == -1)
         return false;
-    int offset = index * 36 + 4;
+    int offset = index * RECORD_SIZE + RECORD_BASE_OFFSET;
     // update record content, only root_id
     memcpy((GetData() + offset + 32), &root_id, 4);
 
@@ -67,12 +74,19 @@ bool HeaderPage::GetRootId(const std::string &name, page_id_t &root_id) {
     // record does not exsit
     if (index == -1)
         return false;
-    int offset = (index + 1) * 36;
-    root_id = *reinterpret_cast<page_id_t *>(GetData() + offset);
+    int offset = index * RECORD_SIZE + RECORD_BASE_OFFSET;
+    root_id = *reinterpret_cast<page_id_t *>(GetData() + offset + 32);
 
     return true;
 }
 
+void HeaderPage::GetRecord(int index, std::string &name, page_id_t &root_id) {
+    assert(index >= 0 && index < GetRecordCount());
+    int offset = index * RECORD_SIZE + RECORD_BASE_OFFSET;
+    name = std::string(GetData() + offset);
+    root_id = *reinterpret_cast<page_id_t *>(GetData() + offset + 32);
+}
+
 /**
  * helper functions
  */
@@ -83,11 +97,20 @@ void HeaderPage::SetRecordCount(int record_count) {
     memcpy(GetData(), &record_count, 4);
 }
 
+page_id_t HeaderPage::GetNextPageId() {
+    return *reinterpret_cast<page_id_t *>(GetData() + 4);
+}
+
+void HeaderPage::SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + 4, &next_page_id, 4);
+}
+
 int HeaderPage::FindRecord(const std::string &name) {
     int record_num = GetRecordCount();
 
     for (int i = 0; i < record_num; i++) {
-        char *raw_name = reinterpret_cast<char *>(GetData() + (4 + i * 36));
+        char *raw_name =
+                reinterpret_cast<char *>(GetData() + (RECORD_BASE_OFFSET + i * RECORD_SIZE));
         if (strcmp(raw_name, name.c_str()) == 0)
             return i;
     }
@@ -15,9 +15,19 @@ void TablePage::Init(page_id_t page_id, size_t page_size,
                      Transaction *txn) {
     memcpy(GetData(), &page_id, 4); // set page_id
     if (ENABLE_LOGGING) {
-        LogRecord record(txn->GetTransactionId(), txn->GetPrevLSN(),
-                         LogRecordType::NEWPAGE, prev_page_id);
-        AppendLogRecord(log_manager, record, txn);
+        lsn_t lsn;
+        char *data = log_manager->ReserveLogRecord(
+                LogRecord::HEADER_SIZE + 2 * sizeof(page_id_t),
+                txn->GetTransactionId(), txn->GetPrevLSN(),
+                LogRecordType::NEWPAGE, lsn);
+        memcpy(data + LogRecord::HEADER_SIZE, &prev_page_id,
+               sizeof(page_id_t));
+        // the created page's own id, so replay can find it again
+        memcpy(data + LogRecord::HEADER_SIZE + sizeof(page_id_t), &page_id,
+               sizeof(page_id_t));
+        log_manager->FinishAppend();
+        txn->SetPrevLSN(lsn);
+        SetLSN(lsn);
     }
     SetPrevPageId(prev_page_id);
     SetNextPageId(INVALID_PAGE_ID);
@@ -25,6 +35,13 @@ void TablePage::Init(page_id_t page_id, size_t page_size,
     SetTupleCount(0);
 }
 
+void TablePage::Reset(size_t page_size) {
+    SetPrevPageId(INVALID_PAGE_ID);
+    SetNextPageId(INVALID_PAGE_ID);
+    SetFreeSpacePointer(page_size);
+    SetTupleCount(0);
+}
+
 page_id_t TablePage::GetPageId() {
     return *reinterpret_cast<page_id_t *>(GetData());
 }
@@ -89,9 +106,8 @@ bool TablePage::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn,
     if (ENABLE_LOGGING) {
         // acquire the exclusive lock
         assert(lock_manager->LockExclusive(txn, rid.Get()));
-        LogRecord record(txn->GetTransactionId(), txn->GetPrevLSN(),
-                         LogRecordType::INSERT, rid, tuple);
-        AppendLogRecord(log_manager, record, txn);
+        AppendTupleLogRecord(log_manager, LogRecordType::INSERT, rid, tuple,
+                             txn);
     }
     // LOG_DEBUG("Tuple inserted");
     return true;
@@ -132,9 +148,8 @@ bool TablePage::MarkDelete(const RID &rid, Transaction *txn,
                    !lock_manager->LockExclusive(txn, rid)) { // no shared lock
             return false;
         }
-        LogRecord record(txn->GetTransactionId(), txn->GetPrevLSN(),
-                         LogRecordType::MARKDELETE, rid, Tuple());
-        AppendLogRecord(log_manager, record, txn);
+        AppendTupleLogRecord(log_manager, LogRecordType::MARKDELETE, rid,
+                             Tuple(), txn);
     }
 
     // set tuple size to negative value
@@ -162,8 +177,11 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple &old_tuple,
         return false;
     }
     if (GetFreeSpaceSize() < new_tuple.size_ - tuple_size) {
-        // should delete/insert because not enough space
-        return false;
+        // reclaim trailing empty slots before forcing a delete/insert
+        TrimEmptySlots();
+        if (GetFreeSpaceSize() < new_tuple.size_ - tuple_size) {
+            return false;
+        }
     }
 
     // copy out old value
@@ -188,9 +206,7 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple &old_tuple,
                    !lock_manager->LockExclusive(txn, rid)) { // no shared lock
             return false;
         }
-        LogRecord record(txn->GetTransactionId(), txn->GetPrevLSN(),
-                         LogRecordType::UPDATE, rid, old_tuple, new_tuple);
-        AppendLogRecord(log_manager, record, txn);
+        AppendUpdateLogRecord(log_manager, rid, old_tuple, new_tuple, txn);
     }
 
     // update
@@ -230,21 +246,20 @@ void TablePage::ApplyDelete(const RID &rid, Transaction *txn,
         tuple_size = -tuple_size;
     } // else: rollback insert op
 
-    // copy out delete value, for undo purpose
-    Tuple delete_tuple;
-    delete_tuple.size_ = tuple_size;
-    delete_tuple.data_ = new char[delete_tuple.size_];
-    memcpy(delete_tuple.data_, GetData() + tuple_offset, delete_tuple.size_);
-    delete_tuple.rid_ = rid;
-    delete_tuple.allocated_ = true;
-
     if (ENABLE_LOGGING) {
         // must already grab the exclusive lock
         assert(txn->GetExclusiveLockSet()->find(rid) !=
                txn->GetExclusiveLockSet()->end());
-        LogRecord record(txn->GetTransactionId(), txn->GetPrevLSN(),
-                         LogRecordType::APPLYDELETE, rid, delete_tuple);
-        AppendLogRecord(log_manager, record, txn);
+        // the delete value for undo purposes, viewed in place: the slot's
+        // bytes are untouched until the compaction below, so they go into
+        // the log reservation straight off the page
+        Tuple delete_tuple;
+        delete_tuple.size_ = tuple_size;
+        delete_tuple.data_ = GetData() + tuple_offset;
+        delete_tuple.rid_ = rid;
+        delete_tuple.allocated_ = false;
+        AppendTupleLogRecord(log_manager, LogRecordType::APPLYDELETE, rid,
+                             delete_tuple, txn);
     }
 
     int32_t free_space_pointer =
@@ -261,6 +276,8 @@ void TablePage::ApplyDelete(const RID &rid, Transaction *txn,
             SetTupleOffset(i, tuple_offset_i + tuple_size);
         }
     }
+    // the freed slot may expose a trailing run of empty slots
+    TrimEmptySlots();
 }
 
 /*
@@ -275,9 +292,8 @@ void TablePage::RollbackDelete(const RID &rid, Transaction *txn,
         // must have already grab the exclusive lock
         assert(txn->GetExclusiveLockSet()->find(rid) !=
                txn->GetExclusiveLockSet()->end());
-        LogRecord record(txn->GetTransactionId(), txn->GetPrevLSN(),
-                         LogRecordType::ROLLBACKDELETE, rid, Tuple());
-        AppendLogRecord(log_manager, record, txn);
+        AppendTupleLogRecord(log_manager, LogRecordType::ROLLBACKDELETE, rid,
+                             Tuple(), txn);
     }
 
     int slot_num = rid.GetSlotNum();
@@ -292,19 +308,59 @@ void TablePage::RollbackDelete(const RID &rid, Transaction *txn,
 bool TablePage::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn,
                          LockManager *lock_manager) {
     int slot_num = rid.GetSlotNum();
+    // a missing or deleted slot is not an error for a snapshot reader, the
+    // version store may still hold the value visible at its snapshot
     if (slot_num >= GetTupleCount()) {
-        if (ENABLE_LOGGING)
+        if (ENABLE_LOGGING && !txn->IsReadOnly())
             txn->SetState(TransactionState::ABORTED);
         return false;
     }
     int32_t tuple_size = GetTupleSize(slot_num);
     if (tuple_size <= 0) {
-        if (ENABLE_LOGGING)
+        if (ENABLE_LOGGING && !txn->IsReadOnly())
             txn->SetState(TransactionState::ABORTED);
         return false;
     }
 
-    if (ENABLE_LOGGING) {
+    // declared read-only txns read committed pages without locks
+    if (ENABLE_LOGGING && !txn->IsReadOnly()) {
+        // acquire shared lock
+        if (txn->GetExclusiveLockSet()->find(rid) ==
+            txn->GetExclusiveLockSet()->end() &&
+            txn->GetSharedLockSet()->find(rid) == txn->GetSharedLockSet()->end() &&
+            !lock_manager->LockShared(txn, rid)) {
+            return false;
+        }
+    }
+
+    int32_t tuple_offset = GetTupleOffset(slot_num);
+    tuple.size_ = tuple_size;
+    if (tuple.allocated_)
+        delete[] tuple.data_;
+    tuple.data_ = new char[tuple.size_];
+    memcpy(tuple.data_, GetData() + tuple_offset, tuple.size_);
+    tuple.rid_ = rid;
+    tuple.allocated_ = true;
+    return true;
+}
+
+bool TablePage::GetTupleView(const RID &rid, Tuple &tuple, Transaction *txn,
+                             LockManager *lock_manager) {
+    int slot_num = rid.GetSlotNum();
+    if (slot_num >= GetTupleCount()) {
+        if (ENABLE_LOGGING && !txn->IsReadOnly())
+            txn->SetState(TransactionState::ABORTED);
+        return false;
+    }
+    int32_t tuple_size = GetTupleSize(slot_num);
+    if (tuple_size <= 0) {
+        if (ENABLE_LOGGING && !txn->IsReadOnly())
+            txn->SetState(TransactionState::ABORTED);
+        return false;
+    }
+
+    // declared read-only txns read committed pages without locks
+    if (ENABLE_LOGGING && !txn->IsReadOnly()) {
         // acquire shared lock
         if (txn->GetExclusiveLockSet()->find(rid) ==
             txn->GetExclusiveLockSet()->end() &&
@@ -314,6 +370,41 @@ bool TablePage::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn,
         }
     }
 
+    if (tuple.allocated_)
+        delete[] tuple.data_;
+    tuple.size_ = tuple_size;
+    tuple.data_ = GetData() + GetTupleOffset(slot_num);
+    tuple.rid_ = rid;
+    tuple.allocated_ = false;
+    return true;
+}
+
+int32_t TablePage::TrimEmptySlots() {
+    int32_t tuple_count = GetTupleCount();
+    int32_t trimmed = 0;
+    while (tuple_count > 0 && GetTupleSize(tuple_count - 1) == 0) {
+        --tuple_count;
+        ++trimmed;
+    }
+    if (trimmed > 0) {
+        SetTupleCount(tuple_count);
+    }
+    return trimmed;
+}
+
+bool TablePage::GetTupleRaw(const RID &rid, Tuple &tuple) {
+    int slot_num = rid.GetSlotNum();
+    if (slot_num >= GetTupleCount()) {
+        return false;
+    }
+    int32_t tuple_size = GetTupleSize(slot_num);
+    if (tuple_size < 0) { // mark-deleted slots still hold their bytes
+        tuple_size = -tuple_size;
+    }
+    if (tuple_size == 0) { // empty slot
+        return false;
+    }
+
     int32_t tuple_offset = GetTupleOffset(slot_num);
     tuple.size_ = tuple_size;
     if (tuple.allocated_)
@@ -354,10 +445,76 @@ bool TablePage::GetNextTupleRid(const RID &cur_rid, RID &next_rid) {
 /**
  * helper functions
  */
-void TablePage::AppendLogRecord(LogManager *log_manager,
-                                LogRecord &log_record,
-                                Transaction *txn) {
-    lsn_t lsn = log_manager->AppendLogRecord(log_record);
+/*
+ * record layout: | HEADER | tuple_rid | tuple_size | tuple_data |
+ * the whole record is reserved (header written, lsn taken) in one latched
+ * step, then rid and tuple land in the reservation without further copies
+ */
+void TablePage::AppendTupleLogRecord(LogManager *log_manager,
+                                     LogRecordType log_record_type,
+                                     const RID &rid, const Tuple &tuple,
+                                     Transaction *txn) {
+    int32_t size = LogRecord::HEADER_SIZE + sizeof(RID) + sizeof(int32_t) +
+                   tuple.GetLength();
+    lsn_t lsn;
+    char *data = log_manager->ReserveLogRecord(size, txn->GetTransactionId(),
+                                               txn->GetPrevLSN(),
+                                               log_record_type, lsn);
+    memcpy(data + LogRecord::HEADER_SIZE, &rid, sizeof(RID));
+    tuple.SerializeTo(data + LogRecord::HEADER_SIZE + sizeof(RID));
+    log_manager->FinishAppend();
+    txn->SetPrevLSN(lsn);
+    SetLSN(lsn);
+}
+
+/*
+ * record layout: | HEADER | tuple_rid | prefix_len | suffix_len |
+ * old_middle_len | old_middle_data | new_middle_len | new_middle_data |
+ * the delta is measured against the two images where they sit and only
+ * the differing middle bytes are copied, directly into the reservation
+ */
+void TablePage::AppendUpdateLogRecord(LogManager *log_manager, const RID &rid,
+                                      const Tuple &old_tuple,
+                                      const Tuple &new_tuple,
+                                      Transaction *txn) {
+    const char *old_data = old_tuple.data_;
+    const char *new_data = new_tuple.data_;
+    const int32_t old_size = old_tuple.size_;
+    const int32_t new_size = new_tuple.size_;
+    const int32_t min_size = old_size < new_size ? old_size : new_size;
+
+    int32_t prefix_len = 0;
+    int32_t suffix_len = 0;
+    while (prefix_len < min_size && old_data[prefix_len] == new_data[prefix_len])
+        ++prefix_len;
+    while (suffix_len < min_size - prefix_len &&
+           old_data[old_size - 1 - suffix_len] ==
+                   new_data[new_size - 1 - suffix_len])
+        ++suffix_len;
+    int32_t old_middle_len = old_size - prefix_len - suffix_len;
+    int32_t new_middle_len = new_size - prefix_len - suffix_len;
+
+    int32_t size = LogRecord::HEADER_SIZE + sizeof(RID) + 4 * sizeof(int32_t) +
+                   old_middle_len + new_middle_len;
+    lsn_t lsn;
+    char *data = log_manager->ReserveLogRecord(size, txn->GetTransactionId(),
+                                               txn->GetPrevLSN(),
+                                               LogRecordType::UPDATE, lsn);
+    int pos = LogRecord::HEADER_SIZE;
+    memcpy(data + pos, &rid, sizeof(RID));
+    pos += sizeof(RID);
+    memcpy(data + pos, &prefix_len, sizeof(int32_t));
+    pos += sizeof(int32_t);
+    memcpy(data + pos, &suffix_len, sizeof(int32_t));
+    pos += sizeof(int32_t);
+    memcpy(data + pos, &old_middle_len, sizeof(int32_t));
+    pos += sizeof(int32_t);
+    memcpy(data + pos, old_data + prefix_len, old_middle_len);
+    pos += old_middle_len;
+    memcpy(data + pos, &new_middle_len, sizeof(int32_t));
+    pos += sizeof(int32_t);
+    memcpy(data + pos, new_data + prefix_len, new_middle_len);
+    log_manager->FinishAppend();
     txn->SetPrevLSN(lsn);
     SetLSN(lsn);
 }
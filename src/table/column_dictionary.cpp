@@ -0,0 +1,119 @@
+/**
+ * column_dictionary.cpp
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "table/column_dictionary.h"
+
+namespace cmudb {
+
+int32_t ColumnDictionary::GetOrAddCode(const std::string &value) {
+    auto it = codes_.find(value);
+    if (it != codes_.end())
+        return it->second;
+    int32_t code = static_cast<int32_t>(values_.size());
+    values_.push_back(value);
+    codes_[value] = code;
+    return code;
+}
+
+int32_t ColumnDictionary::GetCode(const std::string &value) const {
+    auto it = codes_.find(value);
+    return it == codes_.end() ? -1 : it->second;
+}
+
+const std::string &ColumnDictionary::GetValue(int32_t code) const {
+    assert(code >= 0 && code < GetSize());
+    return values_[code];
+}
+
+int32_t ColumnDictionary::GetSerializedSize() const {
+    int32_t size = sizeof(int32_t);
+    for (auto &value : values_)
+        size += sizeof(int32_t) + static_cast<int32_t>(value.size());
+    return size;
+}
+
+void ColumnDictionary::SerializeTo(char *storage) const {
+    int32_t count = GetSize();
+    memcpy(storage, &count, sizeof(int32_t));
+    storage += sizeof(int32_t);
+    for (auto &value : values_) {
+        int32_t len = static_cast<int32_t>(value.size());
+        memcpy(storage, &len, sizeof(int32_t));
+        storage += sizeof(int32_t);
+        memcpy(storage, value.data(), len);
+        storage += len;
+    }
+}
+
+void ColumnDictionary::DeserializeFrom(const char *storage) {
+    values_.clear();
+    codes_.clear();
+    int32_t count;
+    memcpy(&count, storage, sizeof(int32_t));
+    storage += sizeof(int32_t);
+    for (int32_t i = 0; i < count; ++i) {
+        int32_t len;
+        memcpy(&len, storage, sizeof(int32_t));
+        storage += sizeof(int32_t);
+        values_.emplace_back(storage, len);
+        codes_[values_.back()] = i;
+        storage += len;
+    }
+}
+
+DictionaryCodec::DictionaryCodec(Schema *schema) : schema_(schema) {
+    std::vector<Column> columns;
+    for (int i = 0; i < schema->GetColumnCount(); ++i) {
+        Column column = schema->GetColumn(i);
+        if (column.GetType() == TypeId::VARCHAR &&
+            column.GetName().rfind("dict_", 0) == 0) {
+            dict_columns_.push_back(i);
+            dictionaries_[i]; // default-construct the column's dictionary
+            columns.emplace_back(TypeId::INTEGER,
+                                 Type::GetTypeSize(TypeId::INTEGER),
+                                 column.GetName());
+        } else {
+            columns.push_back(column);
+        }
+    }
+    encoded_schema_ = new Schema(columns);
+}
+
+DictionaryCodec::~DictionaryCodec() { delete encoded_schema_; }
+
+Tuple DictionaryCodec::Encode(const Tuple &tuple) {
+    std::vector<Value> values;
+    size_t next_dict = 0;
+    for (int i = 0; i < schema_->GetColumnCount(); ++i) {
+        if (next_dict < dict_columns_.size() && dict_columns_[next_dict] == i) {
+            int32_t code =
+                dictionaries_[i].GetOrAddCode(tuple.GetValue(schema_, i).ToString());
+            values.emplace_back(TypeId::INTEGER, code);
+            ++next_dict;
+        } else {
+            values.push_back(tuple.GetValue(schema_, i));
+        }
+    }
+    return Tuple(values, encoded_schema_);
+}
+
+Tuple DictionaryCodec::Decode(const Tuple &tuple) {
+    std::vector<Value> values;
+    size_t next_dict = 0;
+    for (int i = 0; i < schema_->GetColumnCount(); ++i) {
+        if (next_dict < dict_columns_.size() && dict_columns_[next_dict] == i) {
+            int32_t code = tuple.GetValue(encoded_schema_, i).GetAs<int32_t>();
+            values.emplace_back(TypeId::VARCHAR, dictionaries_[i].GetValue(code));
+            ++next_dict;
+        } else {
+            values.push_back(tuple.GetValue(encoded_schema_, i));
+        }
+    }
+    return Tuple(values, schema_);
+}
+
+} // namespace cmudb
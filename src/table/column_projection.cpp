@@ -0,0 +1,197 @@
+/**
+ * column_projection.cpp
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "table/column_projection.h"
+
+namespace cmudb {
+
+// page header: | NextPageId (4) | EntryCount (4) | FreeOffset (4) |
+static constexpr int32_t HEADER_SIZE = 12;
+// per entry: the owning rid and the serialized size prefix
+static constexpr int32_t ENTRY_OVERHEAD =
+        sizeof(int64_t) + sizeof(int32_t);
+
+ColumnProjection::ColumnProjection(BufferPoolManager *buffer_pool_manager,
+                                   Schema *table_schema,
+                                   const std::vector<int> &proj_attrs,
+                                   page_id_t first_page_id)
+        : buffer_pool_manager_(buffer_pool_manager), table_schema_(table_schema),
+          proj_attrs_(proj_attrs), first_page_id_(first_page_id) {
+    assert(!proj_attrs_.empty());
+    projection_schema_ = Schema::CopySchema(table_schema_, proj_attrs_);
+
+    if (first_page_id_ == INVALID_PAGE_ID) {
+        Page *page = buffer_pool_manager_->NewPage(first_page_id_);
+        assert(page != nullptr);
+        InitPage(page->GetData());
+        buffer_pool_manager_->UnpinPage(first_page_id_, true);
+        tail_page_id_ = first_page_id_;
+        return;
+    }
+    // reopen: walk to the chain's tail so appends can resume there
+    tail_page_id_ = first_page_id_;
+    while (true) {
+        Page *page = buffer_pool_manager_->FetchPage(tail_page_id_);
+        assert(page != nullptr);
+        page_id_t next_page_id = GetNextPageId(page->GetData());
+        buffer_pool_manager_->UnpinPage(tail_page_id_, false);
+        if (next_page_id == INVALID_PAGE_ID)
+            break;
+        tail_page_id_ = next_page_id;
+    }
+}
+
+ColumnProjection::~ColumnProjection() { delete projection_schema_; }
+
+void ColumnProjection::Append(const Tuple &tuple, const RID &rid) {
+    // project down to the column group before taking the latch
+    std::vector<Value> values;
+    for (auto &i : proj_attrs_)
+        values.push_back(tuple.GetValue(table_schema_, i));
+    Tuple narrow(values, projection_schema_);
+    int32_t entry_size = ENTRY_OVERHEAD + narrow.GetLength();
+    assert(entry_size <= PAGE_SIZE - HEADER_SIZE);
+
+    std::lock_guard<std::mutex> guard(latch_);
+    Page *page = buffer_pool_manager_->FetchPage(tail_page_id_);
+    assert(page != nullptr);
+    if (GetFreeOffset(page->GetData()) + entry_size > PAGE_SIZE) {
+        // tail is full: chain a fresh page and move the append target
+        page_id_t new_page_id;
+        Page *new_page = buffer_pool_manager_->NewPage(new_page_id);
+        assert(new_page != nullptr);
+        InitPage(new_page->GetData());
+        SetNextPageId(page->GetData(), new_page_id);
+        buffer_pool_manager_->UnpinPage(tail_page_id_, true);
+        tail_page_id_ = new_page_id;
+        page = new_page;
+    }
+    char *data = page->GetData();
+    int32_t offset = GetFreeOffset(data);
+    int64_t raw_rid = rid.Get();
+    memcpy(data + offset, &raw_rid, sizeof(int64_t));
+    narrow.SerializeTo(data + offset + sizeof(int64_t));
+    SetFreeOffset(data, offset + entry_size);
+    SetEntryCount(data, GetEntryCount(data) + 1);
+    buffer_pool_manager_->UnpinPage(tail_page_id_, true);
+}
+
+bool ColumnProjection::Remove(const RID &rid) {
+    std::lock_guard<std::mutex> guard(latch_);
+    return SetTombstone(rid, true);
+}
+
+bool ColumnProjection::Restore(const RID &rid) {
+    std::lock_guard<std::mutex> guard(latch_);
+    return SetTombstone(rid, false);
+}
+
+bool ColumnProjection::SetTombstone(const RID &rid, bool live) {
+    // a tombstoned rid is stored negated so Restore can flip it back
+    int64_t match = live ? rid.Get() : -rid.Get() - 1;
+    page_id_t page_id = first_page_id_;
+    while (page_id != INVALID_PAGE_ID) {
+        Page *page = buffer_pool_manager_->FetchPage(page_id);
+        assert(page != nullptr);
+        char *data = page->GetData();
+        int32_t count = GetEntryCount(data);
+        int32_t offset = HEADER_SIZE;
+        for (int32_t i = 0; i < count; ++i) {
+            int64_t raw_rid;
+            memcpy(&raw_rid, data + offset, sizeof(int64_t));
+            int32_t size;
+            memcpy(&size, data + offset + sizeof(int64_t), sizeof(int32_t));
+            if (raw_rid == match) {
+                int64_t flipped = -raw_rid - 1;
+                memcpy(data + offset, &flipped, sizeof(int64_t));
+                buffer_pool_manager_->UnpinPage(page_id, true);
+                return true;
+            }
+            offset += ENTRY_OVERHEAD + size;
+        }
+        page_id_t next_page_id = GetNextPageId(data);
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        page_id = next_page_id;
+    }
+    return false;
+}
+
+size_t ColumnProjection::Scan(std::vector<Tuple> &tuples) {
+    std::lock_guard<std::mutex> guard(latch_);
+    size_t delivered = 0;
+    page_id_t page_id = first_page_id_;
+    while (page_id != INVALID_PAGE_ID) {
+        Page *page = buffer_pool_manager_->FetchPage(page_id);
+        assert(page != nullptr);
+        char *data = page->GetData();
+        int32_t count = GetEntryCount(data);
+        int32_t offset = HEADER_SIZE;
+        for (int32_t i = 0; i < count; ++i) {
+            int64_t raw_rid;
+            memcpy(&raw_rid, data + offset, sizeof(int64_t));
+            int32_t size;
+            memcpy(&size, data + offset + sizeof(int64_t), sizeof(int32_t));
+            if (raw_rid >= 0) {
+                Tuple tuple{RID(raw_rid)};
+                tuple.DeserializeFrom(data + offset + sizeof(int64_t));
+                tuples.push_back(std::move(tuple));
+                ++delivered;
+            }
+            offset += ENTRY_OVERHEAD + size;
+        }
+        page_id_t next_page_id = GetNextPageId(data);
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        page_id = next_page_id;
+    }
+    return delivered;
+}
+
+std::vector<int> ColumnProjection::FindProjectionColumns(Schema *schema) {
+    std::vector<int> proj_attrs;
+    for (int i = 0; i < schema->GetColumnCount(); ++i) {
+        if (schema->GetColumn(i).GetName().rfind("proj_", 0) == 0)
+            proj_attrs.push_back(i);
+    }
+    return proj_attrs;
+}
+
+/*
+ * chain page header helpers
+ */
+page_id_t ColumnProjection::GetNextPageId(char *data) {
+    return *reinterpret_cast<page_id_t *>(data);
+}
+
+void ColumnProjection::SetNextPageId(char *data, page_id_t next_page_id) {
+    memcpy(data, &next_page_id, sizeof(page_id_t));
+}
+
+int32_t ColumnProjection::GetEntryCount(char *data) {
+    return *reinterpret_cast<int32_t *>(data + sizeof(page_id_t));
+}
+
+void ColumnProjection::SetEntryCount(char *data, int32_t count) {
+    memcpy(data + sizeof(page_id_t), &count, sizeof(int32_t));
+}
+
+int32_t ColumnProjection::GetFreeOffset(char *data) {
+    return *reinterpret_cast<int32_t *>(data + sizeof(page_id_t) +
+                                        sizeof(int32_t));
+}
+
+void ColumnProjection::SetFreeOffset(char *data, int32_t offset) {
+    memcpy(data + sizeof(page_id_t) + sizeof(int32_t), &offset,
+           sizeof(int32_t));
+}
+
+void ColumnProjection::InitPage(char *data) {
+    SetNextPageId(data, INVALID_PAGE_ID);
+    SetEntryCount(data, 0);
+    SetFreeOffset(data, HEADER_SIZE);
+}
+
+} // namespace cmudb
@@ -2,6 +2,7 @@
  * table_heap.cpp
  */
 
+#include <algorithm>
 #include <cassert>
 
 #include "common/logger.h"
@@ -9,19 +10,28 @@
 
 namespace cmudb {
 
+// overflow stub layout: | Magic (4) | TotalSize (4) | FirstOverflowPage (4) |
+// overflow page layout: | PageId (4) | NextPageId (4) | Payload |
+static const int32_t OVERFLOW_MAGIC = 0x544f5354;
+static const int32_t OVERFLOW_STUB_SIZE = 12;
+static const int32_t OVERFLOW_PAYLOAD_SIZE = PAGE_SIZE - 8;
+
 // open table
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager,
                      LockManager *lock_manager, LogManager *log_manager,
-                     page_id_t first_page_id)
+                     page_id_t first_page_id, VersionManager *version_manager)
         : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager),
-          log_manager_(log_manager), first_page_id_(first_page_id) {}
+          log_manager_(log_manager), first_page_id_(first_page_id),
+          version_manager_(version_manager), last_page_hint_(first_page_id),
+          active_shared_scans_(0), shared_scan_position_(INVALID_PAGE_ID) {}
 
 // create table
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager,
                      LockManager *lock_manager, LogManager *log_manager,
-                     Transaction *txn)
+                     Transaction *txn, VersionManager *version_manager)
         : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager),
-          log_manager_(log_manager) {
+          log_manager_(log_manager), version_manager_(version_manager),
+          active_shared_scans_(0), shared_scan_position_(INVALID_PAGE_ID) {
     auto first_page =
             static_cast<TablePage *>(buffer_pool_manager_->NewPage(first_page_id_));
     assert(first_page != nullptr); // todo: abort table creation?
@@ -31,14 +41,54 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager,
     first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
     first_page->WUnlatch();
     buffer_pool_manager_->UnpinPage(first_page_id_, true);
+    last_page_hint_ = first_page_id_;
 }
 
 bool TableHeap::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn) {
-    if (tuple.size_ + 32 > PAGE_SIZE) { // larger than one page size
+    // a declared read-only txn must not write
+    if (txn->IsReadOnly()) {
         txn->SetState(TransactionState::ABORTED);
         return false;
     }
 
+    // a declared batch transaction stages the row in its private workspace;
+    // it reaches the pages at commit and an abort discards the workspace
+    // without touching a page (the staged rid is not assigned yet)
+    if (txn->IsDeferredWrites()) {
+        txn->StageInsert(this, tuple);
+        return true;
+    }
+
+    if (tuple.size_ + 32 > PAGE_SIZE) { // larger than one page size
+        return InsertOverflowTuple(tuple, rid, txn);
+    }
+
+    // try a page with space reclaimed by ApplyDelete first, so fragmented
+    // tables reuse their holes instead of growing the chain
+    page_id_t reuse_page_id = FindPageWithSpace(tuple.size_ + 32);
+    if (reuse_page_id != INVALID_PAGE_ID) {
+        auto reuse_page = static_cast<TablePage *>(
+                buffer_pool_manager_->FetchPage(reuse_page_id));
+        if (reuse_page != nullptr) {
+            reuse_page->WLatch();
+            if (reuse_page->InsertTuple(tuple, rid, txn, lock_manager_,
+                                        log_manager_)) {
+                RecordFreeSpace(reuse_page_id, reuse_page->GetFreeSpaceSize());
+                if (version_manager_ != nullptr) {
+                    version_manager_->RecordOldVersion(txn, rid, Tuple{}, true);
+                }
+                reuse_page->WUnlatch();
+                buffer_pool_manager_->UnpinPage(reuse_page_id, true);
+                txn->GetWriteSet()->emplace_back(rid, WType::INSERT, Tuple{},
+                                                 this);
+                return true;
+            }
+            // the recorded space was taken in the meantime; fall through
+            reuse_page->WUnlatch();
+            buffer_pool_manager_->UnpinPage(reuse_page_id, false);
+        }
+    }
+
     auto cur_page =
             static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
     if (cur_page == nullptr) {
@@ -72,18 +122,130 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn) {
             cur_page->SetNextPageId(next_page_id);
             new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetPageId(),
                            log_manager_, txn);
+            // WAL: the link must not reach disk before the NEWPAGE record
+            // does, or a crash leaves cur_page pointing at a zero-filled
+            // page; stamping cur_page with the record's LSN makes the
+            // flush path force the log out first
+            if (ENABLE_LOGGING && log_manager_ != nullptr) {
+                cur_page->SetLSN(new_page->GetLSN());
+            }
             cur_page->WUnlatch();
             buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), true);
             cur_page = new_page;
+            last_page_hint_ = next_page_id;
         }
     }
+    // record under the page latch so no reader can see the slot without
+    // finding the version
+    if (version_manager_ != nullptr) {
+        version_manager_->RecordOldVersion(txn, rid, Tuple{}, true);
+    }
     cur_page->WUnlatch();
     buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), true);
     txn->GetWriteSet()->emplace_back(rid, WType::INSERT, Tuple{}, this);
     return true;
 }
 
+bool TableHeap::InsertTuples(const std::vector<Tuple> &tuples,
+                             std::vector<RID> &rids, Transaction *txn) {
+    // a declared read-only txn must not write
+    if (txn->IsReadOnly()) {
+        txn->SetState(TransactionState::ABORTED);
+        return false;
+    }
+
+    // see InsertTuple: a declared batch stages the whole block privately
+    if (txn->IsDeferredWrites()) {
+        for (auto &tuple : tuples) {
+            txn->StageInsert(this, tuple);
+        }
+        return true;
+    }
+
+    // start the walk at the cached tail hint; for a bulk load every tuple
+    // after the first lands on the page already latched here
+    auto cur_page = static_cast<TablePage *>(
+            buffer_pool_manager_->FetchPage(last_page_hint_));
+    if (cur_page == nullptr) {
+        txn->SetState(TransactionState::ABORTED);
+        return false;
+    }
+
+    rids.reserve(rids.size() + tuples.size());
+    cur_page->WLatch();
+    for (const auto &tuple : tuples) {
+        RID rid;
+        if (tuple.size_ + 32 > PAGE_SIZE) { // route through the overflow path
+            cur_page->WUnlatch();
+            buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), true);
+            if (!InsertOverflowTuple(tuple, rid, txn)) {
+                return false;
+            }
+            rids.push_back(rid);
+            cur_page = static_cast<TablePage *>(
+                    buffer_pool_manager_->FetchPage(last_page_hint_));
+            if (cur_page == nullptr) {
+                txn->SetState(TransactionState::ABORTED);
+                return false;
+            }
+            cur_page->WLatch();
+            continue;
+        }
+        while (!cur_page->InsertTuple(
+                tuple, rid, txn, lock_manager_,
+                log_manager_)) { // fail to insert due to not enough space
+            auto next_page_id = cur_page->GetNextPageId();
+            if (next_page_id != INVALID_PAGE_ID) { // valid next page
+                cur_page->WUnlatch();
+                buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), true);
+                cur_page = static_cast<TablePage *>(
+                        buffer_pool_manager_->FetchPage(next_page_id));
+                cur_page->WLatch();
+            } else { // create new page
+                auto new_page = static_cast<TablePage *>(
+                        buffer_pool_manager_->NewPage(next_page_id));
+                if (new_page == nullptr) {
+                    cur_page->WUnlatch();
+                    buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), true);
+                    txn->SetState(TransactionState::ABORTED);
+                    return false;
+                }
+                new_page->WLatch();
+                cur_page->SetNextPageId(next_page_id);
+                new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetPageId(),
+                               log_manager_, txn);
+                // WAL: see InsertTuple -- the link may not be flushed
+                // ahead of the NEWPAGE record it depends on
+                if (ENABLE_LOGGING && log_manager_ != nullptr) {
+                    cur_page->SetLSN(new_page->GetLSN());
+                }
+                cur_page->WUnlatch();
+                buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), true);
+                cur_page = new_page;
+                last_page_hint_ = next_page_id;
+            }
+        }
+        // record under the page latch so no reader can see the slot without
+        // finding the version
+        if (version_manager_ != nullptr) {
+            version_manager_->RecordOldVersion(txn, rid, Tuple{}, true);
+        }
+        rids.push_back(rid);
+        txn->GetWriteSet()->emplace_back(rid, WType::INSERT, Tuple{}, this);
+    }
+    last_page_hint_ = cur_page->GetPageId();
+    cur_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), true);
+    return true;
+}
+
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
+    // a declared read-only txn must not write
+    if (txn->IsReadOnly()) {
+        txn->SetState(TransactionState::ABORTED);
+        return false;
+    }
+
     // todo: remove empty page
     auto page = reinterpret_cast<TablePage *>(
             buffer_pool_manager_->FetchPage(rid.GetPageId()));
@@ -92,6 +254,14 @@ bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
         return false;
     }
     page->WLatch();
+    // the mark itself leaves the page value in place, but ApplyDelete at
+    // commit erases it; save the tuple so snapshot readers keep seeing it
+    if (version_manager_ != nullptr) {
+        Tuple old_tuple;
+        if (page->GetTuple(rid, old_tuple, txn, lock_manager_)) {
+            version_manager_->RecordOldVersion(txn, rid, old_tuple, false);
+        }
+    }
     page->MarkDelete(rid, txn, lock_manager_, log_manager_);
     page->WUnlatch();
     buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
@@ -101,6 +271,12 @@ bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
 
 bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid,
                             Transaction *txn) {
+    // a declared read-only txn must not write
+    if (txn->IsReadOnly()) {
+        txn->SetState(TransactionState::ABORTED);
+        return false;
+    }
+
     auto page = reinterpret_cast<TablePage *>(
             buffer_pool_manager_->FetchPage(rid.GetPageId()));
     if (page == nullptr) {
@@ -111,6 +287,10 @@ bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid,
     page->WLatch();
     bool is_updated = page->UpdateTuple(tuple, old_tuple, rid, txn, lock_manager_,
                                         log_manager_);
+    if (is_updated && txn->GetState() != TransactionState::ABORTED &&
+        version_manager_ != nullptr) {
+        version_manager_->RecordOldVersion(txn, rid, old_tuple, false);
+    }
     page->WUnlatch();
     buffer_pool_manager_->UnpinPage(page->GetPageId(), is_updated);
     if (is_updated && txn->GetState() != TransactionState::ABORTED)
@@ -123,10 +303,21 @@ void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
             buffer_pool_manager_->FetchPage(rid.GetPageId()));
     assert(page != nullptr);
     page->WLatch();
+    // an overflow stub in the slot means the real payload lives in a chain
+    // of overflow pages that must be reclaimed along with the slot
+    page_id_t overflow_page_id = INVALID_PAGE_ID;
+    Tuple victim;
+    if (page->GetTupleRaw(rid, victim) && IsOverflowStub(victim)) {
+        memcpy(&overflow_page_id, victim.data_ + 8, 4);
+    }
     page->ApplyDelete(rid, txn, log_manager_);
     lock_manager_->Unlock(txn, rid);
+    RecordFreeSpace(page->GetPageId(), page->GetFreeSpaceSize());
     page->WUnlatch();
     buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    if (overflow_page_id != INVALID_PAGE_ID) {
+        FreeOverflowChain(overflow_page_id);
+    }
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
@@ -151,9 +342,556 @@ bool TableHeap::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn) {
     bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
     page->RUnlatch();
     buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+
+    // a snapshot reader overrides the page value with the version visible
+    // at its snapshot; the page must be read first so a writer latching it
+    // has already recorded its version by the time the chain is consulted
+    if (txn->IsReadOnly() && version_manager_ != nullptr) {
+        Tuple version;
+        bool absent = false;
+        if (version_manager_->GetVisibleTuple(rid, txn->GetSnapshotTS(), version,
+                                              absent)) {
+            if (absent) {
+                return false;
+            }
+            tuple = version;
+            res = true;
+        }
+    }
+    // a stub left behind by an overflow insert is resolved transparently
+    if (res && IsOverflowStub(tuple)) {
+        res = ResolveOverflowTuple(tuple);
+    }
     return res;
 }
 
+size_t TableHeap::ScanBatch(RID &cursor, std::vector<Tuple> &tuples, size_t n,
+                            Transaction *txn) {
+    size_t count = 0;
+    RID rid = cursor;
+    bool valid = rid.GetPageId() != INVALID_PAGE_ID;
+    page_id_t page_id = valid ? rid.GetPageId() : first_page_id_;
+
+    while (page_id != INVALID_PAGE_ID) {
+        auto page =
+                static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+        if (page == nullptr) {
+            txn->SetState(TransactionState::ABORTED);
+            break;
+        }
+        page->RLatch();
+        if (!valid) { // fresh page, start at its first tuple
+            valid = page->GetFirstTupleRid(rid);
+        }
+        if (valid && count == n) {
+            // the batch is already full; this is the resume position, which
+            // must be pinned down now so the end-of-scan cursor stays
+            // unambiguous when a batch boundary lines up with a page boundary
+            page->RUnlatch();
+            buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+            cursor = rid;
+            return count;
+        }
+        while (valid && count < n) {
+            Tuple tuple;
+            if (ReadVisibleTuple(page, rid, tuple, txn)) {
+                tuples.push_back(tuple);
+                ++count;
+            }
+            RID next_rid;
+            valid = page->GetNextTupleRid(rid, next_rid);
+            if (valid) {
+                rid = next_rid;
+            }
+        }
+        page_id_t next_page_id = page->GetNextPageId();
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        if (valid) { // the batch filled mid-page, resume here next call
+            cursor = rid;
+            return count;
+        }
+        page_id = next_page_id;
+    }
+
+    cursor = RID(INVALID_PAGE_ID, -1);
+    return count;
+}
+
+bool TableHeap::GetTupleView(const RID &rid, PinnedTuple &result,
+                             Transaction *txn) {
+    result.Release();
+    auto page = static_cast<TablePage *>(
+            buffer_pool_manager_->FetchPage(rid.GetPageId()));
+    if (page == nullptr) {
+        txn->SetState(TransactionState::ABORTED);
+        return false;
+    }
+    page->RLatch();
+    bool res = page->GetTupleView(rid, result.tuple_, txn, lock_manager_);
+
+    // the snapshot overlay materializes a version tuple of its own, so no
+    // pin on the table page is needed (or safe) for it
+    if (txn->IsReadOnly() && version_manager_ != nullptr) {
+        Tuple version;
+        bool absent = false;
+        if (version_manager_->GetVisibleTuple(rid, txn->GetSnapshotTS(), version,
+                                              absent)) {
+            page->RUnlatch();
+            buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+            if (absent) {
+                return false;
+            }
+            result.tuple_ = version;
+            if (IsOverflowStub(result.tuple_)) {
+                return ResolveOverflowTuple(result.tuple_);
+            }
+            return true;
+        }
+    }
+
+    if (!res) {
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+        return false;
+    }
+    if (IsOverflowStub(result.tuple_)) {
+        // resolution reassembles an owned tuple from the overflow chain
+        res = ResolveOverflowTuple(result.tuple_);
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+        return res;
+    }
+    result.buffer_pool_manager_ = buffer_pool_manager_;
+    result.page_ = page;
+    return true;
+}
+
+bool TableHeap::IsOverflowStub(const Tuple &tuple) const {
+    // stubs are exactly 12 bytes and start with the magic word; a schema'd
+    // tuple colliding with both is vanishingly unlikely
+    if (tuple.size_ != OVERFLOW_STUB_SIZE) {
+        return false;
+    }
+    int32_t magic;
+    memcpy(&magic, tuple.data_, 4);
+    return magic == OVERFLOW_MAGIC;
+}
+
+bool TableHeap::InsertOverflowTuple(const Tuple &tuple, RID &rid,
+                                    Transaction *txn) {
+    // write the payload across a chain of dedicated overflow pages
+    page_id_t first_page_id = INVALID_PAGE_ID;
+    Page *prev_page = nullptr;
+    int32_t written = 0;
+    while (written < tuple.size_) {
+        page_id_t page_id;
+        Page *page = buffer_pool_manager_->NewPage(page_id);
+        if (page == nullptr) {
+            if (prev_page != nullptr) {
+                buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+            }
+            FreeOverflowChain(first_page_id);
+            txn->SetState(TransactionState::ABORTED);
+            return false;
+        }
+        memcpy(page->GetData(), &page_id, 4);
+        page_id_t next_page_id = INVALID_PAGE_ID;
+        memcpy(page->GetData() + 4, &next_page_id, 4);
+        int32_t chunk = std::min(OVERFLOW_PAYLOAD_SIZE, tuple.size_ - written);
+        memcpy(page->GetData() + 8, tuple.data_ + written, chunk);
+        written += chunk;
+
+        if (prev_page == nullptr) {
+            first_page_id = page_id;
+        } else {
+            memcpy(prev_page->GetData() + 4, &page_id, 4);
+            buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+        }
+        prev_page = page;
+    }
+    buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+
+    // a small stub referencing the chain takes the slot; its rid is the
+    // tuple's rid for all external purposes
+    Tuple stub;
+    stub.size_ = OVERFLOW_STUB_SIZE;
+    stub.data_ = new char[stub.size_];
+    stub.allocated_ = true;
+    memcpy(stub.data_, &OVERFLOW_MAGIC, 4);
+    memcpy(stub.data_ + 4, &tuple.size_, 4);
+    memcpy(stub.data_ + 8, &first_page_id, 4);
+    if (!InsertTuple(stub, rid, txn)) {
+        FreeOverflowChain(first_page_id);
+        return false;
+    }
+    return true;
+}
+
+bool TableHeap::ResolveOverflowTuple(Tuple &tuple) {
+    int32_t total_size;
+    page_id_t page_id;
+    memcpy(&total_size, tuple.data_ + 4, 4);
+    memcpy(&page_id, tuple.data_ + 8, 4);
+
+    char *data = new char[total_size];
+    int32_t read = 0;
+    while (read < total_size && page_id != INVALID_PAGE_ID) {
+        Page *page = buffer_pool_manager_->FetchPage(page_id);
+        if (page == nullptr) {
+            delete[] data;
+            return false;
+        }
+        int32_t chunk = std::min(OVERFLOW_PAYLOAD_SIZE, total_size - read);
+        memcpy(data + read, page->GetData() + 8, chunk);
+        read += chunk;
+        page_id_t next_page_id;
+        memcpy(&next_page_id, page->GetData() + 4, 4);
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        page_id = next_page_id;
+    }
+    assert(read == total_size);
+
+    if (tuple.allocated_) {
+        delete[] tuple.data_;
+    }
+    tuple.data_ = data;
+    tuple.size_ = total_size;
+    tuple.allocated_ = true;
+    return true;
+}
+
+void TableHeap::FreeOverflowChain(page_id_t first_page_id) {
+    page_id_t page_id = first_page_id;
+    while (page_id != INVALID_PAGE_ID) {
+        Page *page = buffer_pool_manager_->FetchPage(page_id);
+        if (page == nullptr) {
+            return;
+        }
+        page_id_t next_page_id;
+        memcpy(&next_page_id, page->GetData() + 4, 4);
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        buffer_pool_manager_->DeletePage(page_id);
+        page_id = next_page_id;
+    }
+}
+
+bool TableHeap::ReadVisibleTuple(TablePage *page, const RID &rid, Tuple &tuple,
+                                 Transaction *txn) {
+    bool visible = page->GetTuple(rid, tuple, txn, lock_manager_);
+    // a snapshot reader overrides the page value with the version visible
+    // at its snapshot, like TableHeap::GetTuple does
+    if (txn->IsReadOnly() && version_manager_ != nullptr) {
+        Tuple version;
+        bool absent = false;
+        if (version_manager_->GetVisibleTuple(rid, txn->GetSnapshotTS(), version,
+                                              absent)) {
+            visible = !absent;
+            if (visible) {
+                tuple = version;
+            }
+        }
+    }
+    if (visible && IsOverflowStub(tuple)) {
+        visible = ResolveOverflowTuple(tuple);
+    }
+    return visible;
+}
+
+std::vector<std::vector<page_id_t>>
+TableHeap::GetScanPartitions(size_t num_partitions) {
+    assert(num_partitions > 0);
+
+    // one walk over the chain to collect the page ids in order
+    std::vector<page_id_t> page_ids;
+    page_id_t page_id = first_page_id_;
+    while (page_id != INVALID_PAGE_ID) {
+        auto page =
+                static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+        assert(page != nullptr);
+        page->RLatch();
+        page_id_t next_page_id = page->GetNextPageId();
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        page_ids.push_back(page_id);
+        page_id = next_page_id;
+    }
+
+    // contiguous split keeps each worker on neighboring pages; short tables
+    // simply yield fewer partitions than requested
+    std::vector<std::vector<page_id_t>> partitions;
+    size_t chunk = (page_ids.size() + num_partitions - 1) / num_partitions;
+    for (size_t begin = 0; begin < page_ids.size(); begin += chunk) {
+        size_t end = std::min(begin + chunk, page_ids.size());
+        partitions.emplace_back(page_ids.begin() + begin,
+                                page_ids.begin() + end);
+    }
+    return partitions;
+}
+
+size_t TableHeap::ScanPages(const std::vector<page_id_t> &pages,
+                            std::vector<Tuple> &tuples, Transaction *txn) {
+    size_t count = 0;
+    for (auto page_id : pages) {
+        auto page =
+                static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+        if (page == nullptr) {
+            txn->SetState(TransactionState::ABORTED);
+            break;
+        }
+        page->RLatch();
+        RID rid;
+        bool valid = page->GetFirstTupleRid(rid);
+        while (valid) {
+            Tuple tuple;
+            if (ReadVisibleTuple(page, rid, tuple, txn)) {
+                tuples.push_back(tuple);
+                ++count;
+            }
+            RID next_rid;
+            valid = page->GetNextTupleRid(rid, next_rid);
+            if (valid) {
+                rid = next_rid;
+            }
+        }
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    }
+    return count;
+}
+
+void TableHeap::BeginSharedScan(SharedScan &scan) {
+    scan.Detach();
+    std::lock_guard<std::mutex> guard(shared_scan_mutex_);
+    page_id_t start = first_page_id_;
+    // join the stream where it currently is; the wrap-around below brings
+    // this scan back over the pages the others have already gone past
+    if (active_shared_scans_ > 0 && shared_scan_position_ != INVALID_PAGE_ID) {
+        start = shared_scan_position_;
+    }
+    ++active_shared_scans_;
+    scan.table_heap_ = this;
+    scan.start_page_id_ = start;
+    scan.next_page_id_ = start;
+}
+
+void TableHeap::EndSharedScan() {
+    std::lock_guard<std::mutex> guard(shared_scan_mutex_);
+    assert(active_shared_scans_ > 0);
+    if (--active_shared_scans_ == 0) {
+        // nobody left to follow; the next scan starts at the first page
+        shared_scan_position_ = INVALID_PAGE_ID;
+    }
+}
+
+void TableHeap::PublishScanPosition(page_id_t page_id) {
+    std::lock_guard<std::mutex> guard(shared_scan_mutex_);
+    shared_scan_position_ = page_id;
+}
+
+bool SharedScan::NextPage(std::vector<Tuple> &tuples, Transaction *txn) {
+    if (table_heap_ == nullptr || next_page_id_ == INVALID_PAGE_ID) {
+        return false;
+    }
+    page_id_t page_id = next_page_id_;
+    table_heap_->PublishScanPosition(page_id);
+
+    BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+    auto page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(page_id));
+    if (page == nullptr) {
+        txn->SetState(TransactionState::ABORTED);
+        Detach();
+        return false;
+    }
+    page->RLatch();
+    RID rid;
+    bool valid = page->GetFirstTupleRid(rid);
+    while (valid) {
+        Tuple tuple;
+        if (table_heap_->ReadVisibleTuple(page, rid, tuple, txn)) {
+            tuples.push_back(tuple);
+        }
+        RID next_rid;
+        valid = page->GetNextTupleRid(rid, next_rid);
+        if (valid) {
+            rid = next_rid;
+        }
+    }
+    page_id_t next = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager->UnpinPage(page->GetPageId(), false);
+
+    if (next == INVALID_PAGE_ID) { // tail of the chain: circle back
+        next = table_heap_->first_page_id_;
+    }
+    if (next == start_page_id_) { // full circle, every page seen
+        next = INVALID_PAGE_ID;
+    }
+    next_page_id_ = next;
+    return true;
+}
+
+void SharedScan::Detach() {
+    if (table_heap_ != nullptr) {
+        table_heap_->EndSharedScan();
+        table_heap_ = nullptr;
+    }
+    start_page_id_ = INVALID_PAGE_ID;
+    next_page_id_ = INVALID_PAGE_ID;
+}
+
+ParallelScan::ParallelScan(TableHeap *table_heap)
+        : table_heap_(table_heap),
+          next_page_id_(table_heap->first_page_id_) {}
+
+bool ParallelScan::NextPage(std::vector<Tuple> &tuples, Transaction *txn) {
+    BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+
+    TablePage *page;
+    {
+        // claim a page and advance the shared cursor; only this chain walk
+        // is serialized, extraction below runs concurrently
+        std::lock_guard<std::mutex> guard(latch_);
+        if (next_page_id_ == INVALID_PAGE_ID) {
+            return false;
+        }
+        page = static_cast<TablePage *>(
+                buffer_pool_manager->FetchPage(next_page_id_));
+        if (page == nullptr) {
+            txn->SetState(TransactionState::ABORTED);
+            next_page_id_ = INVALID_PAGE_ID;
+            return false;
+        }
+        page->RLatch();
+        next_page_id_ = page->GetNextPageId();
+        page->RUnlatch();
+    }
+
+    page->RLatch();
+    RID rid;
+    bool valid = page->GetFirstTupleRid(rid);
+    while (valid) {
+        Tuple tuple;
+        if (table_heap_->ReadVisibleTuple(page, rid, tuple, txn)) {
+            tuples.push_back(tuple);
+        }
+        RID next_rid;
+        valid = page->GetNextTupleRid(rid, next_rid);
+        if (valid) {
+            rid = next_rid;
+        }
+    }
+    page->RUnlatch();
+    buffer_pool_manager->UnpinPage(page->GetPageId(), false);
+    return true;
+}
+
+void TableHeap::RecordFreeSpace(page_id_t page_id, int32_t free_bytes) {
+    std::lock_guard<std::mutex> guard(free_space_mutex_);
+    if (free_bytes >= FREE_SPACE_THRESHOLD) {
+        free_space_map_[page_id] = free_bytes;
+    } else {
+        free_space_map_.erase(page_id);
+    }
+}
+
+page_id_t TableHeap::FindPageWithSpace(int32_t need_bytes) {
+    std::lock_guard<std::mutex> guard(free_space_mutex_);
+    for (auto it = free_space_map_.begin(); it != free_space_map_.end(); ++it) {
+        if (it->second >= need_bytes) {
+            page_id_t page_id = it->first;
+            // claim the entry; the caller re-records what is left over
+            free_space_map_.erase(it);
+            return page_id;
+        }
+    }
+    return INVALID_PAGE_ID;
+}
+
+/*
+ * Bulk truncation, see the header for the contract. One TRUNCATE record
+ * stands in for every per-row delete; it is forced to disk before any
+ * page goes back to the allocator so redo can replay the wipe, and it is
+ * deliberately kept off the transaction's undo chain (truncation cannot
+ * be rolled back)
+ */
+int32_t TableHeap::Truncate(Transaction *txn) {
+    // a declared read-only txn must not write
+    if (txn->IsReadOnly()) {
+        txn->SetState(TransactionState::ABORTED);
+        return -1;
+    }
+
+    auto first_page = static_cast<TablePage *>(
+            buffer_pool_manager_->FetchPage(first_page_id_));
+    assert(first_page != nullptr);
+    first_page->WLatch();
+
+    // collect the successor pages; quiescence means nobody else walks or
+    // extends the chain while we do
+    std::vector<page_id_t> successors;
+    page_id_t page_id = first_page->GetNextPageId();
+    while (page_id != INVALID_PAGE_ID) {
+        auto page =
+                static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+        assert(page != nullptr);
+        successors.push_back(page_id);
+        page_id_t next_page_id = page->GetNextPageId();
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        page_id = next_page_id;
+    }
+
+    // wipe the first page in place; the record's lsn on the page lets redo
+    // recognize an already-applied truncate and makes replayed tuple
+    // records from before the truncate lose against it
+    first_page->Reset(PAGE_SIZE);
+    if (ENABLE_LOGGING && log_manager_ != nullptr) {
+        LogRecord record(INVALID_TXN_ID, INVALID_LSN, LogRecordType::TRUNCATE,
+                         first_page_id_);
+        lsn_t lsn = log_manager_->AppendLogRecord(record);
+        first_page->SetLSN(lsn);
+        log_manager_->GroupCommitAndWait(lsn);
+    }
+    first_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(first_page_id_, true);
+
+    // only now, with the record durable, do the pages go back to the free
+    // map for reuse
+    for (auto dropped : successors) {
+        buffer_pool_manager_->DeletePage(dropped);
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(free_space_mutex_);
+        free_space_map_.clear();
+    }
+    last_page_hint_ = first_page_id_;
+    return static_cast<int32_t>(successors.size());
+}
+
+int32_t TableHeap::Vacuum() {
+    int32_t reclaimed = 0;
+    page_id_t page_id = first_page_id_;
+    while (page_id != INVALID_PAGE_ID) {
+        auto page =
+                static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+        if (page == nullptr) {
+            break;
+        }
+        page->WLatch();
+        int32_t trimmed = page->TrimEmptySlots();
+        reclaimed += trimmed;
+        if (trimmed > 0) {
+            RecordFreeSpace(page_id, page->GetFreeSpaceSize());
+        }
+        page_id_t next_page_id = page->GetNextPageId();
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(page_id, trimmed > 0);
+        page_id = next_page_id;
+    }
+    return reclaimed;
+}
+
 bool TableHeap::DeleteTableHeap() {
     // todo: real delete
     return true;
@@ -6,6 +6,7 @@
 #include <cstdlib>
 #include <sstream>
 
+#include "common/arena.h"
 #include "common/logger.h"
 #include "table/tuple.h"
 
@@ -14,24 +15,100 @@ namespace cmudb {
 Tuple::Tuple(std::vector<Value> values, Schema *schema) : allocated_(true) {
     assert((int)values.size() == schema->GetColumnCount());
 
-    // step1: calculate size of the tuple
-    int32_t tuple_size = schema->GetLength();
-    for (auto &i : schema->GetUnlinedColumns())
-        tuple_size += (values[i].GetLength() + sizeof(uint32_t));
+    // step1: calculate size of the tuple; null varlen columns store no
+    // payload, only the null bit and their (dead) offset slot
+    int32_t tuple_size = schema->GetLength() + NullBitmapSize(schema);
+    for (auto &i : schema->GetUnlinedColumns()) {
+        if (!values[i].IsNull())
+            tuple_size += (values[i].GetLength() + sizeof(uint32_t));
+    }
     // allocate memory using new, allocated_ flag set as true
     size_ = tuple_size;
     data_ = new char[size_];
 
     // step2: Serialize each column(attribute) based on input value
+    SerializeValues(values, schema);
+}
+
+// Arena-backed constructor: same layout, but the bytes come from (and are
+// owned by) the arena, so no per-tuple heap round trip
+Tuple::Tuple(std::vector<Value> values, Schema *schema, Arena *arena)
+        : allocated_(false) {
+    assert((int)values.size() == schema->GetColumnCount());
+
+    int32_t tuple_size = schema->GetLength() + NullBitmapSize(schema);
+    for (auto &i : schema->GetUnlinedColumns()) {
+        if (!values[i].IsNull())
+            tuple_size += (values[i].GetLength() + sizeof(uint32_t));
+    }
+    size_ = tuple_size;
+    data_ = arena->Allocate(size_);
+
+    SerializeValues(values, schema);
+}
+
+Tuple Tuple::Clone(Arena *arena) const {
+    Tuple copy;
+    copy.rid_ = rid_;
+    copy.size_ = size_;
+    copy.data_ = arena->Allocate(size_);
+    memcpy(copy.data_, data_, size_);
+    copy.allocated_ = false; // the arena owns the bytes
+    return copy;
+}
+
+// A typed null Value leaves its payload bytes undefined, but raw-byte
+// key comparisons (hashed and normalized keys) need equal nulls to be
+// byte-identical, so the slot bytes are written canonically here
+void Tuple::SerializeNullSentinel(char *storage, TypeId type) {
+    switch (type) {
+        case TypeId::BOOLEAN:
+            *reinterpret_cast<int8_t *>(storage) = PELOTON_BOOLEAN_NULL;
+            break;
+        case TypeId::TINYINT:
+            *reinterpret_cast<int8_t *>(storage) = PELOTON_INT8_NULL;
+            break;
+        case TypeId::SMALLINT:
+            *reinterpret_cast<int16_t *>(storage) = PELOTON_INT16_NULL;
+            break;
+        case TypeId::INTEGER:
+            *reinterpret_cast<int32_t *>(storage) = PELOTON_INT32_NULL;
+            break;
+        case TypeId::BIGINT:
+            *reinterpret_cast<int64_t *>(storage) = PELOTON_INT64_NULL;
+            break;
+        case TypeId::DECIMAL:
+            *reinterpret_cast<double *>(storage) = PELOTON_DECIMAL_NULL;
+            break;
+        case TypeId::TIMESTAMP:
+            *reinterpret_cast<uint64_t *>(storage) = PELOTON_TIMESTAMP_NULL;
+            break;
+        default:
+            break;
+    }
+}
+
+void Tuple::SerializeValues(std::vector<Value> &values, Schema *schema) {
     int column_count = schema->GetColumnCount();
-    int32_t offset = schema->GetLength();
+    char *bitmap = data_ + schema->GetLength();
+    memset(bitmap, 0, NullBitmapSize(schema));
+    int32_t offset = schema->GetLength() + NullBitmapSize(schema);
     for (int i = 0; i < column_count; i++) {
+        if (values[i].IsNull())
+            bitmap[i / 8] = static_cast<char>(bitmap[i / 8] | (1 << (i % 8)));
         if (!schema->IsInlined(i)) {
             // Serialize relative offset, where the actual varchar data is stored
             *reinterpret_cast<int32_t *>(data_ + schema->GetOffset(i)) = offset;
+            // null varlen columns keep the offset slot but no payload;
+            // GetValue never chases the offset once the bit is set
+            if (values[i].IsNull())
+                continue;
             // Serialize varchar value, in place(size+data)
             values[i].SerializeTo(data_ + offset);
             offset += (values[i].GetLength() + sizeof(uint32_t));
+        } else if (values[i].IsNull()) {
+            SerializeNullSentinel(data_ + schema->GetOffset(i),
+                                  schema->GetType(i));
         } else {
             values[i].SerializeTo(data_ + schema->GetOffset(i));
         }
@@ -74,7 +151,16 @@ Value Tuple::GetValue(Schema *schema, const int column_id) const {
     assert(schema);
     assert(data_);
     const TypeId column_type = schema->GetType(column_id);
-    const char *data_ptr = GetDataPtr(schema, column_id);
+    // null short-circuits on the bitmap: a typed null comes back without
+    // deserializing sentinel bytes, and null varlen columns store no
+    // payload to chase
+    if (IsNull(schema, column_id))
+        return Value(column_type);
+    // fast path for all-inlined schemas: every column sits at its fixed
+    // precomputed offset, no per-column inlined check needed
+    const char *data_ptr = schema->IsInlined()
+                               ? data_ + schema->GetOffset(column_id)
+                               : GetDataPtr(schema, column_id);
     // the third parameter "is_inlined" is unused
     return Value::DeserializeFrom(data_ptr, column_type);
 }
@@ -0,0 +1,98 @@
+/**
+ * tuple_predicate.cpp
+ */
+
+#include <cassert>
+
+#include "table/tuple_predicate.h"
+
+namespace cmudb {
+
+TuplePredicate::TuplePredicate(int column_id, PredicateOp op,
+                               const Value &constant)
+    : column_id_(column_id), op_(op) {
+    // pre-serialize the constant so the batch loop compares raw bytes only;
+    // varchars serialize as | Length (4) | Bytes |
+    size_t size;
+    if (constant.GetTypeId() == TypeId::VARCHAR) {
+        size = constant.GetLength() + sizeof(uint32_t);
+    } else {
+        size = Type::GetTypeSize(constant.GetTypeId());
+    }
+    constant_buf_.resize(size);
+    constant.SerializeTo(constant_buf_.data());
+}
+
+TuplePredicate::TuplePredicate(std::vector<TuplePredicate> children)
+    : column_id_(-1), op_(PredicateOp::Equals),
+      children_(std::move(children)) {}
+
+size_t TuplePredicate::Evaluate(const std::vector<Tuple> &tuples,
+                                Schema *schema,
+                                std::vector<uint8_t> &selection) const {
+    selection.assign(tuples.size(), 1);
+    Apply(tuples, schema, selection);
+    size_t count = 0;
+    for (size_t i = 0; i < selection.size(); ++i) {
+        count += selection[i];
+    }
+    return count;
+}
+
+void TuplePredicate::Apply(const std::vector<Tuple> &tuples, Schema *schema,
+                           std::vector<uint8_t> &selection) const {
+    if (!children_.empty()) {
+        // conjunction: each child narrows the surviving rows further
+        for (auto &child : children_) {
+            child.Apply(tuples, schema, selection);
+        }
+        return;
+    }
+
+    // resolve the column layout and comparator once for the whole batch
+    const int32_t offset = schema->GetOffset(column_id_);
+    const bool inlined = schema->IsInlined(column_id_);
+    RawComparator cmp = GetRawComparator(schema->GetType(column_id_));
+    assert(cmp != nullptr);
+    const char *constant = constant_buf_.data();
+    const PredicateOp op = op_;
+
+    for (size_t i = 0; i < tuples.size(); ++i) {
+        if (!selection[i]) {
+            continue;
+        }
+        const char *data = tuples[i].GetData();
+        const char *field = data + offset;
+        if (!inlined) {
+            // non-inlined columns store a relative offset to the payload
+            int32_t rel;
+            memcpy(&rel, field, sizeof(int32_t));
+            field = data + rel;
+        }
+        int c = cmp(field, constant);
+        bool keep;
+        switch (op) {
+            case PredicateOp::Equals:
+                keep = c == 0;
+                break;
+            case PredicateOp::NotEquals:
+                keep = c != 0;
+                break;
+            case PredicateOp::LessThan:
+                keep = c < 0;
+                break;
+            case PredicateOp::LessThanEquals:
+                keep = c <= 0;
+                break;
+            case PredicateOp::GreaterThan:
+                keep = c > 0;
+                break;
+            case PredicateOp::GreaterThanEquals:
+                keep = c >= 0;
+                break;
+        }
+        selection[i] = keep ? 1 : 0;
+    }
+}
+
+} // namespace cmudb
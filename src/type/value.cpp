@@ -17,7 +17,10 @@ Value::Value(const Value &other) {
             if (size_.len == PELOTON_VALUE_NULL) {
                 value_.varlen = nullptr;
             } else {
-                if (manage_data_) {
+                if (IsInlinedVarlen()) {
+                    memcpy(sbo_buf_, other.value_.varlen, size_.len);
+                    value_.varlen = sbo_buf_;
+                } else if (manage_data_) {
                     value_.varlen = new char[size_.len];
                     memcpy(value_.varlen, other.value_.varlen, size_.len);
                 } else {
@@ -30,6 +33,23 @@ Value::Value(const Value &other) {
     }
 }
 
+Value::Value(Value &&other) noexcept {
+    type_id_ = other.type_id_;
+    size_ = other.size_;
+    manage_data_ = other.manage_data_;
+    value_ = other.value_;
+    if (IsInlinedVarlen()) {
+        // inlined bytes cannot be stolen, only copied
+        memcpy(sbo_buf_, other.sbo_buf_, size_.len);
+        value_.varlen = sbo_buf_;
+    } else if (type_id_ == TypeId::VARCHAR && manage_data_) {
+        // the heap buffer changed owner; disarm the source
+        other.manage_data_ = false;
+        other.value_.varlen = nullptr;
+        other.size_.len = PELOTON_VALUE_NULL;
+    }
+}
+
 Value &Value::operator=(Value other) {
     swap(*this, other);
     return *this;
@@ -238,9 +258,10 @@ Value::Value(TypeId type, const char *data, uint32_t len, bool manage_data)
                 manage_data_ = manage_data;
                 if (manage_data_) {
                     assert(len < PELOTON_VARCHAR_MAX_LEN);
-                    value_.varlen = new char[len];
-                    assert(value_.varlen != nullptr);
                     size_.len = len;
+                    // short strings live in the inline buffer, off the heap
+                    value_.varlen = len <= SBO_SIZE ? sbo_buf_ : new char[len];
+                    assert(value_.varlen != nullptr);
                     memcpy(value_.varlen, data, len);
                 } else {
                     // FUCK YOU GCC I do what I want.
@@ -261,9 +282,10 @@ Value::Value(TypeId type, const std::string &data) : Value(type) {
             manage_data_ = true;
             // TODO: How to represent a null string here?
             uint32_t len = data.length() + 1;
-            value_.varlen = new char[len];
-            assert(value_.varlen != nullptr);
             size_.len = len;
+            // short strings live in the inline buffer, off the heap
+            value_.varlen = len <= SBO_SIZE ? sbo_buf_ : new char[len];
+            assert(value_.varlen != nullptr);
             memcpy(value_.varlen, data.c_str(), len);
             break;
         }
@@ -277,7 +299,7 @@ Value::Value(TypeId type, const std::string &data) : Value(type) {
 Value::~Value() {
     switch (type_id_) {
         case TypeId::VARCHAR:
-            if (manage_data_) {
+            if (manage_data_ && !IsInlinedVarlen()) {
                 delete[] value_.varlen;
             }
             break;
@@ -4,6 +4,7 @@
 #include <algorithm>
 
 #include "common/exception.h"
+#include "type/type_kernels.h"
 #include "type/type_util.h"
 #include "type/varlen_type.h"
 
@@ -44,6 +45,14 @@ CmpBool VarlenType::CompareEquals(const Value &left, const Value &right) const {
         GetLength(right) == PELOTON_VARCHAR_MAX_LEN) {
         return GetCmpBool(GetLength(left) == GetLength(right));
     }
+    // length-first early exit: unequal lengths decide equality without
+    // touching a byte, equal lengths run the chunked kernel
+    if (right.GetTypeId() == TypeId::VARCHAR) {
+        if (GetLength(left) != GetLength(right))
+            return CMP_FALSE;
+        return GetCmpBool(EqualBytes(GetData(left), right.GetData(),
+                                     GetLength(left) - 1));
+    }
 
     VARLEN_COMPARE_FUNC(==);
 }
@@ -57,6 +66,12 @@ CmpBool VarlenType::CompareNotEquals(const Value &left,
         GetLength(right) == PELOTON_VARCHAR_MAX_LEN) {
         return GetCmpBool(GetLength(left) != GetLength(right));
     }
+    if (right.GetTypeId() == TypeId::VARCHAR) {
+        if (GetLength(left) != GetLength(right))
+            return CMP_TRUE;
+        return GetCmpBool(!EqualBytes(GetData(left), right.GetData(),
+                                      GetLength(left) - 1));
+    }
 
     VARLEN_COMPARE_FUNC(!=);
 }
@@ -20,14 +20,13 @@ SQLITE_EXTENSION_INIT1
 /* API implementation */
 int VtabCreate(sqlite3 *db, void *pAux, int argc, const char *const *argv,
                sqlite3_vtab **ppVtab, char **pzErr) {
+    // one engine reference per vtable instance, dropped in VtabDisconnect
+    StorageEngine::Acquire(storage_engine_->GetFileName());
     BufferPoolManager *buffer_pool_manager =
             storage_engine_->buffer_pool_manager_;
     LockManager *lock_manager = storage_engine_->lock_manager_;
     LogManager *log_manager = storage_engine_->log_manager_;
-
-    // fetch header page from buffer pool
-    HeaderPage *header_page =
-            static_cast<HeaderPage *>(buffer_pool_manager->FetchPage(HEADER_PAGE_ID));
+    Catalog *catalog = storage_engine_->catalog_;
 
     // the first three parameter:(1) module name (2) database name (3)table name
     assert(argc >= 4);
@@ -44,15 +43,22 @@ int VtabCreate(sqlite3 *db, void *pAux, int argc, const char *const *argv,
         // create index object, allocate memory space
         IndexMetadata *index_metadata =
                 ParseIndexStatement(index_string, std::string(argv[2]), schema);
-        index = ConstructIndex(index_metadata, buffer_pool_manager);
+        index = ConstructIndex(index_metadata, buffer_pool_manager,
+                               INVALID_PAGE_ID, catalog);
     }
-    // create table object, allocate memory space
-    VirtualTable *table = new VirtualTable(schema, buffer_pool_manager,
-                                           lock_manager, log_manager, index);
-
-    // insert table root page info into header page
-    header_page->InsertRecord(std::string(argv[2]), table->GetFirstPageId());
-    buffer_pool_manager->UnpinPage(HEADER_PAGE_ID, true);
+    // create table object, allocate memory space, tied to the
+    // connection's transaction context
+    VirtualTable *table = new VirtualTable(
+            schema, buffer_pool_manager, lock_manager, log_manager, index,
+            INVALID_PAGE_ID, INVALID_PAGE_ID, TransactionContext::Acquire(db));
+
+    // record the table root page in the catalog
+    catalog->InsertRecord(std::string(argv[2]), table->GetFirstPageId());
+    // the projection chain root rides in the catalog next to the
+    // table's, under the same suffix convention the index roots use
+    if (table->GetProjection() != nullptr)
+        catalog->InsertRecord(std::string(argv[2]) + "_proj",
+                              table->GetProjection()->GetFirstPageId());
 
     // register virtual table within sqlite system
     schema_string = "CREATE TABLE X(" + schema_string + ");";
@@ -71,39 +77,50 @@ int VtabConnect(sqlite3 *db, void *pAux, int argc, const char *const *argv,
     // new virtual table object, allocate memory space
     Schema *schema = ParseCreateStatement(schema_string);
 
+    // one engine reference per vtable instance, dropped in VtabDisconnect
+    StorageEngine::Acquire(storage_engine_->GetFileName());
     BufferPoolManager *buffer_pool_manager =
             storage_engine_->buffer_pool_manager_;
     LockManager *lock_manager = storage_engine_->lock_manager_;
     LogManager *log_manager = storage_engine_->log_manager_;
+    Catalog *catalog = storage_engine_->catalog_;
 
-    // Retrieve table root page info from header page
-    HeaderPage *header_page =
-            static_cast<HeaderPage *>(buffer_pool_manager->FetchPage(HEADER_PAGE_ID));
-    page_id_t table_root_id;
-    header_page->GetRootId(std::string(argv[2]), table_root_id);
+    // Retrieve table root page info from the catalog
+    page_id_t table_root_id = INVALID_PAGE_ID;
+    catalog->GetRootId(std::string(argv[2]), table_root_id);
     // parse arg[4](string that defines table index)
     Index *index = nullptr;
+    page_id_t index_root_id = INVALID_PAGE_ID;
     if (argc > 4) {
         std::string index_string(argv[4]);
         index_string = index_string.substr(1, (index_string.size() - 2));
         // create index object, allocate memory space
         IndexMetadata *index_metadata =
                 ParseIndexStatement(index_string, std::string(argv[2]), schema);
-        // Retrieve index root page info from header page
-        page_id_t index_root_id;
-        header_page->GetRootId(index_metadata->GetName(), index_root_id);
-        index = ConstructIndex(index_metadata, buffer_pool_manager, index_root_id);
+        // Retrieve index root page info from the catalog
+        catalog->GetRootId(index_metadata->GetName(), index_root_id);
+        index = ConstructIndex(index_metadata, buffer_pool_manager,
+                               index_root_id, catalog);
+    }
+    // Retrieve the projection chain root, if the table has one
+    page_id_t projection_root_id = INVALID_PAGE_ID;
+    catalog->GetRootId(std::string(argv[2]) + "_proj", projection_root_id);
+    VirtualTable *table = new VirtualTable(
+            schema, buffer_pool_manager, lock_manager, log_manager, index,
+            table_root_id, projection_root_id, TransactionContext::Acquire(db));
+
+    // an index declared after the table was populated has no root yet:
+    // backfill it with the parallel external-sort build
+    if (index != nullptr && index_root_id == INVALID_PAGE_ID &&
+        table_root_id != INVALID_PAGE_ID) {
+        table->BuildIndexFromTable();
     }
-    VirtualTable *table =
-            new VirtualTable(schema, buffer_pool_manager, lock_manager, log_manager,
-                             index, table_root_id);
 
     // register virtual table within sqlite system
     schema_string = "CREATE TABLE X(" + schema_string + ");";
     assert(sqlite3_declare_vtab(db, schema_string.c_str()) == SQLITE_OK);
 
     *ppVtab = reinterpret_cast<sqlite3_vtab *>(table);
-    buffer_pool_manager->UnpinPage(HEADER_PAGE_ID, false);
     return SQLITE_OK;
 }
 
@@ -111,19 +128,214 @@ int VtabConnect(sqlite3 *db, void *pAux, int argc, const char *const *argv,
  * we only support
  * (1) equlity check. e.g select * from foo where a = 1
  * (2) indexed column == predicated column
+ *
+ * Costs come from the table statistics maintained on the write path: a
+ * sequential scan reads every row once, an index probe pays a B+ tree
+ * descent plus one random rowid lookup per matching row. The index is only
+ * offered as cheap when the probe actually wins, so low-selectivity keys
+ * no longer push sqlite into an index probe over most of the table.
  */
 int VtabBestIndex(sqlite3_vtab *tab, sqlite3_index_info *pIdxInfo) {
     // LOG_DEBUG("VtabBestIndex");
+    // random rowid lookups cost a page fetch each; sequential rows do not
+    static const double RANDOM_LOOKUP_PENALTY = 10.0;
+
     VirtualTable *table = reinterpret_cast<VirtualTable *>(tab);
-    if (table->GetIndex() == nullptr)
+    // a zero count means no write has updated the stats yet (e.g. right
+    // after a reconnect); fall back to sqlite's usual big-table guess so a
+    // unique-key probe keeps winning like it always has
+    const size_t counted_rows = table->GetStats().GetRowCount();
+    const bool stats_known = counted_rows > 0;
+    const double row_count = stats_known ? counted_rows : 1e6;
+
+    // default plan: full sequential scan
+    pIdxInfo->estimatedCost = row_count;
+    pIdxInfo->estimatedRows = (sqlite3_int64)row_count;
+
+    // an index mid-backfill is not offered: it answers nothing reliably
+    // until the online build has applied its captured delta
+    if (table->GetIndex() == nullptr || !table->IsIndexReady())
         return SQLITE_OK;
     const std::vector<int> key_attrs = table->GetIndex()->GetKeyAttrs();
+
+    // ordered and covering scans over the whole index (idxNum 3 ascending,
+    // 4 descending), considered only when no usable constraint touches a
+    // key column — those shapes belong to the point and range plans below.
+    // When every ORDER BY term is the next key column under one common
+    // direction, the leaf chain serves rows pre-sorted and sqlite drops
+    // its sorter; its MIN/MAX rewrite then reads a single row, so MIN(key)
+    // and MAX(key) cost one descent instead of a heap scan. Without ORDER
+    // BY the same walk is offered as a covering scan when the statement
+    // reads indexed columns only (COUNT(*) reads none), trading the heap
+    // pages for the narrower leaf chain
+    if (table->GetIndex()->GetMetadata()->GetIndexType() ==
+        IndexType::BPlusTree) {
+        bool key_constrained = false;
+        for (int i = 0; i < pIdxInfo->nConstraint; i++) {
+            if (pIdxInfo->aConstraint[i].usable != 0 &&
+                std::find(key_attrs.begin(), key_attrs.end(),
+                          pIdxInfo->aConstraint[i].iColumn) != key_attrs.end())
+                key_constrained = true;
+        }
+        if (!key_constrained && pIdxInfo->nOrderBy > 0 &&
+            pIdxInfo->nOrderBy <= (int)key_attrs.size()) {
+            bool order_served = true;
+            const unsigned char desc = pIdxInfo->aOrderBy[0].desc;
+            for (int i = 0; i < pIdxInfo->nOrderBy; i++) {
+                if (pIdxInfo->aOrderBy[i].iColumn != key_attrs[i] ||
+                    pIdxInfo->aOrderBy[i].desc != desc)
+                    order_served = false;
+            }
+            if (order_served) {
+                pIdxInfo->idxNum = desc ? 4 : 3;
+                pIdxInfo->orderByConsumed = 1;
+                // same rows as the scan, minus the sort sqlite would add
+                pIdxInfo->estimatedCost = row_count;
+                pIdxInfo->estimatedRows = (sqlite3_int64)row_count;
+                return SQLITE_OK;
+            }
+        }
+        if (!key_constrained && pIdxInfo->nOrderBy == 0) {
+            sqlite3_uint64 key_mask = 0;
+            bool maskable = true;
+            for (int attr : key_attrs) {
+                if (attr >= 63)
+                    maskable = false;
+                else
+                    key_mask |= ((sqlite3_uint64)1) << attr;
+            }
+            if (maskable && (pIdxInfo->colUsed & ~key_mask) == 0) {
+                pIdxInfo->idxNum = 3;
+                pIdxInfo->estimatedCost = std::max(row_count / 4.0, 1.0);
+                pIdxInfo->estimatedRows = (sqlite3_int64)row_count;
+                return SQLITE_OK;
+            }
+        }
+    }
+
+    // range plan: an ordered index serves any constraint set of the form
+    // "equality on a prefix of the key columns, optionally </<=/>/>= on the
+    // next one" as an index range scan (idxNum 2). VtabFilter rebuilds the
+    // bounds from idxStr, one character per argv slot: 'E' for each prefix
+    // equality value, then 'g'/'G' (lower) and 'l'/'L' (upper)
+    if (table->GetIndex()->GetMetadata()->GetIndexType() ==
+        IndexType::BPlusTree) {
+        Schema *key_schema = table->GetIndex()->GetKeySchema();
+        const int key_count = (int)key_attrs.size();
+
+        // longest run of leading key columns with a usable equality
+        std::vector<int> eq_constraints;
+        while ((int)eq_constraints.size() < key_count) {
+            int found = -1;
+            for (int i = 0; i < pIdxInfo->nConstraint; i++) {
+                if (pIdxInfo->aConstraint[i].usable != 0 &&
+                    pIdxInfo->aConstraint[i].iColumn ==
+                            key_attrs[eq_constraints.size()] &&
+                    pIdxInfo->aConstraint[i].op == SQLITE_INDEX_CONSTRAINT_EQ) {
+                    found = i;
+                    break;
+                }
+            }
+            if (found < 0)
+                break;
+            eq_constraints.push_back(found);
+        }
+        const int prefix_len = (int)eq_constraints.size();
+
+        // equality on every key column is the point plan's job, below
+        if (prefix_len < key_count) {
+            int lower = -1; // constraint index of the lower bound
+            int upper = -1; // constraint index of the upper bound
+            for (int i = 0; i < pIdxInfo->nConstraint; i++) {
+                if (pIdxInfo->aConstraint[i].usable == 0 ||
+                    pIdxInfo->aConstraint[i].iColumn != key_attrs[prefix_len])
+                    continue;
+                switch (pIdxInfo->aConstraint[i].op) {
+                    case SQLITE_INDEX_CONSTRAINT_GT:
+                    case SQLITE_INDEX_CONSTRAINT_GE:
+                        lower = i;
+                        break;
+                    case SQLITE_INDEX_CONSTRAINT_LT:
+                    case SQLITE_INDEX_CONSTRAINT_LE:
+                        upper = i;
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            // key columns past the bound are padded with their type's
+            // min/max to turn the prefix into full-key bounds; the varchar
+            // max sentinel cannot be serialized into a tuple, so a plan
+            // that would need it is not offered
+            bool paddable = true;
+            for (int col = prefix_len + 1; col < key_count; col++) {
+                if (key_schema->GetType(col) == TypeId::VARCHAR)
+                    paddable = false;
+            }
+            if (upper < 0 && prefix_len > 0 &&
+                key_schema->GetType(prefix_len) == TypeId::VARCHAR)
+                paddable = false;
+
+            if (paddable && (prefix_len > 0 || lower >= 0 || upper >= 0)) {
+                // each equality column is assumed to carve the table down
+                // uniformly; a one-sided range then reads more of the
+                // remainder than a closed one
+                const double distinct =
+                        std::max<size_t>(table->GetStats().GetDistinctKeys(), 1);
+                double matching_rows = row_count;
+                if (prefix_len > 0)
+                    matching_rows /=
+                            std::pow(distinct, (double)prefix_len / key_count);
+                const double fraction = (lower >= 0 && upper >= 0)
+                                                ? 9.0
+                                                : (lower >= 0 || upper >= 0)
+                                                          ? 3.0
+                                                          : 1.0;
+                matching_rows = std::max(matching_rows / fraction, 1.0);
+                const double probe_cost = std::log2(row_count + 1) +
+                                          matching_rows * RANDOM_LOOKUP_PENALTY;
+                if (probe_cost < row_count) {
+                    std::string ops;
+                    int argv_index = 0;
+                    for (int i = 0; i < prefix_len; i++) {
+                        pIdxInfo->aConstraintUsage[eq_constraints[i]].argvIndex =
+                                ++argv_index;
+                        ops.push_back('E');
+                    }
+                    if (lower >= 0) {
+                        pIdxInfo->aConstraintUsage[lower].argvIndex =
+                                ++argv_index;
+                        ops.push_back(pIdxInfo->aConstraint[lower].op ==
+                                                      SQLITE_INDEX_CONSTRAINT_GE
+                                              ? 'G'
+                                              : 'g');
+                    }
+                    if (upper >= 0) {
+                        pIdxInfo->aConstraintUsage[upper].argvIndex =
+                                ++argv_index;
+                        ops.push_back(pIdxInfo->aConstraint[upper].op ==
+                                                      SQLITE_INDEX_CONSTRAINT_LE
+                                              ? 'L'
+                                              : 'l');
+                    }
+                    pIdxInfo->idxNum = 2;
+                    pIdxInfo->idxStr = sqlite3_mprintf("%s", ops.c_str());
+                    pIdxInfo->needToFreeIdxStr = 1;
+                    pIdxInfo->estimatedCost = probe_cost;
+                    pIdxInfo->estimatedRows = (sqlite3_int64)matching_rows;
+                }
+                return SQLITE_OK;
+            }
+        }
+    }
+
     // make sure indexed column == predicate column
     // e.g select * from foo where a = 1 and b =2; indexed column must be {a,b}
     if (pIdxInfo->nConstraint != (int)(key_attrs.size()))
         return SQLITE_OK;
 
-    int counter = 0;
+    std::vector<int> matched;
     bool is_index_scan = true;
     for (int i = 0; i < pIdxInfo->nConstraint; i++) {
         if (pIdxInfo->aConstraint[i].usable == 0)
@@ -137,32 +349,80 @@ int VtabBestIndex(sqlite3_vtab *tab, sqlite3_index_info *pIdxInfo) {
                 is_index_scan = false;
                 break;
             }
-            pIdxInfo->aConstraintUsage[i].argvIndex = (i + 1);
-            counter++;
+            matched.push_back(i);
         }
     }
 
-    if (counter == (int)key_attrs.size() && is_index_scan) {
-        pIdxInfo->idxNum = 1;
+    if (matched.size() == key_attrs.size() && is_index_scan) {
+        // rows per key from the distinct-key estimate; a never-written
+        // table has no estimate yet, assume a unique key
+        const double distinct =
+                std::max<size_t>(table->GetStats().GetDistinctKeys(), 1);
+        const double matching_rows =
+                stats_known ? std::max(row_count / distinct, 1.0) : 1.0;
+        const double probe_cost =
+                std::log2(row_count + 1) + matching_rows * RANDOM_LOOKUP_PENALTY;
+
+        // only claim the constraints when the probe actually beats the scan,
+        // otherwise sqlite would be committed to passing the key values
+        if (probe_cost < row_count) {
+            for (size_t i = 0; i < matched.size(); ++i) {
+                pIdxInfo->aConstraintUsage[matched[i]].argvIndex = (int)(i + 1);
+            }
+            pIdxInfo->idxNum = 1;
+            pIdxInfo->estimatedCost = probe_cost;
+            pIdxInfo->estimatedRows = (sqlite3_int64)matching_rows;
+        }
     }
     return SQLITE_OK;
 }
 
 int VtabDisconnect(sqlite3_vtab *pVtab) {
     VirtualTable *virtual_table = reinterpret_cast<VirtualTable *>(pVtab);
+    TransactionContext *txn_context = virtual_table->GetTxnContext();
+    // the table flushes pending index writes on destruction, so the
+    // context must outlive it
     delete virtual_table;
-    // delete all the global managers
-    delete storage_engine_;
+    TransactionContext::Release(txn_context);
+    // the engine outlives the connection so the next one reconnects warm,
+    // this only drops the table's reference (flushing once it was the last)
+    StorageEngine::Release(storage_engine_);
     return SQLITE_OK;
 }
 
+// commit the context's active transaction and clear it; harmless when
+// no transaction is active
+static void CommitActive(TransactionContext *context) {
+    Transaction *transaction = context->Active();
+    if (transaction == nullptr)
+        return;
+    auto transaction_manager = storage_engine_->transaction_manager_;
+    transaction_manager->Commit(transaction);
+    transaction_manager->Recycle(transaction);
+    context->SetActive(nullptr);
+}
+
+// abort counterpart of CommitActive
+static void AbortActive(TransactionContext *context) {
+    Transaction *transaction = context->Active();
+    if (transaction == nullptr)
+        return;
+    auto transaction_manager = storage_engine_->transaction_manager_;
+    transaction_manager->Abort(transaction);
+    transaction_manager->Recycle(transaction);
+    context->SetActive(nullptr);
+}
+
 int VtabOpen(sqlite3_vtab *pVtab, sqlite3_vtab_cursor **ppCursor) {
     // LOG_DEBUG("VtabOpen");
-    // if read operation, begin transaction here
-    if (global_transaction_ == nullptr) {
-        VtabBegin(pVtab);
-    }
     VirtualTable *virtual_table = reinterpret_cast<VirtualTable *>(pVtab);
+    // if read operation, begin transaction here; sqlite calls xBegin
+    // before any write, so a transaction started from a cursor open is a
+    // pure read and can skip the lock manager entirely
+    TransactionContext *context = virtual_table->GetTxnContext();
+    if (context->Active() == nullptr) {
+        context->SetActive(storage_engine_->transaction_manager_->Begin(true));
+    }
     Cursor *cursor = new Cursor(virtual_table);
     *ppCursor = reinterpret_cast<sqlite3_vtab_cursor *>(cursor);
 
@@ -172,8 +432,14 @@ int VtabOpen(sqlite3_vtab *pVtab, sqlite3_vtab_cursor **ppCursor) {
 int VtabClose(sqlite3_vtab_cursor *cur) {
     // LOG_DEBUG("VtabClose");
     Cursor *cursor = reinterpret_cast<Cursor *>(cur);
-    // if read operation, commit transaction here
-    VtabCommit(nullptr);
+    // a pure-read statement leaves its read-only transaction behind, finish
+    // it now; a write transaction must survive cursor close (a DELETE probe
+    // closes its scan cursor mid-statement) and ends at xCommit/xRollback
+    TransactionContext *context =
+            cursor->GetVirtualTable()->GetTxnContext();
+    if (context->Active() != nullptr && context->Active()->IsReadOnly()) {
+        CommitActive(context);
+    }
     delete cursor;
     return SQLITE_OK;
 }
@@ -196,6 +462,88 @@ int VtabFilter(sqlite3_vtab_cursor *pVtabCursor, int idxNum, const char *idxStr,
         key_schema = cursor->GetKeySchema();
         Tuple scan_tuple = ConstructTuple(key_schema, argv);
         cursor->ScanKey(scan_tuple);
+    } else if (idxNum == 2) {
+        // index range scan: idxStr holds one op character per argv slot,
+        // written by VtabBestIndex ('E' equality value for the next prefix
+        // column, 'g'/'G' lower bound, 'l'/'L' upper bound)
+        key_schema = cursor->GetKeySchema();
+        const int column_count = key_schema->GetColumnCount();
+        std::vector<Value> prefix;
+        Value low_bound(TypeId::INVALID);
+        Value high_bound(TypeId::INVALID);
+        bool has_low = false;
+        bool has_high = false;
+        bool low_inclusive = true;
+        bool high_inclusive = true;
+        for (int i = 0; i < argc; i++) {
+            switch (idxStr[i]) {
+                case 'E':
+                    prefix.push_back(ConstructValue(
+                            key_schema->GetType((int)prefix.size()), argv[i]));
+                    break;
+                case 'g':
+                case 'G':
+                    low_bound = ConstructValue(
+                            key_schema->GetType((int)prefix.size()), argv[i]);
+                    has_low = true;
+                    low_inclusive = idxStr[i] == 'G';
+                    break;
+                case 'l':
+                case 'L':
+                    high_bound = ConstructValue(
+                            key_schema->GetType((int)prefix.size()), argv[i]);
+                    has_high = true;
+                    high_inclusive = idxStr[i] == 'L';
+                    break;
+                default:
+                    break;
+            }
+        }
+        // turn the prefix into full-key bounds by padding the remaining
+        // columns with their type's extremes. An exclusive bound pads
+        // toward its own side (max below a '>', min below a '<') so that
+        // every key sharing the bound column's value is excluded; a side
+        // with neither prefix nor bound stays open
+        std::vector<Value> low_values = prefix;
+        std::vector<Value> high_values = prefix;
+        if (has_low)
+            low_values.push_back(low_bound);
+        if (has_high)
+            high_values.push_back(high_bound);
+        while ((int)low_values.size() < column_count) {
+            TypeId type = key_schema->GetType((int)low_values.size());
+            low_values.push_back(has_low && !low_inclusive
+                                         ? Type::GetMaxValue(type)
+                                         : Type::GetMinValue(type));
+        }
+        while ((int)high_values.size() < column_count) {
+            TypeId type = key_schema->GetType((int)high_values.size());
+            high_values.push_back(has_high && !high_inclusive
+                                          ? Type::GetMinValue(type)
+                                          : Type::GetMaxValue(type));
+        }
+        Tuple low;
+        Tuple high;
+        const Tuple *low_ptr = nullptr;
+        const Tuple *high_ptr = nullptr;
+        if (has_low || !prefix.empty()) {
+            low = Tuple(low_values, key_schema);
+            low_ptr = &low;
+        }
+        if (has_high || !prefix.empty()) {
+            high = Tuple(high_values, key_schema);
+            high_ptr = &high;
+        }
+        if (cursor->ScanRange(low_ptr, high_ptr, low_inclusive, high_inclusive))
+            cursor->SetScanFlag(true);
+        // an index that cannot scan ranges leaves the cursor in sequential
+        // mode and sqlite re-checks the constraints itself
+    } else if (idxNum == 3 || idxNum == 4) {
+        // ordered/covering whole-index walk, descending for idxNum 4; rows
+        // stream out of the leaf chain lazily, so a MIN/MAX consumer that
+        // stops after the first row pays one descent
+        if (cursor->ScanOrdered(idxNum == 4))
+            cursor->SetScanFlag(true);
     }
     return SQLITE_OK;
 }
@@ -270,19 +618,18 @@ int VtabUpdate(sqlite3_vtab *pVTab, int argc, sqlite3_value **argv,
         // following. If argv[1] is an SQL NULL, the a new unique rowid is generated
         // automatically.
     else if (argc > 1 && sqlite3_value_type(argv[0]) == SQLITE_NULL) {
-        Schema *schema = table->GetSchema();
-        Tuple tuple = ConstructTuple(schema, (argv + 2));
+        // row builder serializes straight into the table's scratch
+        // buffer: no Value vector, no per-row tuple allocation
+        Tuple tuple = table->GetRowBuilder().Build(argv + 2);
         // insert into table heap
         RID rid;
         table->InsertTuple(tuple, rid);
-        // insert into index
         table->InsertEntry(tuple, rid);
     }
         // The row with rowid argv[0] is updated with new values in argv[2] and
         // following parameters.
     else if (argc > 1 && sqlite3_value_type(argv[0]) != SQLITE_NULL) {
-        Schema *schema = table->GetSchema();
-        Tuple tuple = ConstructTuple(schema, (argv + 2));
+        Tuple tuple = table->GetRowBuilder().Build(argv + 2);
         RID rid(sqlite3_value_int64(argv[0]));
         // for update, index always delete and insert
         // because you have no clue key has been updated or not
@@ -301,24 +648,43 @@ int VtabUpdate(sqlite3_vtab *pVTab, int argc, sqlite3_value **argv,
 
 int VtabBegin(sqlite3_vtab *pVTab) {
     // LOG_DEBUG("VtabBegin");
-    // create new transaction(write operation will call this method)
-    global_transaction_ = storage_engine_->transaction_manager_->Begin();
+    TransactionContext *context =
+            reinterpret_cast<VirtualTable *>(pVTab)->GetTxnContext();
+    // a lingering read-only transaction holds nothing, finish it before
+    // starting the write transaction
+    if (context->Active() != nullptr && context->Active()->IsReadOnly()) {
+        CommitActive(context);
+    }
+    // sqlite calls xBegin once per vtab in the statement; the second
+    // table of a multi-table transaction joins the one already running
+    if (context->Active() == nullptr) {
+        context->SetActive(storage_engine_->transaction_manager_->Begin());
+    }
     return SQLITE_OK;
 }
 
 int VtabCommit(sqlite3_vtab *pVTab) {
     // LOG_DEBUG("VtabCommit");
-    auto transaction = GetTransaction();
-    if (transaction == nullptr)
-        return SQLITE_OK;
-    // get global txn manager
-    auto transaction_manager = storage_engine_->transaction_manager_;
-    // invoke transaction manager to commit(this txn can't fail)
-    transaction_manager->Commit(transaction);
-    // when commit, delete transaction pointer and set to null
-    delete transaction;
-    global_transaction_ = nullptr;
+    // apply the transaction's deferred index writes before the commit
+    // point, each insert run sorted into one batch
+    VirtualTable *table = reinterpret_cast<VirtualTable *>(pVTab);
+    table->FlushIndexEntries();
+    table->RetireProjectionWrites();
+    // the first vtab of a multi-table transaction commits it; the rest
+    // find the context already clear
+    CommitActive(table->GetTxnContext());
+    return SQLITE_OK;
+}
 
+int VtabRollback(sqlite3_vtab *pVTab) {
+    // LOG_DEBUG("VtabRollback");
+    // the deferred index writes were never applied, so an abort just
+    // drops them; projection writes applied synchronously and are
+    // replayed in reverse
+    VirtualTable *table = reinterpret_cast<VirtualTable *>(pVTab);
+    table->DiscardIndexEntries();
+    table->RollbackProjectionWrites();
+    AbortActive(table->GetTxnContext());
     return SQLITE_OK;
 }
 
@@ -340,7 +706,7 @@ sqlite3_module VtableModule = {
         VtabBegin,      /* xBegin */
         0,              /* xSync */
         VtabCommit,     /* xCommit */
-        0,              /* xRollback */
+        VtabRollback,   /* xRollback */
         0,              /* xFindMethod */
         0,              /* xRename */
         0,              /* xSavepoint */
@@ -358,18 +724,28 @@ extern "C" int sqlite3_vtable_init(sqlite3 *db, char **pzErrMsg,
     struct stat buffer;
     bool is_file_exist = (stat(db_file_name.c_str(), &buffer) == 0);
 
-    // init storage engine
-    storage_engine_ = new StorageEngine(db_file_name);
+    // a missing file means any cached engine is stale (the file was removed
+    // since the last connection), throw it away before reconnecting
+    if (!is_file_exist) {
+        StorageEngine::Evict(db_file_name);
+    }
+    // fetch the shared storage engine for this file (built on first use,
+    // reused warm by every later connection)
+    storage_engine_ = StorageEngine::Acquire(db_file_name);
     // start the logging
     storage_engine_->log_manager_->RunFlushThread();
     // create header page from BufferPoolManager if necessary
     if (!is_file_exist) {
         page_id_t header_page_id;
-        storage_engine_->buffer_pool_manager_->NewPage(header_page_id);
+        auto header_page = static_cast<HeaderPage *>(
+                storage_engine_->buffer_pool_manager_->NewPage(header_page_id));
 
         assert(header_page_id == HEADER_PAGE_ID);
+        header_page->Init();
         storage_engine_->buffer_pool_manager_->UnpinPage(header_page_id, true);
     }
+    // the module init reference is transient, tables hold their own
+    StorageEngine::Release(storage_engine_);
 
     int rc = sqlite3_create_module(db, "vtable", &VtableModule, nullptr);
     return rc;
@@ -462,42 +838,122 @@ IndexMetadata *ParseIndexStatement(std::string &sql,
     if ((int)key_attrs.size() > schema->GetColumnCount())
         throw Exception(EXCEPTION_TYPE_INDEX, "can't create index, format error");
 
-    IndexMetadata *metadata =
-            new IndexMetadata(index_name, table_name, schema, key_attrs);
+    // an index named with a "hash_" prefix selects the hash access method
+    // (point lookups only), everything else stays on the B+ tree
+    IndexType index_type = index_name.compare(0, 5, "hash_") == 0
+                                   ? IndexType::Hash
+                                   : IndexType::BPlusTree;
+
+    IndexMetadata *metadata = new IndexMetadata(index_name, table_name, schema,
+                                                key_attrs, index_type);
 
     // LOG_DEBUG("%s", metadata->ToString().c_str());
     return metadata;
 }
 
-Tuple ConstructTuple(Schema *schema, sqlite3_value **argv) {
-    int column_count = schema->GetColumnCount();
-    Value v(TypeId::INVALID);
-    std::vector<Value> values;
-    // iterate through schema, generate column value to insert
-    for (int i = 0; i < column_count; i++) {
-        TypeId type = schema->GetType(i);
+// build a single column value of "type" from a sqlite argument
+Value ConstructValue(TypeId type, sqlite3_value *arg) {
+    switch (type) {
+        case TypeId::BOOLEAN:
+        case TypeId::INTEGER:
+        case TypeId::SMALLINT:
+        case TypeId::TINYINT:
+            return Value(type, (int32_t)sqlite3_value_int(arg));
+        case TypeId::BIGINT:
+            return Value(type, (int64_t)sqlite3_value_int64(arg));
+        case TypeId::DECIMAL:
+            return Value(type, sqlite3_value_double(arg));
+        case TypeId::VARCHAR:
+            return Value(type, std::string(reinterpret_cast<const char *>(
+                                       sqlite3_value_text(arg))));
+        default:
+            return Value(TypeId::INVALID);
+    }
+}
 
-        switch (type) {
+Tuple RowBuilder::Build(sqlite3_value **argv) {
+    const int column_count = schema_->GetColumnCount();
+    const int32_t bitmap_bytes = (column_count + 7) / 8;
+    // size the row exactly: fixed section, null bitmap, then each
+    // non-null varchar at its actual length (content plus terminator
+    // plus the length prefix). sqlite3_value_text runs first so the
+    // byte count reflects the text form of non-text arguments
+    int32_t size = schema_->GetLength() + bitmap_bytes;
+    for (auto column_id : schema_->GetUnlinedColumns()) {
+        if (sqlite3_value_type(argv[column_id]) == SQLITE_NULL)
+            continue;
+        sqlite3_value_text(argv[column_id]);
+        size += sqlite3_value_bytes(argv[column_id]) + 1 + sizeof(uint32_t);
+    }
+    // grows to the steady-state row size once, then gets reused
+    if ((int32_t)buffer_.size() < size)
+        buffer_.resize(size);
+
+    char *data = buffer_.data();
+    char *bitmap = data + schema_->GetLength();
+    memset(bitmap, 0, bitmap_bytes);
+    int32_t offset = schema_->GetLength() + bitmap_bytes;
+    for (int i = 0; i < column_count; i++) {
+        char *slot = data + schema_->GetOffset(i);
+        if (sqlite3_value_type(argv[i]) == SQLITE_NULL) {
+            bitmap[i / 8] = static_cast<char>(bitmap[i / 8] | (1 << (i % 8)));
+            if (schema_->IsInlined(i))
+                Tuple::SerializeNullSentinel(slot, schema_->GetType(i));
+            else // the offset slot stays, no payload follows it
+                *reinterpret_cast<int32_t *>(slot) = offset;
+            continue;
+        }
+        switch (schema_->GetType(i)) {
             case TypeId::BOOLEAN:
-            case TypeId::INTEGER:
-            case TypeId::SMALLINT:
             case TypeId::TINYINT:
-                v = Value(type, (int32_t)sqlite3_value_int(argv[i]));
+                *reinterpret_cast<int8_t *>(slot) =
+                        (int8_t)sqlite3_value_int(argv[i]);
+                break;
+            case TypeId::SMALLINT:
+                *reinterpret_cast<int16_t *>(slot) =
+                        (int16_t)sqlite3_value_int(argv[i]);
+                break;
+            case TypeId::INTEGER:
+                *reinterpret_cast<int32_t *>(slot) =
+                        (int32_t)sqlite3_value_int(argv[i]);
                 break;
             case TypeId::BIGINT:
-                v = Value(type, (int64_t)sqlite3_value_int64(argv[i]));
+                *reinterpret_cast<int64_t *>(slot) =
+                        (int64_t)sqlite3_value_int64(argv[i]);
                 break;
             case TypeId::DECIMAL:
-                v = Value(type, sqlite3_value_double(argv[i]));
+                *reinterpret_cast<double *>(slot) = sqlite3_value_double(argv[i]);
                 break;
-            case TypeId::VARCHAR:
-                v = Value(type, std::string(reinterpret_cast<const char *>(
-                                                    sqlite3_value_text(argv[i]))));
+            case TypeId::VARCHAR: {
+                // | Length (4) | Bytes | with the terminator counted in
+                // the length, matching Value::SerializeTo
+                uint32_t len = (uint32_t)sqlite3_value_bytes(argv[i]) + 1;
+                *reinterpret_cast<int32_t *>(slot) = offset;
+                memcpy(data + offset, &len, sizeof(uint32_t));
+                memcpy(data + offset + sizeof(uint32_t),
+                       sqlite3_value_text(argv[i]), len - 1);
+                data[offset + sizeof(uint32_t) + len - 1] = '\0';
+                offset += len + sizeof(uint32_t);
                 break;
+            }
             default:
                 break;
-        } // End of switch
-        values.emplace_back(v);
+        }
+    }
+
+    Tuple tuple;
+    tuple.size_ = size;
+    tuple.data_ = data;
+    tuple.allocated_ = false; // the scratch buffer owns the bytes
+    return tuple;
+}
+
+Tuple ConstructTuple(Schema *schema, sqlite3_value **argv) {
+    int column_count = schema->GetColumnCount();
+    std::vector<Value> values;
+    // iterate through schema, generate column value to insert
+    for (int i = 0; i < column_count; i++) {
+        values.emplace_back(ConstructValue(schema->GetType(i), argv[i]));
     }
     Tuple tuple(values, schema);
 
@@ -507,31 +963,57 @@ Tuple ConstructTuple(Schema *schema, sqlite3_value **argv) {
 // serve the functionality of index factory
 Index *ConstructIndex(IndexMetadata *metadata,
                       BufferPoolManager *buffer_pool_manager,
-                      page_id_t root_id) {
+                      page_id_t root_id, Catalog *catalog) {
     // The size of the key in bytes
     Schema *key_schema = metadata->GetKeySchema();
     int key_size = key_schema->GetLength();
-    // for each varchar attribute, we assume the largest size is 16 bytes
-    key_size += 16 * key_schema->GetUnlinedColumnCount();
+    // size each varchar attribute from its declared maximum (plus the
+    // length prefix it is serialized with) instead of assuming a blanket
+    // 16 bytes, so short varchar keys land in a tighter size class and
+    // B+ tree fan-out matches the actual key size
+    for (auto column_id : key_schema->GetUnlinedColumns()) {
+        key_size += key_schema->GetVariableLength(column_id) + sizeof(uint32_t);
+    }
+    // key tuples carry the per-tuple null bitmap between the fixed
+    // section and the varlen payloads; size it in so payload bytes are
+    // never clamped off by the key size class
+    key_size += (key_schema->GetColumnCount() + 7) / 8;
+
+    if (metadata->GetIndexType() == IndexType::Hash) {
+        if (key_size <= 4) {
+            return new HashTableIndex<GenericKey<4>, RID, GenericComparator<4>>(
+                    metadata, buffer_pool_manager, root_id, catalog);
+        } else if (key_size <= 8) {
+            return new HashTableIndex<GenericKey<8>, RID, GenericComparator<8>>(
+                    metadata, buffer_pool_manager, root_id, catalog);
+        } else if (key_size <= 16) {
+            return new HashTableIndex<GenericKey<16>, RID, GenericComparator<16>>(
+                    metadata, buffer_pool_manager, root_id, catalog);
+        } else if (key_size <= 32) {
+            return new HashTableIndex<GenericKey<32>, RID, GenericComparator<32>>(
+                    metadata, buffer_pool_manager, root_id, catalog);
+        } else {
+            return new HashTableIndex<GenericKey<64>, RID, GenericComparator<64>>(
+                    metadata, buffer_pool_manager, root_id, catalog);
+        }
+    }
 
     if (key_size <= 4) {
         return new BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>(
-                metadata, buffer_pool_manager, root_id);
+                metadata, buffer_pool_manager, root_id, catalog);
     } else if (key_size <= 8) {
         return new BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>(
-                metadata, buffer_pool_manager, root_id);
+                metadata, buffer_pool_manager, root_id, catalog);
     } else if (key_size <= 16) {
         return new BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>(
-                metadata, buffer_pool_manager, root_id);
+                metadata, buffer_pool_manager, root_id, catalog);
     } else if (key_size <= 32) {
         return new BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>(
-                metadata, buffer_pool_manager, root_id);
+                metadata, buffer_pool_manager, root_id, catalog);
     } else {
         return new BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>(
-                metadata, buffer_pool_manager, root_id);
+                metadata, buffer_pool_manager, root_id, catalog);
     }
 }
 
-Transaction *GetTransaction() { return global_transaction_; }
-
 } // namespace cmudb
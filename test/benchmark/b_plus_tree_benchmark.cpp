@@ -0,0 +1,91 @@
+/**
+ * b_plus_tree_benchmark.cpp
+ *
+ * Microbenchmarks for BPlusTree::GetValue: point lookup cost as the tree
+ * deepens (trees of increasing size, pool large enough that lookups never
+ * hit disk) and lookups under reader concurrency on the largest tree.
+ *
+ *   ./b_plus_tree_benchmark [--ops N] [--threads N]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark_util.h"
+#include "buffer/buffer_pool_manager.h"
+#include "index/b_plus_tree.h"
+#include "vtable/virtual_table.h"
+
+namespace cmudb {
+
+using BenchTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+void BenchGetValue(int num_keys, int num_ops, int num_threads) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("bench.db");
+  BufferPoolManager *bpm = new BufferPoolManager(10000, disk_manager);
+  page_id_t header_page_id;
+  bpm->NewPage(header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+
+  BenchTree tree("bench_pk", bpm, comparator);
+  Transaction *transaction = new Transaction(0);
+  GenericKey<8> index_key;
+  RID rid;
+  for (int64_t key = 0; key < num_keys; key++) {
+    rid.Set(static_cast<int32_t>(key >> 32), static_cast<int>(key));
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+
+  double secs = RunThreads(num_threads, [&](int thread_id) {
+    std::default_random_engine engine(42 + thread_id);
+    std::uniform_int_distribution<int64_t> dist(0, num_keys - 1);
+    GenericKey<8> lookup_key;
+    std::vector<RID> result;
+    for (int i = 0; i < num_ops; i++) {
+      lookup_key.SetFromInteger(dist(engine));
+      result.clear();
+      tree.GetValue(lookup_key, result);
+    }
+  });
+  char name[64];
+  std::snprintf(name, sizeof(name), "BPlusTree/GetValue/%dk", num_keys / 1000);
+  ReportThroughput(name, num_threads,
+                   static_cast<long>(num_ops) * num_threads, secs);
+
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  std::remove("bench.db");
+  std::remove("bench.log");
+  std::remove("bench.fpm");
+  std::remove("bench.cks");
+}
+
+} // namespace cmudb
+
+int main(int argc, char **argv) {
+  int num_ops = 200000;
+  int num_threads = 4;
+  for (int i = 1; i < argc - 1; i++) {
+    if (std::strcmp(argv[i], "--ops") == 0)
+      num_ops = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "--threads") == 0)
+      num_threads = std::atoi(argv[++i]);
+  }
+
+  // deeper trees at each step: with 512 byte pages the fan-out is small,
+  // so these sizes span roughly two to four levels
+  for (int num_keys : {1000, 10000, 100000}) {
+    cmudb::BenchGetValue(num_keys, num_ops, 1);
+  }
+  cmudb::BenchGetValue(100000, num_ops, num_threads);
+  return 0;
+}
@@ -0,0 +1,94 @@
+/**
+ * buffer_pool_benchmark.cpp
+ *
+ * Microbenchmarks for BufferPoolManager::FetchPage: the all-hit cost when
+ * the working set fits in the pool, the miss cost when every fetch evicts,
+ * and the hit path under thread contention.
+ *
+ *   ./buffer_pool_benchmark [--ops N] [--threads N]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark_util.h"
+#include "buffer/buffer_pool_manager.h"
+
+namespace cmudb {
+
+void BenchFetchHit(int num_ops, int num_threads) {
+  DiskManager disk_manager("bench.db");
+  BufferPoolManager bpm(64, &disk_manager);
+
+  std::vector<page_id_t> page_ids(32);
+  for (auto &page_id : page_ids) {
+    bpm.NewPage(page_id);
+    bpm.UnpinPage(page_id, false);
+  }
+
+  double secs = RunThreads(num_threads, [&](int thread_id) {
+    std::default_random_engine engine(42 + thread_id);
+    std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+    for (int i = 0; i < num_ops; i++) {
+      page_id_t page_id = page_ids[dist(engine)];
+      Page *page = bpm.FetchPage(page_id);
+      bpm.UnpinPage(page_id, false);
+      (void)page;
+    }
+  });
+  ReportThroughput("FetchPage/hit", num_threads,
+                   static_cast<long>(num_ops) * num_threads, secs);
+}
+
+void BenchFetchMiss(int num_ops) {
+  DiskManager disk_manager("bench.db");
+  BufferPoolManager bpm(16, &disk_manager);
+
+  // working set far larger than the pool: every fetch evicts and reads
+  std::vector<page_id_t> page_ids(1024);
+  for (auto &page_id : page_ids) {
+    bpm.NewPage(page_id);
+    bpm.UnpinPage(page_id, false);
+  }
+  bpm.FlushAllPages();
+
+  double secs = RunThreads(1, [&](int) {
+    std::default_random_engine engine(42);
+    std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+    for (int i = 0; i < num_ops; i++) {
+      page_id_t page_id = page_ids[dist(engine)];
+      Page *page = bpm.FetchPage(page_id);
+      bpm.UnpinPage(page_id, false);
+      (void)page;
+    }
+  });
+  ReportThroughput("FetchPage/miss", 1, num_ops, secs);
+}
+
+} // namespace cmudb
+
+int main(int argc, char **argv) {
+  int num_ops = 200000;
+  int num_threads = 4;
+  for (int i = 1; i < argc - 1; i++) {
+    if (std::strcmp(argv[i], "--ops") == 0)
+      num_ops = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "--threads") == 0)
+      num_threads = std::atoi(argv[++i]);
+  }
+
+  std::remove("bench.db");
+  cmudb::BenchFetchHit(num_ops, 1);
+  std::remove("bench.db");
+  cmudb::BenchFetchHit(num_ops, num_threads);
+  std::remove("bench.db");
+  cmudb::BenchFetchMiss(num_ops / 10);
+  std::remove("bench.db");
+  std::remove("bench.log");
+  std::remove("bench.fpm");
+  std::remove("bench.cks");
+  return 0;
+}
@@ -0,0 +1,82 @@
+/**
+ * extendible_hash_benchmark.cpp
+ *
+ * Microbenchmarks for the in-memory ExtendibleHash: Find throughput on a
+ * pre-populated table, single threaded and under reader concurrency, plus
+ * a mixed find/insert workload that exercises bucket splits while readers
+ * run.
+ *
+ *   ./extendible_hash_benchmark [--ops N] [--threads N] [--keys N]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include "benchmark/benchmark_util.h"
+#include "hash/extendible_hash.h"
+
+namespace cmudb {
+
+void BenchFind(int num_keys, int num_ops, int num_threads) {
+  ExtendibleHash<int, int> table(64);
+  for (int i = 0; i < num_keys; i++) {
+    table.Insert(i, i);
+  }
+
+  double secs = RunThreads(num_threads, [&](int thread_id) {
+    std::default_random_engine engine(42 + thread_id);
+    std::uniform_int_distribution<int> dist(0, num_keys - 1);
+    int value;
+    for (int i = 0; i < num_ops; i++) {
+      table.Find(dist(engine), value);
+    }
+  });
+  ReportThroughput("ExtendibleHash/Find", num_threads,
+                   static_cast<long>(num_ops) * num_threads, secs);
+}
+
+void BenchMixed(int num_keys, int num_ops, int num_threads) {
+  ExtendibleHash<int, int> table(64);
+  for (int i = 0; i < num_keys; i++) {
+    table.Insert(i, i);
+  }
+
+  // thread 0 keeps inserting fresh keys (forcing splits), the rest read
+  double secs = RunThreads(num_threads, [&](int thread_id) {
+    std::default_random_engine engine(42 + thread_id);
+    std::uniform_int_distribution<int> dist(0, num_keys - 1);
+    int value;
+    for (int i = 0; i < num_ops; i++) {
+      if (thread_id == 0) {
+        table.Insert(num_keys + i, i);
+      } else {
+        table.Find(dist(engine), value);
+      }
+    }
+  });
+  ReportThroughput("ExtendibleHash/Find+Insert", num_threads,
+                   static_cast<long>(num_ops) * num_threads, secs);
+}
+
+} // namespace cmudb
+
+int main(int argc, char **argv) {
+  int num_ops = 1000000;
+  int num_threads = 4;
+  int num_keys = 100000;
+  for (int i = 1; i < argc - 1; i++) {
+    if (std::strcmp(argv[i], "--ops") == 0)
+      num_ops = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "--threads") == 0)
+      num_threads = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "--keys") == 0)
+      num_keys = std::atoi(argv[++i]);
+  }
+
+  cmudb::BenchFind(num_keys, num_ops, 1);
+  cmudb::BenchFind(num_keys, num_ops, num_threads);
+  cmudb::BenchMixed(num_keys, num_ops, num_threads);
+  return 0;
+}
@@ -0,0 +1,406 @@
+/**
+ * recovery_benchmark.cpp
+ *
+ * Recovery-speed numbers and a crash fault-injection loop for the ARIES
+ * redo/undo path, so recovery work (parallel redo, checkpoints) has hard
+ * numbers and regression coverage.
+ *
+ * Two phases:
+ *  - clean measurement: build a committed workload of configurable size
+ *    (plus one dangling transaction for undo), drop the engine without
+ *    flushing its pages, and time LogRecovery::Redo/Undo on a fresh
+ *    engine, reported against the log volume replayed.
+ *  - fault injection: fork a writer child that commits a stream of
+ *    insert+update transactions (every few of them with an extra
+ *    insert+delete pair), SIGKILL it at a random moment -- landing inside
+ *    FlushLog, inside a page write, or anywhere in between -- then recover
+ *    in the parent, time it, and verify the surviving data.
+ *
+ * The child acknowledges each commit in a flushed side file after Commit
+ * returns, which survives the kill in the page cache. Verification then
+ * holds recovery to three invariants: every acknowledged key is present
+ * with its final payload, every present key carries a valid payload (a
+ * commit may land just before the kill beats its acknowledgement), and
+ * the insert+delete keys are absent whether their transaction committed
+ * or was undone.
+ *
+ *   ./recovery_benchmark [--rows N] [--crashes N]
+ */
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "logging/log_recovery.h"
+#include "vtable/virtual_table.h"
+
+namespace cmudb {
+
+static const char *BENCH_DB = "recovery_bench.db";
+static const char *BENCH_ORACLE = "recovery_bench.oracle";
+// insert+delete pairs live above this key so verification can tell at a
+// glance that none of them survived recovery
+static const int DOOMED_KEY_BASE = 1 << 20;
+// the clean measurement's dangling transaction inserts above this key, so
+// anything at or past it after recovery means undo missed it
+static const int UNDO_KEY_BASE = 2 << 20;
+
+// payloads are a pure function of the key, so a recovered row is checked
+// without any other state: each row is inserted with the initial payload
+// and updated to the final one inside the same transaction
+static std::string InitialPayload(int key) {
+  return "key-" + std::to_string(key) + "-v0";
+}
+static std::string FinalPayload(int key) {
+  return "key-" + std::to_string(key) + "-final";
+}
+
+static Tuple MakeRow(int key, const std::string &payload, Schema *schema) {
+  std::vector<Value> values{Value(TypeId::BIGINT, (int64_t)key),
+                            Value(TypeId::VARCHAR, payload)};
+  return Tuple(values, schema);
+}
+
+// every file the engine leaves behind: heap, free page map, checkpoint and
+// clean-shutdown markers, checksum and double-write sidecars, warm-up
+// info, the oracle, and the log with however many segments it rolled into
+static void RemoveBenchFiles() {
+  std::remove("recovery_bench.db");
+  std::remove("recovery_bench.fpm");
+  std::remove("recovery_bench.ckp");
+  std::remove("recovery_bench.cln");
+  std::remove("recovery_bench.cks");
+  std::remove("recovery_bench.dwb");
+  std::remove("recovery_bench.wrm");
+  std::remove(BENCH_ORACLE);
+  std::remove("recovery_bench.log");
+  for (int seg = 1;; seg++) {
+    std::string name = "recovery_bench.log." + std::to_string(seg);
+    if (std::remove(name.c_str()) != 0) {
+      break;
+    }
+  }
+}
+
+/*
+ * Clean measurement: a sized workload, a crash without flushing pages,
+ * and a timed Redo/Undo over the log it left behind
+ */
+static void BenchCleanRecovery(int num_rows) {
+  StorageEngine *engine = new StorageEngine(BENCH_DB);
+  engine->log_manager_->RunFlushThread();
+
+  Transaction *txn = engine->transaction_manager_->Begin();
+  TableHeap *table =
+      new TableHeap(engine->buffer_pool_manager_, engine->lock_manager_,
+                    engine->log_manager_, txn);
+  engine->transaction_manager_->Commit(txn);
+  delete txn;
+  page_id_t first_page_id = table->GetFirstPageId();
+
+  Schema *schema = ParseCreateStatement("a bigint, b varchar");
+  const int rows_per_txn = 50;
+  for (int key = 0; key < num_rows;) {
+    Transaction *writer = engine->transaction_manager_->Begin();
+    for (int i = 0; i < rows_per_txn && key < num_rows; i++, key++) {
+      RID rid;
+      table->InsertTuple(MakeRow(key, InitialPayload(key), schema), rid,
+                         writer);
+      table->UpdateTuple(MakeRow(key, FinalPayload(key), schema), rid, writer);
+    }
+    engine->transaction_manager_->Commit(writer);
+    delete writer;
+  }
+
+  // a dangling transaction so Undo has real work during the measurement
+  Transaction *loser = engine->transaction_manager_->Begin();
+  for (int i = 0; i < rows_per_txn; i++) {
+    RID rid;
+    int key = UNDO_KEY_BASE + i;
+    table->InsertTuple(MakeRow(key, InitialPayload(key), schema), rid, loser);
+  }
+  // let the periodic flush pick up the dangling records, then crash
+  std::this_thread::sleep_for(LOG_TIMEOUT + std::chrono::seconds(1));
+  delete loser;
+  delete table;
+  delete engine;
+
+  engine = new StorageEngine(BENCH_DB);
+  LogRecovery recovery(engine->disk_manager_, engine->buffer_pool_manager_);
+  double log_mb = engine->disk_manager_->GetLogSize() / (1024.0 * 1024.0);
+
+  auto start = std::chrono::steady_clock::now();
+  recovery.Redo();
+  auto mid = std::chrono::steady_clock::now();
+  recovery.Undo();
+  auto end = std::chrono::steady_clock::now();
+  double redo_ms = std::chrono::duration<double, std::milli>(mid - start).count();
+  double undo_ms = std::chrono::duration<double, std::milli>(end - mid).count();
+
+  std::printf("%-28s rows=%-7d log=%6.2f MB  redo=%7.1f ms (%6.1f MB/s)  "
+              "undo=%6.1f ms\n",
+              "recovery/clean", num_rows, log_mb, redo_ms,
+              log_mb / (redo_ms / 1000.0), undo_ms);
+
+  // the recovered image must hold exactly the committed rows
+  txn = engine->transaction_manager_->Begin();
+  table = new TableHeap(engine->buffer_pool_manager_, engine->lock_manager_,
+                        engine->log_manager_, first_page_id);
+  int count = 0;
+  bool ok = true;
+  for (TableIterator itr = table->begin(txn); itr != table->end(); ++itr) {
+    int key = (int)(*itr).GetValue(schema, 0).GetAs<int64_t>();
+    if (key >= UNDO_KEY_BASE) {
+      std::printf("FAIL: uncommitted key %d survived undo\n", key);
+      ok = false;
+    }
+    ++count;
+  }
+  if (count != num_rows) {
+    std::printf("FAIL: recovered %d rows, expected %d\n", count, num_rows);
+    ok = false;
+  }
+  engine->transaction_manager_->Commit(txn);
+  delete txn;
+  delete table;
+  delete schema;
+  delete engine;
+  if (!ok) {
+    std::exit(1);
+  }
+}
+
+/*
+ * The forked writer: commits insert+update transactions forever (the
+ * parent kills it) and acknowledges each one in the oracle file only
+ * after Commit has returned. Runs in its own process so the kill takes
+ * the engine down mid-flight, not at a cooperative point
+ */
+static void RunCrashChild() {
+  StorageEngine *engine = new StorageEngine(BENCH_DB);
+  engine->log_manager_->RunFlushThread();
+
+  Transaction *txn = engine->transaction_manager_->Begin();
+  TableHeap *table =
+      new TableHeap(engine->buffer_pool_manager_, engine->lock_manager_,
+                    engine->log_manager_, txn);
+  engine->transaction_manager_->Commit(txn);
+  delete txn;
+
+  std::FILE *oracle = std::fopen(BENCH_ORACLE, "w");
+  std::fprintf(oracle, "P %d\n", table->GetFirstPageId());
+  std::fflush(oracle);
+
+  Schema *schema = ParseCreateStatement("a bigint, b varchar");
+  for (int key = 0;; key++) {
+    Transaction *writer = engine->transaction_manager_->Begin();
+    RID rid;
+    table->InsertTuple(MakeRow(key, InitialPayload(key), schema), rid, writer);
+    table->UpdateTuple(MakeRow(key, FinalPayload(key), schema), rid, writer);
+    if (key % 7 == 0) {
+      // an insert+delete pair: gone if the transaction commits, gone if
+      // it is undone -- it must never be seen after recovery
+      RID doomed;
+      int doomed_key = DOOMED_KEY_BASE + key;
+      table->InsertTuple(MakeRow(doomed_key, InitialPayload(doomed_key), schema),
+                         doomed, writer);
+      table->MarkDelete(doomed, writer);
+    }
+    engine->transaction_manager_->Commit(writer);
+    delete writer;
+    std::fprintf(oracle, "A %d\n", key);
+    std::fflush(oracle);
+  }
+}
+
+/*
+ * Recover the killed child's files and hold them to the harness
+ * invariants; returns false (and says why) on any violation
+ */
+static bool RecoverAndVerify(int round) {
+  page_id_t first_page_id = INVALID_PAGE_ID;
+  std::unordered_set<int> acked;
+  {
+    std::ifstream in(BENCH_ORACLE);
+    char tag;
+    int value;
+    while (in >> tag >> value) {
+      if (tag == 'P') {
+        first_page_id = value;
+      } else {
+        acked.insert(value);
+      }
+    }
+  }
+  if (first_page_id == INVALID_PAGE_ID) {
+    // killed before the table existed; nothing to hold recovery to
+    std::printf("recovery/crash round %-2d       killed before setup\n", round);
+    return true;
+  }
+
+  StorageEngine *engine = new StorageEngine(BENCH_DB);
+  LogRecovery recovery(engine->disk_manager_, engine->buffer_pool_manager_);
+  auto start = std::chrono::steady_clock::now();
+  recovery.Redo();
+  auto mid = std::chrono::steady_clock::now();
+  recovery.Undo();
+  auto end = std::chrono::steady_clock::now();
+  double redo_ms = std::chrono::duration<double, std::milli>(mid - start).count();
+  double undo_ms = std::chrono::duration<double, std::milli>(end - mid).count();
+
+  bool ok = true;
+  Schema *schema = ParseCreateStatement("a bigint, b varchar");
+  Transaction *txn = engine->transaction_manager_->Begin();
+  TableHeap *table =
+      new TableHeap(engine->buffer_pool_manager_, engine->lock_manager_,
+                    engine->log_manager_, first_page_id);
+  std::unordered_set<int> recovered;
+  // a corrupt recovered chain could loop, so bound the scan instead of
+  // trusting the iterator to terminate; every row fits a page several
+  // times over, so this bound is far above any honest recovery
+  const size_t max_scan = acked.size() * 3 + 10000;
+  const int max_reports = 20;
+  int reports = 0;
+  size_t scanned = 0;
+  for (TableIterator itr = table->begin(txn); itr != table->end(); ++itr) {
+    if (++scanned > max_scan) {
+      std::printf("FAIL: scan passed %zu rows, page chain is likely cyclic\n",
+                  max_scan);
+      ok = false;
+      break;
+    }
+    const Tuple &tuple = *itr;
+    int key = (int)tuple.GetValue(schema, 0).GetAs<int64_t>();
+    RID rid = tuple.GetRid();
+    if (key >= DOOMED_KEY_BASE) {
+      if (reports++ < max_reports)
+        std::printf("FAIL: insert+delete key %d survived recovery at %d:%d\n",
+                    key, rid.GetPageId(), rid.GetSlotNum());
+      ok = false;
+      continue;
+    }
+    if (!recovered.insert(key).second) {
+      if (reports++ < max_reports)
+        std::printf("FAIL: key %d recovered twice, second copy at %d:%d\n",
+                    key, rid.GetPageId(), rid.GetSlotNum());
+      ok = false;
+    }
+    // present but unacknowledged is fine (the kill can beat the
+    // acknowledgement), but the payload must be the committed image
+    Value expected(TypeId::VARCHAR, FinalPayload(key));
+    if (tuple.GetValue(schema, 1).CompareEquals(expected) != 1) {
+      if (reports++ < max_reports)
+        std::printf("FAIL: key %d recovered with a torn payload at %d:%d\n",
+                    key, rid.GetPageId(), rid.GetSlotNum());
+      ok = false;
+    }
+  }
+  for (int key : acked) {
+    if (recovered.count(key) == 0) {
+      if (reports++ < max_reports)
+        std::printf("FAIL: acknowledged commit of key %d lost\n", key);
+      ok = false;
+    }
+  }
+  if (reports > max_reports) {
+    std::printf("(%d further violations suppressed)\n", reports - max_reports);
+  }
+  if (!ok) {
+    // post-mortem aid: walk the raw page chain so a bad link is visible
+    std::printf("page chain:");
+    std::unordered_set<page_id_t> seen;
+    page_id_t pid = first_page_id;
+    while (pid != INVALID_PAGE_ID && seen.insert(pid).second) {
+      auto page = reinterpret_cast<TablePage *>(
+          engine->buffer_pool_manager_->FetchPage(pid));
+      page_id_t next = page->GetNextPageId();
+      std::printf(" %d", pid);
+      engine->buffer_pool_manager_->UnpinPage(pid, false);
+      pid = next;
+    }
+    if (pid != INVALID_PAGE_ID) {
+      std::printf(" -> %d (cycle)", pid);
+    }
+    std::printf("\n");
+  }
+  engine->transaction_manager_->Commit(txn);
+  delete txn;
+  delete table;
+  delete schema;
+  delete engine;
+
+  std::printf("recovery/crash round %-2d acked=%-5zu recovered=%-5zu "
+              "redo=%6.1f ms  undo=%5.1f ms  %s\n",
+              round, acked.size(), recovered.size(), redo_ms, undo_ms,
+              ok ? "ok" : "FAILED");
+  return ok;
+}
+
+/*
+ * The fault-injection loop: each round forks a fresh writer, kills it
+ * after a random slice of work, and recovers. Kill times are uniform over
+ * the round, so across rounds they land inside log flushes, page writes
+ * and everything in between
+ */
+static int RunCrashLoop(int num_crashes) {
+  std::default_random_engine random_engine(
+      std::chrono::steady_clock::now().time_since_epoch().count());
+  std::uniform_int_distribution<int> kill_after_ms(60, 500);
+
+  int failures = 0;
+  for (int round = 0; round < num_crashes; round++) {
+    RemoveBenchFiles();
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+      RunCrashChild(); // runs until killed
+      std::_Exit(0);
+    }
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(kill_after_ms(random_engine)));
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+    if (!RecoverAndVerify(round)) {
+      // stop here so the failing round's db/log/oracle survive for
+      // post-mortem instead of being wiped by the next round
+      ++failures;
+      break;
+    }
+  }
+  return failures;
+}
+
+} // namespace cmudb
+
+int main(int argc, char **argv) {
+  int num_rows = 10000;
+  int num_crashes = 5;
+  for (int i = 1; i < argc - 1; i++) {
+    if (std::strcmp(argv[i], "--rows") == 0)
+      num_rows = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "--crashes") == 0)
+      num_crashes = std::atoi(argv[++i]);
+  }
+
+  cmudb::RemoveBenchFiles();
+  cmudb::BenchCleanRecovery(num_rows);
+  cmudb::RemoveBenchFiles();
+  int failures = cmudb::RunCrashLoop(num_crashes);
+  if (failures > 0) {
+    // leave the last round's files in place for post-mortem
+    std::printf("%d of %d crash rounds failed verification\n", failures,
+                num_crashes);
+    return 1;
+  }
+  cmudb::RemoveBenchFiles();
+  return 0;
+}
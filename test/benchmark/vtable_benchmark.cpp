@@ -0,0 +1,212 @@
+/**
+ * vtable_benchmark.cpp
+ *
+ * YCSB-style end-to-end benchmark. Drives the full stack the way sqlite
+ * does in production: load the libvtable extension, create a virtual table
+ * with a primary key index, bulk-load records, then run a timed phase of
+ * point reads and updates over zipfian-distributed keys and report
+ * throughput plus latency percentiles.
+ *
+ * Worker threads share one serialized-mode connection: the engine keeps a
+ * single global transaction, so sqlite's connection mutex is what makes
+ * concurrent callers safe. Thread count therefore measures end-to-end
+ * overhead under contention, not parallel scaling inside the engine.
+ *
+ *   ./vtable_benchmark [--records N] [--ops N] [--threads N]
+ *                      [--read-pct P] [--zipf THETA]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sqlite/sqlite3.h"
+
+namespace {
+
+struct BenchmarkConfig {
+  int num_records = 10000;
+  int num_ops = 20000;
+  int num_threads = 1;
+  int read_pct = 50;
+  double zipf_theta = 0.99;
+};
+
+// YCSB zipfian generator: key popularity follows a power law with
+// skew theta (0 = uniform, 0.99 = the YCSB default)
+class ZipfianGenerator {
+ public:
+  ZipfianGenerator(int num_items, double theta, unsigned seed)
+      : num_items_(num_items), theta_(theta), engine_(seed) {
+    for (int i = 1; i <= num_items_; i++) {
+      zeta_n_ += 1.0 / std::pow(static_cast<double>(i), theta_);
+    }
+    zeta_2_ = 1.0 + 1.0 / std::pow(2.0, theta_);
+    alpha_ = 1.0 / (1.0 - theta_);
+    eta_ = (1.0 - std::pow(2.0 / num_items_, 1.0 - theta_)) /
+           (1.0 - zeta_2_ / zeta_n_);
+  }
+
+  int Next() {
+    double u = uniform_(engine_);
+    double uz = u * zeta_n_;
+    if (uz < 1.0)
+      return 0;
+    if (uz < zeta_2_)
+      return 1;
+    return static_cast<int>(num_items_ *
+                            std::pow(eta_ * u - eta_ + 1.0, alpha_));
+  }
+
+ private:
+  int num_items_;
+  double theta_;
+  double zeta_n_ = 0.0;
+  double zeta_2_;
+  double alpha_;
+  double eta_;
+  std::default_random_engine engine_;
+  std::uniform_real_distribution<double> uniform_{0.0, 1.0};
+};
+
+bool Exec(sqlite3 *db, const std::string &sql) {
+  char *err_msg = nullptr;
+  int rc = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &err_msg);
+  if (rc != SQLITE_OK) {
+    std::fprintf(stderr, "SQL error: %s (%s)\n", err_msg, sql.c_str());
+    sqlite3_free(err_msg);
+    return false;
+  }
+  return true;
+}
+
+void RunWorker(sqlite3 *db, const BenchmarkConfig &config, int thread_id,
+               std::vector<long> *latencies_us) {
+  ZipfianGenerator keys(config.num_records, config.zipf_theta,
+                        42 + thread_id);
+  std::default_random_engine op_engine(1000 + thread_id);
+  std::uniform_int_distribution<int> op_dist(0, 99);
+
+  int ops = config.num_ops / config.num_threads;
+  latencies_us->reserve(ops);
+  for (int i = 0; i < ops; i++) {
+    int key = keys.Next();
+    std::string sql;
+    if (op_dist(op_engine) < config.read_pct) {
+      sql = "SELECT * FROM bench WHERE a = " + std::to_string(key);
+    } else {
+      sql = "UPDATE bench SET b = 'payload-" + std::to_string(i) +
+            "' WHERE a = " + std::to_string(key);
+    }
+    auto start = std::chrono::steady_clock::now();
+    Exec(db, sql);
+    auto end = std::chrono::steady_clock::now();
+    latencies_us->push_back(
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+            .count());
+  }
+}
+
+long Percentile(const std::vector<long> &sorted, double p) {
+  if (sorted.empty())
+    return 0;
+  size_t index = static_cast<size_t>(p * (sorted.size() - 1));
+  return sorted[index];
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkConfig config;
+  for (int i = 1; i < argc - 1; i++) {
+    if (std::strcmp(argv[i], "--records") == 0)
+      config.num_records = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "--ops") == 0)
+      config.num_ops = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "--threads") == 0)
+      config.num_threads = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "--read-pct") == 0)
+      config.read_pct = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "--zipf") == 0)
+      config.zipf_theta = std::atof(argv[++i]);
+  }
+
+  std::remove("bench.db");
+  std::remove("vtable.db");
+
+  sqlite3 *db;
+  if (sqlite3_open_v2("bench.db", &db,
+                      SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE |
+                          SQLITE_OPEN_FULLMUTEX,
+                      nullptr) != SQLITE_OK) {
+    std::fprintf(stderr, "cannot open database\n");
+    return 1;
+  }
+  sqlite3_enable_load_extension(db, 1);
+  char *err_msg = nullptr;
+  if (sqlite3_load_extension(db, "libvtable", nullptr, &err_msg) !=
+      SQLITE_OK) {
+    std::fprintf(stderr, "cannot load libvtable: %s\n", err_msg);
+    sqlite3_free(err_msg);
+    return 1;
+  }
+
+  if (!Exec(db, "CREATE VIRTUAL TABLE bench USING vtable "
+               "('a int, b varchar', 'bench_pk a')"))
+    return 1;
+
+  // load phase: one multi-row statement per chunk keeps the index
+  // maintenance batched the way a bulk load would
+  auto load_start = std::chrono::steady_clock::now();
+  Exec(db, "BEGIN");
+  for (int i = 0; i < config.num_records; i++) {
+    if (!Exec(db, "INSERT INTO bench VALUES(" + std::to_string(i) +
+                      ", 'payload-" + std::to_string(i) + "')"))
+      return 1;
+  }
+  Exec(db, "COMMIT");
+  auto load_end = std::chrono::steady_clock::now();
+  double load_secs =
+      std::chrono::duration<double>(load_end - load_start).count();
+
+  // run phase
+  std::vector<std::vector<long>> latencies(config.num_threads);
+  std::vector<std::thread> workers;
+  auto run_start = std::chrono::steady_clock::now();
+  for (int t = 0; t < config.num_threads; t++) {
+    workers.emplace_back(RunWorker, db, std::cref(config), t, &latencies[t]);
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  auto run_end = std::chrono::steady_clock::now();
+  double run_secs = std::chrono::duration<double>(run_end - run_start).count();
+
+  std::vector<long> all;
+  for (auto &part : latencies) {
+    all.insert(all.end(), part.begin(), part.end());
+  }
+  std::sort(all.begin(), all.end());
+
+  std::printf("records=%d ops=%zu threads=%d read_pct=%d zipf=%.2f\n",
+              config.num_records, all.size(), config.num_threads,
+              config.read_pct, config.zipf_theta);
+  std::printf("load:  %.2f s (%.0f inserts/s)\n", load_secs,
+              config.num_records / load_secs);
+  std::printf("run:   %.2f s (%.0f ops/s)\n", run_secs, all.size() / run_secs);
+  std::printf("lat us: p50=%ld p95=%ld p99=%ld max=%ld\n",
+              Percentile(all, 0.50), Percentile(all, 0.95),
+              Percentile(all, 0.99), all.empty() ? 0 : all.back());
+
+  sqlite3_close(db);
+  std::remove("bench.db");
+  std::remove("vtable.db");
+  return 0;
+}
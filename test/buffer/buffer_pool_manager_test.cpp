@@ -2,7 +2,9 @@
  * buffer_pool_manager_test.cpp
  */
 
+#include <chrono>
 #include <cstdio>
+#include <thread>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
@@ -48,4 +50,192 @@ TEST(BufferPoolManagerTest, SampleTest) {
   remove("test.db");
 }
 
+TEST(BufferPoolManagerTest, ShardedPoolTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  // 4 frames per shard
+  BufferPoolManager bpm(16, 4, disk_manager);
+
+  // fill every shard and write a recognizable payload
+  for (int i = 0; i < 16; ++i) {
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page%d", temp_page_id);
+  }
+  // every frame is pinned, no shard can serve a new page
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+
+  // unpin everything as dirty, then force evictions by cycling new pages
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, true));
+  }
+  for (int i = 0; i < 16; ++i) {
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+  }
+
+  // evicted pages must come back from disk with their content intact
+  for (int i = 0; i < 16; ++i) {
+    auto page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    char expected[PAGE_SIZE];
+    snprintf(expected, PAGE_SIZE, "Page%d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, ResizeTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(4, disk_manager);
+  EXPECT_EQ(4, bpm.GetPoolSize());
+
+  // fill the pool, everything pinned
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    page_ids.push_back(temp_page_id);
+  }
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+
+  // grow: new frames are usable immediately
+  EXPECT_EQ(8, bpm.Resize(8));
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    page_ids.push_back(temp_page_id);
+  }
+
+  // shrink: only unpinned frames can be retired
+  EXPECT_EQ(8, bpm.Resize(2));
+  for (page_id_t page_id : page_ids) {
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(2, bpm.Resize(2));
+
+  // grow again reuses the retired frames
+  EXPECT_EQ(6, bpm.Resize(6));
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_NE(nullptr, bpm.FetchPage(page_ids[i]));
+    EXPECT_EQ(true, bpm.UnpinPage(page_ids[i], false));
+  }
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, StatsTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager);
+
+  auto page = bpm.NewPage(temp_page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+
+  // one hit
+  ASSERT_NE(nullptr, bpm.FetchPage(temp_page_id));
+  EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+  // one explicit writeback
+  EXPECT_EQ(true, bpm.FlushPage(temp_page_id));
+
+  auto stats = bpm.GetStats();
+  EXPECT_EQ(1, stats.hits);
+  EXPECT_EQ(0, stats.misses);
+  EXPECT_EQ(1, stats.dirty_writebacks);
+  EXPECT_FALSE(stats.ToString().empty());
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, BatchFetchTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager);
+
+  // create a few pages with known content and evict them
+  for (int i = 0; i < 5; ++i) {
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page%d", temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+  }
+
+  // prefetched pages should be re-fetchable and evictable
+  bpm.PrefetchPage(3);
+
+  std::vector<page_id_t> ids = {0, 1, 2, 3, 4};
+  auto pages = bpm.FetchPages(ids);
+  ASSERT_EQ(ids.size(), pages.size());
+  for (size_t i = 0; i < ids.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    char expected[PAGE_SIZE];
+    snprintf(expected, PAGE_SIZE, "Page%d", ids[i]);
+    EXPECT_EQ(0, strcmp(pages[i]->GetData(), expected));
+    EXPECT_EQ(true, bpm.UnpinPage(ids[i], false));
+  }
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, ReadAheadTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  for (int i = 0; i < 30; ++i) {
+    auto page = bpm->NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(true, bpm->UnpinPage(temp_page_id, true));
+  }
+  // restart on the same file so sequential fetches are cold misses
+  bpm->FlushAllPages();
+  delete bpm;
+  bpm = new BufferPoolManager(50, disk_manager);
+
+  // four consecutive page ids form a streak and trigger a window
+  for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  // the worker is asynchronous; give it a moment to pull the full window
+  for (int i = 0; i < 200; ++i) {
+    if (bpm->GetStats().read_ahead_pages >= (size_t)8)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(bpm->GetStats().read_ahead_pages, (size_t)8);
+
+  // a random fetch breaks the streak and schedules nothing further
+  size_t scheduled = bpm->GetStats().read_ahead_pages;
+  ASSERT_NE(nullptr, bpm->FetchPage(20));
+  EXPECT_EQ(true, bpm->UnpinPage(20, false));
+  ASSERT_NE(nullptr, bpm->FetchPage(25));
+  EXPECT_EQ(true, bpm->UnpinPage(25, false));
+  EXPECT_EQ(bpm->GetStats().read_ahead_pages, scheduled);
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
 } // namespace cmudb
@@ -0,0 +1,98 @@
+/**
+ * compressed_page_cache_test.cpp
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/compressed_page_cache.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(CompressedPageCacheTest, CompressionTest) {
+  // a mostly-zero page shrinks a lot and round-trips exactly
+  char page[PAGE_SIZE] = {0};
+  strcpy(page, "Hello");
+  strcpy(page + 300, "World");
+
+  char compressed[PAGE_SIZE];
+  size_t size =
+      CompressedPageCache::Compress(page, PAGE_SIZE, compressed, PAGE_SIZE);
+  ASSERT_GT(size, (size_t)0);
+  EXPECT_LT(size, (size_t)(PAGE_SIZE / 4));
+
+  char restored[PAGE_SIZE];
+  CompressedPageCache::Decompress(compressed, size, restored, PAGE_SIZE);
+  EXPECT_EQ(0, memcmp(page, restored, PAGE_SIZE));
+
+  // incompressible data reports failure instead of growing
+  char noise[PAGE_SIZE];
+  for (int i = 0; i < PAGE_SIZE; ++i) {
+    noise[i] = static_cast<char>(i * 31 + 7) | 1; // no zero bytes
+  }
+  EXPECT_EQ((size_t)0, CompressedPageCache::Compress(noise, PAGE_SIZE,
+                                                     compressed, PAGE_SIZE - 1));
+}
+
+TEST(CompressedPageCacheTest, CacheTest) {
+  CompressedPageCache cache(256);
+
+  char page[PAGE_SIZE] = {0};
+  strcpy(page, "page one");
+  cache.Put(1, page);
+  strcpy(page, "page two");
+  cache.Put(2, page);
+  EXPECT_EQ((size_t)2, cache.GetEntryCount());
+  EXPECT_LE(cache.GetSizeBytes(), (size_t)256);
+
+  // a hit hands the page back and drops the entry
+  char restored[PAGE_SIZE];
+  EXPECT_TRUE(cache.Get(2, restored));
+  EXPECT_EQ(0, strcmp(restored, "page two"));
+  EXPECT_FALSE(cache.Get(2, restored));
+  EXPECT_EQ((size_t)1, cache.GetEntryCount());
+
+  cache.Remove(1);
+  EXPECT_EQ((size_t)0, cache.GetSizeBytes());
+
+  // exceeding the byte budget evicts the oldest entries
+  CompressedPageCache tiny(16);
+  cache.Put(1, page);
+  for (page_id_t id = 0; id < 8; ++id) {
+    tiny.Put(id, page);
+  }
+  EXPECT_LE(tiny.GetSizeBytes(), (size_t)16);
+}
+
+TEST(CompressedPageCacheTest, BufferPoolTierTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(3, disk_manager);
+  bpm.EnableCompressedCache(16 * PAGE_SIZE);
+
+  // fill past the pool size so pages get evicted into the compressed tier
+  page_id_t page_id;
+  for (int i = 0; i < 10; ++i) {
+    auto *page = bpm.NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "cold page %d", i);
+    bpm.UnpinPage(page_id, true);
+  }
+
+  // re-fetching evicted pages is served from the tier, not from disk
+  for (int i = 0; i < 10; ++i) {
+    auto *page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    char expected[32];
+    snprintf(expected, sizeof(expected), "cold page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    bpm.UnpinPage(i, false);
+  }
+  EXPECT_GT(bpm.GetStats().compressed_hits, (size_t)0);
+
+  remove("test.db");
+  delete disk_manager;
+}
+
+} // namespace cmudb
@@ -0,0 +1,80 @@
+/**
+ * lru_k_replacer_test.cpp
+ */
+
+#include <cstdio>
+
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer<int> replacer(2);
+
+  // values with a single access are cold and are evicted FIFO
+  replacer.Insert(1);
+  replacer.Insert(2);
+  replacer.Insert(3);
+  EXPECT_EQ(3, replacer.Size());
+
+  int value;
+  replacer.Victim(value);
+  EXPECT_EQ(1, value);
+
+  // a second access gives 2 a full history, so the cold 3 goes first
+  replacer.Insert(2);
+  replacer.Victim(value);
+  EXPECT_EQ(3, value);
+  replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  EXPECT_EQ(0, replacer.Size());
+  EXPECT_EQ(false, replacer.Victim(value));
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  LRUKReplacer<int> replacer(2);
+
+  // build up a hot set with two accesses each
+  for (int i = 1; i <= 3; ++i) {
+    replacer.Insert(i);
+    replacer.Insert(i);
+  }
+
+  // a "scan" touches many values exactly once
+  for (int i = 100; i < 110; ++i) {
+    replacer.Insert(i);
+  }
+
+  // all ten scan values must be victimized before any hot value
+  int value;
+  for (int i = 100; i < 110; ++i) {
+    replacer.Victim(value);
+    EXPECT_EQ(i, value);
+  }
+  replacer.Victim(value);
+  EXPECT_EQ(1, value);
+}
+
+TEST(LRUKReplacerTest, EraseKeepsHistoryTest) {
+  LRUKReplacer<int> replacer(2);
+
+  replacer.Insert(1);
+  replacer.Insert(1);
+  replacer.Insert(2);
+
+  // pin 1: no longer a victim candidate, but its history survives
+  EXPECT_EQ(true, replacer.Erase(1));
+  EXPECT_EQ(false, replacer.Erase(1));
+  EXPECT_EQ(1, replacer.Size());
+
+  // unpin 1 again: it is hot (three recorded accesses), 2 is still cold
+  replacer.Insert(1);
+  int value;
+  replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  replacer.Victim(value);
+  EXPECT_EQ(1, value);
+}
+
+} // namespace cmudb
@@ -0,0 +1,81 @@
+/**
+ * sampling_replacer_test.cpp
+ */
+
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "buffer/sampling_replacer.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(SamplingReplacerTest, SampleTest) {
+  SamplingReplacer<int> replacer(64);
+
+  // push elements into replacer; a re-insert only refreshes recency
+  for (int i = 1; i <= 6; ++i)
+    replacer.Insert(i);
+  replacer.Insert(1);
+  EXPECT_EQ(replacer.Size(), (size_t)6);
+
+  // erased elements are not victim candidates
+  EXPECT_TRUE(replacer.Erase(3));
+  EXPECT_EQ(replacer.Size(), (size_t)5);
+
+  // eviction is approximate LRU, so assert the set drained rather than
+  // the exact order: every remaining element comes out exactly once
+  int value;
+  std::set<int> victims;
+  while (replacer.Victim(value))
+    victims.insert(value);
+  EXPECT_EQ(victims, (std::set<int>{1, 2, 4, 5, 6}));
+  EXPECT_EQ(replacer.Size(), (size_t)0);
+
+  // a victimized element can come back
+  replacer.Insert(3);
+  EXPECT_TRUE(replacer.Victim(value));
+  EXPECT_EQ(value, 3);
+  EXPECT_FALSE(replacer.Victim(value));
+}
+
+TEST(SamplingReplacerTest, GrowAndConcurrencyTest) {
+  // deliberately undersized so inserts force the table chain to grow
+  SamplingReplacer<int> replacer(16);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&replacer, t] {
+      for (int i = 1; i <= 100; ++i)
+        replacer.Insert(t * 1000 + i);
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  EXPECT_EQ(replacer.Size(), (size_t)400);
+
+  // concurrent victims hand every element out exactly once
+  std::vector<std::set<int>> victim_sets(4);
+  threads.clear();
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&replacer, &victim_sets, t] {
+      int value;
+      while (replacer.Victim(value))
+        victim_sets[t].insert(value);
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  size_t total = 0;
+  std::set<int> all_victims;
+  for (auto &victim_set : victim_sets) {
+    total += victim_set.size();
+    all_victims.insert(victim_set.begin(), victim_set.end());
+  }
+  EXPECT_EQ(total, (size_t)400);
+  EXPECT_EQ(all_victims.size(), (size_t)400);
+}
+
+} // namespace cmudb
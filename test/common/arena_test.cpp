@@ -0,0 +1,50 @@
+/**
+ * arena_test.cpp
+ */
+
+#include <cstring>
+
+#include "common/arena.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(ArenaTest, AllocateTest) {
+  Arena arena(128);
+
+  // allocations are aligned and usable
+  char *a = arena.Allocate(10);
+  char *b = arena.Allocate(20);
+  EXPECT_NE(a, b);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(a) % 8, 0u);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % 8, 0u);
+  memset(a, 0xab, 10);
+  memset(b, 0xcd, 20);
+  EXPECT_EQ((unsigned char)a[9], 0xab);
+  EXPECT_EQ((unsigned char)b[0], 0xcd);
+
+  // oversized requests get a dedicated chunk
+  char *big = arena.Allocate(1024);
+  memset(big, 0, 1024);
+  EXPECT_GE(arena.MemoryUsage(), (size_t)1024 + 128);
+
+  // reset reclaims everything but keeps the first chunk warm
+  arena.Reset();
+  EXPECT_EQ(arena.MemoryUsage(), (size_t)128);
+  char *c = arena.Allocate(16);
+  EXPECT_EQ(c, a); // bump pointer rewound to the start
+}
+
+TEST(ArenaTest, ChunkGrowthTest) {
+  Arena arena(64);
+  // many small allocations must keep handing out distinct valid memory
+  for (int i = 0; i < 1000; ++i) {
+    char *p = arena.Allocate(24);
+    memset(p, i & 0xff, 24);
+  }
+  EXPECT_GE(arena.MemoryUsage(), (size_t)1000 * 24);
+  arena.Reset();
+  EXPECT_EQ(arena.MemoryUsage(), (size_t)64);
+}
+
+} // namespace cmudb
@@ -0,0 +1,73 @@
+/**
+ * latch_profiler_test.cpp
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <thread>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/latch_profiler.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(LatchProfilerTest, ContentionReportTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(10, disk_manager);
+  page_id_t page_id;
+  Page *page = buffer_pool_manager->NewPage(page_id);
+  ASSERT_NE(page, nullptr);
+
+  // disabled (the default): a contended acquisition records nothing
+  {
+    page->WLatch();
+    std::thread reader([&] { page->RLatch(); page->RUnlatch(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    page->WUnlatch();
+    reader.join();
+  }
+  std::stringstream quiet;
+  LatchProfiler::Instance().Report(quiet);
+  EXPECT_EQ(quiet.str().find("page "), std::string::npos);
+
+  // enabled: the blocked reader and writer both get attributed to the page
+  LatchProfiler::Enable();
+  {
+    page->WLatch();
+    std::thread reader([&] { page->RLatch(); page->RUnlatch(); });
+    std::thread writer([&] { page->WLatch(); page->WUnlatch(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    page->WUnlatch();
+    reader.join();
+    writer.join();
+  }
+  LatchProfiler::Disable();
+
+  std::stringstream report;
+  LatchProfiler::Instance().Report(report);
+  std::string text = report.str();
+  EXPECT_NE(text.find("page " + std::to_string(page_id)), std::string::npos);
+  EXPECT_NE(text.find("r_waits:1"), std::string::npos);
+  EXPECT_NE(text.find("w_waits:1"), std::string::npos);
+
+  // an uncontended acquisition records nothing even while enabled
+  LatchProfiler::Instance().Reset();
+  LatchProfiler::Enable();
+  page->WLatch();
+  page->WUnlatch();
+  LatchProfiler::Disable();
+  std::stringstream empty;
+  LatchProfiler::Instance().Report(empty);
+  EXPECT_EQ(empty.str().find("page "), std::string::npos);
+
+  buffer_pool_manager->UnpinPage(page_id, false);
+  remove("test.db");
+  remove("test.log");
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+} // namespace cmudb
@@ -0,0 +1,59 @@
+/**
+ * perf_trace_test.cpp
+ */
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "common/perf_trace.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(PerfTraceTest, CounterTest) {
+  PerfResetCounters();
+  EXPECT_EQ(PerfCounterValue(PerfCounter::LATCH_WAIT), 0u);
+
+  PerfCount(PerfCounter::LATCH_WAIT);
+  PerfCount(PerfCounter::LATCH_WAIT, 4);
+  EXPECT_EQ(PerfCounterValue(PerfCounter::LATCH_WAIT), 5u);
+
+  // counters are shared across threads
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([] {
+      for (int i = 0; i < 1000; i++) {
+        PerfCount(PerfCounter::BPLUS_RESTART);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(PerfCounterValue(PerfCounter::BPLUS_RESTART), 4000u);
+
+  PerfResetCounters();
+  EXPECT_EQ(PerfCounterValue(PerfCounter::LATCH_WAIT), 0u);
+  EXPECT_EQ(PerfCounterValue(PerfCounter::BPLUS_RESTART), 0u);
+}
+
+TEST(PerfTraceTest, TraceDumpTest) {
+  PerfResetCounters();
+  PerfCount(PerfCounter::LOG_FLUSH_STALL, 7);
+  for (int i = 0; i < 16; i++) {
+    PerfTraceEvent(42, i);
+  }
+
+  std::stringstream dump;
+  PerfDump(dump);
+  std::string text = dump.str();
+  EXPECT_NE(text.find("log_flush_stall = 7"), std::string::npos);
+  EXPECT_NE(text.find("id=42"), std::string::npos);
+  // oldest first: the first recorded payload appears before the last
+  EXPECT_LT(text.find("arg=0"), text.find("arg=15"));
+
+  PerfResetCounters();
+}
+
+} // namespace cmudb
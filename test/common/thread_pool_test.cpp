@@ -0,0 +1,65 @@
+/**
+ * thread_pool_test.cpp
+ */
+
+#include <atomic>
+#include <future>
+#include <vector>
+
+#include "common/thread_pool.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(ThreadPoolTest, SubmitAndAsyncTest) {
+  ThreadPool pool(4);
+  EXPECT_EQ(pool.GetWorkerCount(), (size_t)4);
+
+  std::atomic<int> counter{0};
+  for (int i = 0; i < 1000; ++i) {
+    pool.Submit([&counter] { counter++; });
+  }
+
+  // futures carry results back from the pool
+  std::vector<std::future<int>> results;
+  for (int i = 0; i < 100; ++i) {
+    results.push_back(pool.Async([i] { return i * i; }));
+  }
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(results[i].get(), i * i);
+  }
+
+  // shutdown drains the queued work before joining
+  pool.Shutdown();
+  EXPECT_EQ(counter.load(), 1000);
+}
+
+TEST(ThreadPoolTest, PriorityLaneTest) {
+  // a single worker makes the dispatch order observable: block it, queue
+  // LOW before HIGH, and the HIGH lane must still run first
+  ThreadPool pool(1);
+
+  std::promise<void> release;
+  std::shared_future<void> gate = release.get_future().share();
+  pool.Submit([gate] { gate.wait(); }, ThreadPool::Priority::HIGH);
+
+  std::vector<int> order;
+  pool.Submit([&order] { order.push_back(2); }, ThreadPool::Priority::LOW);
+  pool.Submit([&order] { order.push_back(1); }, ThreadPool::Priority::HIGH);
+  release.set_value();
+  pool.Shutdown();
+
+  ASSERT_EQ(order.size(), (size_t)2);
+  EXPECT_EQ(order[0], 1);
+  EXPECT_EQ(order[1], 2);
+}
+
+TEST(ThreadPoolTest, SharedInstanceTest) {
+  ThreadPool &pool = ThreadPool::Instance();
+  EXPECT_GE(pool.GetWorkerCount(), (size_t)2);
+  EXPECT_EQ(&pool, &ThreadPool::Instance());
+  std::future<int> result = pool.Async([] { return 42; });
+  EXPECT_EQ(result.get(), 42);
+}
+
+} // namespace cmudb
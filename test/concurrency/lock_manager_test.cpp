@@ -2,10 +2,13 @@
  * lock_manager_test.cpp
  */
 
+#include <atomic>
+#include <memory>
 #include <thread>
 #include <future>
 #include <mutex>
 #include <string>
+#include <vector>
 #include <iostream>
 
 #include "concurrency/transaction_manager.h"
@@ -153,4 +156,220 @@ TEST(LockManagerTest, ReadWriteTest) {
   EXPECT_TRUE(result == "ESSE" || result == "EESS" || result == "EE" || result == "EES");
 }
 
+/*
+ * Try and timed lock variants must fail fast without aborting the txn,
+ * and succeed once the conflicting lock is released
+ */
+TEST(LockManagerTest, LockTimeoutTest) {
+  LockManager lock_mgr{false};
+  TransactionManager txn_mgr{&lock_mgr};
+  RID rid{0, 0};
+
+  Transaction txn0(0);
+  EXPECT_TRUE(lock_mgr.LockExclusive(&txn0, rid));
+
+  Transaction txn1(1);
+  EXPECT_FALSE(lock_mgr.TryLockExclusive(&txn1, rid));
+  EXPECT_FALSE(lock_mgr.TryLockShared(&txn1, rid));
+  EXPECT_FALSE(lock_mgr.LockShared(&txn1, rid, std::chrono::milliseconds(20)));
+  // the failed attempts must not have aborted the txn
+  EXPECT_EQ(txn1.GetState(), TransactionState::GROWING);
+
+  txn_mgr.Commit(&txn0);
+
+  // retry after the holder released
+  EXPECT_TRUE(lock_mgr.TryLockExclusive(&txn1, rid));
+  txn_mgr.Commit(&txn1);
+  EXPECT_EQ(txn1.GetState(), TransactionState::COMMITTED);
+}
+
+/*
+ * Once a txn exclusively locks LOCK_ESCALATION_THRESHOLD rows of a page
+ * it alone touches, the row locks must collapse into one page lock
+ */
+TEST(LockManagerTest, LockEscalationTest) {
+  LockManager lock_mgr{false};
+  TransactionManager txn_mgr{&lock_mgr};
+  Transaction txn(0);
+
+  for (int slot = 0; slot < LOCK_ESCALATION_THRESHOLD; slot++) {
+    EXPECT_TRUE(lock_mgr.LockExclusive(&txn, RID{1, slot}));
+  }
+
+  // row locks were traded for the single page lock
+  RID page_lock{1, LockManager::PAGE_LOCK_SLOT};
+  EXPECT_EQ(txn.GetExclusiveLockSet()->size(), 1u);
+  EXPECT_EQ(txn.GetExclusiveLockSet()->count(page_lock), 1u);
+
+  // further rows on the page are covered without new entries
+  EXPECT_TRUE(lock_mgr.LockExclusive(&txn, RID{1, 100}));
+  EXPECT_TRUE(lock_mgr.LockShared(&txn, RID{1, 101}));
+  EXPECT_EQ(txn.GetExclusiveLockSet()->size(), 1u);
+  EXPECT_TRUE(txn.GetSharedLockSet()->empty());
+
+  // another txn blocks on the page lock until commit releases it
+  std::thread t0([&] {
+    Transaction other(1);
+    bool res = lock_mgr.LockShared(&other, RID{1, 0});
+    // wait-die may abort the younger txn instead of letting it wait
+    if (res) {
+      EXPECT_EQ(other.GetState(), TransactionState::GROWING);
+      txn_mgr.Commit(&other);
+    } else {
+      EXPECT_EQ(other.GetState(), TransactionState::ABORTED);
+      txn_mgr.Abort(&other);
+    }
+  });
+
+  txn_mgr.Commit(&txn);
+  EXPECT_EQ(txn.GetState(), TransactionState::COMMITTED);
+  EXPECT_TRUE(txn.GetExclusiveLockSet()->empty());
+  t0.join();
+}
+
+/*
+ * In detection mode a younger waiter that does not form a cycle must be
+ * granted the lock once the holder releases, where wait-die would have
+ * aborted it immediately
+ */
+TEST(LockManagerTest, DeadlockDetectionWaitTest) {
+  LockManager lock_mgr{false, true};
+  TransactionManager txn_mgr{&lock_mgr};
+  RID rid{0, 0};
+
+  lock_mgr.RunDetectionThread();
+
+  Transaction txn0(0);
+  EXPECT_TRUE(lock_mgr.LockExclusive(&txn0, rid));
+
+  std::thread t0([&] {
+    Transaction txn(1);
+    // younger than the holder, wait-die would abort here
+    bool res = lock_mgr.LockShared(&txn, rid);
+    EXPECT_EQ(res, true);
+    EXPECT_EQ(txn.GetState(), TransactionState::GROWING);
+    txn_mgr.Commit(&txn);
+    EXPECT_EQ(txn.GetState(), TransactionState::COMMITTED);
+  });
+
+  // let the waiter block and give the detector a few passes over it
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  txn_mgr.Commit(&txn0);
+  EXPECT_EQ(txn0.GetState(), TransactionState::COMMITTED);
+
+  t0.join();
+  lock_mgr.StopDetectionThread();
+}
+
+/*
+ * Two transactions acquiring the same two tuples in opposite order form a
+ * genuine deadlock; the detector must abort exactly the younger one
+ */
+TEST(LockManagerTest, DeadlockDetectionVictimTest) {
+  LockManager lock_mgr{false, true};
+  TransactionManager txn_mgr{&lock_mgr};
+  RID rid0{0, 0};
+  RID rid1{0, 1};
+
+  lock_mgr.RunDetectionThread();
+
+  std::promise<void> lock0_promise;
+  std::shared_future<void> lock0_future = lock0_promise.get_future().share();
+  std::promise<void> lock1_promise;
+  std::shared_future<void> lock1_future = lock1_promise.get_future().share();
+
+  std::thread t0([&] {
+    Transaction txn(0);
+    EXPECT_TRUE(lock_mgr.LockExclusive(&txn, rid0));
+    lock0_promise.set_value();
+    lock1_future.wait();
+
+    // blocks until the detector aborts txn 1 and it releases rid1
+    bool res = lock_mgr.LockExclusive(&txn, rid1);
+    EXPECT_EQ(res, true);
+    EXPECT_EQ(txn.GetState(), TransactionState::GROWING);
+    txn_mgr.Commit(&txn);
+    EXPECT_EQ(txn.GetState(), TransactionState::COMMITTED);
+  });
+
+  std::thread t1([&] {
+    Transaction txn(1);
+    lock0_future.wait();
+    EXPECT_TRUE(lock_mgr.LockExclusive(&txn, rid1));
+    lock1_promise.set_value();
+
+    // closes the cycle; the younger txn is the victim
+    bool res = lock_mgr.LockExclusive(&txn, rid0);
+    EXPECT_EQ(res, false);
+    EXPECT_EQ(txn.GetState(), TransactionState::ABORTED);
+    txn_mgr.Abort(&txn);
+  });
+
+  t0.join();
+  t1.join();
+  lock_mgr.StopDetectionThread();
+}
+
+// a writer queued behind many readers is admitted exactly when the last
+// reader releases, and readers queued behind that writer are admitted
+// together when it releases; detection mode so nobody dies on age
+TEST(LockManagerTest, WaiterWakeupTest) {
+  LockManager lock_mgr{false, true};
+  TransactionManager txn_mgr{&lock_mgr};
+  RID rid{0, 0};
+  const int num_readers = 16;
+
+  std::vector<std::unique_ptr<Transaction>> readers;
+  for (int i = 0; i < num_readers; i++) {
+    readers.emplace_back(new Transaction(i + 1));
+    EXPECT_TRUE(lock_mgr.LockShared(readers.back().get(), rid));
+  }
+
+  std::atomic<bool> writer_granted{false};
+  std::promise<void> writer_release_promise;
+  std::shared_future<void> writer_release_future =
+      writer_release_promise.get_future().share();
+  std::thread writer([&] {
+    Transaction txn(0);
+    EXPECT_TRUE(lock_mgr.LockExclusive(&txn, rid));
+    writer_granted = true;
+    writer_release_future.wait();
+    EXPECT_TRUE(lock_mgr.Unlock(&txn, rid));
+  });
+
+  // all but one reader release: the writer must keep waiting
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  for (int i = 0; i < num_readers - 1; i++) {
+    EXPECT_TRUE(lock_mgr.Unlock(readers[i].get(), rid));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_FALSE(writer_granted);
+
+  // the last reader releases: the writer is woken and granted
+  EXPECT_TRUE(lock_mgr.Unlock(readers[num_readers - 1].get(), rid));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_TRUE(writer_granted);
+
+  // queue readers behind the writer, its release admits all of them
+  std::atomic<int> granted_readers{0};
+  std::vector<std::thread> late_readers;
+  for (int i = 0; i < 4; i++) {
+    late_readers.emplace_back([&, i] {
+      Transaction txn(100 + i);
+      EXPECT_TRUE(lock_mgr.LockShared(&txn, rid));
+      granted_readers++;
+      EXPECT_TRUE(lock_mgr.Unlock(&txn, rid));
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(granted_readers.load(), 0);
+  writer_release_promise.set_value();
+
+  writer.join();
+  for (auto &reader : late_readers) {
+    reader.join();
+  }
+  EXPECT_EQ(granted_readers.load(), 4);
+}
+
 } // namespace cmudb
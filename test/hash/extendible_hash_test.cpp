@@ -102,4 +102,49 @@ TEST(ExtendibleHashTest, ConcurrentRemoveTest) {
   }
 }
 
+// grow the directory well past one segment (4096 entries at bucket size
+// 1), so doubling goes through segment-pointer duplication and splits
+// through copy-on-write segment clones; every key must stay reachable
+TEST(ExtendibleHashTest, SegmentedGrowthTest) {
+  const int num_keys = 4096;
+  ExtendibleHash<int, int> test(1);
+
+  for (int i = 0; i < num_keys; i++) {
+    test.Insert(i, i * 3);
+  }
+  EXPECT_GE(test.GetGlobalDepth(), 12);
+
+  int val;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(test.Find(i, val));
+    EXPECT_EQ(val, i * 3);
+  }
+  EXPECT_FALSE(test.Find(num_keys, val));
+
+  for (int i = 0; i < num_keys; i += 2) {
+    EXPECT_TRUE(test.Remove(i));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_EQ(test.Find(i, val), i % 2 == 1);
+  }
+}
+
+// the hash function is a template parameter; the integer mixer variant
+// behaves identically, only the bucket addressing changes
+TEST(ExtendibleHashTest, CustomHasherTest) {
+  ExtendibleHash<int, int, IntegerMixHash> test(2);
+
+  for (int i = 0; i < 100; i++) {
+    test.Insert(i, i + 1000);
+  }
+  int val;
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(test.Find(i, val));
+    EXPECT_EQ(val, i + 1000);
+  }
+  EXPECT_FALSE(test.Find(100, val));
+  EXPECT_TRUE(test.Remove(42));
+  EXPECT_FALSE(test.Find(42, val));
+}
+
 } // namespace cmudb
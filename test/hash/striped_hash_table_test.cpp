@@ -0,0 +1,73 @@
+/**
+ * striped_hash_table_test.cpp
+ */
+
+#include <memory>
+#include <thread>
+
+#include "hash/striped_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(StripedHashTableTest, SampleTest) {
+  StripedHashTable<int, std::string> *test =
+      new StripedHashTable<int, std::string>(4);
+  EXPECT_EQ(4, test->GetNumStripes());
+
+  // insert several key/value pairs
+  for (int i = 1; i <= 9; ++i) {
+    test->Insert(i, std::string(1, 'a' + i - 1));
+  }
+
+  // find test
+  std::string result;
+  test->Find(9, result);
+  EXPECT_EQ("i", result);
+  test->Find(2, result);
+  EXPECT_EQ("b", result);
+  EXPECT_EQ(0, test->Find(10, result));
+
+  // overwrite test
+  test->Insert(2, "z");
+  test->Find(2, result);
+  EXPECT_EQ("z", result);
+
+  // delete test
+  EXPECT_EQ(1, test->Remove(8));
+  EXPECT_EQ(1, test->Remove(4));
+  EXPECT_EQ(0, test->Remove(20));
+  EXPECT_EQ(0, test->Find(8, result));
+
+  delete test;
+}
+
+TEST(StripedHashTableTest, ConcurrentInsertFindTest) {
+  const int num_runs = 50;
+  const int num_threads = 4;
+  // Run concurrent test multiple times to guarantee correctness.
+  for (int run = 0; run < num_runs; run++) {
+    std::shared_ptr<StripedHashTable<int, int>> test{
+        new StripedHashTable<int, int>(4)};
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.push_back(std::thread([tid, &test]() {
+        for (int i = 0; i < 20; ++i) {
+          test->Insert(tid * 100 + i, tid);
+        }
+      }));
+    }
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads[tid].join();
+    }
+    for (int tid = 0; tid < num_threads; tid++) {
+      for (int i = 0; i < 20; ++i) {
+        int val;
+        EXPECT_EQ(1, test->Find(tid * 100 + i, val));
+        EXPECT_EQ(tid, val);
+      }
+    }
+  }
+}
+
+} // namespace cmudb
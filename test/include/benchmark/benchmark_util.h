@@ -0,0 +1,49 @@
+/**
+ * benchmark_util.h
+ *
+ * Shared helpers for the per-component microbenchmarks: wall-clock timing,
+ * a thread fan-out that starts all workers on a shared barrier, and a
+ * one-line throughput report so the binaries print comparable output.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cmudb {
+
+// run num_threads copies of fn(thread_id), released together, and return
+// the wall-clock seconds from release to the last join
+inline double RunThreads(int num_threads,
+                         const std::function<void(int)> &fn) {
+  std::atomic<bool> start_flag(false);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      while (!start_flag.load(std::memory_order_acquire)) {
+      }
+      fn(t);
+    });
+  }
+  auto start = std::chrono::steady_clock::now();
+  start_flag.store(true, std::memory_order_release);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(end - start).count();
+}
+
+inline void ReportThroughput(const std::string &name, int num_threads,
+                             long total_ops, double secs) {
+  std::printf("%-40s threads=%-2d %10.0f ops/s  (%.1f ns/op)\n", name.c_str(),
+              num_threads, total_ops / secs, secs * 1e9 / total_ops);
+}
+
+} // namespace cmudb
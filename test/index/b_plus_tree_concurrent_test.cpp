@@ -348,4 +348,67 @@ TEST(BPlusTreeConcurrentTest, MixTest) {
   remove("test.log");
 }
 
+// helper function for latch-free reads: GetValue without a transaction takes
+// the optimistic descent, so every key it does find must carry the value the
+// writer stored
+void ReadHelper(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> &tree,
+                const std::vector<int64_t> &keys, int rounds,
+                __attribute__((unused)) uint64_t thread_itr = 0) {
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (int round = 0; round < rounds; round++) {
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      if (tree.GetValue(index_key, rids)) {
+        EXPECT_EQ(rids[0].GetSlotNum(), key & 0xFFFFFFFF);
+      }
+    }
+  }
+}
+
+TEST(BPlusTreeConcurrentTest, OptimisticReadTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void)header_page;
+  // keys to Insert
+  std::vector<int64_t> keys;
+  int64_t scale_factor = 1000;
+  for (int64_t key = 1; key < scale_factor; key++) {
+    keys.push_back(key);
+  }
+
+  // readers race the writer; reads before a key is inserted simply miss,
+  // reads after it must see the stored value
+  std::thread writer(InsertHelper, std::ref(tree), keys, 0);
+  LaunchParallelTest(4, ReadHelper, std::ref(tree), keys, 10);
+  writer.join();
+
+  std::vector<RID> rids;
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, rids));
+    EXPECT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), key & 0xFFFFFFFF);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 } // namespace cmudb
@@ -0,0 +1,144 @@
+/**
+ * b_plus_tree_index_test.cpp
+ */
+
+#include <cstdio>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "index/b_plus_tree_index.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+// index-only scans must hand back the indexed column values along with the
+// rids, reconstructed from the stored keys without touching any heap page
+TEST(BPlusTreeIndexTests, IndexOnlyScanTest) {
+  Schema *tuple_schema = ParseCreateStatement("a bigint, b int");
+  IndexMetadata *metadata =
+      new IndexMetadata("foo_pk", "foo", tuple_schema, {0});
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void)header_page;
+
+  BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> index(metadata,
+                                                                 bpm);
+  Schema *key_schema = index.GetKeySchema();
+
+  for (int64_t key = 1; key <= 100; key++) {
+    std::vector<Value> key_values{Value(TypeId::BIGINT, key)};
+    Tuple key_tuple(key_values, key_schema);
+    index.InsertEntry(key_tuple, RID(0, (int32_t)key));
+  }
+
+  // point scan: one match, carrying the probe key's value
+  std::vector<RID> rids;
+  std::vector<std::vector<Value>> values;
+  std::vector<Value> probe_values{Value(TypeId::BIGINT, (int64_t)42)};
+  Tuple probe(probe_values, key_schema);
+  EXPECT_TRUE(index.ScanKeyIndexOnly(probe, rids, values));
+  ASSERT_EQ(rids.size(), 1);
+  ASSERT_EQ(values.size(), 1);
+  EXPECT_EQ(rids[0].GetSlotNum(), 42);
+  EXPECT_EQ(values[0][0].GetAs<int64_t>(), 42);
+
+  // range scan over [10, 20]: values come back in key order, one vector
+  // of column values per rid
+  rids.clear();
+  values.clear();
+  std::vector<Value> low_values{Value(TypeId::BIGINT, (int64_t)10)};
+  std::vector<Value> high_values{Value(TypeId::BIGINT, (int64_t)20)};
+  Tuple low(low_values, key_schema);
+  Tuple high(high_values, key_schema);
+  EXPECT_TRUE(index.ScanRangeIndexOnly(&low, &high, true, true, rids, values));
+  ASSERT_EQ(rids.size(), 11);
+  ASSERT_EQ(values.size(), 11);
+  for (size_t i = 0; i < rids.size(); i++) {
+    EXPECT_EQ(rids[i].GetSlotNum(), (int64_t)(10 + i));
+    EXPECT_EQ(values[i][0].GetAs<int64_t>(), (int64_t)(10 + i));
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// the bloom filter sidecar must be seeded from pre-existing entries, stay
+// current across inserts and deletes, and never hide a present key
+TEST(BPlusTreeIndexTests, BloomFilterTest) {
+  Schema *tuple_schema = ParseCreateStatement("a bigint, b int");
+  IndexMetadata *metadata =
+      new IndexMetadata("foo_pk", "foo", tuple_schema, {0});
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void)header_page;
+
+  BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> index(metadata,
+                                                                 bpm);
+  Schema *key_schema = index.GetKeySchema();
+
+  auto make_key = [&](int64_t key) {
+    std::vector<Value> key_values{Value(TypeId::BIGINT, key)};
+    return Tuple(key_values, key_schema);
+  };
+
+  // entries inserted before the filter exists must be seeded on enable
+  for (int64_t key = 1; key <= 50; key++) {
+    index.InsertEntry(make_key(key), RID(0, (int32_t)key));
+  }
+  index.EnableBloomFilter(1000);
+  // entries inserted afterwards are tracked incrementally
+  for (int64_t key = 51; key <= 100; key++) {
+    index.InsertEntry(make_key(key), RID(0, (int32_t)key));
+  }
+
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= 100; key++) {
+    rids.clear();
+    index.ScanKey(make_key(key), rids);
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+
+  // misses: keys never inserted must come back empty (whether the filter
+  // short-circuits or the descent runs is invisible here, but both paths
+  // must agree on the answer)
+  for (int64_t key = 101; key <= 200; key++) {
+    rids.clear();
+    index.ScanKey(make_key(key), rids);
+    EXPECT_EQ(rids.size(), 0);
+  }
+
+  // a deleted key misses, its neighbours still hit
+  index.DeleteEntry(make_key(42));
+  rids.clear();
+  index.ScanKey(make_key(42), rids);
+  EXPECT_EQ(rids.size(), 0);
+  rids.clear();
+  index.ScanKey(make_key(41), rids);
+  EXPECT_EQ(rids.size(), 1);
+  // deleting an absent key must not disturb present ones
+  index.DeleteEntry(make_key(42));
+  rids.clear();
+  index.ScanKey(make_key(43), rids);
+  EXPECT_EQ(rids.size(), 1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace cmudb
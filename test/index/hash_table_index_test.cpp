@@ -0,0 +1,121 @@
+/**
+ * hash_table_index_test.cpp
+ */
+
+#include <cstdio>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "index/disk_extendible_hash.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(DiskExtendibleHashTests, InsertScanDeleteTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(30, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void)header_page;
+  // create hash table
+  DiskExtendibleHash<GenericKey<8>, RID, GenericComparator<8>> hash_table(
+      "hash_foo_pk", bpm, comparator);
+  GenericKey<8> index_key;
+  RID rid;
+
+  // enough keys to double the directory, split buckets and spill into
+  // overflow chains
+  int64_t scale = 2000;
+  for (int64_t key = 1; key <= scale; key++) {
+    int64_t value = key & 0xFFFFFFFF;
+    rid.Set((int32_t)(key >> 32), value);
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(hash_table.Insert(index_key, rid));
+  }
+
+  // duplicate keys are rejected
+  index_key.SetFromInteger(1);
+  rid.Set(0, 1);
+  EXPECT_FALSE(hash_table.Insert(index_key, rid));
+
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= scale; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(hash_table.GetValue(index_key, rids));
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+
+  // remove the odd keys, the even ones must survive
+  for (int64_t key = 1; key <= scale; key += 2) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(hash_table.Remove(index_key));
+  }
+  for (int64_t key = 1; key <= scale; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(hash_table.GetValue(index_key, rids), key % 2 == 0);
+  }
+  // removing a missing key reports it
+  index_key.SetFromInteger(1);
+  EXPECT_FALSE(hash_table.Remove(index_key));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskExtendibleHashTests, ReopenTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(30, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void)header_page;
+
+  GenericKey<8> index_key;
+  RID rid;
+  page_id_t header_page_id;
+  {
+    DiskExtendibleHash<GenericKey<8>, RID, GenericComparator<8>> hash_table(
+        "hash_foo_pk", bpm, comparator);
+    for (int64_t key = 1; key <= 100; key++) {
+      int64_t value = key & 0xFFFFFFFF;
+      rid.Set((int32_t)(key >> 32), value);
+      index_key.SetFromInteger(key);
+      hash_table.Insert(index_key, rid);
+    }
+    header_page_id = hash_table.GetHeaderPageId();
+  }
+
+  // reconstruct from the recorded directory page id, like VtabConnect does
+  DiskExtendibleHash<GenericKey<8>, RID, GenericComparator<8>> reopened(
+      "hash_foo_pk", bpm, comparator, header_page_id);
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= 100; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(reopened.GetValue(index_key, rids));
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace cmudb
@@ -0,0 +1,105 @@
+#include <cstdio>
+#include <vector>
+
+#include "logging/backup_manager.h"
+#include "logging/common.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+// full backup while the engine runs, more traffic, an incremental delta,
+// then the overlaid image serves every row under a fresh engine
+TEST(BackupManagerTest, FullAndIncrementalBackupTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+
+  EXPECT_FALSE(ENABLE_LOGGING);
+  storage_engine->log_manager_->RunFlushThread();
+  EXPECT_TRUE(ENABLE_LOGGING);
+
+  Transaction *txn = storage_engine->transaction_manager_->Begin();
+  TableHeap *table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                   storage_engine->lock_manager_,
+                                   storage_engine->log_manager_, txn);
+  page_id_t first_page_id = table->GetFirstPageId();
+
+  std::string createStmt =
+      "a varchar, b smallint, c bigint, d bool, e varchar(16)";
+  Schema *schema = ParseCreateStatement(createStmt);
+
+  std::vector<RID> rids;
+  std::vector<Value> vals;
+  for (int i = 0; i < 5; i++) {
+    Tuple tuple = ConstructTuple(schema);
+    RID rid;
+    EXPECT_TRUE(table->InsertTuple(tuple, rid, txn));
+    rids.push_back(rid);
+    vals.push_back(tuple.GetValue(schema, 4));
+  }
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+
+  BackupManager backup_manager(storage_engine->disk_manager_,
+                               storage_engine->buffer_pool_manager_,
+                               storage_engine->log_manager_);
+  EXPECT_EQ(backup_manager.GetLastBackupLSN(), INVALID_LSN);
+  // an incremental needs a full backup first
+  EXPECT_EQ(backup_manager.TakeIncrementalBackup("backup.delta"), INVALID_LSN);
+
+  lsn_t full_lsn = backup_manager.TakeFullBackup("backup.db");
+  EXPECT_NE(full_lsn, INVALID_LSN);
+  EXPECT_EQ(backup_manager.GetLastBackupLSN(), full_lsn);
+  EXPECT_EQ(BackupManager::ReadBackupLSN("backup.db"), full_lsn);
+
+  // traffic after the full backup lands in the incremental delta
+  txn = storage_engine->transaction_manager_->Begin();
+  for (int i = 0; i < 5; i++) {
+    Tuple tuple = ConstructTuple(schema);
+    RID rid;
+    EXPECT_TRUE(table->InsertTuple(tuple, rid, txn));
+    rids.push_back(rid);
+    vals.push_back(tuple.GetValue(schema, 4));
+  }
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+
+  lsn_t delta_lsn = backup_manager.TakeIncrementalBackup("backup.delta");
+  EXPECT_GT(delta_lsn, full_lsn);
+
+  storage_engine->log_manager_->StopFlushThread();
+  EXPECT_FALSE(ENABLE_LOGGING);
+
+  EXPECT_TRUE(BackupManager::ApplyIncrementalBackup("backup.db",
+                                                    "backup.delta"));
+  EXPECT_EQ(BackupManager::ReadBackupLSN("backup.db"), delta_lsn);
+
+  // the overlaid image is a database file; every row is there
+  StorageEngine *restored = new StorageEngine("backup.db");
+  TableHeap *restored_table =
+      new TableHeap(restored->buffer_pool_manager_, restored->lock_manager_,
+                    restored->log_manager_, first_page_id);
+  txn = restored->transaction_manager_->Begin();
+  for (size_t i = 0; i < rids.size(); i++) {
+    Tuple tuple;
+    EXPECT_TRUE(restored_table->GetTuple(rids[i], tuple, txn));
+    EXPECT_EQ(tuple.GetValue(schema, 4).CompareEquals(vals[i]), 1);
+  }
+  restored->transaction_manager_->Commit(txn);
+  delete txn;
+
+  delete restored_table;
+  delete table;
+  delete restored;
+  delete storage_engine;
+  remove("test.db");
+  remove("test.log");
+  remove("test.cln");
+  remove("backup.db");
+  remove("backup.db.lsn");
+  remove("backup.delta");
+  remove("backup.delta.lsn");
+  remove("backup.log");
+  remove("backup.cln");
+}
+
+} // namespace cmudb
@@ -2,6 +2,7 @@
 #include <cstdio>
 #include <cstdlib>
 
+#include "logging/checkpoint_manager.h"
 #include "logging/common.h"
 #include "logging/log_recovery.h"
 #include "vtable/virtual_table.h"
@@ -124,4 +125,484 @@ TEST(LogManagerTest, RedoTestWithOneTxn) {
   remove("test.log");
 }
 
+// updates are logged as byte deltas; both the redo of a committed update
+// and the undo of an uncommitted one must rebuild the full images
+TEST(LogManagerTest, UpdateDeltaRecoveryTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+
+  EXPECT_FALSE(ENABLE_LOGGING);
+  storage_engine->log_manager_->RunFlushThread();
+  EXPECT_TRUE(ENABLE_LOGGING);
+
+  Transaction *txn = storage_engine->transaction_manager_->Begin();
+  TableHeap *test_table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                        storage_engine->lock_manager_,
+                                        storage_engine->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+
+  Schema *schema = ParseCreateStatement("a bigint, b varchar");
+  std::vector<Value> v0{Value(TypeId::BIGINT, (int64_t)1),
+                        Value(TypeId::VARCHAR, std::string("aaaaaaaa"))};
+  std::vector<Value> v1{Value(TypeId::BIGINT, (int64_t)1),
+                        Value(TypeId::VARCHAR, std::string("bbbbaaaa"))};
+  std::vector<Value> v2{Value(TypeId::BIGINT, (int64_t)1),
+                        Value(TypeId::VARCHAR, std::string("ccccaaaa"))};
+
+  RID rid;
+  EXPECT_TRUE(test_table->InsertTuple(Tuple(v0, schema), rid, txn));
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+
+  // committed update: must be redone
+  txn = storage_engine->transaction_manager_->Begin();
+  EXPECT_TRUE(test_table->UpdateTuple(Tuple(v1, schema), rid, txn));
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+
+  // uncommitted update: must be undone back to the committed image
+  txn = storage_engine->transaction_manager_->Begin();
+  EXPECT_TRUE(test_table->UpdateTuple(Tuple(v2, schema), rid, txn));
+  delete txn;
+  delete test_table;
+
+  // let the periodic flush pick up the dangling update record
+  std::this_thread::sleep_for(LOG_TIMEOUT + std::chrono::seconds(1));
+
+  // shutdown and recover
+  delete storage_engine;
+  storage_engine = new StorageEngine("test.db");
+  LogRecovery *log_recovery = new LogRecovery(
+      storage_engine->disk_manager_, storage_engine->buffer_pool_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+
+  Tuple recovered;
+  txn = storage_engine->transaction_manager_->Begin();
+  test_table = new TableHeap(storage_engine->buffer_pool_manager_,
+                             storage_engine->lock_manager_,
+                             storage_engine->log_manager_, first_page_id);
+  EXPECT_EQ(test_table->GetTuple(rid, recovered, txn), 1);
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+  delete test_table;
+  delete log_recovery;
+
+  EXPECT_EQ(recovered.GetValue(schema, 1).CompareEquals(
+                Value(TypeId::VARCHAR, std::string("bbbbaaaa"))),
+            1);
+
+  delete storage_engine;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(LogManagerTest, AsyncCommitTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+
+  EXPECT_FALSE(ENABLE_LOGGING);
+  storage_engine->log_manager_->RunFlushThread();
+  EXPECT_TRUE(ENABLE_LOGGING);
+
+  LOG_DEBUG("Create a test table");
+  Transaction *txn = storage_engine->transaction_manager_->Begin();
+  TableHeap *test_table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                        storage_engine->lock_manager_,
+                                        storage_engine->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+
+  std::string createStmt =
+      "a varchar, b smallint, c bigint, d bool, e varchar(16)";
+  Schema *schema = ParseCreateStatement(createStmt);
+
+  RID rid;
+  Tuple tuple = ConstructTuple(schema);
+  auto val = tuple.GetValue(schema, 4);
+  EXPECT_TRUE(test_table->InsertTuple(tuple, rid, txn));
+
+  // relaxed durability: commit returns without waiting on the log
+  txn->SetDurabilityLevel(DurabilityLevel::ASYNC);
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+  delete test_table;
+  LOG_DEBUG("Commit txn without waiting for the flush");
+
+  // the periodic LOG_TIMEOUT flush picks the commit record up
+  std::this_thread::sleep_for(LOG_TIMEOUT + std::chrono::seconds(1));
+
+  // shutdown and recover like the redo test
+  delete storage_engine;
+  storage_engine = new StorageEngine("test.db");
+  LogRecovery *log_recovery = new LogRecovery(
+      storage_engine->disk_manager_, storage_engine->buffer_pool_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+
+  Tuple old_tuple;
+  txn = storage_engine->transaction_manager_->Begin();
+  test_table = new TableHeap(storage_engine->buffer_pool_manager_,
+                             storage_engine->lock_manager_,
+                             storage_engine->log_manager_, first_page_id);
+  EXPECT_EQ(test_table->GetTuple(rid, old_tuple, txn), 1);
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+  delete test_table;
+
+  EXPECT_EQ(old_tuple.GetValue(schema, 4).CompareEquals(val), 1);
+
+  delete storage_engine;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(LogManagerTest, CheckpointTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+
+  EXPECT_FALSE(ENABLE_LOGGING);
+  storage_engine->log_manager_->RunFlushThread();
+  EXPECT_TRUE(ENABLE_LOGGING);
+
+  Transaction *txn = storage_engine->transaction_manager_->Begin();
+  TableHeap *test_table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                        storage_engine->lock_manager_,
+                                        storage_engine->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+
+  std::string createStmt =
+      "a varchar, b smallint, c bigint, d bool, e varchar(16)";
+  Schema *schema = ParseCreateStatement(createStmt);
+
+  RID rid;
+  Tuple tuple = ConstructTuple(schema);
+  auto val = tuple.GetValue(schema, 4);
+  EXPECT_TRUE(test_table->InsertTuple(tuple, rid, txn));
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+  delete test_table;
+
+  // no transaction is active, so the checkpoint must succeed and record a
+  // redo start point past the records above
+  CheckpointManager checkpoint_manager(
+      storage_engine->disk_manager_, storage_engine->buffer_pool_manager_,
+      storage_engine->log_manager_, storage_engine->transaction_manager_);
+  EXPECT_TRUE(checkpoint_manager.TakeCheckpoint());
+  EXPECT_GT(storage_engine->disk_manager_->GetCheckpointOffset(), 0);
+
+  // a transaction in flight makes the next attempt fail
+  txn = storage_engine->transaction_manager_->Begin();
+  EXPECT_FALSE(checkpoint_manager.TakeCheckpoint());
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+
+  // shutdown and restart: redo starts at the checkpoint, and the tuple
+  // made durable by it is still there
+  delete storage_engine;
+  storage_engine = new StorageEngine("test.db");
+  LogRecovery *log_recovery = new LogRecovery(
+      storage_engine->disk_manager_, storage_engine->buffer_pool_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+
+  Tuple old_tuple;
+  txn = storage_engine->transaction_manager_->Begin();
+  test_table = new TableHeap(storage_engine->buffer_pool_manager_,
+                             storage_engine->lock_manager_,
+                             storage_engine->log_manager_, first_page_id);
+  EXPECT_EQ(test_table->GetTuple(rid, old_tuple, txn), 1);
+  storage_engine->transaction_manager_->Commit(txn);
+  EXPECT_EQ(old_tuple.GetValue(schema, 4).CompareEquals(val), 1);
+  delete txn;
+  delete test_table;
+  delete log_recovery;
+  delete schema;
+
+  delete storage_engine;
+  remove("test.db");
+  remove("test.log");
+}
+
+// a truncate survives a crash through its single TRUNCATE record: redo
+// replays the wipe instead of thousands of per-row deletes
+TEST(LogManagerTest, TruncateRecoveryTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+
+  EXPECT_FALSE(ENABLE_LOGGING);
+  storage_engine->log_manager_->RunFlushThread();
+  EXPECT_TRUE(ENABLE_LOGGING);
+
+  Transaction *txn = storage_engine->transaction_manager_->Begin();
+  TableHeap *test_table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                        storage_engine->lock_manager_,
+                                        storage_engine->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+
+  std::string createStmt =
+      "a varchar, b smallint, c bigint, d bool, e varchar(16)";
+  Schema *schema = ParseCreateStatement(createStmt);
+
+  RID rid;
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(test_table->InsertTuple(ConstructTuple(schema), rid, txn));
+  }
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+
+  // checkpoint so redo starts just before the truncate
+  CheckpointManager checkpoint_manager(
+      storage_engine->disk_manager_, storage_engine->buffer_pool_manager_,
+      storage_engine->log_manager_, storage_engine->transaction_manager_);
+  EXPECT_TRUE(checkpoint_manager.TakeCheckpoint());
+
+  txn = storage_engine->transaction_manager_->Begin();
+  EXPECT_GT(test_table->Truncate(txn), 0);
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+  delete test_table;
+
+  // crash without flushing and restart
+  delete storage_engine;
+  storage_engine = new StorageEngine("test.db");
+  LogRecovery *log_recovery = new LogRecovery(
+      storage_engine->disk_manager_, storage_engine->buffer_pool_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+
+  txn = storage_engine->transaction_manager_->Begin();
+  test_table = new TableHeap(storage_engine->buffer_pool_manager_,
+                             storage_engine->lock_manager_,
+                             storage_engine->log_manager_, first_page_id);
+  size_t count = 0;
+  for (TableIterator itr = test_table->begin(txn); itr != test_table->end();
+       ++itr) {
+    ++count;
+  }
+  EXPECT_EQ(count, (size_t)0);
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+  delete test_table;
+  delete log_recovery;
+  delete schema;
+  delete storage_engine;
+
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(LogManagerTest, CleanShutdownTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+
+  EXPECT_FALSE(ENABLE_LOGGING);
+  storage_engine->log_manager_->RunFlushThread();
+  EXPECT_TRUE(ENABLE_LOGGING);
+
+  // a run that was not preceded by a clean stop carries no marker
+  EXPECT_FALSE(storage_engine->disk_manager_->WasCleanShutdown());
+
+  Transaction *txn = storage_engine->transaction_manager_->Begin();
+  TableHeap *test_table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                        storage_engine->lock_manager_,
+                                        storage_engine->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+
+  std::string createStmt =
+      "a varchar, b smallint, c bigint, d bool, e varchar(16)";
+  Schema *schema = ParseCreateStatement(createStmt);
+
+  RID rid;
+  Tuple tuple = ConstructTuple(schema);
+  auto val = tuple.GetValue(schema, 4);
+  EXPECT_TRUE(test_table->InsertTuple(tuple, rid, txn));
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+  delete test_table;
+
+  // graceful stop: final checkpoint plus the clean-shutdown marker
+  CheckpointManager checkpoint_manager(
+      storage_engine->disk_manager_, storage_engine->buffer_pool_manager_,
+      storage_engine->log_manager_, storage_engine->transaction_manager_);
+  EXPECT_TRUE(checkpoint_manager.ShutdownCheckpoint());
+  delete storage_engine;
+
+  // the restart consumes the marker and recovery skips the log scan, yet
+  // the committed tuple is already durable in the pages
+  storage_engine = new StorageEngine("test.db");
+  EXPECT_TRUE(storage_engine->disk_manager_->WasCleanShutdown());
+  LogRecovery *log_recovery = new LogRecovery(
+      storage_engine->disk_manager_, storage_engine->buffer_pool_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+
+  Tuple old_tuple;
+  txn = storage_engine->transaction_manager_->Begin();
+  test_table = new TableHeap(storage_engine->buffer_pool_manager_,
+                             storage_engine->lock_manager_,
+                             storage_engine->log_manager_, first_page_id);
+  EXPECT_EQ(test_table->GetTuple(rid, old_tuple, txn), 1);
+  storage_engine->transaction_manager_->Commit(txn);
+  EXPECT_EQ(old_tuple.GetValue(schema, 4).CompareEquals(val), 1);
+  delete txn;
+  delete test_table;
+  delete log_recovery;
+  delete schema;
+  delete storage_engine;
+
+  // the marker was consumed: a third start without another clean stop in
+  // between must run recovery as usual
+  storage_engine = new StorageEngine("test.db");
+  EXPECT_FALSE(storage_engine->disk_manager_->WasCleanShutdown());
+  delete storage_engine;
+
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(LogManagerTest, ReadOnlyTransactionTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+
+  EXPECT_FALSE(ENABLE_LOGGING);
+  storage_engine->log_manager_->RunFlushThread();
+  EXPECT_TRUE(ENABLE_LOGGING);
+
+  Transaction *txn = storage_engine->transaction_manager_->Begin();
+  TableHeap *test_table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                        storage_engine->lock_manager_,
+                                        storage_engine->log_manager_, txn);
+
+  std::string createStmt =
+      "a varchar, b smallint, c bigint, d bool, e varchar(16)";
+  Schema *schema = ParseCreateStatement(createStmt);
+
+  RID rid;
+  Tuple tuple = ConstructTuple(schema);
+  auto val = tuple.GetValue(schema, 4);
+  EXPECT_TRUE(test_table->InsertTuple(tuple, rid, txn));
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+
+  // a read-only transaction reads committed tuples without ever touching
+  // the lock manager
+  Transaction *reader = storage_engine->transaction_manager_->Begin(true);
+  EXPECT_TRUE(reader->IsReadOnly());
+  Tuple read_tuple;
+  EXPECT_TRUE(test_table->GetTuple(rid, read_tuple, reader));
+  EXPECT_EQ(read_tuple.GetValue(schema, 4).CompareEquals(val), 1);
+  EXPECT_TRUE(reader->GetSharedLockSet()->empty());
+
+  // writes through a read-only transaction are rejected
+  RID insert_rid;
+  EXPECT_FALSE(test_table->InsertTuple(tuple, insert_rid, reader));
+  EXPECT_EQ(reader->GetState(), TransactionState::ABORTED);
+  storage_engine->transaction_manager_->Abort(reader);
+  delete reader;
+
+  storage_engine->log_manager_->StopFlushThread();
+  delete test_table;
+  delete schema;
+  delete storage_engine;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(LogManagerTest, SnapshotReadTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+
+  EXPECT_FALSE(ENABLE_LOGGING);
+  storage_engine->log_manager_->RunFlushThread();
+  EXPECT_TRUE(ENABLE_LOGGING);
+
+  VersionManager *version_manager =
+      storage_engine->transaction_manager_->GetVersionManager();
+  Transaction *txn = storage_engine->transaction_manager_->Begin();
+  TableHeap *test_table = new TableHeap(
+      storage_engine->buffer_pool_manager_, storage_engine->lock_manager_,
+      storage_engine->log_manager_, txn, version_manager);
+
+  std::string createStmt =
+      "a varchar, b smallint, c bigint, d bool, e varchar(16)";
+  Schema *schema = ParseCreateStatement(createStmt);
+
+  RID rid;
+  Tuple tuple = ConstructTuple(schema);
+  auto val = tuple.GetValue(schema, 4);
+  EXPECT_TRUE(test_table->InsertTuple(tuple, rid, txn));
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+
+  // this reader's snapshot predates the delete below
+  Transaction *reader = storage_engine->transaction_manager_->Begin(true);
+
+  // delete the tuple and insert a new one in a later transaction
+  Transaction *writer = storage_engine->transaction_manager_->Begin();
+  EXPECT_TRUE(test_table->MarkDelete(rid, writer));
+  RID new_rid;
+  Tuple new_tuple = ConstructTuple(schema);
+  auto new_val = new_tuple.GetValue(schema, 4);
+  EXPECT_TRUE(test_table->InsertTuple(new_tuple, new_rid, writer));
+  storage_engine->transaction_manager_->Commit(writer);
+  delete writer;
+
+  // the old reader still sees the deleted tuple and not the new one
+  Tuple read_tuple;
+  EXPECT_TRUE(test_table->GetTuple(rid, read_tuple, reader));
+  EXPECT_EQ(read_tuple.GetValue(schema, 4).CompareEquals(val), 1);
+  EXPECT_FALSE(test_table->GetTuple(new_rid, read_tuple, reader));
+  EXPECT_NE(reader->GetState(), TransactionState::ABORTED);
+
+  // a reader begun after the commit sees the new state of both rids
+  Transaction *late_reader = storage_engine->transaction_manager_->Begin(true);
+  EXPECT_FALSE(test_table->GetTuple(rid, read_tuple, late_reader));
+  EXPECT_TRUE(test_table->GetTuple(new_rid, read_tuple, late_reader));
+  EXPECT_EQ(read_tuple.GetValue(schema, 4).CompareEquals(new_val), 1);
+  storage_engine->transaction_manager_->Commit(late_reader);
+  delete late_reader;
+
+  storage_engine->transaction_manager_->Commit(reader);
+  delete reader;
+
+  storage_engine->log_manager_->StopFlushThread();
+  delete test_table;
+  delete schema;
+  delete storage_engine;
+  remove("test.db");
+  remove("test.log");
+}
+
+// sustained commit traffic must pull the adaptive flush cadence below the
+// configured LOG_TIMEOUT instead of letting commits wait out the full timer
+TEST(LogManagerTest, AdaptiveFlushTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+
+  // idle cadence starts at the configured timeout
+  EXPECT_EQ(storage_engine->log_manager_->GetEffectiveFlushLatency(),
+            std::chrono::duration_cast<std::chrono::microseconds>(LOG_TIMEOUT));
+
+  Transaction *txn = storage_engine->transaction_manager_->Begin();
+  TableHeap *test_table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                        storage_engine->lock_manager_,
+                                        storage_engine->log_manager_, txn);
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+
+  Schema *schema = ParseCreateStatement("a bigint, b varchar");
+  for (int i = 0; i < 20; i++) {
+    Transaction *writer = storage_engine->transaction_manager_->Begin();
+    RID rid;
+    Tuple tuple = ConstructTuple(schema);
+    EXPECT_TRUE(test_table->InsertTuple(tuple, rid, writer));
+    storage_engine->transaction_manager_->Commit(writer);
+    delete writer;
+  }
+
+  // every commit forced a flush round, so the cadence must have shrunk
+  EXPECT_LT(storage_engine->log_manager_->GetEffectiveFlushLatency(),
+            std::chrono::duration_cast<std::chrono::microseconds>(LOG_TIMEOUT));
+
+  storage_engine->log_manager_->StopFlushThread();
+  delete test_table;
+  delete schema;
+  delete storage_engine;
+  remove("test.db");
+  remove("test.log");
+}
+
 } // namespace cmudb
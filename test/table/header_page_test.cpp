@@ -2,11 +2,12 @@
 #include <cstdlib>
 
 #include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
 #include "page/header_page.h"
 #include "gtest/gtest.h"
 
-// NOTE: when you running this test, make sure page size(config.h) is at least
-// 4096
+// NOTE: 27 records exceed a single 512 byte header page (14 records each),
+// so this also exercises the chained overflow pages behind the catalog
 namespace cmudb {
 
 TEST(HeaderPageTest, UnitTest) {
@@ -17,38 +18,46 @@ TEST(HeaderPageTest, UnitTest) {
   HeaderPage *page =
       static_cast<HeaderPage *>(buffer_pool_manager->NewPage(header_page_id));
   ASSERT_NE(nullptr, page);
+  ASSERT_EQ(header_page_id, HEADER_PAGE_ID);
   page->Init();
+  buffer_pool_manager->UnpinPage(header_page_id, true);
+
+  Catalog catalog(buffer_pool_manager);
 
   for (int i = 1; i < 28; i++) {
     std::string name = std::to_string(i);
-    EXPECT_EQ(page->InsertRecord(name, i), true);
+    EXPECT_EQ(catalog.InsertRecord(name, i), true);
   }
 
   for (int i = 27; i >= 1; i--) {
     std::string name = std::to_string(i);
     page_id_t root_id;
-    EXPECT_EQ(page->GetRootId(name, root_id), true);
-    // std::cout << "root page id is " << root_id << '\n';
+    EXPECT_EQ(catalog.GetRootId(name, root_id), true);
+    EXPECT_EQ(root_id, i);
   }
 
   for (int i = 1; i < 28; i++) {
     std::string name = std::to_string(i);
-    EXPECT_EQ(page->UpdateRecord(name, i + 10), true);
+    EXPECT_EQ(catalog.UpdateRecord(name, i + 10), true);
   }
 
   for (int i = 27; i >= 1; i--) {
     std::string name = std::to_string(i);
     page_id_t root_id;
-    EXPECT_EQ(page->GetRootId(name, root_id), true);
-    // std::cout << "root page id is " << root_id << '\n';
+    EXPECT_EQ(catalog.GetRootId(name, root_id), true);
+    EXPECT_EQ(root_id, i + 10);
   }
 
+  // a cold catalog must find the records back on the chain pages
+  catalog.Invalidate();
+  EXPECT_EQ(catalog.GetRecordCount(), 27);
+
   for (int i = 1; i < 28; i++) {
     std::string name = std::to_string(i);
-    EXPECT_EQ(page->DeleteRecord(name), true);
+    EXPECT_EQ(catalog.DeleteRecord(name), true);
   }
 
-  EXPECT_EQ(page->GetRecordCount(), 0);
+  EXPECT_EQ(catalog.GetRecordCount(), 0);
 
   // delete buffer_pool_manager;
   delete disk_manager;
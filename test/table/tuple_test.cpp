@@ -5,13 +5,18 @@
 #include <algorithm>
 #include <cstdio>
 #include <iostream>
+#include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "common/arena.h"
+#include "concurrency/transaction_manager.h"
 #include "logging/common.h"
 #include "table/table_heap.h"
 #include "table/tuple.h"
+#include "table/tuple_predicate.h"
 #include "vtable/virtual_table.h"
 #include "gtest/gtest.h"
 
@@ -61,4 +66,491 @@ TEST(TupleTest, TableHeapTest) {
   delete disk_manager;
 }
 
+TEST(TupleTest, ArenaTupleTest) {
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+  Arena arena;
+
+  std::vector<Value> values;
+  values.emplace_back(TypeId::BIGINT, (int64_t)99);
+  values.emplace_back(TypeId::VARCHAR, std::string("arena"));
+
+  // arena-backed materialization and clone carry the same bytes as the
+  // heap-allocated path, without owning them
+  Tuple heap_tuple(values, schema);
+  Tuple arena_tuple(values, schema, &arena);
+  EXPECT_FALSE(arena_tuple.IsAllocated());
+  EXPECT_EQ(arena_tuple.GetLength(), heap_tuple.GetLength());
+  EXPECT_EQ(arena_tuple.GetValue(schema, 0).GetAs<int64_t>(), 99);
+  EXPECT_EQ(arena_tuple.GetValue(schema, 1).ToString(), "arena");
+
+  Tuple clone = heap_tuple.Clone(&arena);
+  EXPECT_FALSE(clone.IsAllocated());
+  EXPECT_EQ(clone.GetValue(schema, 1).ToString(), "arena");
+
+  arena.Reset(); // bulk reclaim, no per-tuple frees
+  delete schema;
+}
+
+TEST(TupleTest, PredicateBatchTest) {
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+
+  std::vector<Tuple> tuples;
+  for (int64_t i = 0; i < 100; ++i) {
+    std::vector<Value> values;
+    values.emplace_back(TypeId::BIGINT, i);
+    values.emplace_back(TypeId::VARCHAR,
+                        std::string(i % 2 == 0 ? "even" : "odd"));
+    tuples.emplace_back(values, schema);
+  }
+
+  std::vector<uint8_t> selection;
+  // leaf on an inlined column: a < 10
+  TuplePredicate less_than(0, PredicateOp::LessThan,
+                           Value(TypeId::BIGINT, (int64_t)10));
+  EXPECT_EQ(less_than.Evaluate(tuples, schema, selection), (size_t)10);
+  for (size_t i = 0; i < tuples.size(); ++i) {
+    EXPECT_EQ(selection[i], i < 10 ? 1 : 0);
+  }
+
+  // leaf on a non-inlined column: b = 'even'
+  TuplePredicate equals(1, PredicateOp::Equals,
+                        Value(TypeId::VARCHAR, std::string("even")));
+  EXPECT_EQ(equals.Evaluate(tuples, schema, selection), (size_t)50);
+
+  // conjunction: a >= 20 AND a < 30 AND b = 'odd'
+  std::vector<TuplePredicate> children;
+  children.emplace_back(0, PredicateOp::GreaterThanEquals,
+                        Value(TypeId::BIGINT, (int64_t)20));
+  children.emplace_back(0, PredicateOp::LessThan,
+                        Value(TypeId::BIGINT, (int64_t)30));
+  children.emplace_back(1, PredicateOp::Equals,
+                        Value(TypeId::VARCHAR, std::string("odd")));
+  TuplePredicate conjunction(std::move(children));
+  EXPECT_EQ(conjunction.Evaluate(tuples, schema, selection), (size_t)5);
+  for (size_t i = 0; i < tuples.size(); ++i) {
+    EXPECT_EQ(selection[i], (i >= 20 && i < 30 && i % 2 == 1) ? 1 : 0);
+  }
+
+  delete schema;
+}
+
+TEST(TupleTest, TupleViewTest) {
+  Schema *schema = ParseCreateStatement("a bigint, b smallint");
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(50, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+
+  std::vector<Value> values;
+  values.emplace_back(TypeId::BIGINT, (int64_t)7);
+  values.emplace_back(TypeId::SMALLINT, (int16_t)3);
+  Tuple tuple(values, schema);
+  RID rid;
+  EXPECT_TRUE(table->InsertTuple(tuple, rid, transaction));
+
+  {
+    // the view reads straight from the pinned page, no allocation
+    PinnedTuple view;
+    EXPECT_TRUE(table->GetTupleView(rid, view, transaction));
+    EXPECT_FALSE(const_cast<Tuple &>(view.Get()).IsAllocated());
+    EXPECT_EQ(view.Get().GetValue(schema, 0).GetAs<int64_t>(), 7);
+    EXPECT_EQ(view.Get().GetValue(schema, 1).GetAs<int16_t>(), 3);
+  } // destruction releases the latch and pin
+
+  // a missing tuple leaves the handle empty
+  PinnedTuple missing;
+  EXPECT_FALSE(table->GetTupleView(RID(rid.GetPageId(), 99), missing,
+                                   transaction));
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+TEST(TupleTest, OverflowTupleTest) {
+  Schema *schema = ParseCreateStatement("a varchar(2000), b bigint");
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(50, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+
+  // far larger than one 512 byte page, so the payload must overflow
+  std::string payload(1500, 'x');
+  std::vector<Value> values;
+  values.emplace_back(TypeId::VARCHAR, payload);
+  values.emplace_back(TypeId::BIGINT, (int64_t)42);
+  Tuple tuple(values, schema);
+
+  RID rid;
+  EXPECT_TRUE(table->InsertTuple(tuple, rid, transaction));
+
+  // reads resolve the overflow chain transparently
+  Tuple read_tuple;
+  EXPECT_TRUE(table->GetTuple(rid, read_tuple, transaction));
+  EXPECT_EQ(read_tuple.GetLength(), tuple.GetLength());
+  EXPECT_EQ(read_tuple.GetValue(schema, 0).ToString(), payload);
+  EXPECT_EQ(read_tuple.GetValue(schema, 1).GetAs<int64_t>(), 42);
+
+  // the iterator path goes through the same resolution
+  TableIterator itr = table->begin(transaction);
+  EXPECT_EQ((*itr).GetLength(), tuple.GetLength());
+
+  // deleting the tuple reclaims the chain along with the slot
+  EXPECT_TRUE(table->MarkDelete(rid, transaction));
+  table->ApplyDelete(rid, transaction);
+  EXPECT_FALSE(table->GetTuple(rid, read_tuple, transaction));
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+TEST(TupleTest, BatchInsertTest) {
+  std::string createStmt =
+      "a varchar, b smallint, c bigint, d bool, e varchar(16)";
+  Schema *schema = ParseCreateStatement(createStmt);
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(50, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 1000; ++i) {
+    tuples.push_back(ConstructTuple(schema));
+  }
+  std::vector<RID> rids;
+  EXPECT_TRUE(table->InsertTuples(tuples, rids, transaction));
+  EXPECT_EQ(rids.size(), tuples.size());
+
+  // every returned rid must resolve back to a tuple
+  Tuple read_tuple;
+  for (auto rid : rids) {
+    EXPECT_TRUE(table->GetTuple(rid, read_tuple, transaction));
+  }
+
+  // the batch and single-tuple paths share one page chain
+  RID rid;
+  EXPECT_TRUE(table->InsertTuple(tuples[0], rid, transaction));
+  EXPECT_TRUE(table->GetTuple(rid, read_tuple, transaction));
+
+  size_t count = 0;
+  TableIterator itr = table->begin(transaction);
+  while (itr != table->end()) {
+    ++count;
+    ++itr;
+  }
+  EXPECT_EQ(count, tuples.size() + 1);
+
+  // the vectorized scan must see the same tuples, page at a time
+  RID cursor;
+  std::vector<Tuple> scanned;
+  while (table->ScanBatch(cursor, scanned, 128, transaction) == 128) {
+  }
+  EXPECT_EQ(scanned.size(), tuples.size() + 1);
+
+  // partitioned scan: disjoint segments that together cover the table
+  auto partitions = table->GetScanPartitions(4);
+  EXPECT_GT(partitions.size(), 1u);
+  size_t partitioned_count = 0;
+  for (const auto &partition : partitions) {
+    std::vector<Tuple> partition_tuples;
+    partitioned_count +=
+        table->ScanPages(partition, partition_tuples, transaction);
+  }
+  EXPECT_EQ(partitioned_count, tuples.size() + 1);
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+TEST(TupleTest, TruncateTest) {
+  std::string createStmt =
+      "a varchar, b smallint, c bigint, d bool, e varchar(16)";
+  Schema *schema = ParseCreateStatement(createStmt);
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(50, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+
+  RID rid;
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_TRUE(table->InsertTuple(ConstructTuple(schema), rid, transaction));
+  }
+
+  // the chain spans several pages; all but the first go back at once
+  EXPECT_GT(table->Truncate(transaction), 0);
+
+  size_t count = 0;
+  for (TableIterator itr = table->begin(transaction); itr != table->end();
+       ++itr) {
+    ++count;
+  }
+  EXPECT_EQ(count, (size_t)0);
+
+  // the truncated table keeps working: inserts land on the fresh first page
+  Tuple read_tuple;
+  EXPECT_TRUE(table->InsertTuple(ConstructTuple(schema), rid, transaction));
+  EXPECT_TRUE(table->GetTuple(rid, read_tuple, transaction));
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+// a declared batch transaction stages its inserts privately: nothing is
+// visible (or undone page by page) before commit, everything is after
+TEST(TupleTest, DeferredBatchInsertTest) {
+  std::string createStmt =
+      "a varchar, b smallint, c bigint, d bool, e varchar(16)";
+  Schema *schema = ParseCreateStatement(createStmt);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(50, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TransactionManager txn_mgr{lock_manager, log_manager};
+
+  Transaction *setup = txn_mgr.Begin();
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, setup);
+  txn_mgr.Commit(setup);
+
+  auto count_rows = [&]() {
+    Transaction *reader = txn_mgr.Begin();
+    size_t count = 0;
+    for (TableIterator itr = table->begin(reader); itr != table->end(); ++itr) {
+      ++count;
+    }
+    txn_mgr.Commit(reader);
+    txn_mgr.Recycle(reader);
+    return count;
+  };
+
+  // an aborted batch is a pure workspace discard: no pages were touched,
+  // no write records accumulated for the undo walk
+  Transaction *doomed = txn_mgr.Begin();
+  doomed->SetDeferredWrites(true);
+  RID rid;
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(table->InsertTuple(ConstructTuple(schema), rid, doomed));
+  }
+  EXPECT_TRUE(doomed->GetWriteSet()->empty());
+  txn_mgr.Abort(doomed);
+  txn_mgr.Recycle(doomed);
+  EXPECT_EQ(count_rows(), (size_t)0);
+
+  // a committed batch stays private until commit, then publishes in full
+  Transaction *batch = txn_mgr.Begin();
+  batch->SetDeferredWrites(true);
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 100; ++i) {
+    tuples.push_back(ConstructTuple(schema));
+  }
+  std::vector<RID> rids;
+  EXPECT_TRUE(table->InsertTuples(tuples, rids, batch));
+  EXPECT_TRUE(table->InsertTuple(ConstructTuple(schema), rid, batch));
+  EXPECT_EQ(count_rows(), (size_t)0);
+  txn_mgr.Commit(batch);
+  txn_mgr.Recycle(batch);
+  EXPECT_EQ(count_rows(), (size_t)101);
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+// a scan attaching mid-stream starts at the published position and wraps
+// around, yet both scans must still see every tuple exactly once
+TEST(TupleTest, SharedScanTest) {
+  std::string createStmt =
+      "a varchar, b smallint, c bigint, d bool, e varchar(16)";
+  Schema *schema = ParseCreateStatement(createStmt);
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(50, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 1000; ++i) {
+    tuples.push_back(ConstructTuple(schema));
+  }
+  std::vector<RID> rids;
+  EXPECT_TRUE(table->InsertTuples(tuples, rids, transaction));
+
+  // a lone shared scan behaves like a plain full scan
+  SharedScan solo;
+  table->BeginSharedScan(solo);
+  std::vector<Tuple> solo_tuples;
+  while (solo.NextPage(solo_tuples, transaction)) {
+  }
+  EXPECT_EQ(solo_tuples.size(), tuples.size());
+  EXPECT_FALSE(solo.NextPage(solo_tuples, transaction)); // stays finished
+
+  // leader reads a few pages ahead, then a follower attaches mid-stream
+  SharedScan leader;
+  table->BeginSharedScan(leader);
+  std::vector<Tuple> leader_tuples;
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(leader.NextPage(leader_tuples, transaction));
+  }
+  SharedScan follower;
+  table->BeginSharedScan(follower);
+  std::vector<Tuple> follower_tuples;
+  while (leader.NextPage(leader_tuples, transaction)) {
+  }
+  while (follower.NextPage(follower_tuples, transaction)) {
+  }
+  // the follower circled back over the leader's head start
+  EXPECT_EQ(leader_tuples.size(), tuples.size());
+  EXPECT_EQ(follower_tuples.size(), tuples.size());
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+TEST(TupleTest, ParallelScanTest) {
+  std::string createStmt =
+      "a varchar, b smallint, c bigint, d bool, e varchar(16)";
+  Schema *schema = ParseCreateStatement(createStmt);
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(50, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 1000; ++i) {
+    tuples.push_back(ConstructTuple(schema));
+  }
+  std::vector<RID> rids;
+  EXPECT_TRUE(table->InsertTuples(tuples, rids, transaction));
+
+  // every page goes to exactly one worker: the union of the four private
+  // result sets is the whole table, with no row seen twice
+  ParallelScan scan(table);
+  std::vector<std::vector<Tuple>> worker_tuples(4);
+  std::vector<std::thread> workers;
+  for (int w = 0; w < 4; ++w) {
+    workers.emplace_back([&scan, &worker_tuples, transaction, w] {
+      while (scan.NextPage(worker_tuples[w], transaction)) {
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  std::set<int64_t> seen;
+  size_t total = 0;
+  for (auto &partition : worker_tuples) {
+    total += partition.size();
+    for (auto &tuple : partition) {
+      seen.insert(tuple.GetRid().Get());
+    }
+  }
+  EXPECT_EQ(total, tuples.size());
+  EXPECT_EQ(seen.size(), tuples.size());
+
+  // a finished scan stays finished
+  std::vector<Tuple> extra;
+  EXPECT_FALSE(scan.NextPage(extra, transaction));
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+TEST(TupleTest, NullBitmapTest) {
+  std::string createStmt = "a int, b varchar(16), c smallint";
+  Schema *schema = ParseCreateStatement(createStmt);
+
+  std::vector<Value> values;
+  values.emplace_back(TypeId::INTEGER); // typed null
+  values.emplace_back(TypeId::VARCHAR, std::string("hello"));
+  values.emplace_back(TypeId::SMALLINT, (int16_t)7);
+  Tuple tuple(values, schema);
+
+  // IsNull reads one bitmap bit; GetValue short-circuits to a typed null
+  EXPECT_TRUE(tuple.IsNull(schema, 0));
+  EXPECT_FALSE(tuple.IsNull(schema, 1));
+  EXPECT_FALSE(tuple.IsNull(schema, 2));
+  EXPECT_TRUE(tuple.GetValue(schema, 0).IsNull());
+  EXPECT_EQ(tuple.GetValue(schema, 1).ToString(), "hello");
+  Value c = tuple.GetValue(schema, 2);
+  EXPECT_EQ(c.CompareEquals(Value(TypeId::SMALLINT, (int16_t)7)), CMP_TRUE);
+
+  // serialization round trip keeps the bitmap
+  char storage[128];
+  tuple.SerializeTo(storage);
+  Tuple copy;
+  copy.DeserializeFrom(storage);
+  EXPECT_TRUE(copy.IsNull(schema, 0));
+  EXPECT_FALSE(copy.IsNull(schema, 1));
+
+  // a null varchar stores no payload, so the tuple shrinks relative to
+  // its non-null twin
+  std::vector<Value> null_values;
+  null_values.emplace_back(TypeId::INTEGER, (int32_t)1);
+  null_values.emplace_back(TypeId::VARCHAR); // typed null
+  null_values.emplace_back(TypeId::SMALLINT, (int16_t)7);
+  Tuple null_tuple(null_values, schema);
+  EXPECT_TRUE(null_tuple.IsNull(schema, 1));
+  EXPECT_TRUE(null_tuple.GetValue(schema, 1).IsNull());
+  EXPECT_LT(null_tuple.GetLength(), tuple.GetLength());
+
+  delete schema;
+}
+
 } // namespace cmudb
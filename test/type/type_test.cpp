@@ -2,6 +2,7 @@
  * type_test.cpp
  */
 #include "common/exception.h"
+#include "type/type_kernels.h"
 #include "type/value.h"
 #include "gtest/gtest.h"
 
@@ -68,6 +69,114 @@ TEST(TypeTests, MinValueTest) {
   EXPECT_EQ(val1.CompareEquals(val2), CMP_TRUE);
 }
 
+TEST(TypeTests, VarcharSmallBufferTest) {
+  // short strings live inline; copies, assignment and moves must keep the
+  // value self-contained
+  std::string shrt = "short";
+  std::string lng(100, 'L');
+  Value small(TypeId::VARCHAR, shrt);
+  Value large(TypeId::VARCHAR, lng);
+
+  Value small_copy(small);
+  Value large_copy(large);
+  EXPECT_EQ(small_copy.CompareEquals(small), CMP_TRUE);
+  EXPECT_EQ(large_copy.CompareEquals(large), CMP_TRUE);
+
+  Value moved_small(std::move(small_copy));
+  Value moved_large(std::move(large_copy));
+  EXPECT_EQ(moved_small.CompareEquals(small), CMP_TRUE);
+  EXPECT_EQ(moved_large.CompareEquals(large), CMP_TRUE);
+  EXPECT_TRUE(large_copy.IsNull()); // the heap buffer changed owner
+
+  Value assigned(TypeId::VARCHAR);
+  assigned = moved_small;
+  EXPECT_EQ(assigned.CompareEquals(small), CMP_TRUE);
+  assigned = std::move(moved_large);
+  EXPECT_EQ(assigned.CompareEquals(large), CMP_TRUE);
+
+  // values swapped across the small/large boundary stay intact
+  swap(small, large);
+  EXPECT_EQ(small.ToString(), lng);
+  EXPECT_EQ(large.ToString(), shrt);
+}
+
+TEST(TypeTests, RawKernelTest) {
+  // the typed kernels must order values exactly like the virtual path
+  char lhs[8], rhs[8];
+  Value v1(TypeId::BIGINT, (int64_t)-5);
+  Value v2(TypeId::BIGINT, (int64_t)17);
+  v1.SerializeTo(lhs);
+  v2.SerializeTo(rhs);
+  EXPECT_EQ(CompareRaw<TypeId::BIGINT>(lhs, rhs), -1);
+  EXPECT_EQ(CompareRaw<TypeId::BIGINT>(rhs, lhs), 1);
+  EXPECT_EQ(CompareRaw<TypeId::BIGINT>(lhs, lhs), 0);
+
+  // runtime dispatch resolves to the same kernels, once per batch
+  auto cmp = GetRawComparator(TypeId::DECIMAL);
+  Value d1(TypeId::DECIMAL, 2.5);
+  Value d2(TypeId::DECIMAL, 2.5);
+  d1.SerializeTo(lhs);
+  d2.SerializeTo(rhs);
+  EXPECT_EQ(cmp(lhs, rhs), 0);
+
+  char vl[64], vr[64];
+  Value s1(TypeId::VARCHAR, std::string("apple"));
+  Value s2(TypeId::VARCHAR, std::string("apples"));
+  s1.SerializeTo(vl);
+  s2.SerializeTo(vr);
+  auto vcmp = GetRawComparator(TypeId::VARCHAR);
+  EXPECT_EQ(vcmp(vl, vr), -1); // shorter value orders first on a tie
+  EXPECT_EQ(vcmp(vr, vl), 1);
+  EXPECT_EQ(vcmp(vl, vl), 0);
+
+  // arithmetic kernel over a packed column
+  char column[10 * sizeof(int32_t)];
+  for (int i = 0; i < 10; ++i) {
+    StoreRaw<TypeId::INTEGER>(column + i * sizeof(int32_t), i);
+  }
+  EXPECT_EQ(SumRaw<TypeId::INTEGER>(column, sizeof(int32_t), 10), 45.0);
+}
+
+TEST(TypeTests, ByteKernelTest) {
+  // the chunked kernels must agree with memcmp on every length,
+  // including ones that are not a multiple of the 16-byte chunk
+  std::string base(70, 'a');
+  for (size_t len = 0; len <= base.size(); ++len) {
+    std::string lhs = base.substr(0, len);
+    std::string rhs = lhs;
+    EXPECT_EQ(CompareBytes(lhs.data(), rhs.data(), len), 0);
+    EXPECT_TRUE(EqualBytes(lhs.data(), rhs.data(), len));
+    if (len == 0) {
+      continue;
+    }
+    // flip one byte at the front, middle and back of the buffer
+    for (size_t pos : {(size_t)0, len / 2, len - 1}) {
+      rhs = lhs;
+      rhs[pos] = 'b';
+      EXPECT_EQ(CompareBytes(lhs.data(), rhs.data(), len), -1);
+      EXPECT_EQ(CompareBytes(rhs.data(), lhs.data(), len), 1);
+      EXPECT_FALSE(EqualBytes(lhs.data(), rhs.data(), len));
+    }
+  }
+
+  // bytes compare as unsigned, like memcmp
+  char neg[] = {'\x80'};
+  char pos[] = {'\x01'};
+  EXPECT_EQ(CompareBytes(pos, neg, 1), -1);
+  EXPECT_EQ(CompareBytes(neg, pos, 1), 1);
+
+  // the hash is deterministic, seed-sensitive and spreads nearby keys
+  std::string key(40, 'k');
+  EXPECT_EQ(HashBytes(key.data(), key.size(), 7),
+            HashBytes(key.data(), key.size(), 7));
+  EXPECT_NE(HashBytes(key.data(), key.size(), 7),
+            HashBytes(key.data(), key.size(), 8));
+  std::string twin = key;
+  twin[39] = 'l';
+  EXPECT_NE(HashBytes(key.data(), key.size(), 7),
+            HashBytes(twin.data(), twin.size(), 7));
+}
+
 TEST(TypeTests, TemplateTest) {
   std::string temp = "32";
   Value val1(TypeId::INTEGER, 32);
@@ -1,6 +1,7 @@
 /**
  * virtual_table_test.cpp
  */
+#include "vtable/table_stats.h"
 #include "vtable/testing_vtable_util.h"
 
 namespace cmudb {
@@ -44,4 +45,269 @@ TEST(VtableTest, CreateTest) {
   remove("vtable.db");
   return;
 }
+
+namespace {
+int CountCallback(void *count, int, char **, char **) {
+  ++*static_cast<int *>(count);
+  return 0;
+}
+
+int CountRows(sqlite3 *db, const std::string &sql) {
+  int count = 0;
+  char *zErrMsg = 0;
+  int rc = sqlite3_exec(db, sql.c_str(), CountCallback, &count, &zErrMsg);
+  if (rc != SQLITE_OK) {
+    std::cerr << "SQL error: " + std::string(zErrMsg) << std::endl;
+    sqlite3_free(zErrMsg);
+    return -1;
+  }
+  return count;
+}
+
+int FirstIntCallback(void *result, int argc, char **argv, char **) {
+  if (argc > 0 && argv[0] != nullptr) {
+    *static_cast<int *>(result) = std::atoi(argv[0]);
+  }
+  return 0;
+}
+
+// first column of the first result row as an int, -1 on error
+int QueryInt(sqlite3 *db, const std::string &sql) {
+  int result = -1;
+  char *zErrMsg = 0;
+  int rc = sqlite3_exec(db, sql.c_str(), FirstIntCallback, &result, &zErrMsg);
+  if (rc != SQLITE_OK) {
+    std::cerr << "SQL error: " + std::string(zErrMsg) << std::endl;
+    sqlite3_free(zErrMsg);
+    return -1;
+  }
+  return result;
+}
+} // namespace
+
+TEST(VtableTest, RangeScanTest) {
+  std::string db_file = "sqlite.db";
+  remove(db_file.c_str());
+  remove("vtable.db");
+  sqlite3 *db;
+  EXPECT_EQ(sqlite3_open(db_file.c_str(), &db), SQLITE_OK);
+  EXPECT_EQ(sqlite3_enable_load_extension(db, 1), SQLITE_OK);
+  EXPECT_EQ(sqlite3_load_extension(db, "libvtable", 0, 0), SQLITE_OK);
+
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo2 USING vtable "
+                          "('a bigint, b varchar', 'foo2_pk a')"));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo2 VALUES(" + std::to_string(i) +
+                                ", 'row')"));
+  }
+
+  // range predicates on the indexed column, all four op combinations
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo2 WHERE a > 90"), 9);
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo2 WHERE a >= 90"), 10);
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo2 WHERE a < 10"), 10);
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo2 WHERE a >= 10 AND a <= 19"), 10);
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo2 WHERE a > 10 AND a < 19"), 8);
+  // point query and full scan still behave
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo2 WHERE a = 42"), 1);
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo2"), 100);
+
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo2"));
+  EXPECT_EQ(sqlite3_close(db), SQLITE_OK);
+  remove(db_file.c_str());
+  remove("vtable.db");
+}
+
+TEST(VtableTest, CompositeKeyScanTest) {
+  std::string db_file = "sqlite.db";
+  remove(db_file.c_str());
+  remove("vtable.db");
+  sqlite3 *db;
+  EXPECT_EQ(sqlite3_open(db_file.c_str(), &db), SQLITE_OK);
+  EXPECT_EQ(sqlite3_enable_load_extension(db, 1), SQLITE_OK);
+  EXPECT_EQ(sqlite3_load_extension(db, "libvtable", 0, 0), SQLITE_OK);
+
+  // (tenant, timestamp) style composite index on (a, b)
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo3 USING vtable "
+                          "('a bigint, b bigint, c varchar', 'foo3_pk a, b')"));
+  for (int tenant = 0; tenant < 10; ++tenant) {
+    for (int ts = 0; ts < 20; ++ts) {
+      EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo3 VALUES(" +
+                                  std::to_string(tenant) + ", " +
+                                  std::to_string(ts) + ", 'row')"));
+    }
+  }
+
+  // equality on the leading column alone scans one tenant's prefix
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo3 WHERE a = 7"), 20);
+  // per-tenant time ranges: prefix equality plus a bound on the next column
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo3 WHERE a = 7 AND b >= 5 AND "
+                          "b < 10"),
+            5);
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo3 WHERE a = 7 AND b > 5"), 14);
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo3 WHERE a = 7 AND b <= 3"), 4);
+  // full-key equality still resolves to a point probe
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo3 WHERE a = 7 AND b = 3"), 1);
+  // a bound on a non-leading column alone stays a sequential scan
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo3 WHERE b >= 15"), 50);
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo3"), 200);
+
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo3"));
+  EXPECT_EQ(sqlite3_close(db), SQLITE_OK);
+  remove(db_file.c_str());
+  remove("vtable.db");
+}
+
+TEST(VtableTest, TableStatsTest) {
+  TableStats stats;
+  EXPECT_EQ(stats.GetRowCount(), (size_t)0);
+  EXPECT_EQ(stats.GetDistinctKeys(), (size_t)0);
+
+  // 1000 rows over 10 distinct keys
+  for (int i = 0; i < 1000; ++i) {
+    stats.OnInsert();
+    stats.RecordKey(std::hash<std::string>()(std::to_string(i % 10)));
+  }
+  EXPECT_EQ(stats.GetRowCount(), (size_t)1000);
+  // linear counting should land close to the true cardinality
+  EXPECT_GE(stats.GetDistinctKeys(), (size_t)5);
+  EXPECT_LE(stats.GetDistinctKeys(), (size_t)20);
+
+  for (int i = 0; i < 400; ++i) {
+    stats.OnDelete();
+  }
+  EXPECT_EQ(stats.GetRowCount(), (size_t)600);
+}
+
+// index maintenance is deferred into the transaction's write set: a
+// rolled back transaction must leave no trace in index scans, and a
+// committed one must make every row reachable through the index
+TEST(VtableTest, DeferredIndexWriteTest) {
+  std::string db_file = "sqlite.db";
+  remove(db_file.c_str());
+  remove("vtable.db");
+  sqlite3 *db;
+  EXPECT_EQ(sqlite3_open(db_file.c_str(), &db), SQLITE_OK);
+  EXPECT_EQ(sqlite3_enable_load_extension(db, 1), SQLITE_OK);
+  EXPECT_EQ(sqlite3_load_extension(db, "libvtable", 0, 0), SQLITE_OK);
+
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo4 USING vtable "
+                          "('a bigint, b varchar', 'foo4_pk a')"));
+  EXPECT_TRUE(ExecSQL(db, "BEGIN"));
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo4 VALUES(" + std::to_string(i) +
+                                ", 'payload')"));
+  }
+  EXPECT_TRUE(ExecSQL(db, "COMMIT"));
+
+  // committed rows are reachable through index point probes
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo4 WHERE a = 7"), 1);
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo4"), 20);
+
+  // an aborted transaction leaves the index untouched
+  EXPECT_TRUE(ExecSQL(db, "BEGIN"));
+  for (int i = 20; i < 40; ++i) {
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo4 VALUES(" + std::to_string(i) +
+                                ", 'doomed')"));
+  }
+  EXPECT_TRUE(ExecSQL(db, "ROLLBACK"));
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo4 WHERE a = 25"), 0);
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo4 WHERE a = 7"), 1);
+
+  // deletes queued behind inserts in one transaction net out in order
+  EXPECT_TRUE(ExecSQL(db, "BEGIN"));
+  EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo4 VALUES(100, 'transient')"));
+  EXPECT_TRUE(ExecSQL(db, "DELETE FROM foo4 WHERE a = 100"));
+  EXPECT_TRUE(ExecSQL(db, "DELETE FROM foo4 WHERE a = 3"));
+  EXPECT_TRUE(ExecSQL(db, "COMMIT"));
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo4 WHERE a = 100"), 0);
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo4 WHERE a = 3"), 0);
+  EXPECT_EQ(CountRows(db, "SELECT * FROM foo4"), 19);
+
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo4"));
+  EXPECT_EQ(sqlite3_close(db), SQLITE_OK);
+  remove(db_file.c_str());
+  remove("vtable.db");
+}
+
+// MIN/MAX and ORDER BY on the indexed column ride the ordered index
+// walk (sqlite consumes the order and reads a single row for its
+// MIN/MAX rewrite), and COUNT(*) runs as a covering scan of the leaf
+// chain instead of a heap scan
+TEST(VtableTest, OrderedIndexScanTest) {
+  std::string db_file = "sqlite.db";
+  remove(db_file.c_str());
+  remove("vtable.db");
+  sqlite3 *db;
+  EXPECT_EQ(sqlite3_open(db_file.c_str(), &db), SQLITE_OK);
+  EXPECT_EQ(sqlite3_enable_load_extension(db, 1), SQLITE_OK);
+  EXPECT_EQ(sqlite3_load_extension(db, "libvtable", 0, 0), SQLITE_OK);
+
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo6 USING vtable "
+                          "('a bigint, b varchar', 'foo6_pk a')"));
+  // insert out of key order so the leaf chain does the sorting
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo6 VALUES(" +
+                                std::to_string(i * 37 % 100) + ", 'row')"));
+  }
+
+  EXPECT_EQ(QueryInt(db, "SELECT MIN(a) FROM foo6"), 0);
+  EXPECT_EQ(QueryInt(db, "SELECT MAX(a) FROM foo6"), 99);
+  EXPECT_EQ(QueryInt(db, "SELECT COUNT(*) FROM foo6"), 100);
+  // both directions come back pre-sorted, complete and correct
+  EXPECT_EQ(QueryInt(db, "SELECT a FROM foo6 ORDER BY a LIMIT 1"), 0);
+  EXPECT_EQ(QueryInt(db, "SELECT a FROM foo6 ORDER BY a DESC LIMIT 1"), 99);
+  EXPECT_EQ(CountRows(db, "SELECT a FROM foo6 ORDER BY a"), 100);
+  EXPECT_EQ(CountRows(db, "SELECT a FROM foo6 ORDER BY a DESC"), 100);
+  // a key constraint keeps the range plan; the aggregate stays correct
+  EXPECT_EQ(QueryInt(db, "SELECT MAX(a) FROM foo6 WHERE a < 50"), 49);
+  EXPECT_EQ(QueryInt(db, "SELECT COUNT(*) FROM foo6 WHERE a >= 90"), 10);
+  // non-indexed columns fall back off the covering plan but still order
+  EXPECT_EQ(CountRows(db, "SELECT b FROM foo6 ORDER BY a"), 100);
+
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo6"));
+  EXPECT_EQ(sqlite3_close(db), SQLITE_OK);
+  remove(db_file.c_str());
+  remove("vtable.db");
+}
+
+// two connections to the same database get independent transaction
+// contexts: each runs its own statements without stomping on the other
+// connection's active transaction
+TEST(VtableTest, PerConnectionTransactionTest) {
+  std::string db_file = "sqlite.db";
+  remove(db_file.c_str());
+  remove("vtable.db");
+  sqlite3 *db1;
+  sqlite3 *db2;
+  EXPECT_EQ(sqlite3_open(db_file.c_str(), &db1), SQLITE_OK);
+  EXPECT_EQ(sqlite3_enable_load_extension(db1, 1), SQLITE_OK);
+  EXPECT_EQ(sqlite3_load_extension(db1, "libvtable", 0, 0), SQLITE_OK);
+  EXPECT_TRUE(ExecSQL(db1, "CREATE VIRTUAL TABLE foo5 USING vtable "
+                           "('a bigint, b varchar', 'foo5_pk a')"));
+  EXPECT_TRUE(ExecSQL(db1, "INSERT INTO foo5 VALUES(1, 'one')"));
+
+  // second connection attaches to the same table while the first stays
+  // open; its statements run in its own transaction context
+  EXPECT_EQ(sqlite3_open(db_file.c_str(), &db2), SQLITE_OK);
+  EXPECT_EQ(sqlite3_enable_load_extension(db2, 1), SQLITE_OK);
+  EXPECT_EQ(sqlite3_load_extension(db2, "libvtable", 0, 0), SQLITE_OK);
+  EXPECT_EQ(CountRows(db2, "SELECT * FROM foo5"), 1);
+  EXPECT_TRUE(ExecSQL(db2, "INSERT INTO foo5 VALUES(2, 'two')"));
+
+  // alternating writers: each commit is visible to the other connection
+  EXPECT_TRUE(ExecSQL(db1, "INSERT INTO foo5 VALUES(3, 'three')"));
+  EXPECT_EQ(CountRows(db1, "SELECT * FROM foo5"), 3);
+  EXPECT_EQ(CountRows(db2, "SELECT * FROM foo5"), 3);
+  EXPECT_EQ(CountRows(db2, "SELECT * FROM foo5 WHERE a = 2"), 1);
+
+  // closing one connection must not disturb the other's context
+  EXPECT_EQ(sqlite3_close(db2), SQLITE_OK);
+  EXPECT_TRUE(ExecSQL(db1, "INSERT INTO foo5 VALUES(4, 'four')"));
+  EXPECT_EQ(CountRows(db1, "SELECT * FROM foo5"), 4);
+
+  EXPECT_TRUE(ExecSQL(db1, "DROP TABLE foo5"));
+  EXPECT_EQ(sqlite3_close(db1), SQLITE_OK);
+  remove(db_file.c_str());
+  remove("vtable.db");
+}
 } // namespace cmudb